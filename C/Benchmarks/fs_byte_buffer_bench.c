@@ -0,0 +1,1037 @@
+//
+//  fs_byte_buffer_bench.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 22/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+//  Times every fs_byte_buffer_* operation and reports ns/op and
+//  bytes/s, as a table or as csv / json to diff runs against.
+//
+//  fs_byte_buffer_bench [--quick] [--filter text] [--format table|csv|json]
+//
+
+#include <time.h>
+
+#include "fuse_private.h"
+
+#define BENCH_CAPACITY (1024 * 1024)
+#define BENCH_VALUES   4096
+
+/* shortest run a sample is taken from */
+#define BENCH_MIN_NS       (50 * 1000 * 1000)
+#define BENCH_MIN_NS_QUICK (1 * 1000 * 1000)
+#define BENCH_SAMPLES       5
+
+typedef struct {
+    const char* name;
+
+    /* bytes moved per op, 0 if meaningless */
+    uint32_t bytes;
+
+    /* runs at least iterations ops, returns how many */
+    uint64_t (*run)(uint64_t iterations);
+} bench_case_t;
+
+typedef enum {
+    BENCH_FORMAT_TABLE,
+    BENCH_FORMAT_CSV,
+    BENCH_FORMAT_JSON
+} bench_format_t;
+
+/* shared by every case, reset on each run */
+static fs_byte_buffer_t      bench_buffer;
+static fs_byte_buffer_pool_t bench_pool;
+static fs_byte_t             bench_bytes[BENCH_CAPACITY];
+
+/* source values for the bulk cases */
+static int16_t  bench_int16s[BENCH_VALUES];
+static int32_t  bench_int32s[BENCH_VALUES];
+static int64_t  bench_int64s[BENCH_VALUES];
+static uint32_t bench_varints[BENCH_VALUES];
+
+/* keeps results alive without
+ * a dependency on every value */
+static volatile int64_t bench_sink;
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static inline void bench_check(int result, const char *what)
+{
+    if (result != FS_OKAY)
+    {
+        fprintf(stderr, "%s failed: %s\n", what, fs_error_to_string(result));
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void bench_setup(void)
+{
+    bench_check(fs_byte_buffer_pool_init(&bench_pool, 0), "fs_byte_buffer_pool_init");
+    bench_check(fs_byte_buffer_init(&bench_buffer, BENCH_CAPACITY), "fs_byte_buffer_init");
+
+    /* mostly small varints, a few
+     * long ones like real payloads */
+    for (uint32_t i = 0; i < BENCH_VALUES; i++)
+    {
+        bench_int16s[i]  = (int16_t) (i * 31);
+        bench_int32s[i]  = (int32_t) (i * 2654435761u);
+        bench_int64s[i]  = (int64_t) i * 0x9E3779B97F4A7C15ll;
+        bench_varints[i] = i % 8 == 0 ? i * 40503u : i % 100;
+    }
+
+    for (uint32_t i = 0; i < BENCH_CAPACITY; i++)
+    {
+        bench_bytes[i] = (fs_byte_t) i;
+    }
+}
+
+/* the whole buffer readable, nothing read yet */
+static void bench_fill(void)
+{
+    bench_buffer.reader_index = 0;
+    bench_buffer.writer_index = BENCH_CAPACITY;
+}
+
+/* --> primitives <-- */
+
+#define BENCH_GET(name, type, fn) \
+static uint64_t bench_##name(uint64_t iterations) \
+{ \
+    int64_t sum = 0; \
+    \
+    bench_fill(); \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        type value = 0; \
+        bench_check(fn(&bench_buffer, (uint32_t) (i % BENCH_VALUES) * sizeof(type), &value), #fn); \
+        sum += value; \
+    } \
+    \
+    bench_sink = sum; \
+    \
+    return iterations; \
+}
+
+#define BENCH_SET(name, type, fn) \
+static uint64_t bench_##name(uint64_t iterations) \
+{ \
+    bench_fill(); \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        bench_check(fn(&bench_buffer, (uint32_t) (i % BENCH_VALUES) * sizeof(type), (type) i), #fn); \
+    } \
+    \
+    return iterations; \
+}
+
+/* rounds of BENCH_VALUES, rewinding in between */
+#define BENCH_READ(name, type, fn) \
+static uint64_t bench_##name(uint64_t iterations) \
+{ \
+    int64_t sum = 0; \
+    uint64_t rounds = (iterations + BENCH_VALUES - 1) / BENCH_VALUES; \
+    \
+    bench_fill(); \
+    \
+    for (uint64_t round = 0; round < rounds; round++) \
+    { \
+        bench_buffer.reader_index = 0; \
+        \
+        for (uint32_t i = 0; i < BENCH_VALUES; i++) \
+        { \
+            type value = 0; \
+            bench_check(fn(&bench_buffer, &value), #fn); \
+            sum += value; \
+        } \
+    } \
+    \
+    bench_sink = sum; \
+    \
+    return rounds * BENCH_VALUES; \
+}
+
+#define BENCH_WRITE(name, type, fn) \
+static uint64_t bench_##name(uint64_t iterations) \
+{ \
+    uint64_t rounds = (iterations + BENCH_VALUES - 1) / BENCH_VALUES; \
+    \
+    for (uint64_t round = 0; round < rounds; round++) \
+    { \
+        bench_buffer.writer_index = 0; \
+        \
+        for (uint32_t i = 0; i < BENCH_VALUES; i++) \
+        { \
+            bench_check(fn(&bench_buffer, (type) i), #fn); \
+        } \
+    } \
+    \
+    return rounds * BENCH_VALUES; \
+}
+
+#define BENCH_PRIMITIVE(name, type) \
+BENCH_GET  (get_##name,   type, fs_byte_buffer_get_##name) \
+BENCH_SET  (set_##name,   type, fs_byte_buffer_set_##name) \
+BENCH_READ (read_##name,  type, fs_byte_buffer_read_##name) \
+BENCH_WRITE(write_##name, type, fs_byte_buffer_write_##name)
+
+BENCH_PRIMITIVE(int8,     int8_t)
+BENCH_PRIMITIVE(int16_be, int16_t)
+BENCH_PRIMITIVE(int16_le, int16_t)
+BENCH_PRIMITIVE(int32_be, int32_t)
+BENCH_PRIMITIVE(int32_le, int32_t)
+BENCH_PRIMITIVE(int64_be, int64_t)
+BENCH_PRIMITIVE(int64_le, int64_t)
+
+/* header-only accessors, for comparison */
+BENCH_PRIMITIVE(int32_be_inline, int32_t)
+BENCH_PRIMITIVE(int64_le_inline, int64_t)
+
+/* --> bulk bytes <-- */
+
+#define BENCH_BYTES(length) \
+static uint64_t bench_get_bytes_##length(uint64_t iterations) \
+{ \
+    bench_fill(); \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        uint32_t offset = (uint32_t) (i % (BENCH_CAPACITY / length)) * length; \
+        bench_check(fs_byte_buffer_get_bytes(&bench_buffer, offset, length, bench_bytes), "fs_byte_buffer_get_bytes"); \
+    } \
+    \
+    return iterations; \
+} \
+\
+static uint64_t bench_set_bytes_##length(uint64_t iterations) \
+{ \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        uint32_t offset = (uint32_t) (i % (BENCH_CAPACITY / length)) * length; \
+        bench_check(fs_byte_buffer_set_bytes(&bench_buffer, length, offset, bench_bytes), "fs_byte_buffer_set_bytes"); \
+    } \
+    \
+    return iterations; \
+} \
+\
+static uint64_t bench_read_bytes_##length(uint64_t iterations) \
+{ \
+    bench_fill(); \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        if (bench_buffer.reader_index == BENCH_CAPACITY) \
+        { \
+            bench_buffer.reader_index = 0; \
+        } \
+        \
+        bench_check(fs_byte_buffer_read_bytes(&bench_buffer, length, bench_bytes), "fs_byte_buffer_read_bytes"); \
+    } \
+    \
+    return iterations; \
+} \
+\
+static uint64_t bench_write_bytes_##length(uint64_t iterations) \
+{ \
+    bench_buffer.writer_index = 0; \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        if (bench_buffer.writer_index == BENCH_CAPACITY) \
+        { \
+            bench_buffer.writer_index = 0; \
+        } \
+        \
+        bench_check(fs_byte_buffer_write_bytes(&bench_buffer, length, bench_bytes), "fs_byte_buffer_write_bytes"); \
+    } \
+    \
+    return iterations; \
+}
+
+BENCH_BYTES(64)
+BENCH_BYTES(4096)
+BENCH_BYTES(65536)
+
+/* --> bulk integers and varints, one op is BENCH_VALUES values <-- */
+
+#define BENCH_ARRAY(name, type, values) \
+static uint64_t bench_write_##name##_array(uint64_t iterations) \
+{ \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        bench_buffer.writer_index = 0; \
+        bench_check(fs_byte_buffer_write_##name##_array(&bench_buffer, values, BENCH_VALUES), "fs_byte_buffer_write_" #name "_array"); \
+    } \
+    \
+    return iterations; \
+} \
+\
+static uint64_t bench_read_##name##_array(uint64_t iterations) \
+{ \
+    static type out[BENCH_VALUES]; \
+    \
+    bench_fill(); \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        bench_buffer.reader_index = 0; \
+        bench_check(fs_byte_buffer_read_##name##_array(&bench_buffer, out, BENCH_VALUES), "fs_byte_buffer_read_" #name "_array"); \
+    } \
+    \
+    bench_sink = out[BENCH_VALUES - 1]; \
+    \
+    return iterations; \
+}
+
+BENCH_ARRAY(int16_be, int16_t, bench_int16s)
+BENCH_ARRAY(int32_be, int32_t, bench_int32s)
+BENCH_ARRAY(int32_le, int32_t, bench_int32s)
+BENCH_ARRAY(int64_be, int64_t, bench_int64s)
+
+static uint64_t bench_write_varint32(uint64_t iterations)
+{
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        bench_buffer.writer_index = 0;
+
+        for (uint32_t v = 0; v < BENCH_VALUES; v++)
+        {
+            bench_check(fs_byte_buffer_write_varint32(&bench_buffer, bench_varints[v]), "fs_byte_buffer_write_varint32");
+        }
+    }
+
+    return iterations;
+}
+
+static uint64_t bench_read_varint32(uint64_t iterations)
+{
+    uint64_t sum = 0;
+
+    /* leaves the encoded values in place */
+    bench_write_varint32(1);
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        bench_buffer.reader_index = 0;
+
+        for (uint32_t v = 0; v < BENCH_VALUES; v++)
+        {
+            uint32_t value = 0;
+            bench_check(fs_byte_buffer_read_varint32(&bench_buffer, &value), "fs_byte_buffer_read_varint32");
+            sum += value;
+        }
+    }
+
+    bench_sink = (int64_t) sum;
+
+    return iterations;
+}
+
+static uint64_t bench_read_varint32_array(uint64_t iterations)
+{
+    static uint32_t out[BENCH_VALUES];
+
+    bench_write_varint32(1);
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        bench_buffer.reader_index = 0;
+        bench_check(fs_byte_buffer_read_varint32_array(&bench_buffer, out, BENCH_VALUES), "fs_byte_buffer_read_varint32_array");
+    }
+
+    bench_sink = out[BENCH_VALUES - 1];
+
+    return iterations;
+}
+
+/* --> slices and copies <-- */
+
+static uint64_t bench_get_slice(uint64_t iterations)
+{
+    fs_byte_buffer_t slice;
+
+    bench_fill();
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        bench_check(fs_byte_buffer_get_slice(&bench_buffer, (uint32_t) (i % BENCH_VALUES), 64, &slice), "fs_byte_buffer_get_slice");
+        bench_check(fs_byte_buffer_release(&slice), "fs_byte_buffer_release");
+    }
+
+    return iterations;
+}
+
+static uint64_t bench_copy_4096(uint64_t iterations)
+{
+    fs_byte_buffer_t src;
+    fs_byte_buffer_t dst;
+
+    bench_check(fs_byte_buffer_init(&src, 4096), "fs_byte_buffer_init");
+    bench_check(fs_byte_buffer_init(&dst, 4096), "fs_byte_buffer_init");
+
+    src.writer_index = 4096;
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        bench_check(fs_byte_buffer_copy(&dst, &src), "fs_byte_buffer_copy");
+    }
+
+    fs_byte_buffer_free(&src);
+    fs_byte_buffer_free(&dst);
+
+    return iterations;
+}
+
+/* --> delimiter search, one op scans a 4096 B line <-- */
+
+#define BENCH_LINE 4096
+
+static const fs_byte_t bench_crlf[] = { '\r', '\n' };
+
+/* line of printable bytes with a few lone '\r'
+ * in it, ended by the only "\r\n" */
+static void bench_fill_line(fs_byte_buffer_t *line)
+{
+    bench_check(fs_byte_buffer_init(line, BENCH_LINE), "fs_byte_buffer_init");
+
+    for (uint32_t i = 0; i < BENCH_LINE - 2; i++)
+    {
+        line->heap[i] = (i % 512 == 511) ? '\r': (fs_byte_t) ('a' + i % 26);
+    }
+
+    line->heap[BENCH_LINE - 2] = '\r';
+    line->heap[BENCH_LINE - 1] = '\n';
+    line->writer_index = BENCH_LINE;
+}
+
+static int bench_is_not_lf(void *context, fs_byte_t value)
+{
+    (void) context;
+
+    return value != '\n' ? FS_YES: FS_NO;
+}
+
+static uint64_t bench_index_of_4096(uint64_t iterations)
+{
+    fs_byte_buffer_t line;
+    uint32_t found = 0;
+
+    bench_fill_line(&line);
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        bench_check(fs_byte_buffer_index_of(&line, 0, BENCH_LINE, '\n', &found), "fs_byte_buffer_index_of");
+        bench_sink += found;
+    }
+
+    fs_byte_buffer_free(&line);
+
+    return iterations;
+}
+
+static uint64_t bench_index_of_sequence_4096(uint64_t iterations)
+{
+    fs_byte_buffer_t line;
+    uint32_t found = 0;
+
+    bench_fill_line(&line);
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        bench_check(fs_byte_buffer_index_of_sequence(&line, 0, BENCH_LINE, bench_crlf, sizeof(bench_crlf), &found), "fs_byte_buffer_index_of_sequence");
+        bench_sink += found;
+    }
+
+    fs_byte_buffer_free(&line);
+
+    return iterations;
+}
+
+static uint64_t bench_for_each_byte_4096(uint64_t iterations)
+{
+    fs_byte_buffer_t line;
+    uint32_t found = 0;
+
+    bench_fill_line(&line);
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        bench_check(fs_byte_buffer_for_each_byte(&line, 0, BENCH_LINE, bench_is_not_lf, NULL, &found), "fs_byte_buffer_for_each_byte");
+        bench_sink += found;
+    }
+
+    fs_byte_buffer_free(&line);
+
+    return iterations;
+}
+
+/* what callers did before, one checked get per byte */
+static uint64_t bench_get_int8_scan_4096(uint64_t iterations)
+{
+    fs_byte_buffer_t line;
+
+    bench_fill_line(&line);
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        uint32_t at = 0;
+        int8_t value = 0;
+
+        for (; at < BENCH_LINE; at++)
+        {
+            bench_check(fs_byte_buffer_get_int8(&line, at, &value), "fs_byte_buffer_get_int8");
+
+            if (value == '\n')
+            {
+                break;
+            }
+        }
+
+        bench_sink += at;
+    }
+
+    fs_byte_buffer_free(&line);
+
+    return iterations;
+}
+
+/* --> checksums over the readable bytes <-- */
+
+#define BENCH_CHECKSUM(length) \
+static uint64_t bench_crc32c_##length(uint64_t iterations) \
+{ \
+    uint32_t crc = 0; \
+    \
+    bench_fill(); \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        bench_check(fs_byte_buffer_crc32c(&bench_buffer, 0, length, crc, &crc), "fs_byte_buffer_crc32c"); \
+    } \
+    \
+    bench_sink = crc; \
+    \
+    return iterations; \
+} \
+\
+static uint64_t bench_xxhash64_##length(uint64_t iterations) \
+{ \
+    uint64_t hash = 0; \
+    \
+    bench_fill(); \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        bench_check(fs_byte_buffer_xxhash64(&bench_buffer, 0, length, hash, &hash), "fs_byte_buffer_xxhash64"); \
+    } \
+    \
+    bench_sink = (int64_t) hash; \
+    \
+    return iterations; \
+}
+
+BENCH_CHECKSUM(64)
+BENCH_CHECKSUM(4096)
+BENCH_CHECKSUM(65536)
+
+/* --> UTF-8 validation, 64 KiB of ascii and of mixed text <-- */
+
+#define BENCH_TEXT 65536
+
+static void bench_fill_text(fs_byte_buffer_t *text, const char *sample)
+{
+    uint32_t length = (uint32_t) strlen(sample);
+
+    bench_check(fs_byte_buffer_init(text, BENCH_TEXT), "fs_byte_buffer_init");
+
+    /* whole samples only, so sequences are never cut */
+    while (BENCH_TEXT - text->writer_index >= length)
+    {
+        bench_check(fs_byte_buffer_write_bytes(text, length, (const fs_byte_t *) sample), "fs_byte_buffer_write_bytes");
+    }
+}
+
+#define BENCH_VALIDATE_UTF8(name, sample) \
+static uint64_t bench_validate_utf8_##name(uint64_t iterations) \
+{ \
+    fs_byte_buffer_t text; \
+    int ascii = FS_NO; \
+    \
+    bench_fill_text(&text, sample); \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        bench_check(fs_byte_buffer_validate_utf8(&text, 0, text.writer_index, &ascii), "fs_byte_buffer_validate_utf8"); \
+        bench_sink += ascii; \
+    } \
+    \
+    fs_byte_buffer_free(&text); \
+    \
+    return iterations; \
+}
+
+BENCH_VALIDATE_UTF8(ascii_65536, "GET /index.html HTTP/1.1\r\nHost: example.com\r\n")
+BENCH_VALIDATE_UTF8(mixed_65536, "caf\xc3\xa9 \xe2\x82\xac" "5 \xe6\x97\xa5\xe6\x9c\xac \xf0\x9f\x98\x80 na\xc3\xafve text, ")
+
+/* --> block compression, 64 KiB of telemetry-like text <-- */
+
+#define BENCH_BLOCK 65536
+
+static void bench_fill_block(fs_byte_buffer_t *block)
+{
+    bench_check(fs_byte_buffer_init(block, BENCH_BLOCK), "fs_byte_buffer_init");
+
+    /* repetitive keys, changing values */
+    for (uint32_t n = 0; block->writer_index < BENCH_BLOCK; n++)
+    {
+        char line[96];
+        int length = snprintf(line, sizeof(line), "{\"ts\":%u,\"host\":\"node-%u\",\"cpu\":%u.%02u}\n", 1529990000 + n, n % 16, n * 7 % 100, n * 13 % 100);
+        uint32_t count = (uint32_t) length < BENCH_BLOCK - block->writer_index ? (uint32_t) length : BENCH_BLOCK - block->writer_index;
+
+        bench_check(fs_byte_buffer_write_bytes(block, count, (const fs_byte_t *) line), "fs_byte_buffer_write_bytes");
+    }
+}
+
+static uint64_t bench_compress_65536(uint64_t iterations)
+{
+    fs_byte_buffer_t block;
+    fs_byte_buffer_t compressed;
+    uint32_t written = 0;
+
+    bench_fill_block(&block);
+    bench_check(fs_byte_buffer_init(&compressed, (uint32_t) FS_COMPRESS_BOUND(BENCH_BLOCK)), "fs_byte_buffer_init");
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        block.reader_index = 0;
+        compressed.writer_index = 0;
+
+        bench_check(fs_byte_buffer_write_compressed(&compressed, &block, BENCH_BLOCK, &bench_pool, &written), "fs_byte_buffer_write_compressed");
+        bench_sink += written;
+    }
+
+    fs_byte_buffer_free(&compressed);
+    fs_byte_buffer_free(&block);
+
+    return iterations;
+}
+
+static uint64_t bench_decompress_65536(uint64_t iterations)
+{
+    fs_byte_buffer_t block;
+    fs_byte_buffer_t compressed;
+    uint32_t written = 0;
+
+    bench_fill_block(&block);
+    bench_check(fs_byte_buffer_init(&compressed, (uint32_t) FS_COMPRESS_BOUND(BENCH_BLOCK)), "fs_byte_buffer_init");
+    bench_check(fs_byte_buffer_write_compressed(&compressed, &block, BENCH_BLOCK, &bench_pool, &written), "fs_byte_buffer_write_compressed");
+
+    for (uint64_t i = 0; i < iterations; i++)
+    {
+        compressed.reader_index = 0;
+        block.writer_index = 0;
+
+        bench_check(fs_byte_buffer_write_decompressed(&block, &compressed, written, BENCH_BLOCK), "fs_byte_buffer_write_decompressed");
+        bench_sink += block.heap[i % BENCH_BLOCK];
+    }
+
+    fs_byte_buffer_free(&compressed);
+    fs_byte_buffer_free(&block);
+
+    return iterations;
+}
+
+/* --> growth, one op grows a buffer from 64 B up to target <-- */
+
+#define BENCH_TARGET_BELOW (4 * 1024 * 1024)
+#define BENCH_TARGET_ABOVE (16 * 1024 * 1024)
+
+static void bench_grow(fs_byte_buffer_t *buffer, uint32_t target)
+{
+    while (buffer->capacity < target)
+    {
+        /* full buffers copy every byte */
+        buffer->writer_index = buffer->capacity;
+        bench_check(fs_byte_buffer_resize(buffer, buffer->capacity + 1), "fs_byte_buffer_resize");
+    }
+}
+
+#define BENCH_RESIZE(name, target, init) \
+static uint64_t bench_resize_##name(uint64_t iterations) \
+{ \
+    fs_byte_buffer_t buffer; \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        bench_check(init, "fs_byte_buffer_init"); \
+        bench_grow(&buffer, target); \
+        fs_byte_buffer_free(&buffer); \
+    } \
+    \
+    return iterations; \
+}
+
+BENCH_RESIZE(4m,         BENCH_TARGET_BELOW, fs_byte_buffer_init(&buffer, 64))
+BENCH_RESIZE(16m,        BENCH_TARGET_ABOVE, fs_byte_buffer_init(&buffer, 64))
+BENCH_RESIZE(pooled_4m,  BENCH_TARGET_BELOW, fs_byte_buffer_init_pooled(&buffer, &bench_pool, 64))
+BENCH_RESIZE(pooled_16m, BENCH_TARGET_ABOVE, fs_byte_buffer_init_pooled(&buffer, &bench_pool, 64))
+BENCH_RESIZE(mmap_16m,   BENCH_TARGET_ABOVE, fs_byte_buffer_init_mmap(&buffer, 64))
+
+/* one op writes BENCH_TARGET_ABOVE bytes into an empty
+ * buffer, growing it from inside the write calls */
+#define BENCH_WRITE_GROW(name, init) \
+static uint64_t bench_write_grow_##name(uint64_t iterations) \
+{ \
+    fs_byte_buffer_t buffer; \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        bench_check(init, "fs_byte_buffer_init"); \
+        \
+        for (uint32_t n = 0; n < BENCH_TARGET_ABOVE / 4096; n++) \
+        { \
+            bench_check(fs_byte_buffer_write_bytes(&buffer, 4096, bench_bytes), "fs_byte_buffer_write_bytes"); \
+        } \
+        \
+        fs_byte_buffer_free(&buffer); \
+    } \
+    \
+    return iterations; \
+}
+
+BENCH_WRITE_GROW(16m,        fs_byte_buffer_init(&buffer, 64))
+BENCH_WRITE_GROW(pooled_16m, fs_byte_buffer_init_pooled(&buffer, &bench_pool, 64))
+
+/* --> init / free churn <-- */
+
+#define BENCH_CHURN(name, capacity, init) \
+static uint64_t bench_churn_##name(uint64_t iterations) \
+{ \
+    fs_byte_buffer_t buffer; \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        bench_check(init, "fs_byte_buffer_init"); \
+        \
+        /* touch the memory */ \
+        buffer.heap[i % capacity] = (fs_byte_t) i; \
+        \
+        fs_byte_buffer_free(&buffer); \
+    } \
+    \
+    return iterations; \
+}
+
+BENCH_CHURN(256,          256,   fs_byte_buffer_init(&buffer, 256))
+BENCH_CHURN(65536,        65536, fs_byte_buffer_init(&buffer, 65536))
+BENCH_CHURN(pooled_256,   256,   fs_byte_buffer_init_pooled(&buffer, &bench_pool, 256))
+BENCH_CHURN(pooled_65536, 65536, fs_byte_buffer_init_pooled(&buffer, &bench_pool, 65536))
+BENCH_CHURN(mmap_65536,   65536, fs_byte_buffer_init_mmap(&buffer, 65536))
+BENCH_CHURN(ring_65536,   65536, fs_byte_buffer_init_ring(&buffer, 65536))
+
+/* --> compaction, like a stream consuming 3/4 of every 4 KiB read <-- */
+
+#define BENCH_DISCARD(name, init) \
+static uint64_t bench_discard_##name(uint64_t iterations) \
+{ \
+    fs_byte_buffer_t buffer; \
+    \
+    bench_check(init, "fs_byte_buffer_init"); \
+    \
+    for (uint64_t i = 0; i < iterations; i++) \
+    { \
+        bench_check(fs_byte_buffer_write_bytes(&buffer, 4096, bench_bytes), "fs_byte_buffer_write_bytes"); \
+        buffer.reader_index += 3072; \
+        bench_check(fs_byte_buffer_discard_read_bytes(&buffer), "fs_byte_buffer_discard_read_bytes"); \
+        \
+        /* keep the backlog from piling up */ \
+        if (buffer.writer_index > 32768) \
+        { \
+            buffer.reader_index = buffer.writer_index; \
+        } \
+    } \
+    \
+    fs_byte_buffer_free(&buffer); \
+    \
+    return iterations; \
+}
+
+BENCH_DISCARD(65536,      fs_byte_buffer_init(&buffer, 65536))
+BENCH_DISCARD(ring_65536, fs_byte_buffer_init_ring(&buffer, 65536))
+
+#define BENCH_CASE(name, bytes) { #name, bytes, bench_##name }
+
+#define BENCH_PRIMITIVE_CASES(name, type) \
+    BENCH_CASE(get_##name,   sizeof(type)), \
+    BENCH_CASE(set_##name,   sizeof(type)), \
+    BENCH_CASE(read_##name,  sizeof(type)), \
+    BENCH_CASE(write_##name, sizeof(type))
+
+#define BENCH_BYTES_CASES(length) \
+    BENCH_CASE(get_bytes_##length,   length), \
+    BENCH_CASE(set_bytes_##length,   length), \
+    BENCH_CASE(read_bytes_##length,  length), \
+    BENCH_CASE(write_bytes_##length, length)
+
+#define BENCH_ARRAY_CASES(name, type) \
+    BENCH_CASE(write_##name##_array, BENCH_VALUES * sizeof(type)), \
+    BENCH_CASE(read_##name##_array,  BENCH_VALUES * sizeof(type))
+
+static const bench_case_t bench_cases[] = {
+    BENCH_PRIMITIVE_CASES(int8,            int8_t),
+    BENCH_PRIMITIVE_CASES(int16_be,        int16_t),
+    BENCH_PRIMITIVE_CASES(int16_le,        int16_t),
+    BENCH_PRIMITIVE_CASES(int32_be,        int32_t),
+    BENCH_PRIMITIVE_CASES(int32_le,        int32_t),
+    BENCH_PRIMITIVE_CASES(int64_be,        int64_t),
+    BENCH_PRIMITIVE_CASES(int64_le,        int64_t),
+    BENCH_PRIMITIVE_CASES(int32_be_inline, int32_t),
+    BENCH_PRIMITIVE_CASES(int64_le_inline, int64_t),
+
+    BENCH_BYTES_CASES(64),
+    BENCH_BYTES_CASES(4096),
+    BENCH_BYTES_CASES(65536),
+
+    BENCH_ARRAY_CASES(int16_be, int16_t),
+    BENCH_ARRAY_CASES(int32_be, int32_t),
+    BENCH_ARRAY_CASES(int32_le, int32_t),
+    BENCH_ARRAY_CASES(int64_be, int64_t),
+
+    /* bytes are the decoded values */
+    BENCH_CASE(write_varint32,       BENCH_VALUES * sizeof(uint32_t)),
+    BENCH_CASE(read_varint32,        BENCH_VALUES * sizeof(uint32_t)),
+    BENCH_CASE(read_varint32_array,  BENCH_VALUES * sizeof(uint32_t)),
+
+    BENCH_CASE(get_slice, 0),
+    BENCH_CASE(copy_4096, 4096),
+
+    BENCH_CASE(index_of_4096,          BENCH_LINE),
+    BENCH_CASE(index_of_sequence_4096, BENCH_LINE),
+    BENCH_CASE(for_each_byte_4096,     BENCH_LINE),
+    BENCH_CASE(get_int8_scan_4096,     BENCH_LINE),
+
+    BENCH_CASE(crc32c_64,      64),
+    BENCH_CASE(crc32c_4096,    4096),
+    BENCH_CASE(crc32c_65536,   65536),
+    BENCH_CASE(xxhash64_64,    64),
+    BENCH_CASE(xxhash64_4096,  4096),
+    BENCH_CASE(xxhash64_65536, 65536),
+
+    /* the samples don't fill the last few bytes */
+    BENCH_CASE(validate_utf8_ascii_65536, BENCH_TEXT),
+    BENCH_CASE(validate_utf8_mixed_65536, BENCH_TEXT),
+
+    /* bytes are the uncompressed ones */
+    BENCH_CASE(compress_65536,   BENCH_BLOCK),
+    BENCH_CASE(decompress_65536, BENCH_BLOCK),
+
+    BENCH_CASE(resize_4m,         0),
+    BENCH_CASE(resize_16m,        0),
+    BENCH_CASE(resize_pooled_4m,  0),
+    BENCH_CASE(resize_pooled_16m, 0),
+    BENCH_CASE(resize_mmap_16m,   0),
+
+    BENCH_CASE(write_grow_16m,        BENCH_TARGET_ABOVE),
+    BENCH_CASE(write_grow_pooled_16m, BENCH_TARGET_ABOVE),
+
+    BENCH_CASE(churn_256,          0),
+    BENCH_CASE(churn_65536,        0),
+    BENCH_CASE(churn_pooled_256,   0),
+    BENCH_CASE(churn_pooled_65536, 0),
+    BENCH_CASE(churn_mmap_65536,   0),
+    BENCH_CASE(churn_ring_65536,   0),
+
+    BENCH_CASE(discard_65536,      4096),
+    BENCH_CASE(discard_ring_65536, 4096)
+};
+
+typedef struct {
+    uint64_t ops;
+    double   ns_per_op;
+    double   bytes_per_second;
+} bench_result_t;
+
+/* doubles the iterations until a run takes min_ns,
+ * then keeps the fastest of BENCH_SAMPLES runs */
+static bench_result_t bench_measure(const bench_case_t *bench, double min_ns)
+{
+    bench_result_t result = { 0, 0, 0 };
+
+    uint64_t iterations = 1;
+    double   elapsed;
+    uint64_t ops;
+
+    for (;;)
+    {
+        double start = bench_now();
+        ops = bench->run(iterations);
+        elapsed = bench_now() - start;
+
+        if (elapsed >= min_ns)
+        {
+            break;
+        }
+
+        /* aim a bit past min_ns, at most 10x at once */
+        double scale = elapsed > 0 ? min_ns * 1.2 / elapsed : 10;
+
+        iterations = (uint64_t) (iterations * (scale < 10 ? (scale > 2 ? scale : 2) : 10));
+    }
+
+    double best = elapsed / ops;
+
+    for (int sample = 1; sample < BENCH_SAMPLES; sample++)
+    {
+        double start = bench_now();
+        uint64_t done = bench->run(iterations);
+        double ns = (bench_now() - start) / done;
+
+        best = ns < best ? ns : best;
+    }
+
+    result.ops = ops;
+    result.ns_per_op = best;
+    result.bytes_per_second = bench->bytes > 0 ? bench->bytes * 1e9 / best : 0;
+
+    return result;
+}
+
+static void bench_print_header(bench_format_t format)
+{
+    switch (format)
+    {
+        case BENCH_FORMAT_TABLE:
+            printf("%-28s %12s %12s %12s\n", "benchmark", "ops", "ns/op", "MiB/s");
+            break;
+
+        case BENCH_FORMAT_CSV:
+            printf("name,ops,ns_per_op,bytes_per_second\n");
+            break;
+
+        case BENCH_FORMAT_JSON:
+            printf("{\n  \"benchmarks\": [\n");
+            break;
+    }
+}
+
+static void bench_print_result(bench_format_t format, const bench_case_t *bench, bench_result_t *result, int first)
+{
+    switch (format)
+    {
+        case BENCH_FORMAT_TABLE:
+            if (result->bytes_per_second > 0)
+            {
+                printf("%-28s %12llu %12.2f %12.1f\n", bench->name, (unsigned long long) result->ops, result->ns_per_op, result->bytes_per_second / (1024 * 1024));
+            }
+            else
+            {
+                printf("%-28s %12llu %12.2f %12s\n", bench->name, (unsigned long long) result->ops, result->ns_per_op, "-");
+            }
+            break;
+
+        case BENCH_FORMAT_CSV:
+            printf("%s,%llu,%.3f,%.0f\n", bench->name, (unsigned long long) result->ops, result->ns_per_op, result->bytes_per_second);
+            break;
+
+        case BENCH_FORMAT_JSON:
+            printf("%s    {\"name\": \"%s\", \"ops\": %llu, \"ns_per_op\": %.3f, \"bytes_per_second\": %.0f}",
+                   first ? "" : ",\n", bench->name, (unsigned long long) result->ops, result->ns_per_op, result->bytes_per_second);
+            break;
+    }
+
+    fflush(stdout);
+}
+
+static void bench_print_footer(bench_format_t format)
+{
+    if (format == BENCH_FORMAT_JSON)
+    {
+        printf("\n  ]\n}\n");
+    }
+}
+
+static void bench_usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [--quick] [--filter text] [--format table|csv|json]\n", program);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    bench_format_t format = BENCH_FORMAT_TABLE;
+    const char*    filter = NULL;
+    double         min_ns = BENCH_MIN_NS;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+        {
+            min_ns = BENCH_MIN_NS_QUICK;
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+        {
+            const char *name = argv[++i];
+
+            if (strcmp(name, "table") == 0)
+            {
+                format = BENCH_FORMAT_TABLE;
+            }
+            else if (strcmp(name, "csv") == 0)
+            {
+                format = BENCH_FORMAT_CSV;
+            }
+            else if (strcmp(name, "json") == 0)
+            {
+                format = BENCH_FORMAT_JSON;
+            }
+            else
+            {
+                bench_usage(argv[0]);
+            }
+        }
+        else
+        {
+            bench_usage(argv[0]);
+        }
+    }
+
+    bench_setup();
+    bench_print_header(format);
+
+    int first = 1;
+
+    for (size_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++)
+    {
+        const bench_case_t *bench = &bench_cases[i];
+
+        if (filter != NULL && strstr(bench->name, filter) == NULL)
+        {
+            continue;
+        }
+
+        bench_result_t result = bench_measure(bench, min_ns);
+
+        bench_print_result(format, bench, &result, first);
+        first = 0;
+    }
+
+    bench_print_footer(format);
+
+    fs_byte_buffer_free(&bench_buffer);
+    fs_byte_buffer_pool_free(&bench_pool);
+
+    return 0;
+}
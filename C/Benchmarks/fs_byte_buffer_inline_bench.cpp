@@ -0,0 +1,142 @@
+//
+//  fs_byte_buffer_inline_bench.cpp
+//  Fuse
+//
+//  Created by Jairo Tylera on 18/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+//  Compares the out-of-line primitive accessors against the
+//  header-only ones in fuse_inline.h and fuse.hpp.
+//
+//  cc -O2 -c -IC/Sources/headers C/Sources/*.c
+//  c++ -O2 -std=c++11 -IC/Sources/headers C/Benchmarks/fs_byte_buffer_inline_bench.cpp *.o -lpthread
+//
+
+#include <time.h>
+
+#include "fuse.hpp"
+
+#define BENCH_VALUES 4096
+#define BENCH_ROUNDS 2000
+
+static double bench_now()
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* keeps results alive without
+ * a dependency on every value */
+static volatile int64_t bench_sink;
+
+template <typename F>
+static double bench_run(fs_byte_buffer_t *buffer, F body)
+{
+    int64_t sum = 0;
+    
+    double start = bench_now();
+    
+    for (int round = 0; round < BENCH_ROUNDS; round++)
+    {
+        buffer->reader_index = 0;
+        buffer->writer_index = 0;
+        
+        sum += body(buffer);
+    }
+    
+    double elapsed = bench_now() - start;
+    
+    bench_sink = sum;
+    
+    /* ns per value, written and read back */
+    return elapsed / ((double) BENCH_ROUNDS * BENCH_VALUES);
+}
+
+static int64_t bench_out_of_line(fs_byte_buffer_t *buffer)
+{
+    int64_t sum = 0;
+    
+    for (int32_t i = 0; i < BENCH_VALUES; i++)
+    {
+        fs_byte_buffer_write_int32_be(buffer, i);
+    }
+    
+    for (int i = 0; i < BENCH_VALUES; i++)
+    {
+        int32_t value = 0;
+        fs_byte_buffer_read_int32_be(buffer, &value);
+        sum += value;
+    }
+    
+    return sum;
+}
+
+static int64_t bench_inline(fs_byte_buffer_t *buffer)
+{
+    int64_t sum = 0;
+    
+    for (int32_t i = 0; i < BENCH_VALUES; i++)
+    {
+        fs_byte_buffer_write_int32_be_inline(buffer, i);
+    }
+    
+    for (int i = 0; i < BENCH_VALUES; i++)
+    {
+        int32_t value = 0;
+        fs_byte_buffer_read_int32_be_inline(buffer, &value);
+        sum += value;
+    }
+    
+    return sum;
+}
+
+template <fs::Endianness E>
+static int64_t bench_template(fs_byte_buffer_t *handle)
+{
+    fs::ByteBuffer<E> &buffer = fs::ByteBuffer<E>::wrap(*handle);
+    
+    int64_t sum = 0;
+    
+    for (int32_t i = 0; i < BENCH_VALUES; i++)
+    {
+        buffer.write(i);
+    }
+    
+    for (int i = 0; i < BENCH_VALUES; i++)
+    {
+        int32_t value = 0;
+        buffer.read(value);
+        sum += value;
+    }
+    
+    return sum;
+}
+
+int main()
+{
+    fs_byte_buffer_t buffer;
+    
+    if (fs_byte_buffer_init(&buffer, BENCH_VALUES * sizeof(int32_t)) != FS_OKAY)
+    {
+        fprintf(stderr, "init failed\n");
+        return EXIT_FAILURE;
+    }
+    
+    double plain   = bench_run(&buffer, bench_out_of_line);
+    double inlined = bench_run(&buffer, bench_inline);
+    double big     = bench_run(&buffer, bench_template<fs::Endianness::big>);
+    double native  = bench_run(&buffer, bench_template<fs::Endianness::native>);
+    
+    printf("%-28s %10s %8s\n", "int32 write + read", "ns/value", "speedup");
+    printf("%-28s %10.3f %7.2fx\n", "fs_byte_buffer_*_int32_be", plain, 1.0);
+    printf("%-28s %10.3f %7.2fx\n", "fs_byte_buffer_*_be_inline", inlined, plain / inlined);
+    printf("%-28s %10.3f %7.2fx\n", "fs::ByteBuffer<big>", big, plain / big);
+    printf("%-28s %10.3f %7.2fx\n", "fs::ByteBuffer<native>", native, plain / native);
+    
+    fs_byte_buffer_free(&buffer);
+    
+    return 0;
+}
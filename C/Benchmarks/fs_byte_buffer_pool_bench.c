@@ -0,0 +1,132 @@
+//
+//  fs_byte_buffer_pool_bench.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 12/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+//  Compares fs_byte_buffer_init / fs_byte_buffer_free churn on
+//  plain malloc against fs_byte_buffer_init_pooled.
+//
+//  cc -O2 -IC/Sources/headers C/Sources/*.c C/Benchmarks/fs_byte_buffer_pool_bench.c -lpthread
+//
+
+#include <time.h>
+
+#include "fuse_private.h"
+
+#define BENCH_ITERATIONS 1000000
+#define BENCH_LIVE       16
+
+typedef struct {
+    fs_byte_buffer_pool_t* pool;
+    uint32_t capacity;
+    double   elapsed;
+} bench_args_t;
+
+static double bench_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* keeps a few buffers alive at once,
+ * like a pipeline with frames in flight */
+static void *bench_churn(void *arg)
+{
+    bench_args_t *args = arg;
+    fs_byte_buffer_t live[BENCH_LIVE];
+
+    double start = bench_now();
+
+    for (int i = 0; i < BENCH_ITERATIONS; i++)
+    {
+        fs_byte_buffer_t *buffer = &live[i % BENCH_LIVE];
+
+        if (i >= BENCH_LIVE)
+        {
+            fs_byte_buffer_free(buffer);
+        }
+
+        if (fs_byte_buffer_init_pooled(buffer, args->pool, args->capacity) != FS_OKAY)
+        {
+            fprintf(stderr, "init failed\n");
+            exit(EXIT_FAILURE);
+        }
+
+        /* touch the memory */
+        buffer->heap[0] = (fs_byte_t) i;
+    }
+
+    for (int i = 0; i < BENCH_LIVE; i++)
+    {
+        fs_byte_buffer_free(&live[i]);
+    }
+
+    args->elapsed = bench_now() - start;
+
+    return NULL;
+}
+
+static double bench_run(fs_byte_buffer_pool_t *pool, uint32_t capacity, int threads)
+{
+    pthread_t    tids[threads];
+    bench_args_t args[threads];
+
+    double total = 0;
+
+    for (int i = 0; i < threads; i++)
+    {
+        args[i].pool = pool;
+        args[i].capacity = capacity;
+
+        pthread_create(&tids[i], NULL, bench_churn, &args[i]);
+    }
+
+    for (int i = 0; i < threads; i++)
+    {
+        pthread_join(tids[i], NULL);
+        total += args[i].elapsed;
+    }
+
+    /* ns per init + free pair */
+    return total / ((double) threads * BENCH_ITERATIONS);
+}
+
+int main(void)
+{
+    static const uint32_t capacities[] = { 64, 256, 4096, 65536, 1024 * 1024 };
+    static const int threads[] = { 1, 4 };
+
+    fs_byte_buffer_pool_t pool;
+    fs_byte_buffer_pool_stats_t stats;
+
+    fs_byte_buffer_pool_init(&pool, 0);
+
+    printf("%-10s %-8s %12s %12s %8s\n", "capacity", "threads", "malloc ns", "pooled ns", "speedup");
+
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++)
+    {
+        for (size_t c = 0; c < sizeof(capacities) / sizeof(capacities[0]); c++)
+        {
+            double plain  = bench_run(NULL,  capacities[c], threads[t]);
+            double pooled = bench_run(&pool, capacities[c], threads[t]);
+
+            printf("%-10u %-8d %12.2f %12.2f %7.2fx\n", capacities[c], threads[t], plain, pooled, plain / pooled);
+        }
+    }
+
+    fs_byte_buffer_pool_stats(&pool, &stats);
+
+    printf("\npool: %llu hits, %llu misses, %llu bytes retained\n",
+           (unsigned long long) stats.hits,
+           (unsigned long long) stats.misses,
+           (unsigned long long) stats.bytes_retained);
+
+    fs_byte_buffer_pool_free(&pool);
+
+    return 0;
+}
@@ -0,0 +1,270 @@
+//
+//  fs_socket_bench.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 26/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+//  Streams small messages over loopback through one edge
+//  triggered event loop, queued in a composite buffer and sent
+//  one per call or gathered with fs_socket_writev. Every byte
+//  received is checked, any error aborts.
+//
+//  fs_socket_bench [--quick]
+//
+
+#include <time.h>
+#include <errno.h>
+#include <string.h>
+
+#include "fuse_private.h"
+
+#define BENCH_MESSAGE_LENGTH 128
+#define BENCH_SOURCE_LENGTH  (251 * 4096) // whole pattern periods
+#define BENCH_RCVBUF_LENGTH  (64 * 1024)
+#define BENCH_MAX_QUEUED     (256 * 1024) // per connection, like a high water mark
+
+typedef struct {
+    int fd;
+    int connected;
+    uint64_t sent;
+    uint64_t calls;
+    fs_composite_buffer_t queue;
+} bench_client_t;
+
+typedef struct {
+    int fd;
+    uint64_t received;
+    fs_byte_buffer_t rcvbuf;
+} bench_server_t;
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench_check(int result, const char *what)
+{
+    if (result != FS_OKAY)
+    {
+        fprintf(stderr, "%s failed: %s (%s)\n", what, fs_error_to_string(result), strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+}
+
+static inline fs_byte_t bench_pattern(uint64_t position)
+{
+    return (fs_byte_t) (position % 251);
+}
+
+/* queues messages up to the limit, each one a slice of source */
+static void bench_fill(bench_client_t *client, fs_byte_buffer_t *source, uint64_t total, uint64_t *queued)
+{
+    while (*queued < total && client->queue.writer_index - client->queue.reader_index < BENCH_MAX_QUEUED)
+    {
+        source->reader_index = (uint32_t) (*queued % BENCH_SOURCE_LENGTH);
+        
+        uint32_t saved = source->writer_index;
+        source->writer_index = source->reader_index + BENCH_MESSAGE_LENGTH;
+        
+        bench_check(fs_composite_buffer_add_component(&client->queue, source), "add component");
+        
+        source->writer_index = saved;
+        *queued += BENCH_MESSAGE_LENGTH;
+    }
+}
+
+/* sends until the socket would block, `max` bytes per call */
+static void bench_flush(bench_client_t *client, uint32_t max)
+{
+    while (client->queue.reader_index < client->queue.writer_index)
+    {
+        uint32_t written;
+        
+        bench_check(fs_socket_writev(client->fd, &client->queue, max, &written), "writev");
+        
+        client->calls += 1;
+        
+        if (written == 0)
+        {
+            break;
+        }
+        
+        client->sent += written;
+    }
+    
+    bench_check(fs_composite_buffer_discard_read_components(&client->queue), "discard");
+}
+
+static void bench_drain(bench_server_t *server)
+{
+    for (;;)
+    {
+        uint32_t count;
+        
+        server->rcvbuf.reader_index = 0;
+        server->rcvbuf.writer_index = 0;
+        
+        bench_check(fs_socket_read(server->fd, &server->rcvbuf, BENCH_RCVBUF_LENGTH, &count), "read");
+        
+        if (count == 0)
+        {
+            return;
+        }
+        
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (server->rcvbuf.heap[i] != bench_pattern(server->received + i))
+            {
+                fprintf(stderr, "corrupted byte at %llu\n", (unsigned long long) (server->received + i));
+                exit(EXIT_FAILURE);
+            }
+        }
+        
+        server->received += count;
+    }
+}
+
+/* returns ns taken to stream total bytes, `gather` bytes per call */
+static double bench_run(uint64_t total, uint32_t gather, uint64_t *calls)
+{
+    fs_socket_options_t options = { .nodelay = 1 };
+    fs_event_loop_t loop;
+    
+    int listener;
+    uint16_t port;
+    
+    bench_check(fs_event_loop_init(&loop), "event loop init");
+    bench_check(fs_socket_listen("127.0.0.1", 0, 16, &listener, &port), "listen");
+    bench_check(fs_event_loop_add(&loop, listener, &listener), "add listener");
+    
+    bench_client_t client = { .fd = -1 };
+    bench_server_t server = { .fd = -1 };
+    
+    fs_byte_buffer_t source;
+    
+    bench_check(fs_byte_buffer_init(&source, BENCH_SOURCE_LENGTH + BENCH_MESSAGE_LENGTH), "source init");
+    bench_check(fs_byte_buffer_init(&server.rcvbuf, BENCH_RCVBUF_LENGTH), "rcvbuf init");
+    bench_check(fs_composite_buffer_init(&client.queue, 64), "queue init");
+    
+    /* past the end too, messages may run over it */
+    for (uint32_t i = 0; i < source.capacity; i++)
+    {
+        source.heap[i] = bench_pattern(i);
+    }
+    
+    source.writer_index = source.capacity;
+    
+    bench_check(fs_socket_connect("127.0.0.1", port, &options, &client.fd), "connect");
+    bench_check(fs_event_loop_add(&loop, client.fd, &client), "add client");
+    
+    uint64_t queued = 0;
+    double   start  = bench_now();
+    
+    while (server.received < total)
+    {
+        fs_event_t events[16];
+        uint32_t count;
+        
+        bench_check(fs_event_loop_wait(&loop, events, 16, 1000, &count), "wait");
+        
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (events[i].context == &listener)
+            {
+                bench_check(fs_socket_accept(listener, &options, &server.fd), "accept");
+                
+                if (server.fd != -1)
+                {
+                    bench_check(fs_event_loop_add(&loop, server.fd, &server), "add server");
+                    bench_drain(&server);
+                }
+            }
+            else if (events[i].context == &server && (events[i].events & FS_EVENT_READ))
+            {
+                bench_drain(&server);
+            }
+            else if (events[i].context == &client && (events[i].events & FS_EVENT_WRITE))
+            {
+                if (!client.connected)
+                {
+                    bench_check(fs_socket_finish_connect(client.fd), "finish connect");
+                    client.connected = 1;
+                }
+                
+                bench_fill(&client, &source, total, &queued);
+                bench_flush(&client, gather);
+            }
+        }
+        
+        /* edge triggered, the client may still have room left */
+        if (client.connected && client.queue.reader_index == client.queue.writer_index && queued < total)
+        {
+            bench_fill(&client, &source, total, &queued);
+            bench_flush(&client, gather);
+        }
+    }
+    
+    double elapsed = bench_now() - start;
+    
+    if (server.received != total || client.sent != total)
+    {
+        fprintf(stderr, "sent %llu, received %llu of %llu\n",
+                (unsigned long long) client.sent, (unsigned long long) server.received, (unsigned long long) total);
+        exit(EXIT_FAILURE);
+    }
+    
+    *calls = client.calls;
+    
+    fs_composite_buffer_free(&client.queue);
+    fs_byte_buffer_free(&server.rcvbuf);
+    fs_byte_buffer_free(&source);
+    
+    fs_socket_close(client.fd);
+    fs_socket_close(server.fd);
+    fs_socket_close(listener);
+    fs_event_loop_free(&loop);
+    
+    return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t total = 256ull * 1024 * 1024;
+    
+    if (argc > 1 && strcmp(argv[1], "--quick") == 0)
+    {
+        total = 4 * 1024 * 1024;
+    }
+    
+    static const struct {
+        const char *name;
+        uint32_t gather;
+    } cases[] = {
+        { "send",   BENCH_MESSAGE_LENGTH },
+        { "writev", UINT32_MAX }
+    };
+    
+    uint64_t messages = total / BENCH_MESSAGE_LENGTH;
+    
+    printf("%-8s %12s %14s %14s\n", "case", "MiB/s", "messages/s", "calls/message");
+    
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        uint64_t calls;
+        
+        double elapsed = bench_run(total, cases[c].gather, &calls);
+        
+        printf("%-8s %12.1f %14.0f %14.4f\n",
+               cases[c].name,
+               total / (elapsed / 1e9) / (1024 * 1024),
+               messages / (elapsed / 1e9),
+               (double) calls / messages);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,523 @@
+//
+//  fs_uring_bench.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 26/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+//  Echo server over loopback, many connections at once, driven
+//  by readiness (edge triggered epoll, recv and writev) or by
+//  completions (io_uring, multishot accept and receive into
+//  pooled provided buffers, sends batched into one submit per
+//  turn). Counts the syscalls the server makes per message.
+//  Every byte echoed is checked, any error aborts.
+//
+//  fs_uring_bench [--quick]
+//
+
+#include <time.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "fuse_private.h"
+
+#define BENCH_MESSAGE_LENGTH 64
+#define BENCH_MAX_CONNECTIONS 256
+#define BENCH_RCVBUF_LENGTH  2048
+#define BENCH_RING_ENTRIES   1024
+#define BENCH_RING_BUFFERS   1024
+
+typedef struct {
+    int fd;
+    int sending;
+    fs_composite_buffer_t queue;
+    fs_uring_send_t send;
+} bench_connection_t;
+
+typedef struct {
+    uint16_t port;
+    uint32_t connections;
+    uint32_t rounds;
+} bench_clients_t;
+
+typedef struct {
+    int listener;
+    uint32_t accepted;
+    uint64_t echoed;
+    uint64_t syscalls;
+    fs_byte_buffer_pool_t pool;
+    bench_connection_t connections[BENCH_MAX_CONNECTIONS];
+} bench_server_t;
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench_check(int result, const char *what)
+{
+    if (result != FS_OKAY)
+    {
+        fprintf(stderr, "%s failed: %s (%s)\n", what, fs_error_to_string(result), strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+}
+
+static inline fs_byte_t bench_pattern(uint32_t connection, uint32_t round, uint32_t i)
+{
+    return (fs_byte_t) (connection * 31 + round * 7 + i);
+}
+
+/* blocking clients, every round sends one message on each
+ * connection and then waits for every echo to come back */
+static void *bench_clients(void *argument)
+{
+    bench_clients_t *clients = argument;
+    
+    int fds[BENCH_MAX_CONNECTIONS];
+    
+    struct sockaddr_in address;
+    
+    memset(&address, 0, sizeof(address));
+    
+    address.sin_family      = AF_INET;
+    address.sin_port        = htons(clients->port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    
+    for (uint32_t c = 0; c < clients->connections; c++)
+    {
+        int yes = 1;
+        
+        fds[c] = socket(AF_INET, SOCK_STREAM, 0);
+        
+        if (fds[c] == -1 || connect(fds[c], (struct sockaddr *) &address, sizeof(address)) == -1)
+        {
+            perror("client connect");
+            exit(EXIT_FAILURE);
+        }
+        
+        setsockopt(fds[c], IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    }
+    
+    fs_byte_t message[BENCH_MESSAGE_LENGTH];
+    
+    for (uint32_t r = 0; r < clients->rounds; r++)
+    {
+        for (uint32_t c = 0; c < clients->connections; c++)
+        {
+            for (uint32_t i = 0; i < BENCH_MESSAGE_LENGTH; i++)
+            {
+                message[i] = bench_pattern(c, r, i);
+            }
+            
+            if (send(fds[c], message, BENCH_MESSAGE_LENGTH, MSG_NOSIGNAL) != BENCH_MESSAGE_LENGTH)
+            {
+                perror("client send");
+                exit(EXIT_FAILURE);
+            }
+        }
+        
+        for (uint32_t c = 0; c < clients->connections; c++)
+        {
+            ssize_t received = 0;
+            
+            while (received < BENCH_MESSAGE_LENGTH)
+            {
+                ssize_t count = recv(fds[c], message + received, BENCH_MESSAGE_LENGTH - received, 0);
+                
+                if (count <= 0)
+                {
+                    perror("client recv");
+                    exit(EXIT_FAILURE);
+                }
+                
+                received += count;
+            }
+            
+            for (uint32_t i = 0; i < BENCH_MESSAGE_LENGTH; i++)
+            {
+                if (message[i] != bench_pattern(c, r, i))
+                {
+                    fprintf(stderr, "corrupted echo on connection %u, round %u\n", c, r);
+                    exit(EXIT_FAILURE);
+                }
+            }
+        }
+    }
+    
+    for (uint32_t c = 0; c < clients->connections; c++)
+    {
+        close(fds[c]);
+    }
+    
+    return NULL;
+}
+
+/* --> readiness <-- */
+
+static void bench_epoll_flush(bench_server_t *server, bench_connection_t *connection)
+{
+    while (connection->queue.reader_index < connection->queue.writer_index)
+    {
+        uint32_t written;
+        
+        server->syscalls += 1;
+        
+        bench_check(fs_socket_writev(connection->fd, &connection->queue, UINT32_MAX, &written), "writev");
+        
+        if (written == 0)
+        {
+            break;
+        }
+    }
+    
+    bench_check(fs_composite_buffer_discard_read_components(&connection->queue), "discard");
+}
+
+static void bench_epoll_drain(bench_server_t *server, bench_connection_t *connection)
+{
+    for (;;)
+    {
+        fs_byte_buffer_t rcvbuf;
+        uint32_t count;
+        
+        bench_check(fs_byte_buffer_init_pooled(&rcvbuf, &server->pool, BENCH_RCVBUF_LENGTH), "rcvbuf init");
+        
+        server->syscalls += 1;
+        
+        int result = fs_socket_read(connection->fd, &rcvbuf, BENCH_RCVBUF_LENGTH, &count);
+        
+        if (result == FS_ERR_EOF)
+        {
+            count = 0;
+            result = FS_OKAY;
+        }
+        
+        bench_check(result, "read");
+        
+        if (count > 0)
+        {
+            bench_check(fs_composite_buffer_add_component(&connection->queue, &rcvbuf), "queue");
+        }
+        
+        fs_byte_buffer_free(&rcvbuf);
+        
+        if (count == 0)
+        {
+            break;
+        }
+        
+        server->echoed += count;
+    }
+    
+    bench_epoll_flush(server, connection);
+}
+
+static void bench_epoll(bench_server_t *server, fs_socket_options_t *options, uint64_t total)
+{
+    fs_event_loop_t loop;
+    
+    bench_check(fs_event_loop_init(&loop), "event loop init");
+    bench_check(fs_event_loop_add(&loop, server->listener, server), "add listener");
+    
+    while (server->echoed < total)
+    {
+        fs_event_t events[64];
+        uint32_t count;
+        
+        server->syscalls += 1;
+        
+        bench_check(fs_event_loop_wait(&loop, events, 64, 1000, &count), "wait");
+        
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (events[i].context == server)
+            {
+                for (;;)
+                {
+                    int fd;
+                    
+                    server->syscalls += 1;
+                    
+                    bench_check(fs_socket_accept(server->listener, options, &fd), "accept");
+                    
+                    if (fd == -1)
+                    {
+                        break;
+                    }
+                    
+                    bench_connection_t *connection = &server->connections[server->accepted++];
+                    
+                    connection->fd = fd;
+                    
+                    server->syscalls += 1;
+                    
+                    bench_check(fs_event_loop_add(&loop, fd, connection), "add connection");
+                    bench_epoll_drain(server, connection);
+                }
+                
+                continue;
+            }
+            
+            bench_connection_t *connection = events[i].context;
+            
+            if (events[i].events & (FS_EVENT_READ | FS_EVENT_HANGUP))
+            {
+                bench_epoll_drain(server, connection);
+            }
+            else if (events[i].events & FS_EVENT_WRITE)
+            {
+                bench_epoll_flush(server, connection);
+            }
+        }
+    }
+    
+    fs_event_loop_free(&loop);
+}
+
+/* --> completions <-- */
+
+static void bench_uring_send(fs_uring_t *ring, bench_connection_t *connection)
+{
+    if (connection->sending || connection->queue.reader_index == connection->queue.writer_index)
+    {
+        return;
+    }
+    
+    bench_check(fs_uring_sendmsg(ring, connection->fd, &connection->send, &connection->queue, UINT32_MAX, connection), "sendmsg");
+    
+    connection->sending = 1;
+}
+
+static void bench_uring(bench_server_t *server, fs_uring_t *ring, fs_socket_options_t *options, uint64_t total)
+{
+    bench_check(fs_uring_accept(ring, server->listener, server), "accept");
+    
+    while (server->echoed < total)
+    {
+        fs_uring_event_t events[256];
+        uint32_t count;
+        
+        /* everything queued last turn goes in with the wait */
+        server->syscalls += 1;
+        
+        bench_check(fs_uring_submit(ring, 1), "submit");
+        
+        do
+        {
+            bench_check(fs_uring_reap(ring, events, 256, &count), "reap");
+            
+            for (uint32_t i = 0; i < count; i++)
+            {
+                fs_uring_event_t *event = &events[i];
+                
+                if (event->op == FS_URING_OP_ACCEPT)
+                {
+                    if (event->result < 0)
+                    {
+                        errno = -event->result;
+                        bench_check(FS_ERR_IO, "accept");
+                    }
+                    
+                    bench_connection_t *connection = &server->connections[server->accepted++];
+                    
+                    connection->fd = event->result;
+                    
+                    server->syscalls += 1;
+                    
+                    bench_check(fs_socket_set_options(connection->fd, options), "options");
+                    bench_check(fs_uring_recv(ring, connection->fd, connection), "recv");
+                    
+                    if (!(event->flags & FS_URING_MORE))
+                    {
+                        bench_check(fs_uring_accept(ring, server->listener, server), "accept");
+                    }
+                    
+                    continue;
+                }
+                
+                bench_connection_t *connection = event->context;
+                
+                if (event->op == FS_URING_OP_RECV)
+                {
+                    if (event->flags & FS_URING_BUFFER)
+                    {
+                        fs_byte_buffer_t bytes;
+                        
+                        bench_check(fs_uring_take_buffer(ring, event->buffer, (uint32_t) event->result, &bytes), "take buffer");
+                        bench_check(fs_composite_buffer_add_component(&connection->queue, &bytes), "queue");
+                        
+                        fs_byte_buffer_free(&bytes);
+                        
+                        server->echoed += (uint64_t) event->result;
+                        
+                        bench_uring_send(ring, connection);
+                    }
+                    
+                    /* out of buffers, or any other pause */
+                    if (!(event->flags & FS_URING_MORE) && event->result != 0)
+                    {
+                        if (event->result < 0 && event->result != -ENOBUFS)
+                        {
+                            errno = -event->result;
+                            bench_check(FS_ERR_IO, "recv");
+                        }
+                        
+                        bench_check(fs_uring_recv(ring, connection->fd, connection), "recv");
+                    }
+                }
+                else if (event->op == FS_URING_OP_SEND)
+                {
+                    if (event->result < 0)
+                    {
+                        errno = -event->result;
+                        bench_check(FS_ERR_IO, "send");
+                    }
+                    
+                    connection->queue.reader_index += (uint32_t) event->result;
+                    connection->sending = 0;
+                    
+                    bench_check(fs_composite_buffer_discard_read_components(&connection->queue), "discard");
+                    
+                    bench_uring_send(ring, connection);
+                }
+            }
+        }
+        while (count > 0);
+    }
+    
+    /* ends every multishot request before the descriptors go */
+    for (uint32_t c = 0; c < server->accepted; c++)
+    {
+        bench_check(fs_uring_cancel(ring, server->connections[c].fd), "cancel");
+    }
+    
+    bench_check(fs_uring_cancel(ring, server->listener), "cancel");
+    bench_check(fs_uring_submit(ring, 0), "submit");
+}
+
+/* returns ns taken to echo every message, `ring` NULL for epoll */
+static double bench_run(fs_uring_t *ring, uint32_t connections, uint32_t rounds, uint64_t *syscalls)
+{
+    static bench_server_t server;
+    
+    fs_socket_options_t options = { .nodelay = 1 };
+    
+    memset(&server, 0, sizeof(server));
+    
+    bench_check(fs_byte_buffer_pool_init(&server.pool, 64 * 1024 * 1024), "pool init");
+    
+    for (uint32_t c = 0; c < connections; c++)
+    {
+        bench_check(fs_composite_buffer_init(&server.connections[c].queue, 16), "queue init");
+    }
+    
+    uint16_t port;
+    
+    bench_check(fs_socket_listen("127.0.0.1", 0, BENCH_MAX_CONNECTIONS, &server.listener, &port), "listen");
+    
+    bench_clients_t clients = { .port = port, .connections = connections, .rounds = rounds };
+    pthread_t thread;
+    
+    uint64_t total = (uint64_t) connections * rounds * BENCH_MESSAGE_LENGTH;
+    double   start = bench_now();
+    
+    pthread_create(&thread, NULL, bench_clients, &clients);
+    
+    if (ring == NULL)
+    {
+        bench_epoll(&server, &options, total);
+    }
+    else
+    {
+        bench_uring(&server, ring, &options, total);
+    }
+    
+    pthread_join(thread, NULL);
+    
+    double elapsed = bench_now() - start;
+    
+    if (server.echoed != total)
+    {
+        fprintf(stderr, "echoed %llu of %llu\n", (unsigned long long) server.echoed, (unsigned long long) total);
+        exit(EXIT_FAILURE);
+    }
+    
+    *syscalls = server.syscalls;
+    
+    for (uint32_t c = 0; c < server.accepted; c++)
+    {
+        fs_socket_close(server.connections[c].fd);
+    }
+    
+    for (uint32_t c = 0; c < connections; c++)
+    {
+        fs_composite_buffer_free(&server.connections[c].queue);
+    }
+    
+    fs_socket_close(server.listener);
+    
+    return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t connections = 64;
+    uint32_t rounds      = 20000;
+    
+    if (argc > 1 && strcmp(argv[1], "--quick") == 0)
+    {
+        connections = 16;
+        rounds      = 200;
+    }
+    
+    /* a lost message would otherwise hang for ever */
+    alarm(300);
+    
+    fs_byte_buffer_pool_t pool;
+    fs_uring_t ring;
+    
+    bench_check(fs_byte_buffer_pool_init(&pool, 16 * 1024 * 1024), "pool init");
+    
+    int uring = fs_uring_init(&ring, BENCH_RING_ENTRIES, &pool, BENCH_RING_BUFFERS, BENCH_RCVBUF_LENGTH) == FS_OKAY;
+    
+    if (!uring)
+    {
+        printf("io_uring unavailable (%s), epoll only\n", strerror(errno));
+    }
+    
+    uint64_t messages = (uint64_t) connections * rounds;
+    
+    printf("%-8s %12s %14s %16s\n", "case", "messages/s", "syscalls", "syscalls/message");
+    
+    for (int c = 0; c < (uring ? 2 : 1); c++)
+    {
+        uint64_t syscalls;
+        
+        double elapsed = bench_run(c == 0 ? NULL : &ring, connections, rounds, &syscalls);
+        
+        printf("%-8s %12.0f %14llu %16.3f\n",
+               c == 0 ? "epoll" : "io_uring",
+               messages / (elapsed / 1e9),
+               (unsigned long long) syscalls,
+               (double) syscalls / messages);
+    }
+    
+    if (uring)
+    {
+        fs_uring_free(&ring);
+    }
+    
+    fs_byte_buffer_pool_free(&pool);
+    
+    return 0;
+}
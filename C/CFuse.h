@@ -15,3 +15,4 @@ FOUNDATION_EXPORT double CFuseVersionNumber;
 FOUNDATION_EXPORT const unsigned char CFuseVersionString[];
 
 #import "fuse.h"
+#import "fuse_inline.h"
@@ -0,0 +1,390 @@
+//
+//  fs_block_codec.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 26/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+//  LZ4 block format. Every sequence is a token (literal length
+//  in the high nibble, match length - 4 in the low one), the
+//  extra literal length bytes, the literals, a 16 bit little
+//  endian offset and the extra match length bytes. The last
+//  sequence holds literals only.
+//
+
+#include "fuse_private.h"
+
+#define BLOCK_MIN_MATCH     4
+#define BLOCK_LAST_LITERALS 5   // a block always ends with as many literals
+#define BLOCK_MATCH_LIMIT   12  // nor does any match start closer to its end
+#define BLOCK_MAX_OFFSET    65535
+#define BLOCK_SKIP_TRIGGER  6   // step up after 2^6 misses in a row
+
+static inline uint32_t fs_block_read32(const fs_byte_t *heap)
+{
+    uint32_t value;
+    memcpy(&value, heap, sizeof(value));
+    return value;
+}
+
+static inline uint64_t fs_block_read64(const fs_byte_t *heap)
+{
+    uint64_t value;
+    memcpy(&value, heap, sizeof(value));
+    return value;
+}
+
+static inline uint32_t fs_block_hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - FS_BLOCK_HASH_LOG);
+}
+
+/* bytes in common at ip and match, up to limit */
+static inline uint32_t fs_block_count(const fs_byte_t *ip, const fs_byte_t *match, const fs_byte_t *limit)
+{
+    const fs_byte_t *start = ip;
+    
+    while (ip + 8 <= limit)
+    {
+        uint64_t diff = fs_block_read64(ip) ^ fs_block_read64(match);
+        
+        if (diff != 0)
+        {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            return (uint32_t) (ip - start) + (__builtin_clzll(diff) >> 3);
+#else
+            return (uint32_t) (ip - start) + (__builtin_ctzll(diff) >> 3);
+#endif
+        }
+        
+        ip    += 8;
+        match += 8;
+    }
+    
+    while (ip < limit && *ip == *match)
+    {
+        ip++;
+        match++;
+    }
+    
+    return (uint32_t) (ip - start);
+}
+
+/* 15 in the nibble, then 255s until what's left */
+static inline fs_byte_t *fs_block_write_length(fs_byte_t *op, uint32_t length)
+{
+    for (; length >= 255; length -= 255)
+    {
+        *op++ = 255;
+    }
+    
+    *op++ = (fs_byte_t) length;
+    
+    return op;
+}
+
+static inline fs_byte_t *fs_block_write_literals(fs_byte_t *op, fs_byte_t *token, const fs_byte_t *literals, uint32_t length)
+{
+    if (length >= 15)
+    {
+        *token = 15 << 4;
+        op = fs_block_write_length(op, length - 15);
+    }
+    else
+    {
+        *token = (fs_byte_t) (length << 4);
+    }
+    
+    memcpy(op, literals, length);
+    
+    return op + length;
+}
+
+uint32_t fs_block_compress(const fs_byte_t *src, uint32_t length, fs_byte_t *dst, uint32_t *table)
+{
+    const fs_byte_t *ip     = src;
+    const fs_byte_t *anchor = src;
+    const fs_byte_t *end    = src + length;
+    
+    fs_byte_t *op = dst;
+    
+    if (length > BLOCK_MATCH_LIMIT)
+    {
+        const fs_byte_t *match_limit = end - BLOCK_MATCH_LIMIT;
+        const fs_byte_t *copy_limit  = end - BLOCK_LAST_LITERALS;
+        
+        /* stale entries are fine, every candidate is compared */
+        memset(table, 0, sizeof(uint32_t) << FS_BLOCK_HASH_LOG);
+        
+        table[fs_block_hash(fs_block_read32(ip))] = 0;
+        ip++;
+        
+        for (;;)
+        {
+            const fs_byte_t *match;
+            const fs_byte_t *forward = ip;
+            
+            uint32_t attempts = 1 << BLOCK_SKIP_TRIGGER;
+            
+            /* incompressible runs are skipped faster and faster */
+            do
+            {
+                ip = forward;
+                forward = ip + (attempts++ >> BLOCK_SKIP_TRIGGER);
+                
+                if (forward > match_limit)
+                {
+                    goto last_literals;
+                }
+                
+                uint32_t hash = fs_block_hash(fs_block_read32(ip));
+                
+                match = src + table[hash];
+                table[hash] = (uint32_t) (ip - src);
+            }
+            while (ip - match > BLOCK_MAX_OFFSET || fs_block_read32(match) != fs_block_read32(ip));
+            
+            /* the match may start before where it was found */
+            while (ip > anchor && match > src && ip[-1] == match[-1])
+            {
+                ip--;
+                match--;
+            }
+            
+            fs_byte_t *token = op++;
+            
+            op = fs_block_write_literals(op, token, anchor, (uint32_t) (ip - anchor));
+            
+            uint32_t offset = (uint32_t) (ip - match);
+            
+            *op++ = (fs_byte_t) offset;
+            *op++ = (fs_byte_t) (offset >> 8);
+            
+            uint32_t extra = fs_block_count(ip + BLOCK_MIN_MATCH, match + BLOCK_MIN_MATCH, copy_limit);
+            
+            if (extra >= 15)
+            {
+                *token += 15;
+                op = fs_block_write_length(op, extra - 15);
+            }
+            else
+            {
+                *token += (fs_byte_t) extra;
+            }
+            
+            ip += BLOCK_MIN_MATCH + extra;
+            anchor = ip;
+            
+            if (ip > match_limit)
+            {
+                break;
+            }
+            
+            /* bytes skipped over by the match are worth a slot */
+            table[fs_block_hash(fs_block_read32(ip - 2))] = (uint32_t) (ip - 2 - src);
+        }
+    }
+
+last_literals:
+    {
+        fs_byte_t *token = op++;
+        
+        op = fs_block_write_literals(op, token, anchor, (uint32_t) (end - anchor));
+    }
+    
+    return (uint32_t) (op - dst);
+}
+
+/* copies whole chunks of 16, or 8, bytes up to past op + length.
+ * The caller leaves room for the overrun and, for matches, at
+ * least a chunk between op and ip so no chunk reads itself */
+static inline void fs_block_wild_copy16(fs_byte_t *op, const fs_byte_t *ip, uint32_t length)
+{
+    fs_byte_t *end = op + length;
+    
+    do
+    {
+        memcpy(op, ip, 16);
+        
+        op += 16;
+        ip += 16;
+    }
+    while (op < end);
+}
+
+static inline void fs_block_wild_copy8(fs_byte_t *op, const fs_byte_t *ip, uint32_t length)
+{
+    fs_byte_t *end = op + length;
+    
+    do
+    {
+        memcpy(op, ip, 8);
+        
+        op += 8;
+        ip += 8;
+    }
+    while (op < end);
+}
+
+/* reads the 255-continued part of a length, FS_NO if the input runs out */
+static inline int fs_block_read_length(const fs_byte_t **ip, const fs_byte_t *end, uint32_t *length)
+{
+    fs_byte_t byte;
+    
+    do
+    {
+        if (*ip >= end)
+        {
+            return FS_NO;
+        }
+        
+        byte = *(*ip)++;
+        
+        /* longer than any buffer could hold */
+        if (*length > UINT32_MAX - 255)
+        {
+            return FS_NO;
+        }
+        
+        *length += byte;
+    }
+    while (byte == 255);
+    
+    return FS_YES;
+}
+
+int fs_block_decompress(const fs_byte_t *src, uint32_t length, fs_byte_t *dst, uint32_t capacity, uint32_t *out)
+{
+    const fs_byte_t *ip  = src;
+    const fs_byte_t *end = src + length;
+    
+    fs_byte_t *op     = dst;
+    fs_byte_t *op_end = dst + capacity;
+    
+    /* never trusts the input, every length is
+     * checked against both ends before copying */
+    while (ip < end)
+    {
+        fs_byte_t token = *ip++;
+        uint32_t literals = token >> 4;
+        
+        /* most sequences have a few literals and a short match,
+         * they're copied in fixed size chunks while both ends
+         * have room for them, without any length checks */
+        if (literals < 15 && end - ip >= 16 && op_end - op >= 32)
+        {
+            memcpy(op, ip, 16);
+            
+            op += literals;
+            ip += literals;
+        }
+        else
+        {
+            if (literals == 15 && fs_block_read_length(&ip, end, &literals) == FS_NO)
+            {
+                return FS_ERR_DATA;
+            }
+            
+            if (literals > (uint32_t) (end - ip) || literals > (uint32_t) (op_end - op))
+            {
+                return FS_ERR_DATA;
+            }
+            
+            if (end - ip >= literals + 16 && op_end - op >= literals + 16)
+            {
+                fs_block_wild_copy16(op, ip, literals);
+            }
+            else
+            {
+                memcpy(op, ip, literals);
+            }
+            
+            op += literals;
+            ip += literals;
+            
+            /* last sequence, literals only */
+            if (ip == end)
+            {
+                break;
+            }
+        }
+        
+        if (end - ip < 2)
+        {
+            return FS_ERR_DATA;
+        }
+        
+        uint32_t offset = ip[0] | (uint32_t) ip[1] << 8;
+        ip += 2;
+        
+        if (offset == 0 || offset > (uint32_t) (op - dst))
+        {
+            return FS_ERR_DATA;
+        }
+        
+        uint32_t count = token & 15;
+        
+        /* up to 18 bytes, 8 back or more, so each chunk
+         * reads bytes written before it */
+        if (count < 15 && offset >= 8 && op_end - op >= 18)
+        {
+            memcpy(op,      op - offset,      8);
+            memcpy(op + 8,  op - offset + 8,  8);
+            memcpy(op + 16, op - offset + 16, 2);
+            
+            op += count + BLOCK_MIN_MATCH;
+            
+            continue;
+        }
+        
+        if (count == 15 && fs_block_read_length(&ip, end, &count) == FS_NO)
+        {
+            return FS_ERR_DATA;
+        }
+        
+        count += BLOCK_MIN_MATCH;
+        
+        if (count > (uint32_t) (op_end - op))
+        {
+            return FS_ERR_DATA;
+        }
+        
+        if (offset >= 16 && op_end - op >= count + 16)
+        {
+            fs_block_wild_copy16(op, op - offset, count);
+            op += count;
+        }
+        else if (offset >= 8 && op_end - op >= count + 8)
+        {
+            fs_block_wild_copy8(op, op - offset, count);
+            op += count;
+        }
+        else if (offset >= count)
+        {
+            memcpy(op, op - offset, count);
+            op += count;
+        }
+        else
+        {
+            /* overlapping, the match repeats its last offset
+             * bytes. Any multiple of offset back still holds
+             * the same pattern, so copies double each time */
+            uint32_t distance = offset;
+            
+            while (count > 0)
+            {
+                uint32_t n = count < distance ? count : distance;
+                
+                memcpy(op, op - distance, n);
+                
+                op       += n;
+                count    -= n;
+                distance += distance;
+            }
+        }
+    }
+    
+    *out = (uint32_t) (op - dst);
+    
+    return FS_OKAY;
+}
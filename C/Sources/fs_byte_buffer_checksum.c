@@ -0,0 +1,44 @@
+//
+//  fs_byte_buffer_checksum.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 25/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_byte_buffer_crc32c(fs_byte_buffer_t *buffer, uint32_t offset, uint32_t length, uint32_t seed, uint32_t *out)
+{
+    /* src must be readable */
+    int is_readable = fs_byte_buffer_is_readable_by_length_at_offset(buffer, length, offset);
+    
+    if (is_readable == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    *out = fs_byte_crc32c(seed, buffer->heap + offset, length);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_xxhash64(fs_byte_buffer_t *buffer, uint32_t offset, uint32_t length, uint64_t seed, uint64_t *out)
+{
+    fs_byte_xxhash64_t state;
+    
+    /* src must be readable */
+    int is_readable = fs_byte_buffer_is_readable_by_length_at_offset(buffer, length, offset);
+    
+    if (is_readable == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_xxhash64_init(&state, seed);
+    fs_byte_xxhash64_update(&state, buffer->heap + offset, length);
+    
+    *out = fs_byte_xxhash64_digest(&state);
+    
+    return FS_OKAY;
+}
@@ -0,0 +1,95 @@
+//
+//  fs_byte_buffer_compress.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 26/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+#define BLOCK_TABLE_SIZE (sizeof(uint32_t) << FS_BLOCK_HASH_LOG)
+
+int fs_byte_buffer_write_compressed(fs_byte_buffer_t *buffer, fs_byte_buffer_t *src, uint32_t length, fs_byte_buffer_pool_t *pool, uint32_t *written)
+{
+    /* src must be readable */
+    int is_readable = fs_byte_buffer_is_readable_by_length_at_offset(src, length, src->reader_index);
+    
+    if (is_readable == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    uint64_t bound = FS_COMPRESS_BOUND(length);
+    
+    if (bound > FS_BUFFER_MAX_CAPACITY)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    /* room for the worst case, written bytes are what it really took */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, (uint32_t) bound);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    /* the table is rewritten on every call, a pooled block saves
+     * a malloc per frame on the outbound path */
+    uint32_t *table = (uint32_t *) fs_byte_buffer_storage_alloc(pool, BLOCK_TABLE_SIZE);
+    
+    if (table == NULL)
+    {
+        return FS_ERR_OOM;
+    }
+    
+    uint32_t count = fs_block_compress(src->heap + src->reader_index, length, buffer->heap + buffer->writer_index, table);
+    
+    fs_byte_buffer_storage_release(pool, (fs_byte_t *) table, BLOCK_TABLE_SIZE);
+    
+    src->reader_index    += length;
+    buffer->writer_index += count;
+    
+    *written = count;
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_write_decompressed(fs_byte_buffer_t *buffer, fs_byte_buffer_t *src, uint32_t length, uint32_t decompressed)
+{
+    /* src must be readable */
+    int is_readable = fs_byte_buffer_is_readable_by_length_at_offset(src, length, src->reader_index);
+    
+    if (is_readable == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, decompressed);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    uint32_t count;
+    
+    /* writer index stays put unless the whole block is good */
+    result = fs_block_decompress(src->heap + src->reader_index, length, buffer->heap + buffer->writer_index, decompressed, &count);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (count != decompressed)
+    {
+        return FS_ERR_DATA;
+    }
+    
+    src->reader_index    += length;
+    buffer->writer_index += count;
+    
+    return FS_OKAY;
+}
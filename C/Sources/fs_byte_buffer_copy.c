@@ -10,7 +10,25 @@
 
 int fs_byte_buffer_copy(fs_byte_buffer_t *dst, fs_byte_buffer_t *src)
 {
-    // TODO
+    /* make room for every written byte, dst
+     * grows from its own pool if it has one */
+    if (dst->capacity < src->writer_index)
+    {
+        int result = fs_byte_buffer_resize(dst, src->writer_index);
+        
+        if (result != FS_OKAY)
+        {
+            return result;
+        }
+    }
+    
+    memcpy(dst->heap, src->heap, src->writer_index);
+    
+    dst->reader_mark = src->reader_mark;
+    dst->writer_mark = src->writer_mark;
+    
+    dst->reader_index = src->reader_index;
+    dst->writer_index = src->writer_index;
     
     return FS_OKAY;
 }
@@ -0,0 +1,69 @@
+//
+//  fs_byte_buffer_discard.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 21/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_byte_buffer_discard_read_bytes(fs_byte_buffer_t *buffer)
+{
+    uint32_t length = buffer->reader_index;
+    uint32_t readable = buffer->writer_index - buffer->reader_index;
+    
+    /* nothing read yet */
+    if (length == 0)
+    {
+        return FS_OKAY;
+    }
+    
+    if (buffer->flags & FS_BUFFER_RING)
+    {
+        /* no copy, the window just moves forward */
+        int result = fs_byte_buffer_ring_rotate(buffer);
+        
+        if (result != FS_OKAY)
+        {
+            return result;
+        }
+    }
+    else if (buffer->shared != NULL && __atomic_load_n(&buffer->shared->refcnt, __ATOMIC_ACQUIRE) != 1)
+    {
+        /* slices still see the old bytes in place,
+         * move the unread ones to a private copy,
+         * pooled storage comes in class sizes only */
+        uint32_t capacity = buffer->pool != NULL ? fs_byte_buffer_capacity_for(buffer->capacity) : buffer->capacity;
+        
+        fs_byte_t *heap = fs_byte_buffer_storage_alloc(buffer->pool, capacity);
+        
+        if (heap == NULL)
+        {
+            return FS_ERR_OOM;
+        }
+        
+        memcpy(heap, buffer->heap + length, readable);
+        fs_byte_buffer_unshare(buffer->shared);
+        
+        buffer->heap = heap;
+        buffer->capacity = capacity;
+        buffer->shared = NULL;
+        buffer->flags = 0;
+    }
+    else
+    {
+        /* no one else holds the storage, slices included,
+         * ranges overlap whenever readable > length */
+        memmove(buffer->heap, buffer->heap + length, readable);
+    }
+    
+    /* marks before the reader are gone */
+    buffer->reader_mark = buffer->reader_mark > length ? buffer->reader_mark - length : 0;
+    buffer->writer_mark = buffer->writer_mark > length ? buffer->writer_mark - length : 0;
+    
+    buffer->reader_index = 0;
+    buffer->writer_index = readable;
+    
+    return FS_OKAY;
+}
@@ -22,11 +22,27 @@ int fs_byte_buffer_free(fs_byte_buffer_t* buffer)
             buffer->heap[i] = 0;
         } */
         
-        /* Free the memory */
-        free(buffer->heap);
+        /* Drop our reference to shared storage, or
+         * free the memory / hand it back to its pool */
+        if (buffer->shared != NULL)
+        {
+            fs_byte_buffer_unshare(buffer->shared);
+        }
+        else if (buffer->flags & FS_BUFFER_MAPPED)
+        {
+            fs_byte_buffer_map_release(buffer->heap, buffer->capacity);
+        }
+        else
+        {
+            fs_byte_buffer_storage_release(buffer->pool, buffer->heap, buffer->capacity);
+        }
         
         /* Reset members to make debugging easier */
         buffer->heap = NULL;
+        buffer->pool = NULL;
+        buffer->shared = NULL;
+        buffer->flags = 0;
+        buffer->growth = NULL;
         
         buffer->reader_mark = 0;
         buffer->writer_mark = 0;
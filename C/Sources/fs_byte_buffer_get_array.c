@@ -0,0 +1,87 @@
+//
+//  fs_byte_buffer_get_array.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 17/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_byte_buffer_get_int16_be_array(fs_byte_buffer_t *buffer, uint32_t offset, int16_t *out, uint32_t count)
+{
+    /* one bounds check for the whole array */
+    if (count > UINT32_MAX / sizeof(int16_t) || fs_byte_buffer_is_readable_by_length_at_offset(buffer, count * sizeof(int16_t), offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_order_be16(out, buffer->heap + offset, count);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_get_int16_le_array(fs_byte_buffer_t *buffer, uint32_t offset, int16_t *out, uint32_t count)
+{
+    /* one bounds check for the whole array */
+    if (count > UINT32_MAX / sizeof(int16_t) || fs_byte_buffer_is_readable_by_length_at_offset(buffer, count * sizeof(int16_t), offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_order_le16(out, buffer->heap + offset, count);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_get_int32_be_array(fs_byte_buffer_t *buffer, uint32_t offset, int32_t *out, uint32_t count)
+{
+    /* one bounds check for the whole array */
+    if (count > UINT32_MAX / sizeof(int32_t) || fs_byte_buffer_is_readable_by_length_at_offset(buffer, count * sizeof(int32_t), offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_order_be32(out, buffer->heap + offset, count);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_get_int32_le_array(fs_byte_buffer_t *buffer, uint32_t offset, int32_t *out, uint32_t count)
+{
+    /* one bounds check for the whole array */
+    if (count > UINT32_MAX / sizeof(int32_t) || fs_byte_buffer_is_readable_by_length_at_offset(buffer, count * sizeof(int32_t), offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_order_le32(out, buffer->heap + offset, count);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_get_int64_be_array(fs_byte_buffer_t *buffer, uint32_t offset, int64_t *out, uint32_t count)
+{
+    /* one bounds check for the whole array */
+    if (count > UINT32_MAX / sizeof(int64_t) || fs_byte_buffer_is_readable_by_length_at_offset(buffer, count * sizeof(int64_t), offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_order_be64(out, buffer->heap + offset, count);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_get_int64_le_array(fs_byte_buffer_t *buffer, uint32_t offset, int64_t *out, uint32_t count)
+{
+    /* one bounds check for the whole array */
+    if (count > UINT32_MAX / sizeof(int64_t) || fs_byte_buffer_is_readable_by_length_at_offset(buffer, count * sizeof(int64_t), offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_order_le64(out, buffer->heap + offset, count);
+    
+    return FS_OKAY;
+}
@@ -0,0 +1,46 @@
+//
+//  fs_byte_buffer_get_slice.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 14/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_byte_buffer_get_slice(fs_byte_buffer_t *buffer, uint32_t offset, uint32_t length, fs_byte_buffer_t *out)
+{
+    /* src must be readable */
+    int is_readable = fs_byte_buffer_is_readable_by_length_at_offset(buffer, length, offset);
+    
+    if (is_readable == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    /* slice shares storage, no copy */
+    int result = fs_byte_buffer_retain(buffer);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    out->heap = buffer->heap + offset;
+    out->capacity = length;
+    
+    /* Set marks to zero */
+    out->reader_mark = 0;
+    out->writer_mark = 0;
+    
+    /* whole window is readable */
+    out->reader_index = 0;
+    out->writer_index = length;
+    
+    out->pool = buffer->pool;
+    out->shared = buffer->shared;
+    out->flags = buffer->flags;
+    out->growth = NULL;
+    
+    return FS_OKAY;
+}
@@ -0,0 +1,175 @@
+//
+//  fs_byte_buffer_growth.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 23/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+/* used by buffers without a policy, same as fs_byte_buffer_resize */
+static const fs_byte_buffer_growth_t fs_byte_buffer_growth_default = {
+    FS_GROWTH_DOUBLING,
+    BUFFER_CAPACITY_THRESHOLD,
+    FS_BUFFER_MAX_CAPACITY,
+    NULL,
+    NULL
+};
+
+int fs_byte_buffer_growth_init(fs_byte_buffer_growth_t *growth, int policy, uint32_t step, uint32_t max_capacity)
+{
+    if (policy != FS_GROWTH_DOUBLING && policy != FS_GROWTH_STEP)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    if (step == 0 || max_capacity == 0)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    growth->policy = policy;
+    growth->step = step;
+    growth->max_capacity = max_capacity;
+    growth->predict = NULL;
+    growth->context = NULL;
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_growth_init_predict(fs_byte_buffer_growth_t *growth, fs_byte_buffer_predict_t predict, void *context, uint32_t max_capacity)
+{
+    if (predict == NULL || max_capacity == 0)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    growth->policy = FS_GROWTH_PREDICT;
+    growth->step = BUFFER_CAPACITY_THRESHOLD;
+    growth->max_capacity = max_capacity;
+    growth->predict = predict;
+    growth->context = context;
+    
+    return FS_OKAY;
+}
+
+/* capacity to grow to, never under required. Done in
+ * 64 bits so that steps near 4 GiB can't wrap around */
+static uint64_t fs_byte_buffer_growth_next(const fs_byte_buffer_growth_t *growth, uint32_t capacity, uint64_t required)
+{
+    uint64_t step = growth->step;
+    uint64_t next;
+    
+    switch (growth->policy)
+    {
+        case FS_GROWTH_STEP:
+            next = capacity + (required - capacity + step - 1) / step * step;
+            break;
+        
+        case FS_GROWTH_PREDICT:
+            next = growth->predict(growth->context, capacity, required);
+            break;
+        
+        default:
+            if (required <= step)
+            {
+                /* next power of two, from 64 */
+                next = BUFFER_CAPACITY_MINIMUM;
+                
+                while (next < required)
+                {
+                    next <<= 1;
+                }
+                
+                next = next < step ? next : step;
+            }
+            else
+            {
+                next = (required + step - 1) / step * step;
+            }
+            break;
+    }
+    
+    return next > required ? next : required;
+}
+
+/* moves a pooled buffer to malloc'd storage of exactly
+ * capacity bytes, for caps that aren't a class size */
+static int fs_byte_buffer_unpool(fs_byte_buffer_t *buffer, uint32_t capacity)
+{
+    fs_byte_t *heap = OPT_CAST(fs_byte_t) malloc(capacity);
+    
+    if (heap == NULL)
+    {
+        return FS_ERR_OOM;
+    }
+    
+    if (buffer->heap != NULL)
+    {
+        memcpy(heap, buffer->heap, buffer->writer_index);
+        
+        if (buffer->shared != NULL)
+        {
+            fs_byte_buffer_unshare(buffer->shared);
+        }
+        else
+        {
+            fs_byte_buffer_pool_release(buffer->pool, buffer->heap, buffer->capacity);
+        }
+    }
+    
+    buffer->heap = heap;
+    buffer->capacity = capacity;
+    buffer->pool = NULL;
+    buffer->shared = NULL;
+    buffer->flags = 0;
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_ensure_writable(fs_byte_buffer_t *buffer, uint32_t length)
+{
+    uint64_t required = (uint64_t) buffer->writer_index + length;
+    
+    /* fast path, already fits */
+    if (required <= buffer->capacity)
+    {
+        return FS_OKAY;
+    }
+    
+    /* borrowed bytes never grow */
+    if (buffer->flags & FS_BUFFER_FIXED)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    const fs_byte_buffer_growth_t *growth = buffer->growth != NULL ? buffer->growth : &fs_byte_buffer_growth_default;
+    
+    if (required > growth->max_capacity)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    uint64_t capacity = fs_byte_buffer_growth_next(growth, buffer->capacity, required);
+    
+    /* pooled storage comes in class sizes only, rounded
+     * up before the cap so that it can't go past it */
+    if (buffer->pool != NULL && capacity <= BUFFER_CAPACITY_THRESHOLD)
+    {
+        capacity = fs_byte_buffer_capacity_for((uint32_t) capacity);
+    }
+    
+    if (capacity > growth->max_capacity)
+    {
+        capacity = growth->max_capacity;
+        
+        /* no class fits under the cap, leave the pool */
+        if (buffer->pool != NULL && capacity <= BUFFER_CAPACITY_THRESHOLD && fs_byte_buffer_capacity_for((uint32_t) capacity) != capacity)
+        {
+            return fs_byte_buffer_unpool(buffer, (uint32_t) capacity);
+        }
+    }
+    
+    return fs_byte_buffer_reallocate(buffer, (uint32_t) capacity);
+}
@@ -0,0 +1,68 @@
+//
+//  fs_byte_buffer_index_of.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 24/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_byte_buffer_index_of(fs_byte_buffer_t *buffer, uint32_t from, uint32_t to, fs_byte_t value, uint32_t *out)
+{
+    /* range must be readable */
+    if (from > to || fs_byte_buffer_is_readable_by_length_at_offset(buffer, to - from, from) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    uint32_t found = fs_byte_search(buffer->heap + from, to - from, value);
+    
+    *out = (found == to - from) ? FS_INDEX_NOT_FOUND: from + found;
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_index_of_sequence(fs_byte_buffer_t *buffer, uint32_t from, uint32_t to, const fs_byte_t *sequence, uint32_t length, uint32_t *out)
+{
+    /* range must be readable */
+    if (from > to || fs_byte_buffer_is_readable_by_length_at_offset(buffer, to - from, from) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    /* empty sequences match right away */
+    if (length == 0)
+    {
+        *out = from;
+        return FS_OKAY;
+    }
+    
+    uint32_t found = fs_byte_search_sequence(buffer->heap + from, to - from, sequence, length);
+    
+    *out = (found == to - from) ? FS_INDEX_NOT_FOUND: from + found;
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_for_each_byte(fs_byte_buffer_t *buffer, uint32_t from, uint32_t to, fs_byte_visitor_t visitor, void *context, uint32_t *out)
+{
+    /* range must be readable */
+    if (from > to || fs_byte_buffer_is_readable_by_length_at_offset(buffer, to - from, from) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    for (uint32_t i = from; i < to; i++)
+    {
+        if (visitor(context, buffer->heap[i]) == FS_NO)
+        {
+            *out = i;
+            return FS_OKAY;
+        }
+    }
+    
+    *out = FS_INDEX_NOT_FOUND;
+    
+    return FS_OKAY;
+}
@@ -38,5 +38,55 @@ int fs_byte_buffer_init(fs_byte_buffer_t* buffer, uint32_t capacity)
     buffer->reader_index = 0;
     buffer->writer_index = 0;
     
+    /* Not owned by any pool */
+    buffer->pool = NULL;
+    buffer->shared = NULL;
+    buffer->flags = 0;
+    buffer->growth = NULL;
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_init_pooled(fs_byte_buffer_t* buffer, fs_byte_buffer_pool_t* pool, uint32_t capacity)
+{
+    if (pool == NULL)
+    {
+        return fs_byte_buffer_init(buffer, capacity);
+    }
+    
+    /* round capacity up to its size class,
+     * the extra room comes for free */
+    int klass = fs_byte_buffer_pool_class(capacity);
+    
+    if (klass >= 0)
+    {
+        capacity = fs_byte_buffer_capacity_for(capacity);
+    }
+    
+    /* take memory from the pool */
+    buffer->heap = fs_byte_buffer_pool_alloc(pool, capacity);
+    
+    if (buffer->heap == NULL)
+    {
+        return FS_ERR_OOM;
+    }
+    
+    /* Set capacity */
+    buffer->capacity = capacity;
+    
+    /* Set marks to zero */
+    buffer->reader_mark = 0;
+    buffer->writer_mark = 0;
+    
+    /* Set indices to zero */
+    buffer->reader_index = 0;
+    buffer->writer_index = 0;
+    
+    /* Give it back on free */
+    buffer->pool = pool;
+    buffer->shared = NULL;
+    buffer->flags = 0;
+    buffer->growth = NULL;
+    
     return FS_OKAY;
 }
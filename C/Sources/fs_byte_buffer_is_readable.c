@@ -20,5 +20,6 @@ int fs_byte_buffer_is_readable_by_length(fs_byte_buffer_t *buffer, uint32_t leng
 
 int fs_byte_buffer_is_readable_by_length_at_offset(fs_byte_buffer_t *buffer, uint32_t length, uint32_t offset)
 {
-    return (buffer->writer_index - offset >= length) ? FS_YES: FS_NO;
+    /* offset past writer_index would wrap around */
+    return (offset <= buffer->writer_index && buffer->writer_index - offset >= length) ? FS_YES: FS_NO;
 }
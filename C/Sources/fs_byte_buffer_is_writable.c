@@ -20,5 +20,6 @@ int fs_byte_buffer_is_writable_by_length(fs_byte_buffer_t *buffer, uint32_t leng
 
 int fs_byte_buffer_is_writable_by_length_at_offset(fs_byte_buffer_t *buffer, uint32_t length, uint32_t offset)
 {
-    return (buffer->capacity - offset) >= length ? FS_YES: FS_NO;
+    /* offset past capacity would wrap around */
+    return (offset <= buffer->capacity && buffer->capacity - offset >= length) ? FS_YES: FS_NO;
 }
@@ -0,0 +1,209 @@
+//
+//  fs_byte_buffer_mmap.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 20/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#ifdef __linux__
+/* mremap */
+#define _GNU_SOURCE
+#endif
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "fuse_private.h"
+
+/* page rounded mapping size, never 0 */
+static inline size_t fs_byte_buffer_map_length(uint32_t capacity)
+{
+    size_t page   = (size_t) sysconf(_SC_PAGESIZE);
+    size_t length = capacity > 0 ? capacity : 1;
+    
+    return (length + page - 1) & ~(page - 1);
+}
+
+static inline fs_byte_t *fs_byte_buffer_map_anonymous(size_t length)
+{
+    void *heap = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    
+    return heap != MAP_FAILED ? OPT_CAST(fs_byte_t) heap : NULL;
+}
+
+static inline void fs_byte_buffer_map_setup(fs_byte_buffer_t *buffer, fs_byte_t *heap, uint32_t capacity, uint32_t length, uint32_t flags)
+{
+    buffer->heap = heap;
+    buffer->capacity = capacity;
+    
+    /* Set marks to zero */
+    buffer->reader_mark = 0;
+    buffer->writer_mark = 0;
+    
+    /* whole file is readable */
+    buffer->reader_index = 0;
+    buffer->writer_index = length;
+    
+    buffer->pool = NULL;
+    buffer->shared = NULL;
+    buffer->flags = flags;
+    buffer->growth = NULL;
+}
+
+int fs_byte_buffer_init_mmap(fs_byte_buffer_t *buffer, uint32_t capacity)
+{
+    fs_byte_t *heap = fs_byte_buffer_map_anonymous(fs_byte_buffer_map_length(capacity));
+    
+    if (heap == NULL)
+    {
+        return FS_ERR_OOM;
+    }
+    
+    fs_byte_buffer_map_setup(buffer, heap, capacity, 0, FS_BUFFER_MAPPED);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_init_mmap_file(fs_byte_buffer_t *buffer, const char *path)
+{
+    struct stat st;
+    fs_byte_t *heap;
+    
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    
+    if (fd < 0)
+    {
+        return FS_ERR_IO;
+    }
+    
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return FS_ERR_IO;
+    }
+    
+    /* indices are 32 bits wide */
+    if ((uint64_t) st.st_size > UINT32_MAX)
+    {
+        close(fd);
+        return FS_ERR_OOR;
+    }
+    
+    uint32_t size = (uint32_t) st.st_size;
+    
+    /* empty files can't be mapped */
+    if (size == 0)
+    {
+        heap = fs_byte_buffer_map_anonymous(fs_byte_buffer_map_length(0));
+    }
+    else
+    {
+        /* private mapping, writes land in copy-on-write
+         * pages and never reach the file itself */
+        void *map = mmap(NULL, fs_byte_buffer_map_length(size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        
+        heap = map != MAP_FAILED ? OPT_CAST(fs_byte_t) map : NULL;
+    }
+    
+    /* the mapping keeps the file alive */
+    close(fd);
+    
+    if (heap == NULL)
+    {
+        return FS_ERR_IO;
+    }
+    
+    fs_byte_buffer_map_setup(buffer, heap, size, size, FS_BUFFER_MAPPED | FS_BUFFER_FILE);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_advise(fs_byte_buffer_t *buffer, int advice)
+{
+    static const int advices[] = {
+        POSIX_MADV_NORMAL,
+        POSIX_MADV_SEQUENTIAL,
+        POSIX_MADV_RANDOM,
+        POSIX_MADV_WILLNEED,
+        POSIX_MADV_DONTNEED
+    };
+    
+    if (advice < 0 || advice >= (int) (sizeof(advices) / sizeof(advices[0])))
+    {
+        return FS_ERR_OOR;
+    }
+    
+    /* only mappings are known to be page aligned */
+    if ((buffer->flags & FS_BUFFER_MAPPED) == 0 || buffer->heap == NULL)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    /* slices start anywhere inside the mapping */
+    uintptr_t page  = (uintptr_t) sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t) buffer->heap & ~(page - 1);
+    uintptr_t end   = (uintptr_t) buffer->heap + buffer->capacity;
+    
+    if (end == start)
+    {
+        return FS_OKAY;
+    }
+    
+    if (posix_madvise((void *) start, end - start, advices[advice]) != 0)
+    {
+        return FS_ERR_IO;
+    }
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_map_resize(fs_byte_buffer_t *buffer, uint32_t capacity)
+{
+    size_t old_length = fs_byte_buffer_map_length(buffer->capacity);
+    size_t new_length = fs_byte_buffer_map_length(capacity);
+
+#ifdef __linux__
+    /* anonymous mappings grow in place, or get their
+     * pages moved by the kernel, never copied */
+    if ((buffer->flags & FS_BUFFER_FILE) == 0)
+    {
+        void *heap = mremap(buffer->heap, old_length, new_length, MREMAP_MAYMOVE);
+        
+        if (heap == MAP_FAILED)
+        {
+            return FS_ERR_OOM;
+        }
+        
+        buffer->heap = OPT_CAST(fs_byte_t) heap;
+        buffer->capacity = capacity;
+        
+        return FS_OKAY;
+    }
+#endif
+    
+    /* pages past a file's end can't be touched, and
+     * there's no mremap elsewhere: move to a new mapping */
+    fs_byte_t *heap = fs_byte_buffer_map_anonymous(new_length);
+    
+    if (heap == NULL)
+    {
+        return FS_ERR_OOM;
+    }
+    
+    memcpy(heap, buffer->heap, buffer->writer_index < capacity ? buffer->writer_index : capacity);
+    munmap(buffer->heap, old_length);
+    
+    buffer->heap = heap;
+    buffer->capacity = capacity;
+    buffer->flags = FS_BUFFER_MAPPED;
+    
+    return FS_OKAY;
+}
+
+void fs_byte_buffer_map_release(fs_byte_t *heap, uint32_t capacity)
+{
+    munmap(heap, fs_byte_buffer_map_length(capacity));
+}
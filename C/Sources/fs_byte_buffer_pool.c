@@ -0,0 +1,387 @@
+//
+//  fs_byte_buffer_pool.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 12/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+/* thread cache counters are only written by their owner
+ * thread but read by fs_byte_buffer_pool_stats */
+#define POOL_STAT_ADD(field, n) __atomic_store_n(&(field), (field) + (n), __ATOMIC_RELAXED)
+#define POOL_STAT_GET(field)    __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+static inline uint32_t fs_byte_buffer_pool_class_size(int klass)
+{
+    return (uint32_t) BUFFER_CAPACITY_MINIMUM << klass;
+}
+
+static inline uint32_t fs_byte_buffer_pool_cache_limit(int klass)
+{
+    uint32_t limit = POOL_CACHE_CLASS_BYTES / fs_byte_buffer_pool_class_size(klass);
+
+    if (limit == 0)
+    {
+        return 1;
+    }
+
+    return limit > POOL_CACHE_CLASS_LIMIT ? POOL_CACHE_CLASS_LIMIT : limit;
+}
+
+/* free lists are linked through
+ * the first word of each block */
+static inline void fs_byte_buffer_pool_push(void **list, void *block)
+{
+    *(void **) block = *list;
+    *list = block;
+}
+
+static inline void *fs_byte_buffer_pool_pop(void **list)
+{
+    void *block = *list;
+
+    *list = *(void **) block;
+
+    return block;
+}
+
+/* must hold pool->lock */
+static void fs_byte_buffer_pool_arena_push(fs_byte_buffer_pool_t *pool, int klass, void *block)
+{
+    uint32_t size = fs_byte_buffer_pool_class_size(klass);
+
+    /* over budget, hand it back to the system */
+    if (pool->retained + size > pool->max_retained)
+    {
+        free(block);
+        return;
+    }
+
+    fs_byte_buffer_pool_push(&pool->arena[klass], block);
+
+    pool->arena_count[klass] += 1;
+    pool->retained += size;
+}
+
+/* must hold pool->lock, moves `count` blocks
+ * of the given class from cache to arena */
+static void fs_byte_buffer_pool_cache_flush(fs_byte_buffer_pool_cache_t *cache, int klass, uint32_t count)
+{
+    uint32_t size = fs_byte_buffer_pool_class_size(klass);
+
+    while (count-- > 0 && cache->bins[klass] != NULL)
+    {
+        void *block = fs_byte_buffer_pool_pop(&cache->bins[klass]);
+
+        cache->counts[klass] -= 1;
+        POOL_STAT_ADD(cache->retained, -(uint64_t) size);
+
+        fs_byte_buffer_pool_arena_push(cache->pool, klass, block);
+    }
+}
+
+/* pthread key destructor, runs on thread exit */
+static void fs_byte_buffer_pool_cache_destroy(void *arg)
+{
+    fs_byte_buffer_pool_cache_t *cache = arg;
+    fs_byte_buffer_pool_t *pool = cache->pool;
+
+    pthread_mutex_lock(&pool->lock);
+
+    for (int klass = 0; klass < FS_POOL_SIZE_CLASSES; klass++)
+    {
+        fs_byte_buffer_pool_cache_flush(cache, klass, cache->counts[klass]);
+    }
+
+    /* keep stats of exited threads */
+    pool->hits   += cache->hits;
+    pool->misses += cache->misses;
+
+    if (cache->prev != NULL)
+    {
+        cache->prev->next = cache->next;
+    }
+    else
+    {
+        pool->caches = cache->next;
+    }
+
+    if (cache->next != NULL)
+    {
+        cache->next->prev = cache->prev;
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    free(cache);
+}
+
+static fs_byte_buffer_pool_cache_t *fs_byte_buffer_pool_cache_get(fs_byte_buffer_pool_t *pool)
+{
+    fs_byte_buffer_pool_cache_t *cache = pthread_getspecific(pool->cache_key);
+
+    if (cache != NULL)
+    {
+        return cache;
+    }
+
+    cache = OPT_CAST(fs_byte_buffer_pool_cache_t) calloc(1, sizeof(fs_byte_buffer_pool_cache_t));
+
+    /* callers fall back to the shared arena */
+    if (cache == NULL)
+    {
+        return NULL;
+    }
+
+    cache->pool = pool;
+
+    if (pthread_setspecific(pool->cache_key, cache) != 0)
+    {
+        free(cache);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+
+    cache->next = pool->caches;
+
+    if (pool->caches != NULL)
+    {
+        pool->caches->prev = cache;
+    }
+
+    pool->caches = cache;
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return cache;
+}
+
+int fs_byte_buffer_pool_init(fs_byte_buffer_pool_t *pool, uint64_t max_retained)
+{
+    memset(pool, 0, sizeof(fs_byte_buffer_pool_t));
+
+    if (pthread_key_create(&pool->cache_key, fs_byte_buffer_pool_cache_destroy) != 0)
+    {
+        return FS_ERR_OOM;
+    }
+
+    if (pthread_mutex_init(&pool->lock, NULL) != 0)
+    {
+        pthread_key_delete(pool->cache_key);
+        return FS_ERR_OOM;
+    }
+
+    pool->max_retained = max_retained != 0 ? max_retained : POOL_DEFAULT_MAX_RETAINED;
+
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_pool_free(fs_byte_buffer_pool_t *pool)
+{
+    /* no destructors will run from now on, every
+     * buffer taken from this pool must be freed */
+    pthread_key_delete(pool->cache_key);
+
+    pthread_mutex_lock(&pool->lock);
+
+    while (pool->caches != NULL)
+    {
+        fs_byte_buffer_pool_cache_t *cache = pool->caches;
+
+        for (int klass = 0; klass < FS_POOL_SIZE_CLASSES; klass++)
+        {
+            while (cache->bins[klass] != NULL)
+            {
+                free(fs_byte_buffer_pool_pop(&cache->bins[klass]));
+            }
+        }
+
+        pool->caches = cache->next;
+
+        free(cache);
+    }
+
+    for (int klass = 0; klass < FS_POOL_SIZE_CLASSES; klass++)
+    {
+        while (pool->arena[klass] != NULL)
+        {
+            free(fs_byte_buffer_pool_pop(&pool->arena[klass]));
+        }
+
+        pool->arena_count[klass] = 0;
+    }
+
+    pool->retained = 0;
+
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_destroy(&pool->lock);
+
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_pool_stats(fs_byte_buffer_pool_t *pool, fs_byte_buffer_pool_stats_t *out)
+{
+    pthread_mutex_lock(&pool->lock);
+
+    out->hits = pool->hits;
+    out->misses = pool->misses;
+    out->bytes_retained = pool->retained;
+
+    for (fs_byte_buffer_pool_cache_t *cache = pool->caches; cache != NULL; cache = cache->next)
+    {
+        out->hits += POOL_STAT_GET(cache->hits);
+        out->misses += POOL_STAT_GET(cache->misses);
+        out->bytes_retained += POOL_STAT_GET(cache->retained);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return FS_OKAY;
+}
+
+fs_byte_t *fs_byte_buffer_pool_alloc(fs_byte_buffer_pool_t *pool, uint32_t capacity)
+{
+    int klass = fs_byte_buffer_pool_class(capacity);
+
+    fs_byte_buffer_pool_cache_t *cache = fs_byte_buffer_pool_cache_get(pool);
+
+    /* over threshold, never pooled */
+    if (klass < 0)
+    {
+        if (cache != NULL)
+        {
+            POOL_STAT_ADD(cache->misses, 1);
+        }
+
+        return OPT_CAST(fs_byte_t) malloc(capacity);
+    }
+
+    uint32_t size = fs_byte_buffer_pool_class_size(klass);
+
+    if (cache == NULL)
+    {
+        void *block = NULL;
+
+        pthread_mutex_lock(&pool->lock);
+
+        if (pool->arena[klass] != NULL)
+        {
+            block = fs_byte_buffer_pool_pop(&pool->arena[klass]);
+
+            pool->arena_count[klass] -= 1;
+            pool->retained -= size;
+            pool->hits += 1;
+        }
+        else
+        {
+            pool->misses += 1;
+        }
+
+        pthread_mutex_unlock(&pool->lock);
+
+        return OPT_CAST(fs_byte_t) (block != NULL ? block : malloc(size));
+    }
+
+    /* refill half a bin from the shared arena */
+    if (cache->bins[klass] == NULL)
+    {
+        uint32_t batch = (fs_byte_buffer_pool_cache_limit(klass) + 1) / 2;
+
+        pthread_mutex_lock(&pool->lock);
+
+        while (batch-- > 0 && pool->arena[klass] != NULL)
+        {
+            void *block = fs_byte_buffer_pool_pop(&pool->arena[klass]);
+
+            pool->arena_count[klass] -= 1;
+            pool->retained -= size;
+
+            fs_byte_buffer_pool_push(&cache->bins[klass], block);
+
+            cache->counts[klass] += 1;
+            POOL_STAT_ADD(cache->retained, size);
+        }
+
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    if (cache->bins[klass] == NULL)
+    {
+        POOL_STAT_ADD(cache->misses, 1);
+
+        return OPT_CAST(fs_byte_t) malloc(size);
+    }
+
+    cache->counts[klass] -= 1;
+    POOL_STAT_ADD(cache->retained, -(uint64_t) size);
+    POOL_STAT_ADD(cache->hits, 1);
+
+    return OPT_CAST(fs_byte_t) fs_byte_buffer_pool_pop(&cache->bins[klass]);
+}
+
+void fs_byte_buffer_pool_release(fs_byte_buffer_pool_t *pool, fs_byte_t *heap, uint32_t capacity)
+{
+    int klass = fs_byte_buffer_pool_class(capacity);
+
+    if (heap == NULL)
+    {
+        return;
+    }
+
+    /* over threshold, never pooled */
+    if (klass < 0)
+    {
+        free(heap);
+        return;
+    }
+
+    fs_byte_buffer_pool_cache_t *cache = fs_byte_buffer_pool_cache_get(pool);
+
+    if (cache == NULL)
+    {
+        pthread_mutex_lock(&pool->lock);
+        fs_byte_buffer_pool_arena_push(pool, klass, heap);
+        pthread_mutex_unlock(&pool->lock);
+        return;
+    }
+
+    uint32_t limit = fs_byte_buffer_pool_cache_limit(klass);
+
+    /* bin is full, spill half of it to the shared arena */
+    if (cache->counts[klass] >= limit)
+    {
+        pthread_mutex_lock(&pool->lock);
+        fs_byte_buffer_pool_cache_flush(cache, klass, (limit + 1) / 2);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    fs_byte_buffer_pool_push(&cache->bins[klass], heap);
+
+    cache->counts[klass] += 1;
+    POOL_STAT_ADD(cache->retained, fs_byte_buffer_pool_class_size(klass));
+}
+
+fs_byte_t *fs_byte_buffer_storage_alloc(fs_byte_buffer_pool_t *pool, uint32_t capacity)
+{
+    if (pool != NULL)
+    {
+        return fs_byte_buffer_pool_alloc(pool, capacity);
+    }
+
+    return OPT_CAST(fs_byte_t) malloc(capacity);
+}
+
+void fs_byte_buffer_storage_release(fs_byte_buffer_pool_t *pool, fs_byte_t *heap, uint32_t capacity)
+{
+    if (pool != NULL)
+    {
+        fs_byte_buffer_pool_release(pool, heap, capacity);
+    }
+    else
+    {
+        free(heap);
+    }
+}
@@ -0,0 +1,105 @@
+//
+//  fs_byte_buffer_read_array.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 17/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_byte_buffer_read_int16_be_array(fs_byte_buffer_t *buffer, int16_t *out, uint32_t count)
+{
+    /* get current reader pos */
+    uint32_t offset = buffer->reader_index;
+    
+    int result = fs_byte_buffer_get_int16_be_array(buffer, offset, out, count);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase reader pos by count * 2 */
+        buffer->reader_index += count * sizeof(int16_t);
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_read_int16_le_array(fs_byte_buffer_t *buffer, int16_t *out, uint32_t count)
+{
+    /* get current reader pos */
+    uint32_t offset = buffer->reader_index;
+    
+    int result = fs_byte_buffer_get_int16_le_array(buffer, offset, out, count);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase reader pos by count * 2 */
+        buffer->reader_index += count * sizeof(int16_t);
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_read_int32_be_array(fs_byte_buffer_t *buffer, int32_t *out, uint32_t count)
+{
+    /* get current reader pos */
+    uint32_t offset = buffer->reader_index;
+    
+    int result = fs_byte_buffer_get_int32_be_array(buffer, offset, out, count);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase reader pos by count * 4 */
+        buffer->reader_index += count * sizeof(int32_t);
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_read_int32_le_array(fs_byte_buffer_t *buffer, int32_t *out, uint32_t count)
+{
+    /* get current reader pos */
+    uint32_t offset = buffer->reader_index;
+    
+    int result = fs_byte_buffer_get_int32_le_array(buffer, offset, out, count);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase reader pos by count * 4 */
+        buffer->reader_index += count * sizeof(int32_t);
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_read_int64_be_array(fs_byte_buffer_t *buffer, int64_t *out, uint32_t count)
+{
+    /* get current reader pos */
+    uint32_t offset = buffer->reader_index;
+    
+    int result = fs_byte_buffer_get_int64_be_array(buffer, offset, out, count);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase reader pos by count * 8 */
+        buffer->reader_index += count * sizeof(int64_t);
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_read_int64_le_array(fs_byte_buffer_t *buffer, int64_t *out, uint32_t count)
+{
+    /* get current reader pos */
+    uint32_t offset = buffer->reader_index;
+    
+    int result = fs_byte_buffer_get_int64_le_array(buffer, offset, out, count);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase reader pos by count * 8 */
+        buffer->reader_index += count * sizeof(int64_t);
+    }
+    
+    return result;
+}
@@ -0,0 +1,25 @@
+//
+//  fs_byte_buffer_read_slice.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 14/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_byte_buffer_read_slice(fs_byte_buffer_t *buffer, uint32_t length, fs_byte_buffer_t *out)
+{
+    /* get current reader pos */
+    uint32_t offset = buffer->reader_index;
+    
+    int result = fs_byte_buffer_get_slice(buffer, offset, length, out);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase reader pos by length */
+        buffer->reader_index += length;
+    }
+    
+    return result;
+}
@@ -0,0 +1,194 @@
+//
+//  fs_byte_buffer_read_varint_array.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 19/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+//  Bulk LEB128 decoding in the spirit of masked vbyte: the
+//  continuation bits of 16 bytes are gathered into a mask,
+//  runs of single byte varints are widened 8 at a time and
+//  every other varint ending in the window is decoded by
+//  its length, without testing bytes one by one.
+//
+
+#include "fuse_private.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/* bit i set if byte i has its continuation bit */
+static inline uint32_t fs_varint_mask16(const fs_byte_t *heap)
+{
+#if defined(__SSE2__)
+    return (uint32_t) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) heap));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    static const int8_t shifts[16] = { 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7 };
+    
+    uint8x16_t bits = vshlq_u8(vshrq_n_u8(vld1q_u8(heap), 7), vld1q_s8(shifts));
+    
+    return (uint32_t) vaddv_u8(vget_low_u8(bits)) | (uint32_t) vaddv_u8(vget_high_u8(bits)) << 8;
+#else
+    uint64_t lo, hi;
+    
+    memcpy(&lo, heap, sizeof(lo));
+    memcpy(&hi, heap + 8, sizeof(hi));
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    lo = __builtin_bswap64(lo);
+    hi = __builtin_bswap64(hi);
+#endif
+    
+    /* gathers the top bit of each byte into the top byte */
+    lo = ((lo >> 7) & 0x0101010101010101ull) * 0x0102040810204080ull;
+    hi = ((hi >> 7) & 0x0101010101010101ull) * 0x0102040810204080ull;
+    
+    return (uint32_t) (lo >> 56) | (uint32_t) (hi >> 56) << 8;
+#endif
+}
+
+/* 8 single byte varints, zero extended */
+static inline void fs_varint_widen8(uint32_t *out, const fs_byte_t *heap)
+{
+#if defined(__SSE2__)
+    __m128i zero  = _mm_setzero_si128();
+    __m128i words = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) heap), zero);
+    
+    _mm_storeu_si128((__m128i *) out,       _mm_unpacklo_epi16(words, zero));
+    _mm_storeu_si128((__m128i *) (out + 4), _mm_unpackhi_epi16(words, zero));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    uint16x8_t words = vmovl_u8(vld1_u8(heap));
+    
+    vst1q_u32(out,     vmovl_u16(vget_low_u16(words)));
+    vst1q_u32(out + 4, vmovl_u16(vget_high_u16(words)));
+#else
+    for (int i = 0; i < 8; i++)
+    {
+        out[i] = heap[i];
+    }
+#endif
+}
+
+/* length must be validated by the caller */
+static inline uint64_t fs_varint_decode(const fs_byte_t *heap, uint32_t length)
+{
+    uint64_t value = 0;
+    
+    for (uint32_t i = 0; i < length; i++)
+    {
+        value |= (uint64_t) (heap[i] & 0x7f) << (7 * i);
+    }
+    
+    return value;
+}
+
+static inline void fs_varint_store(void *out, uint32_t index, uint32_t width, uint64_t value)
+{
+    if (width == sizeof(uint32_t))
+    {
+        ((uint32_t *) out)[index] = (uint32_t) value;
+    }
+    else
+    {
+        ((uint64_t *) out)[index] = value;
+    }
+}
+
+/* decodes count varints at the reader index, all or nothing */
+static inline int fs_byte_buffer_read_varints(fs_byte_buffer_t *buffer, void *out, uint32_t count, uint32_t width, uint32_t max)
+{
+    const fs_byte_t *heap = buffer->heap + buffer->reader_index;
+    const fs_byte_t *end  = buffer->heap + buffer->writer_index;
+    
+    uint32_t i = 0;
+    
+    while (i < count)
+    {
+        /* vector path, needs a full window */
+        if (end - heap >= 16)
+        {
+            uint32_t mask = fs_varint_mask16(heap);
+            
+            /* a run of 8 small values */
+            if ((mask & 0xff) == 0 && width == sizeof(uint32_t) && count - i >= 8)
+            {
+                fs_varint_widen8((uint32_t *) out + i, heap);
+                
+                heap += 8;
+                i += 8;
+                
+                continue;
+            }
+            
+            /* every zero bit terminates a varint */
+            uint32_t ends  = ~mask & 0xffff;
+            uint32_t start = 0;
+            
+            while (ends != 0 && i < count)
+            {
+                uint32_t stop = __builtin_ctz(ends);
+                uint32_t length = stop - start + 1;
+                
+                if (length > max)
+                {
+                    return FS_ERR_OOR;
+                }
+                
+                fs_varint_store(out, i++, width, fs_varint_decode(heap + start, length));
+                
+                start = stop + 1;
+                ends &= ends - 1;
+            }
+            
+            /* no terminator within 16 bytes */
+            if (start == 0)
+            {
+                return FS_ERR_OOR;
+            }
+            
+            heap += start;
+            
+            continue;
+        }
+        
+        /* scalar tail, bounds checked byte by byte */
+        uint32_t length = 0;
+        
+        while (length < max && heap + length < end && heap[length] >= 0x80)
+        {
+            length++;
+        }
+        
+        if (length == max)
+        {
+            return FS_ERR_OOR;
+        }
+        
+        if (heap + length == end)
+        {
+            return FS_ERR_OOB;
+        }
+        
+        fs_varint_store(out, i++, width, fs_varint_decode(heap, length + 1));
+        
+        heap += length + 1;
+    }
+    
+    /* increase reader pos by consumed bytes */
+    buffer->reader_index = (uint32_t) (heap - buffer->heap);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_read_varint32_array(fs_byte_buffer_t *buffer, uint32_t *out, uint32_t count)
+{
+    return fs_byte_buffer_read_varints(buffer, out, count, sizeof(uint32_t), FS_VARINT32_MAX_LENGTH);
+}
+
+int fs_byte_buffer_read_varint64_array(fs_byte_buffer_t *buffer, uint64_t *out, uint32_t count)
+{
+    return fs_byte_buffer_read_varints(buffer, out, count, sizeof(uint64_t), FS_VARINT64_MAX_LENGTH);
+}
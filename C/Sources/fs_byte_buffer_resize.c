@@ -10,38 +10,84 @@
 
 int fs_byte_buffer_resize(fs_byte_buffer_t *buffer, uint32_t capacity)
 {
-    /* If min required capacity equals threshold
-     * just set new buffer capacity to threshold */
-    if (capacity == BUFFER_CAPACITY_THRESHOLD)
+    /* rings are sized in pages */
+    if (buffer->flags & FS_BUFFER_RING)
     {
-        buffer->capacity = BUFFER_CAPACITY_THRESHOLD;
+        return fs_byte_buffer_reallocate(buffer, capacity);
     }
     
-    /* If over threshold, do not double
+    /* Double up to 4 MiB, starting from 64.
+     * If over threshold, do not double
      * but just increase by threshold */
-    else if (capacity > BUFFER_CAPACITY_THRESHOLD)
+    return fs_byte_buffer_reallocate(buffer, fs_byte_buffer_capacity_for(capacity));
+}
+
+int fs_byte_buffer_reallocate(fs_byte_buffer_t *buffer, uint32_t capacity)
+{
+    fs_byte_t *heap;
+    
+    /* borrowed bytes can't be moved */
+    if (buffer->flags & FS_BUFFER_FIXED)
     {
-        buffer->capacity  = capacity / BUFFER_CAPACITY_THRESHOLD * BUFFER_CAPACITY_THRESHOLD;
-        buffer->capacity += BUFFER_CAPACITY_THRESHOLD;
+        return FS_ERR_OOR;
     }
-    /* If not over threshold.
-     * Double up to 4 MiB, starting from 64 */
-    else
+    
+    /* rings can only move to a new ring */
+    if (buffer->flags & FS_BUFFER_RING)
     {
-        buffer->capacity = 64;
+        return fs_byte_buffer_ring_move(buffer, capacity, 0);
+    }
+    
+    /* Shared storage (slices) is never moved under
+     * other owners' feet, detach into a private copy.
+     * Pooled buffers within the size classes
+     * move to a block of the new class */
+    if (buffer->shared != NULL || (buffer->pool != NULL && (capacity <= BUFFER_CAPACITY_THRESHOLD || buffer->capacity <= BUFFER_CAPACITY_THRESHOLD)))
+    {
+        heap = fs_byte_buffer_storage_alloc(buffer->pool, capacity);
+        
+        if (heap == NULL)
+        {
+            return FS_ERR_OOM;
+        }
         
-        while (buffer->capacity < capacity)
+        /* only written bytes are worth copying */
+        if (buffer->heap != NULL)
         {
-            buffer->capacity <<= 1;
+            memcpy(heap, buffer->heap, buffer->writer_index < capacity ? buffer->writer_index : capacity);
+            
+            if (buffer->shared != NULL)
+            {
+                fs_byte_buffer_unshare(buffer->shared);
+            }
+            else
+            {
+                fs_byte_buffer_pool_release(buffer->pool, buffer->heap, buffer->capacity);
+            }
         }
+        
+        buffer->shared = NULL;
+        buffer->flags = 0;
     }
-    
-    buffer->heap = realloc(buffer->heap, buffer->capacity);
-    
-    if (buffer->heap == NULL)
+    else if (buffer->flags & FS_BUFFER_MAPPED)
     {
-        return FS_ERR_OOM;
+        /* mappings grow page-wise, not by copy */
+        return fs_byte_buffer_map_resize(buffer, capacity);
     }
+    else
+    {
+        heap = OPT_CAST(fs_byte_t) realloc(buffer->heap, capacity);
+        
+        /* keep the old heap
+         * on failure, no leaks */
+        if (heap == NULL)
+        {
+            return FS_ERR_OOM;
+        }
+    }
+    
+    buffer->heap = heap;
+    buffer->capacity = capacity;
     
     return FS_OKAY;
 }
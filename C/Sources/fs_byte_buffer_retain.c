@@ -0,0 +1,118 @@
+//
+//  fs_byte_buffer_retain.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 14/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_byte_buffer_share(fs_byte_buffer_t *buffer)
+{
+    /* already shared */
+    if (buffer->shared != NULL)
+    {
+        return FS_OKAY;
+    }
+    
+    fs_byte_buffer_shared_t *shared = OPT_CAST(fs_byte_buffer_shared_t) malloc(sizeof(fs_byte_buffer_shared_t));
+    
+    if (shared == NULL)
+    {
+        return FS_ERR_OOM;
+    }
+    
+    /* the shared block remembers the original
+     * allocation, slices only see a window of it */
+    shared->heap     = buffer->heap;
+    shared->capacity = buffer->capacity;
+    shared->pool     = buffer->pool;
+    shared->flags    = buffer->flags;
+    shared->refcnt   = 1;
+    
+    buffer->shared = shared;
+    
+    return FS_OKAY;
+}
+
+void fs_byte_buffer_unshare(fs_byte_buffer_shared_t *shared)
+{
+    if (__atomic_sub_fetch(&shared->refcnt, 1, __ATOMIC_ACQ_REL) != 0)
+    {
+        return;
+    }
+    
+    if (shared->flags & FS_BUFFER_RING)
+    {
+        fs_byte_buffer_ring_release(shared->heap, shared->capacity);
+    }
+    else if (shared->flags & FS_BUFFER_MAPPED)
+    {
+        fs_byte_buffer_map_release(shared->heap, shared->capacity);
+    }
+    else
+    {
+        fs_byte_buffer_storage_release(shared->pool, shared->heap, shared->capacity);
+    }
+    
+    free(shared);
+}
+
+int fs_byte_buffer_retain(fs_byte_buffer_t *buffer)
+{
+    if (buffer->heap == NULL)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    int result = fs_byte_buffer_share(buffer);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    __atomic_add_fetch(&buffer->shared->refcnt, 1, __ATOMIC_RELAXED);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_release(fs_byte_buffer_t *buffer)
+{
+    if (buffer->heap == NULL)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    /* sole owner, nothing to count */
+    if (buffer->shared == NULL)
+    {
+        return fs_byte_buffer_free(buffer);
+    }
+    
+    /* last reference, storage goes away with it */
+    if (__atomic_load_n(&buffer->shared->refcnt, __ATOMIC_ACQUIRE) == 1)
+    {
+        return fs_byte_buffer_free(buffer);
+    }
+    
+    fs_byte_buffer_unshare(buffer->shared);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_ref_count(fs_byte_buffer_t *buffer)
+{
+    if (buffer->heap == NULL)
+    {
+        return 0;
+    }
+    
+    if (buffer->shared == NULL)
+    {
+        return 1;
+    }
+    
+    return (int) __atomic_load_n(&buffer->shared->refcnt, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,240 @@
+//
+//  fs_byte_buffer_ring.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 21/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#ifdef __linux__
+/* memfd_create */
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "fuse_private.h"
+
+/* page rounded ring size, never 0 */
+static inline uint32_t fs_byte_buffer_ring_length(uint32_t capacity)
+{
+    uint32_t page = (uint32_t) sysconf(_SC_PAGESIZE);
+    
+    if (capacity == 0)
+    {
+        return page;
+    }
+    
+    /* keep the rounding from wrapping around */
+    if (capacity > UINT32_MAX - page + 1)
+    {
+        return 0;
+    }
+    
+    return (capacity + page - 1) & ~(page - 1);
+}
+
+/* anonymous file backing both halves of the ring */
+static inline int fs_byte_buffer_ring_file(void)
+{
+#ifdef __linux__
+    return memfd_create("fuse-ring", MFD_CLOEXEC);
+#else
+    /* unique per ring, threads create them concurrently */
+    static uint32_t counter = 0;
+    
+    char name[32];
+    int fd;
+    
+    do
+    {
+        uint32_t n = __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED);
+        
+        snprintf(name, sizeof(name), "/fuse-ring-%ld-%u", (long) getpid(), n);
+        
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    /* left behind by a dead process with the same pid */
+    while (fd == -1 && errno == EEXIST);
+    
+    /* the mappings keep it alive */
+    if (fd >= 0)
+    {
+        shm_unlink(name);
+    }
+    
+    return fd;
+#endif
+}
+
+/* maps the same length bytes twice in a row, so that
+ * [heap, heap + length) wraps into [heap + length, ...) */
+static fs_byte_t *fs_byte_buffer_ring_map(uint32_t length)
+{
+    int fd = fs_byte_buffer_ring_file();
+    
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    
+    if (ftruncate(fd, length) != 0)
+    {
+        close(fd);
+        return NULL;
+    }
+    
+    /* reserve both halves first, so nothing
+     * else can land in between the two maps */
+    fs_byte_t *heap = OPT_CAST(fs_byte_t) mmap(NULL, (size_t) length * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    
+    if ((void *) heap == MAP_FAILED)
+    {
+        close(fd);
+        return NULL;
+    }
+    
+    void *lower = mmap(heap, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    void *upper = mmap(heap + length, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+    
+    /* the mappings keep the file alive */
+    close(fd);
+    
+    if (lower == MAP_FAILED || upper == MAP_FAILED)
+    {
+        munmap(heap, (size_t) length * 2);
+        return NULL;
+    }
+    
+    return heap;
+}
+
+/* shared block owning the ring, refcnt starts at 1 */
+static fs_byte_buffer_shared_t *fs_byte_buffer_ring_alloc(uint32_t length)
+{
+    fs_byte_buffer_shared_t *shared = OPT_CAST(fs_byte_buffer_shared_t) malloc(sizeof(fs_byte_buffer_shared_t));
+    
+    if (shared == NULL)
+    {
+        return NULL;
+    }
+    
+    shared->heap = fs_byte_buffer_ring_map(length);
+    
+    if (shared->heap == NULL)
+    {
+        free(shared);
+        return NULL;
+    }
+    
+    shared->capacity = length;
+    shared->pool     = NULL;
+    shared->flags    = FS_BUFFER_RING;
+    shared->refcnt   = 1;
+    
+    return shared;
+}
+
+int fs_byte_buffer_init_ring(fs_byte_buffer_t *buffer, uint32_t capacity)
+{
+    uint32_t length = fs_byte_buffer_ring_length(capacity);
+    
+    if (length == 0)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    fs_byte_buffer_shared_t *shared = fs_byte_buffer_ring_alloc(length);
+    
+    if (shared == NULL)
+    {
+        return FS_ERR_OOM;
+    }
+    
+    /* the whole ring is usable */
+    buffer->heap = shared->heap;
+    buffer->capacity = length;
+    
+    /* Set marks to zero */
+    buffer->reader_mark = 0;
+    buffer->writer_mark = 0;
+    
+    /* Set indices to zero */
+    buffer->reader_index = 0;
+    buffer->writer_index = 0;
+    
+    /* rings always own a shared block, it's
+     * where the start of the mapping is kept */
+    buffer->pool = NULL;
+    buffer->shared = shared;
+    buffer->flags = FS_BUFFER_RING;
+    buffer->growth = NULL;
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_ring_rotate(fs_byte_buffer_t *buffer)
+{
+    fs_byte_buffer_shared_t *shared = buffer->shared;
+    
+    /* slices may still see the read bytes,
+     * they can't be handed out for writing */
+    if (__atomic_load_n(&shared->refcnt, __ATOMIC_ACQUIRE) != 1)
+    {
+        return fs_byte_buffer_ring_move(buffer, buffer->capacity, buffer->reader_index);
+    }
+    
+    /* move the window forward, wrapping it back into the
+     * lower half: both halves are the same physical pages */
+    uint32_t start = (uint32_t) (buffer->heap - shared->heap) + buffer->reader_index;
+    
+    if (start >= shared->capacity)
+    {
+        start -= shared->capacity;
+    }
+    
+    buffer->heap = shared->heap + start;
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_ring_move(fs_byte_buffer_t *buffer, uint32_t capacity, uint32_t from)
+{
+    uint32_t length = fs_byte_buffer_ring_length(capacity);
+    
+    if (length == 0)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    fs_byte_buffer_shared_t *shared = fs_byte_buffer_ring_alloc(length);
+    
+    if (shared == NULL)
+    {
+        return FS_ERR_OOM;
+    }
+    
+    /* only written bytes are worth copying */
+    uint32_t count = buffer->writer_index - from;
+    
+    memcpy(shared->heap, buffer->heap + from, count < length ? count : length);
+    
+    fs_byte_buffer_unshare(buffer->shared);
+    
+    buffer->heap = shared->heap;
+    buffer->capacity = length;
+    buffer->pool = NULL;
+    buffer->shared = shared;
+    buffer->flags = FS_BUFFER_RING;
+    
+    return FS_OKAY;
+}
+
+void fs_byte_buffer_ring_release(fs_byte_t *heap, uint32_t capacity)
+{
+    munmap(heap, (size_t) capacity * 2);
+}
@@ -0,0 +1,87 @@
+//
+//  fs_byte_buffer_set_array.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 17/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_byte_buffer_set_int16_be_array(fs_byte_buffer_t *buffer, uint32_t offset, const int16_t *in, uint32_t count)
+{
+    /* one bounds check for the whole array */
+    if (count > UINT32_MAX / sizeof(int16_t) || fs_byte_buffer_is_writable_by_length_at_offset(buffer, count * sizeof(int16_t), offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_order_be16(buffer->heap + offset, in, count);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_set_int16_le_array(fs_byte_buffer_t *buffer, uint32_t offset, const int16_t *in, uint32_t count)
+{
+    /* one bounds check for the whole array */
+    if (count > UINT32_MAX / sizeof(int16_t) || fs_byte_buffer_is_writable_by_length_at_offset(buffer, count * sizeof(int16_t), offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_order_le16(buffer->heap + offset, in, count);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_set_int32_be_array(fs_byte_buffer_t *buffer, uint32_t offset, const int32_t *in, uint32_t count)
+{
+    /* one bounds check for the whole array */
+    if (count > UINT32_MAX / sizeof(int32_t) || fs_byte_buffer_is_writable_by_length_at_offset(buffer, count * sizeof(int32_t), offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_order_be32(buffer->heap + offset, in, count);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_set_int32_le_array(fs_byte_buffer_t *buffer, uint32_t offset, const int32_t *in, uint32_t count)
+{
+    /* one bounds check for the whole array */
+    if (count > UINT32_MAX / sizeof(int32_t) || fs_byte_buffer_is_writable_by_length_at_offset(buffer, count * sizeof(int32_t), offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_order_le32(buffer->heap + offset, in, count);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_set_int64_be_array(fs_byte_buffer_t *buffer, uint32_t offset, const int64_t *in, uint32_t count)
+{
+    /* one bounds check for the whole array */
+    if (count > UINT32_MAX / sizeof(int64_t) || fs_byte_buffer_is_writable_by_length_at_offset(buffer, count * sizeof(int64_t), offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_order_be64(buffer->heap + offset, in, count);
+    
+    return FS_OKAY;
+}
+
+int fs_byte_buffer_set_int64_le_array(fs_byte_buffer_t *buffer, uint32_t offset, const int64_t *in, uint32_t count)
+{
+    /* one bounds check for the whole array */
+    if (count > UINT32_MAX / sizeof(int64_t) || fs_byte_buffer_is_writable_by_length_at_offset(buffer, count * sizeof(int64_t), offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_order_le64(buffer->heap + offset, in, count);
+    
+    return FS_OKAY;
+}
@@ -0,0 +1,34 @@
+//
+//  fs_byte_buffer_utf8.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 26/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_byte_buffer_validate_utf8(fs_byte_buffer_t *buffer, uint32_t offset, uint32_t length, int *ascii)
+{
+    int is_ascii;
+    
+    /* src must be readable */
+    int is_readable = fs_byte_buffer_is_readable_by_length_at_offset(buffer, length, offset);
+    
+    if (is_readable == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    if (fs_byte_utf8_validate(buffer->heap + offset, length, &is_ascii) == FS_NO)
+    {
+        return FS_ERR_DATA;
+    }
+    
+    if (ascii != NULL)
+    {
+        *ascii = is_ascii;
+    }
+    
+    return FS_OKAY;
+}
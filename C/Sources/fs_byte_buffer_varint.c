@@ -0,0 +1,179 @@
+//
+//  fs_byte_buffer_varint.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 19/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+/* decodes at most max bytes of LEB128 */
+static inline int fs_byte_buffer_get_varint(fs_byte_buffer_t *buffer, uint32_t offset, uint32_t max, uint64_t *out, uint32_t *length)
+{
+    if (offset >= buffer->writer_index)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    const fs_byte_t *heap = buffer->heap + offset;
+    uint32_t available = buffer->writer_index - offset;
+    
+    /* most varints on the wire fit in one byte */
+    if (heap[0] < 0x80)
+    {
+        *out = heap[0];
+        *length = 1;
+        
+        return FS_OKAY;
+    }
+    
+    uint64_t value = 0;
+    
+    for (uint32_t i = 0; i < max; i++)
+    {
+        /* truncated, wait for more bytes */
+        if (i == available)
+        {
+            return FS_ERR_OOB;
+        }
+        
+        value |= (uint64_t) (heap[i] & 0x7f) << (7 * i);
+        
+        if (heap[i] < 0x80)
+        {
+            *out = value;
+            *length = i + 1;
+            
+            return FS_OKAY;
+        }
+    }
+    
+    /* too many continuation bytes */
+    return FS_ERR_OOR;
+}
+
+static inline int fs_byte_buffer_write_varint(fs_byte_buffer_t *buffer, uint64_t value)
+{
+    fs_byte_t scratch[FS_VARINT64_MAX_LENGTH];
+    uint32_t length = 0;
+    
+    while (value >= 0x80)
+    {
+        scratch[length++] = (fs_byte_t) (value | 0x80);
+        value >>= 7;
+    }
+    
+    scratch[length++] = (fs_byte_t) value;
+    
+    return fs_byte_buffer_write_bytes(buffer, length, scratch);
+}
+
+int fs_byte_buffer_get_varint32(fs_byte_buffer_t *buffer, uint32_t offset, uint32_t *out, uint32_t *length)
+{
+    uint64_t value;
+    
+    int result = fs_byte_buffer_get_varint(buffer, offset, FS_VARINT32_MAX_LENGTH, &value, length);
+    
+    if (result == FS_OKAY)
+    {
+        *out = (uint32_t) value;
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_get_varint64(fs_byte_buffer_t *buffer, uint32_t offset, uint64_t *out, uint32_t *length)
+{
+    return fs_byte_buffer_get_varint(buffer, offset, FS_VARINT64_MAX_LENGTH, out, length);
+}
+
+int fs_byte_buffer_read_varint32(fs_byte_buffer_t *buffer, uint32_t *out)
+{
+    uint32_t length;
+    
+    int result = fs_byte_buffer_get_varint32(buffer, buffer->reader_index, out, &length);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase reader pos by encoded length */
+        buffer->reader_index += length;
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_read_varint64(fs_byte_buffer_t *buffer, uint64_t *out)
+{
+    uint32_t length;
+    
+    int result = fs_byte_buffer_get_varint64(buffer, buffer->reader_index, out, &length);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase reader pos by encoded length */
+        buffer->reader_index += length;
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_read_zigzag32(fs_byte_buffer_t *buffer, int32_t *out)
+{
+    uint32_t value;
+    
+    int result = fs_byte_buffer_read_varint32(buffer, &value);
+    
+    if (result == FS_OKAY)
+    {
+        *out = fs_zigzag_decode32(value);
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_read_zigzag64(fs_byte_buffer_t *buffer, int64_t *out)
+{
+    uint64_t value;
+    
+    int result = fs_byte_buffer_read_varint64(buffer, &value);
+    
+    if (result == FS_OKAY)
+    {
+        *out = fs_zigzag_decode64(value);
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_write_varint32(fs_byte_buffer_t *buffer, uint32_t value)
+{
+    /* fast path, single byte */
+    if (value < 0x80)
+    {
+        return fs_byte_buffer_write_int8_inline(buffer, (int8_t) value);
+    }
+    
+    return fs_byte_buffer_write_varint(buffer, value);
+}
+
+int fs_byte_buffer_write_varint64(fs_byte_buffer_t *buffer, uint64_t value)
+{
+    /* fast path, single byte */
+    if (value < 0x80)
+    {
+        return fs_byte_buffer_write_int8_inline(buffer, (int8_t) value);
+    }
+    
+    return fs_byte_buffer_write_varint(buffer, value);
+}
+
+int fs_byte_buffer_write_zigzag32(fs_byte_buffer_t *buffer, int32_t value)
+{
+    return fs_byte_buffer_write_varint32(buffer, fs_zigzag_encode32(value));
+}
+
+int fs_byte_buffer_write_zigzag64(fs_byte_buffer_t *buffer, int64_t value)
+{
+    return fs_byte_buffer_write_varint64(buffer, fs_zigzag_encode64(value));
+}
@@ -0,0 +1,189 @@
+//
+//  fs_byte_buffer_write_array.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 17/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_byte_buffer_write_int16_be_array(fs_byte_buffer_t *buffer, const int16_t *in, uint32_t count)
+{
+    /* byte length must fit in 32 bits */
+    if (count > UINT32_MAX / sizeof(int16_t))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    /* grow first, if needs be */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, count * sizeof(int16_t));
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    /* get current writer pos */
+    uint32_t offset = buffer->writer_index;
+    
+    result = fs_byte_buffer_set_int16_be_array(buffer, offset, in, count);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase writer pos by count * 2 */
+        buffer->writer_index += count * sizeof(int16_t);
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_write_int16_le_array(fs_byte_buffer_t *buffer, const int16_t *in, uint32_t count)
+{
+    /* byte length must fit in 32 bits */
+    if (count > UINT32_MAX / sizeof(int16_t))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    /* grow first, if needs be */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, count * sizeof(int16_t));
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    /* get current writer pos */
+    uint32_t offset = buffer->writer_index;
+    
+    result = fs_byte_buffer_set_int16_le_array(buffer, offset, in, count);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase writer pos by count * 2 */
+        buffer->writer_index += count * sizeof(int16_t);
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_write_int32_be_array(fs_byte_buffer_t *buffer, const int32_t *in, uint32_t count)
+{
+    /* byte length must fit in 32 bits */
+    if (count > UINT32_MAX / sizeof(int32_t))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    /* grow first, if needs be */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, count * sizeof(int32_t));
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    /* get current writer pos */
+    uint32_t offset = buffer->writer_index;
+    
+    result = fs_byte_buffer_set_int32_be_array(buffer, offset, in, count);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase writer pos by count * 4 */
+        buffer->writer_index += count * sizeof(int32_t);
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_write_int32_le_array(fs_byte_buffer_t *buffer, const int32_t *in, uint32_t count)
+{
+    /* byte length must fit in 32 bits */
+    if (count > UINT32_MAX / sizeof(int32_t))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    /* grow first, if needs be */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, count * sizeof(int32_t));
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    /* get current writer pos */
+    uint32_t offset = buffer->writer_index;
+    
+    result = fs_byte_buffer_set_int32_le_array(buffer, offset, in, count);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase writer pos by count * 4 */
+        buffer->writer_index += count * sizeof(int32_t);
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_write_int64_be_array(fs_byte_buffer_t *buffer, const int64_t *in, uint32_t count)
+{
+    /* byte length must fit in 32 bits */
+    if (count > UINT32_MAX / sizeof(int64_t))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    /* grow first, if needs be */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, count * sizeof(int64_t));
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    /* get current writer pos */
+    uint32_t offset = buffer->writer_index;
+    
+    result = fs_byte_buffer_set_int64_be_array(buffer, offset, in, count);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase writer pos by count * 8 */
+        buffer->writer_index += count * sizeof(int64_t);
+    }
+    
+    return result;
+}
+
+int fs_byte_buffer_write_int64_le_array(fs_byte_buffer_t *buffer, const int64_t *in, uint32_t count)
+{
+    /* byte length must fit in 32 bits */
+    if (count > UINT32_MAX / sizeof(int64_t))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    /* grow first, if needs be */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, count * sizeof(int64_t));
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    /* get current writer pos */
+    uint32_t offset = buffer->writer_index;
+    
+    result = fs_byte_buffer_set_int64_le_array(buffer, offset, in, count);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase writer pos by count * 8 */
+        buffer->writer_index += count * sizeof(int64_t);
+    }
+    
+    return result;
+}
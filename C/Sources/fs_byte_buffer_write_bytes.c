@@ -10,10 +10,18 @@
 
 int fs_byte_buffer_write_bytes(fs_byte_buffer_t *buffer, uint32_t length, const fs_byte_t *in)
 {
+    /* grow first, if needs be */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, length);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
     /* get current writer pos */
     int offset = buffer->writer_index;
     
-    int result = fs_byte_buffer_set_bytes(buffer, length, offset, in);
+    result = fs_byte_buffer_set_bytes(buffer, length, offset, in);
     
     if (result == FS_OKAY)
     {
@@ -10,10 +10,18 @@
 
 int fs_byte_buffer_write_int32_be(fs_byte_buffer_t *buffer, int32_t value)
 {
+    /* grow first, if needs be */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int32_t));
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
     /* get current writer pos */
     int offset = buffer->writer_index;
     
-    int result = fs_byte_buffer_set_int32_be(buffer, offset, value);
+    result = fs_byte_buffer_set_int32_be(buffer, offset, value);
     
     if (result == FS_OKAY)
     {
@@ -26,10 +34,18 @@ int fs_byte_buffer_write_int32_be(fs_byte_buffer_t *buffer, int32_t value)
 
 int fs_byte_buffer_write_int32_le(fs_byte_buffer_t *buffer, int32_t value)
 {
+    /* grow first, if needs be */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int32_t));
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
     /* get current writer pos */
     int offset = buffer->writer_index;
     
-    int result = fs_byte_buffer_set_int32_le(buffer, offset, value);
+    result = fs_byte_buffer_set_int32_le(buffer, offset, value);
     
     if (result == FS_OKAY)
     {
@@ -10,10 +10,18 @@
 
 int fs_byte_buffer_write_int64_be(fs_byte_buffer_t *buffer, int64_t value)
 {
+    /* grow first, if needs be */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int64_t));
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
     /* get current writer pos */
     int offset = buffer->writer_index;
     
-    int result = fs_byte_buffer_set_int64_be(buffer, offset, value);
+    result = fs_byte_buffer_set_int64_be(buffer, offset, value);
     
     if (result == FS_OKAY)
     {
@@ -26,10 +34,18 @@ int fs_byte_buffer_write_int64_be(fs_byte_buffer_t *buffer, int64_t value)
 
 int fs_byte_buffer_write_int64_le(fs_byte_buffer_t *buffer, int64_t value)
 {
+    /* grow first, if needs be */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int64_t));
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
     /* get current writer pos */
     int offset = buffer->writer_index;
     
-    int result = fs_byte_buffer_set_int64_le(buffer, offset, value);
+    result = fs_byte_buffer_set_int64_le(buffer, offset, value);
     
     if (result == FS_OKAY)
     {
@@ -10,10 +10,18 @@
 
 int fs_byte_buffer_write_int8(fs_byte_buffer_t *buffer, int8_t value)
 {
+    /* grow first, if needs be */
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int8_t));
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
     /* get current writer pos */
     int offset = buffer->writer_index;
     
-    int result = fs_byte_buffer_set_int8(buffer, offset, value);
+    result = fs_byte_buffer_set_int8(buffer, offset, value);
     
     if (result == FS_OKAY)
     {
@@ -0,0 +1,562 @@
+//
+//  fs_byte_checksum.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 25/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define FS_CRC_X86 1
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#define FS_CRC_ARM 1
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#if defined(__clang__)
+#define FS_CRC_ARM_TARGET __attribute__((target("crc")))
+#else
+#define FS_CRC_ARM_TARGET __attribute__((target("+crc")))
+#endif
+#endif
+
+/* CRC-32C (Castagnoli), reflected */
+#define CRC32C_POLY 0x82F63B78
+
+/* hardware kernels run three streams at once, each stream
+ * being LONG (then SHORT) bytes, and merge them after */
+#define CRC32C_LONG  8192
+#define CRC32C_SHORT 256
+
+typedef uint32_t (*fs_byte_crc32c_fn)(uint32_t crc, const fs_byte_t *heap, uint32_t length);
+
+/* slicing-by-8 tables for the fallback */
+static uint32_t fs_crc32c_table[8][256];
+
+/* operators appending LONG / SHORT zero bytes to a crc */
+static uint32_t fs_crc32c_long[4][256];
+static uint32_t fs_crc32c_short[4][256];
+
+static pthread_once_t fs_crc32c_once = PTHREAD_ONCE_INIT;
+
+/* GF(2) matrix times vector, mat being 32 columns */
+static uint32_t fs_gf2_matrix_times(const uint32_t *mat, uint32_t vec)
+{
+    uint32_t sum = 0;
+    
+    while (vec != 0)
+    {
+        if (vec & 1)
+        {
+            sum ^= *mat;
+        }
+        
+        vec >>= 1;
+        mat++;
+    }
+    
+    return sum;
+}
+
+static void fs_gf2_matrix_square(uint32_t *square, const uint32_t *mat)
+{
+    for (int n = 0; n < 32; n++)
+    {
+        square[n] = fs_gf2_matrix_times(mat, mat[n]);
+    }
+}
+
+/* operator appending length zero bytes, length being a power of two */
+static void fs_crc32c_zeros(uint32_t zeros[4][256], uint32_t length)
+{
+    uint32_t even[32];
+    uint32_t odd[32];
+    
+    /* one zero bit */
+    odd[0] = CRC32C_POLY;
+    
+    for (int n = 1; n < 32; n++)
+    {
+        odd[n] = 1u << (n - 1);
+    }
+    
+    /* two, then four zero bits */
+    fs_gf2_matrix_square(even, odd);
+    fs_gf2_matrix_square(odd, even);
+    
+    /* every square doubles them, starting from one byte */
+    const uint32_t *op = odd;
+    
+    for (;;)
+    {
+        fs_gf2_matrix_square(even, odd);
+        op = even;
+        length >>= 1;
+        
+        if (length == 0)
+        {
+            break;
+        }
+        
+        fs_gf2_matrix_square(odd, even);
+        op = odd;
+        length >>= 1;
+        
+        if (length == 0)
+        {
+            break;
+        }
+    }
+    
+    /* spread per byte of the crc, 4 lookups per shift */
+    for (uint32_t n = 0; n < 256; n++)
+    {
+        zeros[0][n] = fs_gf2_matrix_times(op, n);
+        zeros[1][n] = fs_gf2_matrix_times(op, n << 8);
+        zeros[2][n] = fs_gf2_matrix_times(op, n << 16);
+        zeros[3][n] = fs_gf2_matrix_times(op, n << 24);
+    }
+}
+
+static void fs_crc32c_init_tables(void)
+{
+    for (uint32_t n = 0; n < 256; n++)
+    {
+        uint32_t crc = n;
+        
+        for (int k = 0; k < 8; k++)
+        {
+            crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        }
+        
+        fs_crc32c_table[0][n] = crc;
+    }
+    
+    for (uint32_t n = 0; n < 256; n++)
+    {
+        uint32_t crc = fs_crc32c_table[0][n];
+        
+        for (int k = 1; k < 8; k++)
+        {
+            crc = fs_crc32c_table[0][crc & 0xFF] ^ (crc >> 8);
+            fs_crc32c_table[k][n] = crc;
+        }
+    }
+    
+    fs_crc32c_zeros(fs_crc32c_long,  CRC32C_LONG);
+    fs_crc32c_zeros(fs_crc32c_short, CRC32C_SHORT);
+}
+
+static inline uint32_t fs_crc32c_shift(uint32_t zeros[4][256], uint32_t crc)
+{
+    return zeros[0][crc & 0xFF] ^ zeros[1][(crc >> 8) & 0xFF] ^ zeros[2][(crc >> 16) & 0xFF] ^ zeros[3][crc >> 24];
+}
+
+/* table fallback, 8 bytes per step */
+static uint32_t fs_byte_crc32c_table(uint32_t crc, const fs_byte_t *heap, uint32_t length)
+{
+    crc = ~crc;
+    
+    for (; length >= 8; heap += 8, length -= 8)
+    {
+        uint64_t word;
+        memcpy(&word, heap, sizeof(word));
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word = __builtin_bswap64(word);
+#endif
+        
+        word ^= crc;
+        
+        crc = fs_crc32c_table[7][ word        & 0xFF] ^
+              fs_crc32c_table[6][(word >>  8) & 0xFF] ^
+              fs_crc32c_table[5][(word >> 16) & 0xFF] ^
+              fs_crc32c_table[4][(word >> 24) & 0xFF] ^
+              fs_crc32c_table[3][(word >> 32) & 0xFF] ^
+              fs_crc32c_table[2][(word >> 40) & 0xFF] ^
+              fs_crc32c_table[1][(word >> 48) & 0xFF] ^
+              fs_crc32c_table[0][ word >> 56];
+    }
+    
+    for (; length > 0; heap++, length--)
+    {
+        crc = fs_crc32c_table[0][(crc ^ *heap) & 0xFF] ^ (crc >> 8);
+    }
+    
+    return ~crc;
+}
+
+#if FS_CRC_X86
+
+/* one crc32 instruction has a latency of 3 cycles but
+ * issues every cycle, three streams keep it busy */
+__attribute__((target("sse4.2")))
+static uint32_t fs_byte_crc32c_sse42(uint32_t crc, const fs_byte_t *heap, uint32_t length)
+{
+    uint64_t crc0 = ~crc;
+    
+    while (length >= CRC32C_LONG * 3)
+    {
+        uint64_t crc1 = 0;
+        uint64_t crc2 = 0;
+        
+        for (const fs_byte_t *end = heap + CRC32C_LONG; heap < end; heap += 8)
+        {
+            uint64_t word0, word1, word2;
+            
+            memcpy(&word0, heap, sizeof(uint64_t));
+            memcpy(&word1, heap + CRC32C_LONG, sizeof(uint64_t));
+            memcpy(&word2, heap + CRC32C_LONG * 2, sizeof(uint64_t));
+            
+            crc0 = _mm_crc32_u64(crc0, word0);
+            crc1 = _mm_crc32_u64(crc1, word1);
+            crc2 = _mm_crc32_u64(crc2, word2);
+        }
+        
+        crc0 = fs_crc32c_shift(fs_crc32c_long, (uint32_t) crc0) ^ crc1;
+        crc0 = fs_crc32c_shift(fs_crc32c_long, (uint32_t) crc0) ^ crc2;
+        
+        heap   += CRC32C_LONG * 2;
+        length -= CRC32C_LONG * 3;
+    }
+    
+    while (length >= CRC32C_SHORT * 3)
+    {
+        uint64_t crc1 = 0;
+        uint64_t crc2 = 0;
+        
+        for (const fs_byte_t *end = heap + CRC32C_SHORT; heap < end; heap += 8)
+        {
+            uint64_t word0, word1, word2;
+            
+            memcpy(&word0, heap, sizeof(uint64_t));
+            memcpy(&word1, heap + CRC32C_SHORT, sizeof(uint64_t));
+            memcpy(&word2, heap + CRC32C_SHORT * 2, sizeof(uint64_t));
+            
+            crc0 = _mm_crc32_u64(crc0, word0);
+            crc1 = _mm_crc32_u64(crc1, word1);
+            crc2 = _mm_crc32_u64(crc2, word2);
+        }
+        
+        crc0 = fs_crc32c_shift(fs_crc32c_short, (uint32_t) crc0) ^ crc1;
+        crc0 = fs_crc32c_shift(fs_crc32c_short, (uint32_t) crc0) ^ crc2;
+        
+        heap   += CRC32C_SHORT * 2;
+        length -= CRC32C_SHORT * 3;
+    }
+    
+    for (; length >= 8; heap += 8, length -= 8)
+    {
+        uint64_t word;
+        memcpy(&word, heap, sizeof(uint64_t));
+        
+        crc0 = _mm_crc32_u64(crc0, word);
+    }
+    
+    for (; length > 0; heap++, length--)
+    {
+        crc0 = _mm_crc32_u8((uint32_t) crc0, *heap);
+    }
+    
+    return ~(uint32_t) crc0;
+}
+
+#endif /* FS_CRC_X86 */
+
+#if FS_CRC_ARM
+
+/* same three streams as the sse4.2 kernel */
+FS_CRC_ARM_TARGET
+static uint32_t fs_byte_crc32c_armv8(uint32_t crc, const fs_byte_t *heap, uint32_t length)
+{
+    uint32_t crc0 = ~crc;
+    
+    while (length >= CRC32C_LONG * 3)
+    {
+        uint32_t crc1 = 0;
+        uint32_t crc2 = 0;
+        
+        for (const fs_byte_t *end = heap + CRC32C_LONG; heap < end; heap += 8)
+        {
+            uint64_t word0, word1, word2;
+            
+            memcpy(&word0, heap, sizeof(uint64_t));
+            memcpy(&word1, heap + CRC32C_LONG, sizeof(uint64_t));
+            memcpy(&word2, heap + CRC32C_LONG * 2, sizeof(uint64_t));
+            
+            crc0 = __crc32cd(crc0, word0);
+            crc1 = __crc32cd(crc1, word1);
+            crc2 = __crc32cd(crc2, word2);
+        }
+        
+        crc0 = fs_crc32c_shift(fs_crc32c_long, crc0) ^ crc1;
+        crc0 = fs_crc32c_shift(fs_crc32c_long, crc0) ^ crc2;
+        
+        heap   += CRC32C_LONG * 2;
+        length -= CRC32C_LONG * 3;
+    }
+    
+    while (length >= CRC32C_SHORT * 3)
+    {
+        uint32_t crc1 = 0;
+        uint32_t crc2 = 0;
+        
+        for (const fs_byte_t *end = heap + CRC32C_SHORT; heap < end; heap += 8)
+        {
+            uint64_t word0, word1, word2;
+            
+            memcpy(&word0, heap, sizeof(uint64_t));
+            memcpy(&word1, heap + CRC32C_SHORT, sizeof(uint64_t));
+            memcpy(&word2, heap + CRC32C_SHORT * 2, sizeof(uint64_t));
+            
+            crc0 = __crc32cd(crc0, word0);
+            crc1 = __crc32cd(crc1, word1);
+            crc2 = __crc32cd(crc2, word2);
+        }
+        
+        crc0 = fs_crc32c_shift(fs_crc32c_short, crc0) ^ crc1;
+        crc0 = fs_crc32c_shift(fs_crc32c_short, crc0) ^ crc2;
+        
+        heap   += CRC32C_SHORT * 2;
+        length -= CRC32C_SHORT * 3;
+    }
+    
+    for (; length >= 8; heap += 8, length -= 8)
+    {
+        uint64_t word;
+        memcpy(&word, heap, sizeof(uint64_t));
+        
+        crc0 = __crc32cd(crc0, word);
+    }
+    
+    for (; length > 0; heap++, length--)
+    {
+        crc0 = __crc32cb(crc0, *heap);
+    }
+    
+    return ~crc0;
+}
+
+static int fs_byte_crc32c_armv8_supported(void)
+{
+#if defined(__APPLE__)
+    /* every arm64 apple core has it */
+    return FS_YES;
+#elif defined(__linux__) && defined(HWCAP_CRC32)
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) ? FS_YES: FS_NO;
+#else
+    return FS_NO;
+#endif
+}
+
+#endif /* FS_CRC_ARM */
+
+static uint32_t fs_byte_crc32c_resolve(uint32_t crc, const fs_byte_t *heap, uint32_t length);
+
+static fs_byte_crc32c_fn fs_byte_crc32c_kernel = fs_byte_crc32c_resolve;
+
+/* picked on first use. Unlike the other kernels these
+ * read tables, built once before the kernel is published */
+static uint32_t fs_byte_crc32c_resolve(uint32_t crc, const fs_byte_t *heap, uint32_t length)
+{
+    fs_byte_crc32c_fn kernel = fs_byte_crc32c_table;
+    
+    pthread_once(&fs_crc32c_once, fs_crc32c_init_tables);
+
+#if FS_CRC_X86
+    __builtin_cpu_init();
+    
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        kernel = fs_byte_crc32c_sse42;
+    }
+#elif FS_CRC_ARM
+    if (fs_byte_crc32c_armv8_supported())
+    {
+        kernel = fs_byte_crc32c_armv8;
+    }
+#endif
+    
+    __atomic_store_n(&fs_byte_crc32c_kernel, kernel, __ATOMIC_RELEASE);
+    
+    return kernel(crc, heap, length);
+}
+
+uint32_t fs_byte_crc32c(uint32_t crc, const fs_byte_t *heap, uint32_t length)
+{
+    return __atomic_load_n(&fs_byte_crc32c_kernel, __ATOMIC_ACQUIRE)(crc, heap, length);
+}
+
+/* xxHash64 primes */
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ull
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4Full
+#define XXH_PRIME64_3 0x165667B19E3779F9ull
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ull
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ull
+
+static inline uint64_t fs_xxh_rotl64(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t fs_xxh_read64(const fs_byte_t *heap)
+{
+    uint64_t value;
+    memcpy(&value, heap, sizeof(value));
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    
+    return value;
+}
+
+static inline uint32_t fs_xxh_read32(const fs_byte_t *heap)
+{
+    uint32_t value;
+    memcpy(&value, heap, sizeof(value));
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    
+    return value;
+}
+
+static inline uint64_t fs_xxh_round(uint64_t acc, uint64_t input)
+{
+    acc += input * XXH_PRIME64_2;
+    acc  = fs_xxh_rotl64(acc, 31);
+    
+    return acc * XXH_PRIME64_1;
+}
+
+static inline uint64_t fs_xxh_merge_round(uint64_t acc, uint64_t value)
+{
+    acc ^= fs_xxh_round(0, value);
+    
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+void fs_byte_xxhash64_init(fs_byte_xxhash64_t *state, uint64_t seed)
+{
+    state->v[0] = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+    state->v[1] = seed + XXH_PRIME64_2;
+    state->v[2] = seed;
+    state->v[3] = seed - XXH_PRIME64_1;
+    
+    state->seed = seed;
+    state->total = 0;
+    state->buffered = 0;
+}
+
+void fs_byte_xxhash64_update(fs_byte_xxhash64_t *state, const fs_byte_t *heap, uint32_t length)
+{
+    state->total += length;
+    
+    /* not even one stripe yet, keep it for later */
+    if (state->buffered + length < 32)
+    {
+        memcpy(state->stripe + state->buffered, heap, length);
+        state->buffered += length;
+        return;
+    }
+    
+    /* complete the stripe left from the last update */
+    if (state->buffered > 0)
+    {
+        uint32_t n = 32 - state->buffered;
+        
+        memcpy(state->stripe + state->buffered, heap, n);
+        
+        for (int i = 0; i < 4; i++)
+        {
+            state->v[i] = fs_xxh_round(state->v[i], fs_xxh_read64(state->stripe + i * 8));
+        }
+        
+        heap   += n;
+        length -= n;
+        
+        state->buffered = 0;
+    }
+    
+    uint64_t v0 = state->v[0];
+    uint64_t v1 = state->v[1];
+    uint64_t v2 = state->v[2];
+    uint64_t v3 = state->v[3];
+    
+    for (; length >= 32; heap += 32, length -= 32)
+    {
+        v0 = fs_xxh_round(v0, fs_xxh_read64(heap));
+        v1 = fs_xxh_round(v1, fs_xxh_read64(heap + 8));
+        v2 = fs_xxh_round(v2, fs_xxh_read64(heap + 16));
+        v3 = fs_xxh_round(v3, fs_xxh_read64(heap + 24));
+    }
+    
+    state->v[0] = v0;
+    state->v[1] = v1;
+    state->v[2] = v2;
+    state->v[3] = v3;
+    
+    memcpy(state->stripe, heap, length);
+    state->buffered = length;
+}
+
+uint64_t fs_byte_xxhash64_digest(const fs_byte_xxhash64_t *state)
+{
+    uint64_t hash;
+    
+    if (state->total >= 32)
+    {
+        hash = fs_xxh_rotl64(state->v[0], 1) + fs_xxh_rotl64(state->v[1], 7) + fs_xxh_rotl64(state->v[2], 12) + fs_xxh_rotl64(state->v[3], 18);
+        
+        for (int i = 0; i < 4; i++)
+        {
+            hash = fs_xxh_merge_round(hash, state->v[i]);
+        }
+    }
+    else
+    {
+        hash = state->seed + XXH_PRIME64_5;
+    }
+    
+    hash += state->total;
+    
+    const fs_byte_t *heap = state->stripe;
+    uint32_t length = state->buffered;
+    
+    for (; length >= 8; heap += 8, length -= 8)
+    {
+        hash ^= fs_xxh_round(0, fs_xxh_read64(heap));
+        hash  = fs_xxh_rotl64(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+    
+    if (length >= 4)
+    {
+        hash ^= (uint64_t) fs_xxh_read32(heap) * XXH_PRIME64_1;
+        hash  = fs_xxh_rotl64(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        
+        heap   += 4;
+        length -= 4;
+    }
+    
+    for (; length > 0; heap++, length--)
+    {
+        hash ^= *heap * XXH_PRIME64_5;
+        hash  = fs_xxh_rotl64(hash, 11) * XXH_PRIME64_1;
+    }
+    
+    /* avalanche */
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME64_3;
+    hash ^= hash >> 32;
+    
+    return hash;
+}
@@ -0,0 +1,327 @@
+//
+//  fs_byte_search.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 24/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FS_SEARCH_X86 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FS_SEARCH_NEON 1
+#endif
+
+typedef uint32_t (*fs_byte_search_fn)(const fs_byte_t *heap, uint32_t length, fs_byte_t value);
+typedef uint32_t (*fs_byte_search_sequence_fn)(const fs_byte_t *heap, uint32_t length, const fs_byte_t *sequence, uint32_t count);
+
+/* swar fallback, also used for vector tails */
+static uint32_t fs_byte_search_scalar(const fs_byte_t *heap, uint32_t length, fs_byte_t value)
+{
+    const uint64_t ones  = 0x0101010101010101ull;
+    const uint64_t highs = 0x8080808080808080ull;
+    
+    uint64_t pattern = ones * value;
+    uint32_t i = 0;
+    
+    for (; i + 8 <= length; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, heap + i, sizeof(word));
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        /* borrows run towards the high bytes,
+         * keep the first byte the lowest one */
+        word = __builtin_bswap64(word);
+#endif
+        
+        /* matching bytes become zero, which get their high bit
+         * set. The lowest one is exact, borrows only go up */
+        word ^= pattern;
+        
+        uint64_t zeros = (word - ones) & ~word & highs;
+        
+        if (zeros != 0)
+        {
+            return i + (__builtin_ctzll(zeros) >> 3);
+        }
+    }
+    
+    for (; i < length; i++)
+    {
+        if (heap[i] == value)
+        {
+            return i;
+        }
+    }
+    
+    return length;
+}
+
+#if FS_SEARCH_X86
+
+__attribute__((target("sse2")))
+static uint32_t fs_byte_search_sse2(const fs_byte_t *heap, uint32_t length, fs_byte_t value)
+{
+    const __m128i pattern = _mm_set1_epi8((char) value);
+    
+    uint32_t i = 0;
+    
+    for (; i + 32 <= length; i += 32)
+    {
+        __m128i lo = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (heap + i)), pattern);
+        __m128i hi = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (heap + i + 16)), pattern);
+        
+        uint32_t mask = (uint32_t) _mm_movemask_epi8(lo) | (uint32_t) _mm_movemask_epi8(hi) << 16;
+        
+        if (mask != 0)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    
+    for (; i + 16 <= length; i += 16)
+    {
+        uint32_t mask = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (heap + i)), pattern));
+        
+        if (mask != 0)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    
+    return i + fs_byte_search_scalar(heap + i, length - i, value);
+}
+
+__attribute__((target("avx2")))
+static uint32_t fs_byte_search_avx2(const fs_byte_t *heap, uint32_t length, fs_byte_t value)
+{
+    const __m256i pattern = _mm256_set1_epi8((char) value);
+    
+    uint32_t i = 0;
+    
+    for (; i + 64 <= length; i += 64)
+    {
+        __m256i lo = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (heap + i)), pattern);
+        __m256i hi = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (heap + i + 32)), pattern);
+        
+        /* one test for both halves, most blocks don't match */
+        if (_mm256_testz_si256(_mm256_or_si256(lo, hi), _mm256_or_si256(lo, hi)))
+        {
+            continue;
+        }
+        
+        uint64_t mask = (uint32_t) _mm256_movemask_epi8(lo) | (uint64_t) (uint32_t) _mm256_movemask_epi8(hi) << 32;
+        
+        return i + __builtin_ctzll(mask);
+    }
+    
+    for (; i + 32 <= length; i += 32)
+    {
+        uint32_t mask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (heap + i)), pattern));
+        
+        if (mask != 0)
+        {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    
+    return i + fs_byte_search_scalar(heap + i, length - i, value);
+}
+
+#endif /* FS_SEARCH_X86 */
+
+#if FS_SEARCH_NEON
+
+static uint32_t fs_byte_search_neon(const fs_byte_t *heap, uint32_t length, fs_byte_t value)
+{
+    const uint8x16_t pattern = vdupq_n_u8(value);
+    
+    uint32_t i = 0;
+    
+    for (; i + 16 <= length; i += 16)
+    {
+        uint8x16_t eq = vceqq_u8(vld1q_u8(heap + i), pattern);
+        
+        /* no movemask on neon, narrow to 4 bits per byte instead */
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        
+        if (mask != 0)
+        {
+            return i + (__builtin_ctzll(mask) >> 2);
+        }
+    }
+    
+    return i + fs_byte_search_scalar(heap + i, length - i, value);
+}
+
+#endif /* FS_SEARCH_NEON */
+
+/* kernels picked on first use, every thread
+ * resolves to the same ones so racing is fine */
+static uint32_t fs_byte_search_resolve(const fs_byte_t *heap, uint32_t length, fs_byte_t value);
+static uint32_t fs_byte_search_sequence_resolve(const fs_byte_t *heap, uint32_t length, const fs_byte_t *sequence, uint32_t count);
+
+static fs_byte_search_fn          fs_byte_search_kernel          = fs_byte_search_resolve;
+static fs_byte_search_sequence_fn fs_byte_search_sequence_kernel = fs_byte_search_sequence_resolve;
+
+/* first byte found by the vector kernel, the rest compared.
+ * count must be at least 1 */
+static uint32_t fs_byte_search_sequence_scalar(const fs_byte_t *heap, uint32_t length, const fs_byte_t *sequence, uint32_t count)
+{
+    uint32_t i = 0;
+    
+    while (length - i >= count)
+    {
+        /* only where the whole sequence still fits */
+        uint32_t window = length - i - count + 1;
+        uint32_t at = fs_byte_search(heap + i, window, sequence[0]);
+        
+        if (at == window)
+        {
+            break;
+        }
+        
+        if (memcmp(heap + i + at + 1, sequence + 1, count - 1) == 0)
+        {
+            return i + at;
+        }
+        
+        i += at + 1;
+    }
+    
+    return length;
+}
+
+#if FS_SEARCH_X86
+
+/* candidates must match both the first and last byte of the
+ * sequence, which rules out nearly all of them before memcmp */
+__attribute__((target("sse2")))
+static uint32_t fs_byte_search_sequence_sse2(const fs_byte_t *heap, uint32_t length, const fs_byte_t *sequence, uint32_t count)
+{
+    if (count < 2)
+    {
+        return fs_byte_search_sse2(heap, length, sequence[0]);
+    }
+    
+    const __m128i first = _mm_set1_epi8((char) sequence[0]);
+    const __m128i last  = _mm_set1_epi8((char) sequence[count - 1]);
+    
+    uint32_t i = 0;
+    
+    for (; (uint64_t) i + count + 15 <= length; i += 16)
+    {
+        __m128i head = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (heap + i)), first);
+        __m128i tail = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (heap + i + count - 1)), last);
+        
+        uint32_t mask = (uint32_t) _mm_movemask_epi8(_mm_and_si128(head, tail));
+        
+        while (mask != 0)
+        {
+            uint32_t bit = __builtin_ctz(mask);
+            
+            if (memcmp(heap + i + bit + 1, sequence + 1, count - 2) == 0)
+            {
+                return i + bit;
+            }
+            
+            mask &= mask - 1;
+        }
+    }
+    
+    return i + fs_byte_search_sequence_scalar(heap + i, length - i, sequence, count);
+}
+
+__attribute__((target("avx2")))
+static uint32_t fs_byte_search_sequence_avx2(const fs_byte_t *heap, uint32_t length, const fs_byte_t *sequence, uint32_t count)
+{
+    if (count < 2)
+    {
+        return fs_byte_search_avx2(heap, length, sequence[0]);
+    }
+    
+    const __m256i first = _mm256_set1_epi8((char) sequence[0]);
+    const __m256i last  = _mm256_set1_epi8((char) sequence[count - 1]);
+    
+    uint32_t i = 0;
+    
+    for (; (uint64_t) i + count + 31 <= length; i += 32)
+    {
+        __m256i head = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (heap + i)), first);
+        __m256i tail = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (heap + i + count - 1)), last);
+        
+        uint32_t mask = (uint32_t) _mm256_movemask_epi8(_mm256_and_si256(head, tail));
+        
+        while (mask != 0)
+        {
+            uint32_t bit = __builtin_ctz(mask);
+            
+            if (memcmp(heap + i + bit + 1, sequence + 1, count - 2) == 0)
+            {
+                return i + bit;
+            }
+            
+            mask &= mask - 1;
+        }
+    }
+    
+    return i + fs_byte_search_sequence_scalar(heap + i, length - i, sequence, count);
+}
+
+#endif /* FS_SEARCH_X86 */
+
+static void fs_byte_search_resolve_kernels(void)
+{
+    fs_byte_search_fn          search          = fs_byte_search_scalar;
+    fs_byte_search_sequence_fn search_sequence = fs_byte_search_sequence_scalar;
+
+#if FS_SEARCH_X86
+    __builtin_cpu_init();
+    
+    if (__builtin_cpu_supports("avx2"))
+    {
+        search          = fs_byte_search_avx2;
+        search_sequence = fs_byte_search_sequence_avx2;
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        search          = fs_byte_search_sse2;
+        search_sequence = fs_byte_search_sequence_sse2;
+    }
+#elif FS_SEARCH_NEON
+    /* the sequence search leans on this one */
+    search = fs_byte_search_neon;
+#endif
+    
+    __atomic_store_n(&fs_byte_search_kernel, search, __ATOMIC_RELAXED);
+    __atomic_store_n(&fs_byte_search_sequence_kernel, search_sequence, __ATOMIC_RELAXED);
+}
+
+static uint32_t fs_byte_search_resolve(const fs_byte_t *heap, uint32_t length, fs_byte_t value)
+{
+    fs_byte_search_resolve_kernels();
+    
+    return fs_byte_search_kernel(heap, length, value);
+}
+
+static uint32_t fs_byte_search_sequence_resolve(const fs_byte_t *heap, uint32_t length, const fs_byte_t *sequence, uint32_t count)
+{
+    fs_byte_search_resolve_kernels();
+    
+    return fs_byte_search_sequence_kernel(heap, length, sequence, count);
+}
+
+uint32_t fs_byte_search(const fs_byte_t *heap, uint32_t length, fs_byte_t value)
+{
+    return __atomic_load_n(&fs_byte_search_kernel, __ATOMIC_RELAXED)(heap, length, value);
+}
+
+uint32_t fs_byte_search_sequence(const fs_byte_t *heap, uint32_t length, const fs_byte_t *sequence, uint32_t count)
+{
+    return __atomic_load_n(&fs_byte_search_sequence_kernel, __ATOMIC_RELAXED)(heap, length, sequence, count);
+}
@@ -0,0 +1,291 @@
+//
+//  fs_byte_swap.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 17/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FS_SWAP_X86 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FS_SWAP_NEON 1
+#endif
+
+typedef void (*fs_byte_swap_fn)(void *dst, const void *src, uint32_t count);
+
+/* scalar kernels, also used for vector tails */
+
+static void fs_byte_swap16_scalar(void *dst, const void *src, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint16_t value;
+        
+        memcpy(&value, (const fs_byte_t *) src + i * sizeof(uint16_t), sizeof(uint16_t));
+        value = __builtin_bswap16(value);
+        memcpy((fs_byte_t *) dst + i * sizeof(uint16_t), &value, sizeof(uint16_t));
+    }
+}
+
+static void fs_byte_swap32_scalar(void *dst, const void *src, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t value;
+        
+        memcpy(&value, (const fs_byte_t *) src + i * sizeof(uint32_t), sizeof(uint32_t));
+        value = __builtin_bswap32(value);
+        memcpy((fs_byte_t *) dst + i * sizeof(uint32_t), &value, sizeof(uint32_t));
+    }
+}
+
+static void fs_byte_swap64_scalar(void *dst, const void *src, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t value;
+        
+        memcpy(&value, (const fs_byte_t *) src + i * sizeof(uint64_t), sizeof(uint64_t));
+        value = __builtin_bswap64(value);
+        memcpy((fs_byte_t *) dst + i * sizeof(uint64_t), &value, sizeof(uint64_t));
+    }
+}
+
+#if FS_SWAP_X86
+
+/* sse2 has no byte shuffle, so swap 16-bit
+ * lanes first and then the bytes inside them */
+__attribute__((target("sse2")))
+static inline __m128i fs_byte_swap16_sse2_lanes(__m128i v)
+{
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+__attribute__((target("sse2")))
+static void fs_byte_swap16_sse2(void *dst, const void *src, uint32_t count)
+{
+    uint32_t i = 0;
+    
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *) ((const fs_byte_t *) src + i * 2));
+        _mm_storeu_si128((__m128i *) ((fs_byte_t *) dst + i * 2), fs_byte_swap16_sse2_lanes(v));
+    }
+    
+    fs_byte_swap16_scalar((fs_byte_t *) dst + i * 2, (const fs_byte_t *) src + i * 2, count - i);
+}
+
+__attribute__((target("sse2")))
+static void fs_byte_swap32_sse2(void *dst, const void *src, uint32_t count)
+{
+    uint32_t i = 0;
+    
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *) ((const fs_byte_t *) src + i * 4));
+        
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+        
+        _mm_storeu_si128((__m128i *) ((fs_byte_t *) dst + i * 4), fs_byte_swap16_sse2_lanes(v));
+    }
+    
+    fs_byte_swap32_scalar((fs_byte_t *) dst + i * 4, (const fs_byte_t *) src + i * 4, count - i);
+}
+
+__attribute__((target("sse2")))
+static void fs_byte_swap64_sse2(void *dst, const void *src, uint32_t count)
+{
+    uint32_t i = 0;
+    
+    for (; i + 2 <= count; i += 2)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *) ((const fs_byte_t *) src + i * 8));
+        
+        v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+        
+        _mm_storeu_si128((__m128i *) ((fs_byte_t *) dst + i * 8), fs_byte_swap16_sse2_lanes(v));
+    }
+    
+    fs_byte_swap64_scalar((fs_byte_t *) dst + i * 8, (const fs_byte_t *) src + i * 8, count - i);
+}
+
+/* avx2 shuffles bytes within each 128-bit lane,
+ * so the masks repeat the same pattern twice */
+__attribute__((target("avx2")))
+static inline void fs_byte_swap_avx2(void *dst, const void *src, uint32_t length, __m256i mask)
+{
+    uint32_t i = 0;
+    
+    for (; i + 32 <= length; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *) ((const fs_byte_t *) src + i));
+        _mm256_storeu_si256((__m256i *) ((fs_byte_t *) dst + i), _mm256_shuffle_epi8(v, mask));
+    }
+}
+
+__attribute__((target("avx2")))
+static void fs_byte_swap16_avx2(void *dst, const void *src, uint32_t count)
+{
+    const __m256i mask = _mm256_setr_epi8(
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    
+    uint32_t n = count & ~15u;
+    
+    fs_byte_swap_avx2(dst, src, n * 2, mask);
+    fs_byte_swap16_scalar((fs_byte_t *) dst + n * 2, (const fs_byte_t *) src + n * 2, count - n);
+}
+
+__attribute__((target("avx2")))
+static void fs_byte_swap32_avx2(void *dst, const void *src, uint32_t count)
+{
+    const __m256i mask = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    
+    uint32_t n = count & ~7u;
+    
+    fs_byte_swap_avx2(dst, src, n * 4, mask);
+    fs_byte_swap32_scalar((fs_byte_t *) dst + n * 4, (const fs_byte_t *) src + n * 4, count - n);
+}
+
+__attribute__((target("avx2")))
+static void fs_byte_swap64_avx2(void *dst, const void *src, uint32_t count)
+{
+    const __m256i mask = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    
+    uint32_t n = count & ~3u;
+    
+    fs_byte_swap_avx2(dst, src, n * 8, mask);
+    fs_byte_swap64_scalar((fs_byte_t *) dst + n * 8, (const fs_byte_t *) src + n * 8, count - n);
+}
+
+#endif /* FS_SWAP_X86 */
+
+#if FS_SWAP_NEON
+
+static void fs_byte_swap16_neon(void *dst, const void *src, uint32_t count)
+{
+    uint32_t i = 0;
+    
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x16_t v = vld1q_u8((const uint8_t *) src + i * 2);
+        vst1q_u8((uint8_t *) dst + i * 2, vrev16q_u8(v));
+    }
+    
+    fs_byte_swap16_scalar((fs_byte_t *) dst + i * 2, (const fs_byte_t *) src + i * 2, count - i);
+}
+
+static void fs_byte_swap32_neon(void *dst, const void *src, uint32_t count)
+{
+    uint32_t i = 0;
+    
+    for (; i + 4 <= count; i += 4)
+    {
+        uint8x16_t v = vld1q_u8((const uint8_t *) src + i * 4);
+        vst1q_u8((uint8_t *) dst + i * 4, vrev32q_u8(v));
+    }
+    
+    fs_byte_swap32_scalar((fs_byte_t *) dst + i * 4, (const fs_byte_t *) src + i * 4, count - i);
+}
+
+static void fs_byte_swap64_neon(void *dst, const void *src, uint32_t count)
+{
+    uint32_t i = 0;
+    
+    for (; i + 2 <= count; i += 2)
+    {
+        uint8x16_t v = vld1q_u8((const uint8_t *) src + i * 8);
+        vst1q_u8((uint8_t *) dst + i * 8, vrev64q_u8(v));
+    }
+    
+    fs_byte_swap64_scalar((fs_byte_t *) dst + i * 8, (const fs_byte_t *) src + i * 8, count - i);
+}
+
+#endif /* FS_SWAP_NEON */
+
+/* kernels picked on first use, every thread
+ * resolves to the same ones so racing is fine */
+
+static void fs_byte_swap16_resolve(void *dst, const void *src, uint32_t count);
+static void fs_byte_swap32_resolve(void *dst, const void *src, uint32_t count);
+static void fs_byte_swap64_resolve(void *dst, const void *src, uint32_t count);
+
+static fs_byte_swap_fn fs_byte_swap16_kernel = fs_byte_swap16_resolve;
+static fs_byte_swap_fn fs_byte_swap32_kernel = fs_byte_swap32_resolve;
+static fs_byte_swap_fn fs_byte_swap64_kernel = fs_byte_swap64_resolve;
+
+static void fs_byte_swap_resolve(void)
+{
+    fs_byte_swap_fn swap16 = fs_byte_swap16_scalar;
+    fs_byte_swap_fn swap32 = fs_byte_swap32_scalar;
+    fs_byte_swap_fn swap64 = fs_byte_swap64_scalar;
+
+#if FS_SWAP_X86
+    __builtin_cpu_init();
+    
+    if (__builtin_cpu_supports("avx2"))
+    {
+        swap16 = fs_byte_swap16_avx2;
+        swap32 = fs_byte_swap32_avx2;
+        swap64 = fs_byte_swap64_avx2;
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        swap16 = fs_byte_swap16_sse2;
+        swap32 = fs_byte_swap32_sse2;
+        swap64 = fs_byte_swap64_sse2;
+    }
+#elif FS_SWAP_NEON
+    swap16 = fs_byte_swap16_neon;
+    swap32 = fs_byte_swap32_neon;
+    swap64 = fs_byte_swap64_neon;
+#endif
+    
+    __atomic_store_n(&fs_byte_swap16_kernel, swap16, __ATOMIC_RELAXED);
+    __atomic_store_n(&fs_byte_swap32_kernel, swap32, __ATOMIC_RELAXED);
+    __atomic_store_n(&fs_byte_swap64_kernel, swap64, __ATOMIC_RELAXED);
+}
+
+static void fs_byte_swap16_resolve(void *dst, const void *src, uint32_t count)
+{
+    fs_byte_swap_resolve();
+    fs_byte_swap16_kernel(dst, src, count);
+}
+
+static void fs_byte_swap32_resolve(void *dst, const void *src, uint32_t count)
+{
+    fs_byte_swap_resolve();
+    fs_byte_swap32_kernel(dst, src, count);
+}
+
+static void fs_byte_swap64_resolve(void *dst, const void *src, uint32_t count)
+{
+    fs_byte_swap_resolve();
+    fs_byte_swap64_kernel(dst, src, count);
+}
+
+void fs_byte_swap16(void *dst, const void *src, uint32_t count)
+{
+    __atomic_load_n(&fs_byte_swap16_kernel, __ATOMIC_RELAXED)(dst, src, count);
+}
+
+void fs_byte_swap32(void *dst, const void *src, uint32_t count)
+{
+    __atomic_load_n(&fs_byte_swap32_kernel, __ATOMIC_RELAXED)(dst, src, count);
+}
+
+void fs_byte_swap64(void *dst, const void *src, uint32_t count)
+{
+    __atomic_load_n(&fs_byte_swap64_kernel, __ATOMIC_RELAXED)(dst, src, count);
+}
@@ -0,0 +1,473 @@
+//
+//  fs_byte_utf8.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 26/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+//  The vector kernels follow Keiser & Lemire's lookup algorithm,
+//  the one simdjson uses. Every pair of adjacent bytes is checked
+//  through three 16 entry tables, indexed by the high and low
+//  nibble of the first byte and the high nibble of the second,
+//  whose entries are bitmasks of the errors that pair could be.
+//  Bits set in all three are real errors, except the ones a
+//  third or fourth continuation byte explains.
+//
+
+#include "fuse_private.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FS_UTF8_X86 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FS_UTF8_NEON 1
+#endif
+
+/* error bits, more than one may share a bit
+ * when no table entry could set both */
+#define UTF8_TOO_SHORT      (1 << 0) // lead byte not followed by a continuation
+#define UTF8_TOO_LONG       (1 << 1) // continuation after an ascii byte
+#define UTF8_OVERLONG_3     (1 << 2) // 11100000 100_____
+#define UTF8_TOO_LARGE      (1 << 3) // above U+10FFFF
+#define UTF8_SURROGATE      (1 << 4) // 11101101 101_____
+#define UTF8_OVERLONG_2     (1 << 5) // 1100000_ 10______
+#define UTF8_TOO_LARGE_1000 (1 << 6) // 11110101 1000____ and up
+#define UTF8_OVERLONG_4     (1 << 6) // 11110000 1000____
+#define UTF8_TWO_CONTS      (1 << 7) // continuation after a continuation, unless a 3rd or 4th byte
+
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+#define UTF8_BYTE_1_HIGH \
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, \
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, \
+    UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, \
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2, \
+    UTF8_TOO_SHORT, \
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE, \
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4
+
+#define UTF8_BYTE_1_LOW \
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4, \
+    UTF8_CARRY | UTF8_OVERLONG_2, \
+    UTF8_CARRY, \
+    UTF8_CARRY, \
+    UTF8_CARRY | UTF8_TOO_LARGE, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000, \
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000
+
+#define UTF8_BYTE_2_HIGH \
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, \
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, \
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4, \
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE, \
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE, \
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE, \
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT
+
+/* a block ending in these may be cut short, 0xff never is */
+#define UTF8_INCOMPLETE_TAIL 0xef, 0xdf, 0xbf
+
+typedef int (*fs_byte_utf8_validate_fn)(const fs_byte_t *heap, uint32_t length, int *ascii);
+
+/* one sequence at a time, after the well-formed byte
+ * sequences table of the Unicode standard (3.9, D92) */
+static int fs_byte_utf8_validate_scalar(const fs_byte_t *heap, uint32_t length, int *ascii)
+{
+    int only_ascii = FS_YES;
+    uint32_t i = 0;
+    
+    while (i < length)
+    {
+        /* ascii runs 8 bytes at a time */
+        if (length - i >= 8)
+        {
+            uint64_t word;
+            memcpy(&word, heap + i, sizeof(word));
+            
+            if ((word & 0x8080808080808080ull) == 0)
+            {
+                i += 8;
+                continue;
+            }
+        }
+        
+        fs_byte_t lead = heap[i];
+        
+        if (lead < 0x80)
+        {
+            i++;
+            continue;
+        }
+        
+        only_ascii = FS_NO;
+        
+        /* continuations, and the range the first one must be in */
+        uint32_t count;
+        fs_byte_t low  = 0x80;
+        fs_byte_t high = 0xbf;
+        
+        if (lead >= 0xc2 && lead <= 0xdf)
+        {
+            count = 1;
+        }
+        else if (lead >= 0xe0 && lead <= 0xef)
+        {
+            count = 2;
+            low   = lead == 0xe0 ? 0xa0 : 0x80;
+            high  = lead == 0xed ? 0x9f : 0xbf;
+        }
+        else if (lead >= 0xf0 && lead <= 0xf4)
+        {
+            count = 3;
+            low   = lead == 0xf0 ? 0x90 : 0x80;
+            high  = lead == 0xf4 ? 0x8f : 0xbf;
+        }
+        else
+        {
+            return FS_NO;
+        }
+        
+        if (length - i - 1 < count || heap[i + 1] < low || heap[i + 1] > high)
+        {
+            return FS_NO;
+        }
+        
+        for (uint32_t k = 2; k <= count; k++)
+        {
+            if ((heap[i + k] & 0xc0) != 0x80)
+            {
+                return FS_NO;
+            }
+        }
+        
+        i += count + 1;
+    }
+    
+    *ascii = only_ascii;
+    
+    return FS_YES;
+}
+
+#if FS_UTF8_X86
+
+__attribute__((target("ssse3")))
+static inline __m128i fs_byte_utf8_check_ssse3(__m128i input, __m128i prev)
+{
+    const __m128i byte_1_high = _mm_setr_epi8(UTF8_BYTE_1_HIGH);
+    const __m128i byte_1_low  = _mm_setr_epi8(UTF8_BYTE_1_LOW);
+    const __m128i byte_2_high = _mm_setr_epi8(UTF8_BYTE_2_HIGH);
+    const __m128i nibble      = _mm_set1_epi8(0x0f);
+    
+    /* the input as seen 1, 2 and 3 bytes back */
+    __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+    __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+    __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+    
+    __m128i special = _mm_and_si128(
+        _mm_and_si128(
+            _mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+            _mm_shuffle_epi8(byte_1_low,  _mm_and_si128(prev1, nibble))),
+        _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+    
+    /* third and fourth bytes of a sequence must be continuations,
+     * which is the only time two of them in a row are right */
+    __m128i is_third  = _mm_subs_epu8(prev2, _mm_set1_epi8((char) (0xe0 - 0x80)));
+    __m128i is_fourth = _mm_subs_epu8(prev3, _mm_set1_epi8((char) (0xf0 - 0x80)));
+    __m128i must_be_continuation = _mm_and_si128(_mm_or_si128(is_third, is_fourth), _mm_set1_epi8((char) 0x80));
+    
+    return _mm_xor_si128(must_be_continuation, special);
+}
+
+__attribute__((target("ssse3")))
+static int fs_byte_utf8_validate_ssse3(const fs_byte_t *heap, uint32_t length, int *ascii)
+{
+    const __m128i incomplete = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char) 0xef, (char) 0xdf, (char) 0xbf);
+    
+    __m128i prev            = _mm_setzero_si128();
+    __m128i prev_incomplete = _mm_setzero_si128();
+    __m128i error           = _mm_setzero_si128();
+    
+    int only_ascii = FS_YES;
+    
+    for (uint32_t i = 0; i < length; i += 16)
+    {
+        __m128i input;
+        
+        if (length - i >= 16)
+        {
+            input = _mm_loadu_si128((const __m128i *) (heap + i));
+        }
+        else
+        {
+            /* padded with ascii, which ends any sequence left open */
+            fs_byte_t tail[16] = { 0 };
+            memcpy(tail, heap + i, length - i);
+            input = _mm_loadu_si128((const __m128i *) tail);
+        }
+        
+        if (_mm_movemask_epi8(input) == 0)
+        {
+            error = _mm_or_si128(error, prev_incomplete);
+            
+            prev            = _mm_setzero_si128();
+            prev_incomplete = _mm_setzero_si128();
+            
+            continue;
+        }
+        
+        only_ascii = FS_NO;
+        
+        error = _mm_or_si128(error, fs_byte_utf8_check_ssse3(input, prev));
+        
+        prev            = input;
+        prev_incomplete = _mm_subs_epu8(input, incomplete);
+    }
+    
+    error = _mm_or_si128(error, prev_incomplete);
+    
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xffff)
+    {
+        return FS_NO;
+    }
+    
+    *ascii = only_ascii;
+    
+    return FS_YES;
+}
+
+__attribute__((target("avx2")))
+static inline __m256i fs_byte_utf8_check_avx2(__m256i input, __m256i prev)
+{
+    const __m256i byte_1_high = _mm256_setr_epi8(UTF8_BYTE_1_HIGH, UTF8_BYTE_1_HIGH);
+    const __m256i byte_1_low  = _mm256_setr_epi8(UTF8_BYTE_1_LOW,  UTF8_BYTE_1_LOW);
+    const __m256i byte_2_high = _mm256_setr_epi8(UTF8_BYTE_2_HIGH, UTF8_BYTE_2_HIGH);
+    const __m256i nibble      = _mm256_set1_epi8(0x0f);
+    
+    /* alignr works per lane, the low one needs the high lane of prev */
+    __m256i carry = _mm256_permute2x128_si256(prev, input, 0x21);
+    
+    __m256i prev1 = _mm256_alignr_epi8(input, carry, 15);
+    __m256i prev2 = _mm256_alignr_epi8(input, carry, 14);
+    __m256i prev3 = _mm256_alignr_epi8(input, carry, 13);
+    
+    __m256i special = _mm256_and_si256(
+        _mm256_and_si256(
+            _mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+            _mm256_shuffle_epi8(byte_1_low,  _mm256_and_si256(prev1, nibble))),
+        _mm256_shuffle_epi8(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+    
+    __m256i is_third  = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char) (0xe0 - 0x80)));
+    __m256i is_fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char) (0xf0 - 0x80)));
+    __m256i must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third, is_fourth), _mm256_set1_epi8((char) 0x80));
+    
+    return _mm256_xor_si256(must_be_continuation, special);
+}
+
+__attribute__((target("avx2")))
+static int fs_byte_utf8_validate_avx2(const fs_byte_t *heap, uint32_t length, int *ascii)
+{
+    const __m256i incomplete = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char) 0xef, (char) 0xdf, (char) 0xbf);
+    
+    __m256i prev            = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+    __m256i error           = _mm256_setzero_si256();
+    
+    int only_ascii = FS_YES;
+    
+    for (uint32_t i = 0; i < length; i += 32)
+    {
+        __m256i input;
+        
+        if (length - i >= 32)
+        {
+            input = _mm256_loadu_si256((const __m256i *) (heap + i));
+        }
+        else
+        {
+            fs_byte_t tail[32] = { 0 };
+            memcpy(tail, heap + i, length - i);
+            input = _mm256_loadu_si256((const __m256i *) tail);
+        }
+        
+        if (_mm256_movemask_epi8(input) == 0)
+        {
+            error = _mm256_or_si256(error, prev_incomplete);
+            
+            prev            = _mm256_setzero_si256();
+            prev_incomplete = _mm256_setzero_si256();
+            
+            continue;
+        }
+        
+        only_ascii = FS_NO;
+        
+        error = _mm256_or_si256(error, fs_byte_utf8_check_avx2(input, prev));
+        
+        prev            = input;
+        prev_incomplete = _mm256_subs_epu8(input, incomplete);
+    }
+    
+    error = _mm256_or_si256(error, prev_incomplete);
+    
+    if (!_mm256_testz_si256(error, error))
+    {
+        return FS_NO;
+    }
+    
+    *ascii = only_ascii;
+    
+    return FS_YES;
+}
+
+#endif /* FS_UTF8_X86 */
+
+#if FS_UTF8_NEON
+
+static inline uint8x16_t fs_byte_utf8_check_neon(uint8x16_t input, uint8x16_t prev)
+{
+    static const uint8_t tables[3][16] = {
+        { UTF8_BYTE_1_HIGH },
+        { UTF8_BYTE_1_LOW  },
+        { UTF8_BYTE_2_HIGH }
+    };
+    
+    uint8x16_t prev1 = vextq_u8(prev, input, 15);
+    uint8x16_t prev2 = vextq_u8(prev, input, 14);
+    uint8x16_t prev3 = vextq_u8(prev, input, 13);
+    
+    uint8x16_t special = vandq_u8(
+        vandq_u8(
+            vqtbl1q_u8(vld1q_u8(tables[0]), vshrq_n_u8(prev1, 4)),
+            vqtbl1q_u8(vld1q_u8(tables[1]), vandq_u8(prev1, vdupq_n_u8(0x0f)))),
+        vqtbl1q_u8(vld1q_u8(tables[2]), vshrq_n_u8(input, 4)));
+    
+    uint8x16_t is_third  = vqsubq_u8(prev2, vdupq_n_u8(0xe0 - 0x80));
+    uint8x16_t is_fourth = vqsubq_u8(prev3, vdupq_n_u8(0xf0 - 0x80));
+    uint8x16_t must_be_continuation = vandq_u8(vorrq_u8(is_third, is_fourth), vdupq_n_u8(0x80));
+    
+    return veorq_u8(must_be_continuation, special);
+}
+
+static int fs_byte_utf8_validate_neon(const fs_byte_t *heap, uint32_t length, int *ascii)
+{
+    static const uint8_t tail_max[16] = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, UTF8_INCOMPLETE_TAIL
+    };
+    
+    const uint8x16_t incomplete = vld1q_u8(tail_max);
+    
+    uint8x16_t prev            = vdupq_n_u8(0);
+    uint8x16_t prev_incomplete = vdupq_n_u8(0);
+    uint8x16_t error           = vdupq_n_u8(0);
+    
+    int only_ascii = FS_YES;
+    
+    for (uint32_t i = 0; i < length; i += 16)
+    {
+        uint8x16_t input;
+        
+        if (length - i >= 16)
+        {
+            input = vld1q_u8(heap + i);
+        }
+        else
+        {
+            fs_byte_t tail[16] = { 0 };
+            memcpy(tail, heap + i, length - i);
+            input = vld1q_u8(tail);
+        }
+        
+        if (vmaxvq_u8(input) < 0x80)
+        {
+            error = vorrq_u8(error, prev_incomplete);
+            
+            prev            = vdupq_n_u8(0);
+            prev_incomplete = vdupq_n_u8(0);
+            
+            continue;
+        }
+        
+        only_ascii = FS_NO;
+        
+        error = vorrq_u8(error, fs_byte_utf8_check_neon(input, prev));
+        
+        prev            = input;
+        prev_incomplete = vqsubq_u8(input, incomplete);
+    }
+    
+    error = vorrq_u8(error, prev_incomplete);
+    
+    if (vmaxvq_u8(error) != 0)
+    {
+        return FS_NO;
+    }
+    
+    *ascii = only_ascii;
+    
+    return FS_YES;
+}
+
+#endif /* FS_UTF8_NEON */
+
+/* kernel picked on first use, every thread
+ * resolves to the same one so racing is fine */
+static int fs_byte_utf8_validate_resolve(const fs_byte_t *heap, uint32_t length, int *ascii);
+
+static fs_byte_utf8_validate_fn fs_byte_utf8_validate_kernel = fs_byte_utf8_validate_resolve;
+
+static int fs_byte_utf8_validate_resolve(const fs_byte_t *heap, uint32_t length, int *ascii)
+{
+    fs_byte_utf8_validate_fn validate = fs_byte_utf8_validate_scalar;
+
+#if FS_UTF8_X86
+    __builtin_cpu_init();
+    
+    if (__builtin_cpu_supports("avx2"))
+    {
+        validate = fs_byte_utf8_validate_avx2;
+    }
+    else if (__builtin_cpu_supports("ssse3"))
+    {
+        validate = fs_byte_utf8_validate_ssse3;
+    }
+#elif FS_UTF8_NEON
+    validate = fs_byte_utf8_validate_neon;
+#endif
+    
+    __atomic_store_n(&fs_byte_utf8_validate_kernel, validate, __ATOMIC_RELAXED);
+    
+    return validate(heap, length, ascii);
+}
+
+int fs_byte_utf8_validate(const fs_byte_t *heap, uint32_t length, int *ascii)
+{
+    return __atomic_load_n(&fs_byte_utf8_validate_kernel, __ATOMIC_RELAXED)(heap, length, ascii);
+}
+
+uint32_t fs_byte_utf8_incomplete(const fs_byte_t *heap, uint32_t length)
+{
+    for (uint32_t back = 1; back <= 3 && back <= length; back++)
+    {
+        fs_byte_t byte = heap[length - back];
+        
+        /* the last byte that isn't a continuation starts the sequence */
+        if ((byte & 0xc0) != 0x80)
+        {
+            return fs_byte_utf8_sequence_length(byte) > back ? back : 0;
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,92 @@
+//
+//  fs_composite_buffer_checksum.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 25/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_composite_buffer_crc32c(fs_composite_buffer_t *buffer, uint32_t offset, uint32_t length, uint32_t seed, uint32_t *out)
+{
+    /* src must be readable */
+    int is_readable = fs_composite_buffer_is_readable_by_length_at_offset(buffer, length, offset);
+    
+    if (is_readable == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    uint32_t crc = seed;
+    
+    if (length > 0)
+    {
+        uint32_t index = fs_composite_buffer_locate(buffer, offset);
+        
+        /* crcs chain, one kernel call per component */
+        while (length > 0)
+        {
+            fs_composite_component_t *component = &buffer->components[index++];
+            
+            uint32_t at = offset - component->offset;
+            uint32_t n  = component->buffer.writer_index - at;
+            
+            if (n > length)
+            {
+                n = length;
+            }
+            
+            crc = fs_byte_crc32c(crc, component->buffer.heap + at, n);
+            
+            offset += n;
+            length -= n;
+        }
+    }
+    
+    *out = crc;
+    
+    return FS_OKAY;
+}
+
+int fs_composite_buffer_xxhash64(fs_composite_buffer_t *buffer, uint32_t offset, uint32_t length, uint64_t seed, uint64_t *out)
+{
+    fs_byte_xxhash64_t state;
+    
+    /* src must be readable */
+    int is_readable = fs_composite_buffer_is_readable_by_length_at_offset(buffer, length, offset);
+    
+    if (is_readable == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_byte_xxhash64_init(&state, seed);
+    
+    if (length > 0)
+    {
+        uint32_t index = fs_composite_buffer_locate(buffer, offset);
+        
+        while (length > 0)
+        {
+            fs_composite_component_t *component = &buffer->components[index++];
+            
+            uint32_t at = offset - component->offset;
+            uint32_t n  = component->buffer.writer_index - at;
+            
+            if (n > length)
+            {
+                n = length;
+            }
+            
+            fs_byte_xxhash64_update(&state, component->buffer.heap + at, n);
+            
+            offset += n;
+            length -= n;
+        }
+    }
+    
+    *out = fs_byte_xxhash64_digest(&state);
+    
+    return FS_OKAY;
+}
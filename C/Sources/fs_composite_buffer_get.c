@@ -0,0 +1,310 @@
+//
+//  fs_composite_buffer_get.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 16/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_composite_buffer_is_readable_by_length_at_offset(fs_composite_buffer_t *buffer, uint32_t length, uint32_t offset)
+{
+    /* offset past writer_index would wrap around */
+    return (offset <= buffer->writer_index && buffer->writer_index - offset >= length) ? FS_YES: FS_NO;
+}
+
+int fs_composite_buffer_get_bytes(fs_composite_buffer_t *buffer, uint32_t offset, uint32_t length, fs_byte_t *out)
+{
+    /* src must be readable */
+    int is_readable = fs_composite_buffer_is_readable_by_length_at_offset(buffer, length, offset);
+    
+    if (is_readable == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    if (length == 0)
+    {
+        return FS_OKAY;
+    }
+    
+    uint32_t index = fs_composite_buffer_locate(buffer, offset);
+    
+    /* gather from as many components as needed */
+    while (length > 0)
+    {
+        fs_composite_component_t *component = &buffer->components[index++];
+        
+        uint32_t at = offset - component->offset;
+        uint32_t n  = component->buffer.writer_index - at;
+        
+        if (n > length)
+        {
+            n = length;
+        }
+        
+        memcpy(out, component->buffer.heap + at, n);
+        
+        out    += n;
+        offset += n;
+        length -= n;
+    }
+    
+    return FS_OKAY;
+}
+
+int fs_composite_buffer_get_int8(fs_composite_buffer_t *buffer, uint32_t offset, int8_t *out)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int8_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_get_int8(view, at, out);
+    }
+    
+    /* value spans two components, gather it first */
+    fs_byte_t scratch[sizeof(int8_t)];
+    fs_byte_buffer_t gathered;
+    
+    fs_composite_buffer_get_bytes(buffer, offset, sizeof(int8_t), scratch);
+    fs_byte_buffer_wrap(&gathered, scratch, sizeof(int8_t), sizeof(int8_t));
+    
+    return fs_byte_buffer_get_int8(&gathered, 0, out);
+}
+
+int fs_composite_buffer_get_int16_be(fs_composite_buffer_t *buffer, uint32_t offset, int16_t *out)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int16_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_get_int16_be(view, at, out);
+    }
+    
+    /* value spans two components, gather it first */
+    fs_byte_t scratch[sizeof(int16_t)];
+    fs_byte_buffer_t gathered;
+    
+    fs_composite_buffer_get_bytes(buffer, offset, sizeof(int16_t), scratch);
+    fs_byte_buffer_wrap(&gathered, scratch, sizeof(int16_t), sizeof(int16_t));
+    
+    return fs_byte_buffer_get_int16_be(&gathered, 0, out);
+}
+
+int fs_composite_buffer_get_int16_le(fs_composite_buffer_t *buffer, uint32_t offset, int16_t *out)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int16_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_get_int16_le(view, at, out);
+    }
+    
+    /* value spans two components, gather it first */
+    fs_byte_t scratch[sizeof(int16_t)];
+    fs_byte_buffer_t gathered;
+    
+    fs_composite_buffer_get_bytes(buffer, offset, sizeof(int16_t), scratch);
+    fs_byte_buffer_wrap(&gathered, scratch, sizeof(int16_t), sizeof(int16_t));
+    
+    return fs_byte_buffer_get_int16_le(&gathered, 0, out);
+}
+
+int fs_composite_buffer_get_int32_be(fs_composite_buffer_t *buffer, uint32_t offset, int32_t *out)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int32_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_get_int32_be(view, at, out);
+    }
+    
+    /* value spans two components, gather it first */
+    fs_byte_t scratch[sizeof(int32_t)];
+    fs_byte_buffer_t gathered;
+    
+    fs_composite_buffer_get_bytes(buffer, offset, sizeof(int32_t), scratch);
+    fs_byte_buffer_wrap(&gathered, scratch, sizeof(int32_t), sizeof(int32_t));
+    
+    return fs_byte_buffer_get_int32_be(&gathered, 0, out);
+}
+
+int fs_composite_buffer_get_int32_le(fs_composite_buffer_t *buffer, uint32_t offset, int32_t *out)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int32_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_get_int32_le(view, at, out);
+    }
+    
+    /* value spans two components, gather it first */
+    fs_byte_t scratch[sizeof(int32_t)];
+    fs_byte_buffer_t gathered;
+    
+    fs_composite_buffer_get_bytes(buffer, offset, sizeof(int32_t), scratch);
+    fs_byte_buffer_wrap(&gathered, scratch, sizeof(int32_t), sizeof(int32_t));
+    
+    return fs_byte_buffer_get_int32_le(&gathered, 0, out);
+}
+
+int fs_composite_buffer_get_int64_be(fs_composite_buffer_t *buffer, uint32_t offset, int64_t *out)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int64_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_get_int64_be(view, at, out);
+    }
+    
+    /* value spans two components, gather it first */
+    fs_byte_t scratch[sizeof(int64_t)];
+    fs_byte_buffer_t gathered;
+    
+    fs_composite_buffer_get_bytes(buffer, offset, sizeof(int64_t), scratch);
+    fs_byte_buffer_wrap(&gathered, scratch, sizeof(int64_t), sizeof(int64_t));
+    
+    return fs_byte_buffer_get_int64_be(&gathered, 0, out);
+}
+
+int fs_composite_buffer_get_int64_le(fs_composite_buffer_t *buffer, uint32_t offset, int64_t *out)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int64_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_get_int64_le(view, at, out);
+    }
+    
+    /* value spans two components, gather it first */
+    fs_byte_t scratch[sizeof(int64_t)];
+    fs_byte_buffer_t gathered;
+    
+    fs_composite_buffer_get_bytes(buffer, offset, sizeof(int64_t), scratch);
+    fs_byte_buffer_wrap(&gathered, scratch, sizeof(int64_t), sizeof(int64_t));
+    
+    return fs_byte_buffer_get_int64_le(&gathered, 0, out);
+}
+
+int fs_composite_buffer_get_varint32(fs_composite_buffer_t *buffer, uint32_t offset, uint32_t *out, uint32_t *length)
+{
+    fs_byte_t scratch[FS_VARINT32_MAX_LENGTH];
+    fs_byte_buffer_t *view;
+    fs_byte_buffer_t wrapped;
+    uint32_t at;
+    
+    if (fs_composite_buffer_find(buffer, offset, 1, &view, &at) != FS_OKAY)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    /* fast path, varint ends in this component */
+    int result = fs_byte_buffer_get_varint32(view, at, out, length);
+    
+    if (result != FS_ERR_OOB)
+    {
+        return result;
+    }
+    
+    uint32_t n = buffer->writer_index - offset;
+    
+    if (n > sizeof(scratch))
+    {
+        n = sizeof(scratch);
+    }
+    
+    fs_composite_buffer_get_bytes(buffer, offset, n, scratch);
+    fs_byte_buffer_wrap(&wrapped, scratch, n, n);
+    
+    return fs_byte_buffer_get_varint32(&wrapped, 0, out, length);
+}
+
+int fs_composite_buffer_get_varint64(fs_composite_buffer_t *buffer, uint32_t offset, uint64_t *out, uint32_t *length)
+{
+    fs_byte_t scratch[FS_VARINT64_MAX_LENGTH];
+    fs_byte_buffer_t *view;
+    fs_byte_buffer_t wrapped;
+    uint32_t at;
+    
+    if (fs_composite_buffer_find(buffer, offset, 1, &view, &at) != FS_OKAY)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    /* fast path, varint ends in this component */
+    int result = fs_byte_buffer_get_varint64(view, at, out, length);
+    
+    if (result != FS_ERR_OOB)
+    {
+        return result;
+    }
+    
+    uint32_t n = buffer->writer_index - offset;
+    
+    if (n > sizeof(scratch))
+    {
+        n = sizeof(scratch);
+    }
+    
+    fs_composite_buffer_get_bytes(buffer, offset, n, scratch);
+    fs_byte_buffer_wrap(&wrapped, scratch, n, n);
+    
+    return fs_byte_buffer_get_varint64(&wrapped, 0, out, length);
+}
@@ -0,0 +1,205 @@
+//
+//  fs_composite_buffer_index_of.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 24/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+/* compares sequence against the bytes at offset, which
+ * may run over any number of components after index */
+static int fs_composite_buffer_matches(fs_composite_buffer_t *buffer, uint32_t index, uint32_t offset, const fs_byte_t *sequence, uint32_t length)
+{
+    while (length > 0)
+    {
+        fs_composite_component_t *component = &buffer->components[index++];
+        
+        uint32_t at = offset - component->offset;
+        uint32_t n  = component->buffer.writer_index - at;
+        
+        if (n > length)
+        {
+            n = length;
+        }
+        
+        if (memcmp(component->buffer.heap + at, sequence, n) != 0)
+        {
+            return FS_NO;
+        }
+        
+        sequence += n;
+        offset   += n;
+        length   -= n;
+    }
+    
+    return FS_YES;
+}
+
+int fs_composite_buffer_index_of(fs_composite_buffer_t *buffer, uint32_t from, uint32_t to, fs_byte_t value, uint32_t *out)
+{
+    /* range must be readable */
+    if (from > to || fs_composite_buffer_is_readable_by_length_at_offset(buffer, to - from, from) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    *out = FS_INDEX_NOT_FOUND;
+    
+    if (from == to)
+    {
+        return FS_OKAY;
+    }
+    
+    uint32_t index = fs_composite_buffer_locate(buffer, from);
+    uint32_t offset = from;
+    
+    /* one kernel call per component */
+    while (offset < to)
+    {
+        fs_composite_component_t *component = &buffer->components[index++];
+        
+        uint32_t at = offset - component->offset;
+        uint32_t n  = component->buffer.writer_index - at;
+        
+        if (n > to - offset)
+        {
+            n = to - offset;
+        }
+        
+        uint32_t found = fs_byte_search(component->buffer.heap + at, n, value);
+        
+        if (found != n)
+        {
+            *out = offset + found;
+            return FS_OKAY;
+        }
+        
+        offset += n;
+    }
+    
+    return FS_OKAY;
+}
+
+int fs_composite_buffer_index_of_sequence(fs_composite_buffer_t *buffer, uint32_t from, uint32_t to, const fs_byte_t *sequence, uint32_t length, uint32_t *out)
+{
+    /* range must be readable */
+    if (from > to || fs_composite_buffer_is_readable_by_length_at_offset(buffer, to - from, from) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    /* empty sequences match right away */
+    if (length == 0)
+    {
+        *out = from;
+        return FS_OKAY;
+    }
+    
+    *out = FS_INDEX_NOT_FOUND;
+    
+    if (to - from < length)
+    {
+        return FS_OKAY;
+    }
+    
+    /* last offset a match may start at */
+    uint32_t last = to - length;
+    
+    uint32_t index = fs_composite_buffer_locate(buffer, from);
+    uint32_t offset = from;
+    
+    while (offset <= last)
+    {
+        fs_composite_component_t *component = &buffer->components[index++];
+        
+        uint32_t at  = offset - component->offset;
+        uint32_t end = component->buffer.writer_index;
+        
+        if (end - at > to - offset)
+        {
+            end = at + (to - offset);
+        }
+        
+        /* matches held by this component alone */
+        uint32_t found = fs_byte_search_sequence(component->buffer.heap + at, end - at, sequence, length);
+        
+        if (found != end - at)
+        {
+            *out = offset + found;
+            return FS_OKAY;
+        }
+        
+        /* then the ones starting in its last bytes and running
+         * into the next components, still in offset order */
+        uint32_t tail = (end - at >= length) ? end - length + 1: at;
+        
+        while (tail < end && component->offset + tail <= last)
+        {
+            uint32_t hit = tail + fs_byte_search(component->buffer.heap + tail, end - tail, sequence[0]);
+            
+            if (hit == end || component->offset + hit > last)
+            {
+                break;
+            }
+            
+            if (fs_composite_buffer_matches(buffer, index - 1, component->offset + hit, sequence, length) == FS_YES)
+            {
+                *out = component->offset + hit;
+                return FS_OKAY;
+            }
+            
+            tail = hit + 1;
+        }
+        
+        offset = component->offset + end;
+    }
+    
+    return FS_OKAY;
+}
+
+int fs_composite_buffer_for_each_byte(fs_composite_buffer_t *buffer, uint32_t from, uint32_t to, fs_byte_visitor_t visitor, void *context, uint32_t *out)
+{
+    /* range must be readable */
+    if (from > to || fs_composite_buffer_is_readable_by_length_at_offset(buffer, to - from, from) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    *out = FS_INDEX_NOT_FOUND;
+    
+    if (from == to)
+    {
+        return FS_OKAY;
+    }
+    
+    uint32_t index = fs_composite_buffer_locate(buffer, from);
+    uint32_t offset = from;
+    
+    while (offset < to)
+    {
+        fs_composite_component_t *component = &buffer->components[index++];
+        
+        uint32_t at = offset - component->offset;
+        uint32_t n  = component->buffer.writer_index - at;
+        
+        if (n > to - offset)
+        {
+            n = to - offset;
+        }
+        
+        for (uint32_t i = 0; i < n; i++)
+        {
+            if (visitor(context, component->buffer.heap[at + i]) == FS_NO)
+            {
+                *out = offset + i;
+                return FS_OKAY;
+            }
+        }
+        
+        offset += n;
+    }
+    
+    return FS_OKAY;
+}
@@ -0,0 +1,345 @@
+//
+//  fs_composite_buffer_init.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 16/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_composite_buffer_init(fs_composite_buffer_t *buffer, uint32_t components)
+{
+    buffer->components = NULL;
+    
+    if (components > 0)
+    {
+        buffer->components = OPT_CAST(fs_composite_component_t) malloc(components * sizeof(fs_composite_component_t));
+        
+        if (buffer->components == NULL)
+        {
+            return FS_ERR_OOM;
+        }
+    }
+    
+    buffer->count = 0;
+    buffer->slots = components;
+    
+    /* Set marks to zero */
+    buffer->reader_mark = 0;
+    buffer->writer_mark = 0;
+    
+    /* Set indices to zero */
+    buffer->reader_index = 0;
+    buffer->writer_index = 0;
+    
+    return FS_OKAY;
+}
+
+int fs_composite_buffer_free(fs_composite_buffer_t *buffer)
+{
+    /* drop every component reference */
+    for (uint32_t i = 0; i < buffer->count; i++)
+    {
+        fs_byte_buffer_free(&buffer->components[i].buffer);
+    }
+    
+    free(buffer->components);
+    
+    /* Reset members to make debugging easier */
+    buffer->components = NULL;
+    
+    buffer->count = 0;
+    buffer->slots = 0;
+    
+    buffer->reader_mark = 0;
+    buffer->writer_mark = 0;
+    
+    buffer->reader_index = 0;
+    buffer->writer_index = 0;
+    
+    return FS_OKAY;
+}
+
+/* takes ownership of slice */
+static int fs_composite_buffer_append(fs_composite_buffer_t *buffer, fs_byte_buffer_t *slice)
+{
+    if (buffer->count == buffer->slots)
+    {
+        uint32_t slots = buffer->slots > 0 ? buffer->slots << 1 : 4;
+        
+        fs_composite_component_t *components = OPT_CAST(fs_composite_component_t) realloc(buffer->components, slots * sizeof(fs_composite_component_t));
+        
+        if (components == NULL)
+        {
+            return FS_ERR_OOM;
+        }
+        
+        buffer->components = components;
+        buffer->slots = slots;
+    }
+    
+    buffer->components[buffer->count].buffer = *slice;
+    buffer->components[buffer->count].offset = buffer->writer_index;
+    
+    buffer->count += 1;
+    buffer->writer_index += slice->writer_index;
+    
+    return FS_OKAY;
+}
+
+int fs_composite_buffer_add_component(fs_composite_buffer_t *buffer, fs_byte_buffer_t *component)
+{
+    fs_byte_buffer_t slice;
+    
+    uint32_t length = component->writer_index - component->reader_index;
+    
+    /* nothing to read, nothing to add */
+    if (length == 0)
+    {
+        return FS_OKAY;
+    }
+    
+    /* share the readable bytes, no copy */
+    int result = fs_byte_buffer_get_slice(component, component->reader_index, length, &slice);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    result = fs_composite_buffer_append(buffer, &slice);
+    
+    if (result != FS_OKAY)
+    {
+        fs_byte_buffer_free(&slice);
+    }
+    
+    return result;
+}
+
+/* appends slices of src covering [offset, offset + length) */
+static int fs_composite_buffer_add_range(fs_composite_buffer_t *buffer, fs_composite_buffer_t *src, uint32_t offset, uint32_t length)
+{
+    if (length == 0)
+    {
+        return FS_OKAY;
+    }
+    
+    if (fs_composite_buffer_is_readable_by_length_at_offset(src, length, offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    uint32_t index = fs_composite_buffer_locate(src, offset);
+    
+    while (length > 0)
+    {
+        fs_byte_buffer_t slice;
+        fs_composite_component_t *component = &src->components[index++];
+        
+        uint32_t at = offset - component->offset;
+        uint32_t n  = component->buffer.writer_index - at;
+        
+        if (n > length)
+        {
+            n = length;
+        }
+        
+        int result = fs_byte_buffer_get_slice(&component->buffer, at, n, &slice);
+        
+        if (result == FS_OKAY)
+        {
+            result = fs_composite_buffer_append(buffer, &slice);
+            
+            if (result != FS_OKAY)
+            {
+                fs_byte_buffer_free(&slice);
+            }
+        }
+        
+        if (result != FS_OKAY)
+        {
+            return result;
+        }
+        
+        offset += n;
+        length -= n;
+    }
+    
+    return FS_OKAY;
+}
+
+int fs_composite_buffer_add_composite(fs_composite_buffer_t *buffer, fs_composite_buffer_t *components)
+{
+    return fs_composite_buffer_add_range(buffer, components, components->reader_index, components->writer_index - components->reader_index);
+}
+
+int fs_composite_buffer_get_slice(fs_composite_buffer_t *buffer, uint32_t offset, uint32_t length, fs_composite_buffer_t *out)
+{
+    int result = fs_composite_buffer_init(out, 0);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    result = fs_composite_buffer_add_range(out, buffer, offset, length);
+    
+    if (result != FS_OKAY)
+    {
+        fs_composite_buffer_free(out);
+    }
+    
+    return result;
+}
+
+int fs_composite_buffer_read_slice(fs_composite_buffer_t *buffer, uint32_t length, fs_composite_buffer_t *out)
+{
+    int result = fs_composite_buffer_get_slice(buffer, buffer->reader_index, length, out);
+    
+    if (result == FS_OKAY)
+    {
+        /* increase reader pos by length */
+        buffer->reader_index += length;
+    }
+    
+    return result;
+}
+
+int fs_composite_buffer_discard_read_components(fs_composite_buffer_t *buffer)
+{
+    uint32_t n = 0;
+    
+    /* release components that have been fully read */
+    while (n < buffer->count && buffer->components[n].offset + buffer->components[n].buffer.writer_index <= buffer->reader_index)
+    {
+        fs_byte_buffer_free(&buffer->components[n++].buffer);
+    }
+    
+    if (n == 0)
+    {
+        return FS_OKAY;
+    }
+    
+    uint32_t removed = n < buffer->count ? buffer->components[n].offset : buffer->writer_index;
+    
+    buffer->count -= n;
+    
+    memmove(buffer->components, buffer->components + n, buffer->count * sizeof(fs_composite_component_t));
+    
+    for (uint32_t i = 0; i < buffer->count; i++)
+    {
+        buffer->components[i].offset -= removed;
+    }
+    
+    buffer->reader_index -= removed;
+    buffer->writer_index -= removed;
+    
+    buffer->reader_mark = buffer->reader_mark > removed ? buffer->reader_mark - removed : 0;
+    buffer->writer_mark = buffer->writer_mark > removed ? buffer->writer_mark - removed : 0;
+    
+    return FS_OKAY;
+}
+
+int fs_composite_buffer_consolidate(fs_composite_buffer_t *buffer, fs_byte_buffer_pool_t *pool)
+{
+    fs_byte_buffer_t merged;
+    
+    /* already contiguous */
+    if (buffer->count == 1)
+    {
+        return FS_OKAY;
+    }
+    
+    uint32_t length = buffer->writer_index;
+    
+    int result = fs_byte_buffer_init_pooled(&merged, pool, length > 0 ? length : BUFFER_CAPACITY_MINIMUM);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    result = fs_composite_buffer_get_bytes(buffer, 0, length, merged.heap);
+    
+    if (result != FS_OKAY)
+    {
+        fs_byte_buffer_free(&merged);
+        return result;
+    }
+    
+    merged.writer_index = length;
+    
+    if (buffer->slots == 0)
+    {
+        buffer->components = OPT_CAST(fs_composite_component_t) malloc(sizeof(fs_composite_component_t));
+        
+        if (buffer->components == NULL)
+        {
+            fs_byte_buffer_free(&merged);
+            return FS_ERR_OOM;
+        }
+        
+        buffer->slots = 1;
+    }
+    
+    for (uint32_t i = 0; i < buffer->count; i++)
+    {
+        fs_byte_buffer_free(&buffer->components[i].buffer);
+    }
+    
+    buffer->components[0].buffer = merged;
+    buffer->components[0].offset = 0;
+    
+    buffer->count = 1;
+    
+    return FS_OKAY;
+}
+
+uint32_t fs_composite_buffer_locate(fs_composite_buffer_t *buffer, uint32_t offset)
+{
+    uint32_t lo = 0;
+    uint32_t hi = buffer->count - 1;
+    
+    /* last component starting at or before offset */
+    while (lo < hi)
+    {
+        uint32_t mid = (lo + hi + 1) >> 1;
+        
+        if (buffer->components[mid].offset <= offset)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid - 1;
+        }
+    }
+    
+    return lo;
+}
+
+int fs_composite_buffer_find(fs_composite_buffer_t *buffer, uint32_t offset, uint32_t length, fs_byte_buffer_t **view, uint32_t *at)
+{
+    if (length == 0 || fs_composite_buffer_is_readable_by_length_at_offset(buffer, length, offset) == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    fs_composite_component_t *component = &buffer->components[fs_composite_buffer_locate(buffer, offset)];
+    
+    *at = offset - component->offset;
+    
+    /* fast path, no value crosses a boundary */
+    if (*at + length <= component->buffer.writer_index)
+    {
+        *view = &component->buffer;
+    }
+    else
+    {
+        *view = NULL;
+    }
+    
+    return FS_OKAY;
+}
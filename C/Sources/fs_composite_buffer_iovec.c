@@ -0,0 +1,37 @@
+//
+//  fs_composite_buffer_iovec.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 16/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_composite_buffer_iovec(fs_composite_buffer_t *buffer, struct iovec *out, uint32_t max, uint32_t *count)
+{
+    *count = 0;
+    
+    /* nothing to gather */
+    if (buffer->reader_index >= buffer->writer_index)
+    {
+        return FS_OKAY;
+    }
+    
+    uint32_t index = fs_composite_buffer_locate(buffer, buffer->reader_index);
+    uint32_t at    = buffer->reader_index - buffer->components[index].offset;
+    
+    /* first entry may start mid-component */
+    while (index < buffer->count && *count < max)
+    {
+        fs_byte_buffer_t *component = &buffer->components[index++].buffer;
+        
+        out[*count].iov_base = component->heap + at;
+        out[*count].iov_len  = component->writer_index - at;
+        
+        *count += 1;
+        at = 0;
+    }
+    
+    return FS_OKAY;
+}
@@ -0,0 +1,133 @@
+//
+//  fs_composite_buffer_read.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 16/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_composite_buffer_read_int8(fs_composite_buffer_t *buffer, int8_t *out)
+{
+    int result = fs_composite_buffer_get_int8(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int8_t);
+    }
+    
+    return result;
+}
+
+int fs_composite_buffer_read_int16_be(fs_composite_buffer_t *buffer, int16_t *out)
+{
+    int result = fs_composite_buffer_get_int16_be(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int16_t);
+    }
+    
+    return result;
+}
+
+int fs_composite_buffer_read_int16_le(fs_composite_buffer_t *buffer, int16_t *out)
+{
+    int result = fs_composite_buffer_get_int16_le(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int16_t);
+    }
+    
+    return result;
+}
+
+int fs_composite_buffer_read_int32_be(fs_composite_buffer_t *buffer, int32_t *out)
+{
+    int result = fs_composite_buffer_get_int32_be(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int32_t);
+    }
+    
+    return result;
+}
+
+int fs_composite_buffer_read_int32_le(fs_composite_buffer_t *buffer, int32_t *out)
+{
+    int result = fs_composite_buffer_get_int32_le(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int32_t);
+    }
+    
+    return result;
+}
+
+int fs_composite_buffer_read_int64_be(fs_composite_buffer_t *buffer, int64_t *out)
+{
+    int result = fs_composite_buffer_get_int64_be(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int64_t);
+    }
+    
+    return result;
+}
+
+int fs_composite_buffer_read_int64_le(fs_composite_buffer_t *buffer, int64_t *out)
+{
+    int result = fs_composite_buffer_get_int64_le(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int64_t);
+    }
+    
+    return result;
+}
+
+int fs_composite_buffer_read_bytes(fs_composite_buffer_t *buffer, uint32_t length, fs_byte_t *out)
+{
+    int result = fs_composite_buffer_get_bytes(buffer, buffer->reader_index, length, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += length;
+    }
+    
+    return result;
+}
+
+int fs_composite_buffer_read_varint32(fs_composite_buffer_t *buffer, uint32_t *out)
+{
+    uint32_t length;
+    
+    int result = fs_composite_buffer_get_varint32(buffer, buffer->reader_index, out, &length);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += length;
+    }
+    
+    return result;
+}
+
+int fs_composite_buffer_read_varint64(fs_composite_buffer_t *buffer, uint64_t *out)
+{
+    uint32_t length;
+    
+    int result = fs_composite_buffer_get_varint64(buffer, buffer->reader_index, out, &length);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += length;
+    }
+    
+    return result;
+}
@@ -0,0 +1,238 @@
+//
+//  fs_composite_buffer_set.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 16/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_composite_buffer_set_bytes(fs_composite_buffer_t *buffer, uint32_t length, uint32_t offset, const fs_byte_t *in)
+{
+    /* only bytes already there can be overwritten */
+    int is_writable = fs_composite_buffer_is_readable_by_length_at_offset(buffer, length, offset);
+    
+    if (is_writable == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    if (length == 0)
+    {
+        return FS_OKAY;
+    }
+    
+    uint32_t index = fs_composite_buffer_locate(buffer, offset);
+    
+    /* scatter across as many components as needed */
+    while (length > 0)
+    {
+        fs_composite_component_t *component = &buffer->components[index++];
+        
+        uint32_t at = offset - component->offset;
+        uint32_t n  = component->buffer.writer_index - at;
+        
+        if (n > length)
+        {
+            n = length;
+        }
+        
+        memcpy(component->buffer.heap + at, in, n);
+        
+        in     += n;
+        offset += n;
+        length -= n;
+    }
+    
+    return FS_OKAY;
+}
+
+int fs_composite_buffer_set_int8(fs_composite_buffer_t *buffer, uint32_t offset, int8_t value)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int8_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_set_int8(view, at, value);
+    }
+    
+    /* value spans two components, encode then scatter */
+    fs_byte_t scratch[sizeof(int8_t)];
+    fs_byte_buffer_t encoded;
+    
+    fs_byte_buffer_wrap(&encoded, scratch, sizeof(int8_t), 0);
+    fs_byte_buffer_set_int8(&encoded, 0, value);
+    
+    return fs_composite_buffer_set_bytes(buffer, sizeof(int8_t), offset, scratch);
+}
+
+int fs_composite_buffer_set_int16_be(fs_composite_buffer_t *buffer, uint32_t offset, int16_t value)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int16_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_set_int16_be(view, at, value);
+    }
+    
+    /* value spans two components, encode then scatter */
+    fs_byte_t scratch[sizeof(int16_t)];
+    fs_byte_buffer_t encoded;
+    
+    fs_byte_buffer_wrap(&encoded, scratch, sizeof(int16_t), 0);
+    fs_byte_buffer_set_int16_be(&encoded, 0, value);
+    
+    return fs_composite_buffer_set_bytes(buffer, sizeof(int16_t), offset, scratch);
+}
+
+int fs_composite_buffer_set_int16_le(fs_composite_buffer_t *buffer, uint32_t offset, int16_t value)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int16_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_set_int16_le(view, at, value);
+    }
+    
+    /* value spans two components, encode then scatter */
+    fs_byte_t scratch[sizeof(int16_t)];
+    fs_byte_buffer_t encoded;
+    
+    fs_byte_buffer_wrap(&encoded, scratch, sizeof(int16_t), 0);
+    fs_byte_buffer_set_int16_le(&encoded, 0, value);
+    
+    return fs_composite_buffer_set_bytes(buffer, sizeof(int16_t), offset, scratch);
+}
+
+int fs_composite_buffer_set_int32_be(fs_composite_buffer_t *buffer, uint32_t offset, int32_t value)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int32_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_set_int32_be(view, at, value);
+    }
+    
+    /* value spans two components, encode then scatter */
+    fs_byte_t scratch[sizeof(int32_t)];
+    fs_byte_buffer_t encoded;
+    
+    fs_byte_buffer_wrap(&encoded, scratch, sizeof(int32_t), 0);
+    fs_byte_buffer_set_int32_be(&encoded, 0, value);
+    
+    return fs_composite_buffer_set_bytes(buffer, sizeof(int32_t), offset, scratch);
+}
+
+int fs_composite_buffer_set_int32_le(fs_composite_buffer_t *buffer, uint32_t offset, int32_t value)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int32_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_set_int32_le(view, at, value);
+    }
+    
+    /* value spans two components, encode then scatter */
+    fs_byte_t scratch[sizeof(int32_t)];
+    fs_byte_buffer_t encoded;
+    
+    fs_byte_buffer_wrap(&encoded, scratch, sizeof(int32_t), 0);
+    fs_byte_buffer_set_int32_le(&encoded, 0, value);
+    
+    return fs_composite_buffer_set_bytes(buffer, sizeof(int32_t), offset, scratch);
+}
+
+int fs_composite_buffer_set_int64_be(fs_composite_buffer_t *buffer, uint32_t offset, int64_t value)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int64_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_set_int64_be(view, at, value);
+    }
+    
+    /* value spans two components, encode then scatter */
+    fs_byte_t scratch[sizeof(int64_t)];
+    fs_byte_buffer_t encoded;
+    
+    fs_byte_buffer_wrap(&encoded, scratch, sizeof(int64_t), 0);
+    fs_byte_buffer_set_int64_be(&encoded, 0, value);
+    
+    return fs_composite_buffer_set_bytes(buffer, sizeof(int64_t), offset, scratch);
+}
+
+int fs_composite_buffer_set_int64_le(fs_composite_buffer_t *buffer, uint32_t offset, int64_t value)
+{
+    fs_byte_buffer_t *view;
+    uint32_t at;
+    
+    int result = fs_composite_buffer_find(buffer, offset, sizeof(int64_t), &view, &at);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    if (view != NULL)
+    {
+        return fs_byte_buffer_set_int64_le(view, at, value);
+    }
+    
+    /* value spans two components, encode then scatter */
+    fs_byte_t scratch[sizeof(int64_t)];
+    fs_byte_buffer_t encoded;
+    
+    fs_byte_buffer_wrap(&encoded, scratch, sizeof(int64_t), 0);
+    fs_byte_buffer_set_int64_le(&encoded, 0, value);
+    
+    return fs_composite_buffer_set_bytes(buffer, sizeof(int64_t), offset, scratch);
+}
@@ -0,0 +1,109 @@
+//
+//  fs_composite_buffer_utf8.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 26/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include "fuse_private.h"
+
+int fs_composite_buffer_validate_utf8(fs_composite_buffer_t *buffer, uint32_t offset, uint32_t length, int *ascii)
+{
+    int is_ascii;
+    int only_ascii = FS_YES;
+    
+    /* a sequence cut at the end of a component */
+    fs_byte_t carry[4];
+    uint32_t  carried = 0;
+    uint32_t  needed  = 0;
+    
+    /* src must be readable */
+    int is_readable = fs_composite_buffer_is_readable_by_length_at_offset(buffer, length, offset);
+    
+    if (is_readable == FS_NO)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    if (length > 0)
+    {
+        uint32_t index = fs_composite_buffer_locate(buffer, offset);
+        
+        while (length > 0)
+        {
+            fs_composite_component_t *component = &buffer->components[index++];
+            
+            uint32_t at = offset - component->offset;
+            uint32_t n  = component->buffer.writer_index - at;
+            
+            if (n > length)
+            {
+                n = length;
+            }
+            
+            const fs_byte_t *heap = component->buffer.heap + at;
+            
+            offset += n;
+            length -= n;
+            
+            /* finish it off with the first bytes of this one,
+             * or the ones after it if it's too short for that */
+            while (carried > 0 && carried < needed && n > 0)
+            {
+                carry[carried++] = *heap++;
+                n--;
+            }
+            
+            if (carried > 0)
+            {
+                if (carried < needed)
+                {
+                    continue;
+                }
+                
+                if (fs_byte_utf8_validate(carry, carried, &is_ascii) == FS_NO)
+                {
+                    return FS_ERR_DATA;
+                }
+                
+                only_ascii = FS_NO;
+                carried = 0;
+            }
+            
+            /* whole sequences through the kernel, the cut one carried */
+            uint32_t tail = fs_byte_utf8_incomplete(heap, n);
+            
+            if (fs_byte_utf8_validate(heap, n - tail, &is_ascii) == FS_NO)
+            {
+                return FS_ERR_DATA;
+            }
+            
+            if (is_ascii == FS_NO)
+            {
+                only_ascii = FS_NO;
+            }
+            
+            if (tail > 0)
+            {
+                memcpy(carry, heap + n - tail, tail);
+                
+                carried = tail;
+                needed  = fs_byte_utf8_sequence_length(carry[0]);
+            }
+        }
+    }
+    
+    /* the range ends mid-sequence */
+    if (carried > 0)
+    {
+        return FS_ERR_DATA;
+    }
+    
+    if (ascii != NULL)
+    {
+        *ascii = only_ascii;
+    }
+    
+    return FS_OKAY;
+}
@@ -7,7 +7,10 @@ static const struct {
     { FS_OKAY,    "Successful" },
     { FS_ERR_OOB, "Out of boundaries"},
     { FS_ERR_OOM, "Out of heap" },
-    { FS_ERR_OOR, "Value out of range" }
+    { FS_ERR_OOR, "Value out of range" },
+    { FS_ERR_IO,  "I/O error" },
+    { FS_ERR_DATA, "Malformed data" },
+    { FS_ERR_EOF,  "End of stream" }
 };
 
 const char *fs_error_to_string(int code)
@@ -0,0 +1,205 @@
+//
+//  fs_event_loop.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 26/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include <errno.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+#include "fuse_private.h"
+
+/* epoll_event slots read per wait */
+#define EVENT_LOOP_BATCH 64
+
+#ifdef __linux__
+
+int fs_event_loop_init(fs_event_loop_t *loop)
+{
+    loop->fd = epoll_create1(EPOLL_CLOEXEC);
+    
+    if (loop->fd == -1)
+    {
+        return FS_ERR_IO;
+    }
+    
+    loop->wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    
+    if (loop->wakeup == -1)
+    {
+        close(loop->fd);
+        return FS_ERR_IO;
+    }
+    
+    /* level triggered, it's drained on every wait */
+    struct epoll_event event = { .events = EPOLLIN, .data.ptr = loop };
+    
+    if (epoll_ctl(loop->fd, EPOLL_CTL_ADD, loop->wakeup, &event) == -1)
+    {
+        close(loop->wakeup);
+        close(loop->fd);
+        return FS_ERR_IO;
+    }
+    
+    return FS_OKAY;
+}
+
+int fs_event_loop_free(fs_event_loop_t *loop)
+{
+    close(loop->wakeup);
+    close(loop->fd);
+    
+    return FS_OKAY;
+}
+
+int fs_event_loop_add(fs_event_loop_t *loop, int fd, void *context)
+{
+    struct epoll_event event = {
+        .events   = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET,
+        .data.ptr = context
+    };
+    
+    return epoll_ctl(loop->fd, EPOLL_CTL_ADD, fd, &event) == 0 ? FS_OKAY : FS_ERR_IO;
+}
+
+int fs_event_loop_remove(fs_event_loop_t *loop, int fd)
+{
+    /* pre 2.6.9 kernels want an event, even if unused */
+    struct epoll_event event = { 0 };
+    
+    return epoll_ctl(loop->fd, EPOLL_CTL_DEL, fd, &event) == 0 ? FS_OKAY : FS_ERR_IO;
+}
+
+int fs_event_loop_wait(fs_event_loop_t *loop, fs_event_t *events, uint32_t max, int timeout, uint32_t *count)
+{
+    struct epoll_event ready[EVENT_LOOP_BATCH];
+    
+    *count = 0;
+    
+    int n = epoll_wait(loop->fd, ready, max < EVENT_LOOP_BATCH ? (int) max : EVENT_LOOP_BATCH, timeout);
+    
+    if (n == -1)
+    {
+        return errno == EINTR ? FS_OKAY : FS_ERR_IO;
+    }
+    
+    for (int i = 0; i < n; i++)
+    {
+        if (ready[i].data.ptr == loop)
+        {
+            uint64_t value;
+            
+            /* wakeups only cut the wait short */
+            while (read(loop->wakeup, &value, sizeof(value)) == -1 && errno == EINTR);
+            
+            continue;
+        }
+        
+        uint32_t flags = 0;
+        
+        if (ready[i].events & EPOLLIN)
+        {
+            flags |= FS_EVENT_READ;
+        }
+        
+        if (ready[i].events & EPOLLOUT)
+        {
+            flags |= FS_EVENT_WRITE;
+        }
+        
+        if (ready[i].events & (EPOLLRDHUP | EPOLLHUP))
+        {
+            flags |= FS_EVENT_HANGUP;
+        }
+        
+        if (ready[i].events & EPOLLERR)
+        {
+            flags |= FS_EVENT_ERROR;
+        }
+        
+        events[*count].context = ready[i].data.ptr;
+        events[*count].events  = flags;
+        
+        *count += 1;
+    }
+    
+    return FS_OKAY;
+}
+
+int fs_event_loop_wakeup(fs_event_loop_t *loop)
+{
+    uint64_t value = 1;
+    
+    for (;;)
+    {
+        if (write(loop->wakeup, &value, sizeof(value)) == sizeof(value))
+        {
+            return FS_OKAY;
+        }
+        
+        /* a full counter still wakes the loop */
+        if (errno == EAGAIN)
+        {
+            return FS_OKAY;
+        }
+        
+        if (errno != EINTR)
+        {
+            return FS_ERR_IO;
+        }
+    }
+}
+
+#else
+
+/* no epoll, sockets still work on their own */
+
+int fs_event_loop_init(fs_event_loop_t *loop)
+{
+    loop->fd     = -1;
+    loop->wakeup = -1;
+    
+    errno = ENOSYS;
+    
+    return FS_ERR_IO;
+}
+
+int fs_event_loop_free(fs_event_loop_t *loop)
+{
+    return FS_OKAY;
+}
+
+int fs_event_loop_add(fs_event_loop_t *loop, int fd, void *context)
+{
+    errno = ENOSYS;
+    return FS_ERR_IO;
+}
+
+int fs_event_loop_remove(fs_event_loop_t *loop, int fd)
+{
+    errno = ENOSYS;
+    return FS_ERR_IO;
+}
+
+int fs_event_loop_wait(fs_event_loop_t *loop, fs_event_t *events, uint32_t max, int timeout, uint32_t *count)
+{
+    *count = 0;
+    errno  = ENOSYS;
+    
+    return FS_ERR_IO;
+}
+
+int fs_event_loop_wakeup(fs_event_loop_t *loop)
+{
+    errno = ENOSYS;
+    return FS_ERR_IO;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,387 @@
+//
+//  fs_socket.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 26/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#ifdef __linux__
+/* accept4 */
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "fuse_private.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static int fs_socket_set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
+    {
+        return FS_ERR_IO;
+    }
+    
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    
+    return FS_OKAY;
+}
+
+static int fs_socket_open(int family)
+{
+    int fd = socket(family, SOCK_STREAM, 0);
+    
+    if (fd == -1)
+    {
+        return -1;
+    }
+    
+    if (fs_socket_set_nonblocking(fd) != FS_OKAY)
+    {
+        close(fd);
+        return -1;
+    }
+
+#ifdef SO_NOSIGPIPE
+    /* no MSG_NOSIGNAL, a closed peer would raise SIGPIPE */
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof(yes));
+#endif
+    
+    return fd;
+}
+
+static int fs_socket_resolve(const char *host, uint16_t port, int flags, struct addrinfo **out)
+{
+    char service[8];
+    struct addrinfo hints;
+    
+    memset(&hints, 0, sizeof(hints));
+    
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = flags;
+    
+    snprintf(service, sizeof(service), "%u", port);
+    
+    if (getaddrinfo(host, service, &hints, out) != 0)
+    {
+        errno = EHOSTUNREACH;
+        return FS_ERR_IO;
+    }
+    
+    return FS_OKAY;
+}
+
+int fs_socket_set_options(int fd, const fs_socket_options_t *options)
+{
+    int nodelay   = options->nodelay   ? 1 : 0;
+    int keepalive = options->keepalive ? 1 : 0;
+    
+    if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) == -1)
+    {
+        return FS_ERR_IO;
+    }
+    
+    if (setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &keepalive, sizeof(keepalive)) == -1)
+    {
+        return FS_ERR_IO;
+    }
+    
+    if (options->sndbuf > INT_MAX || options->rcvbuf > INT_MAX)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    int sndbuf = (int) options->sndbuf;
+    int rcvbuf = (int) options->rcvbuf;
+    
+    if (sndbuf > 0 && setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)) == -1)
+    {
+        return FS_ERR_IO;
+    }
+    
+    if (rcvbuf > 0 && setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) == -1)
+    {
+        return FS_ERR_IO;
+    }
+    
+    return FS_OKAY;
+}
+
+int fs_socket_connect(const char *host, uint16_t port, const fs_socket_options_t *options, int *fd)
+{
+    struct addrinfo *addresses;
+    
+    int result = fs_socket_resolve(host, port, 0, &addresses);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    result = FS_ERR_IO;
+    
+    /* first address that takes the connection, it
+     * completes once the socket turns writable */
+    for (struct addrinfo *address = addresses; address != NULL; address = address->ai_next)
+    {
+        int sock = fs_socket_open(address->ai_family);
+        
+        if (sock == -1)
+        {
+            continue;
+        }
+        
+        if (fs_socket_set_options(sock, options) == FS_OKAY &&
+           (connect(sock, address->ai_addr, address->ai_addrlen) == 0 || errno == EINPROGRESS))
+        {
+            *fd = sock;
+            result = FS_OKAY;
+            break;
+        }
+        
+        int error = errno;
+        close(sock);
+        errno = error;
+    }
+    
+    freeaddrinfo(addresses);
+    
+    return result;
+}
+
+int fs_socket_finish_connect(int fd)
+{
+    int error = 0;
+    socklen_t length = sizeof(error);
+    
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == -1)
+    {
+        return FS_ERR_IO;
+    }
+    
+    if (error != 0)
+    {
+        errno = error;
+        return FS_ERR_IO;
+    }
+    
+    return FS_OKAY;
+}
+
+int fs_socket_listen(const char *host, uint16_t port, int backlog, int *fd, uint16_t *bound)
+{
+    struct addrinfo *addresses;
+    
+    int result = fs_socket_resolve(host, port, AI_PASSIVE, &addresses);
+    
+    if (result != FS_OKAY)
+    {
+        return result;
+    }
+    
+    int sock = fs_socket_open(addresses->ai_family);
+    int yes  = 1;
+    
+    if (sock == -1)
+    {
+        freeaddrinfo(addresses);
+        return FS_ERR_IO;
+    }
+    
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    
+    if (bind(sock, addresses->ai_addr, addresses->ai_addrlen) == -1 || listen(sock, backlog) == -1)
+    {
+        int error = errno;
+        
+        close(sock);
+        freeaddrinfo(addresses);
+        
+        errno = error;
+        return FS_ERR_IO;
+    }
+    
+    freeaddrinfo(addresses);
+    
+    /* port 0 binds to any free one */
+    struct sockaddr_storage address;
+    socklen_t length = sizeof(address);
+    
+    getsockname(sock, (struct sockaddr *) &address, &length);
+    
+    if (address.ss_family == AF_INET6)
+    {
+        *bound = ntohs(((struct sockaddr_in6 *) &address)->sin6_port);
+    }
+    else
+    {
+        *bound = ntohs(((struct sockaddr_in *) &address)->sin_port);
+    }
+    
+    *fd = sock;
+    
+    return FS_OKAY;
+}
+
+int fs_socket_accept(int fd, const fs_socket_options_t *options, int *out)
+{
+    *out = -1;
+    
+    for (;;)
+    {
+#ifdef __linux__
+        int sock = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+        int sock = accept(fd, NULL, NULL);
+        
+        if (sock != -1 && fs_socket_set_nonblocking(sock) != FS_OKAY)
+        {
+            close(sock);
+            return FS_ERR_IO;
+        }
+#endif
+        
+        if (sock == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            
+            /* nobody waiting */
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return FS_OKAY;
+            }
+            
+            return FS_ERR_IO;
+        }
+        
+        int result = fs_socket_set_options(sock, options);
+        
+        if (result != FS_OKAY)
+        {
+            close(sock);
+            return result;
+        }
+        
+        *out = sock;
+        
+        return FS_OKAY;
+    }
+}
+
+int fs_socket_close(int fd)
+{
+    return close(fd) == 0 ? FS_OKAY : FS_ERR_IO;
+}
+
+int fs_socket_read(int fd, fs_byte_buffer_t *buffer, uint32_t max, uint32_t *read)
+{
+    uint32_t writable = buffer->capacity - buffer->writer_index;
+    uint32_t length   = max < writable ? max : writable;
+    
+    *read = 0;
+    
+    if (length == 0)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    for (;;)
+    {
+        ssize_t count = recv(fd, buffer->heap + buffer->writer_index, length, 0);
+        
+        if (count > 0)
+        {
+            buffer->writer_index += (uint32_t) count;
+            *read = (uint32_t) count;
+            
+            return FS_OKAY;
+        }
+        
+        if (count == 0)
+        {
+            return FS_ERR_EOF;
+        }
+        
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        
+        return errno == EAGAIN || errno == EWOULDBLOCK ? FS_OKAY : FS_ERR_IO;
+    }
+}
+
+int fs_socket_writev(int fd, fs_composite_buffer_t *buffer, uint32_t max, uint32_t *written)
+{
+    struct iovec iovecs[FS_SOCKET_MAX_IOVECS];
+    uint32_t count;
+    
+    *written = 0;
+    
+    fs_composite_buffer_iovec(buffer, iovecs, FS_SOCKET_MAX_IOVECS, &count);
+    
+    /* bytes past max stay behind, the last entry is cut short */
+    uint32_t total = 0;
+    uint32_t used  = 0;
+    
+    while (used < count && total < max)
+    {
+        if (iovecs[used].iov_len > max - total)
+        {
+            iovecs[used].iov_len = max - total;
+        }
+        
+        total += (uint32_t) iovecs[used++].iov_len;
+    }
+    
+    if (used == 0)
+    {
+        return FS_OKAY;
+    }
+    
+    struct msghdr message;
+    
+    memset(&message, 0, sizeof(message));
+    
+    message.msg_iov    = iovecs;
+    message.msg_iovlen = used;
+    
+    for (;;)
+    {
+        /* sendmsg is writev taking flags, a closed peer
+         * must fail the write instead of raising SIGPIPE */
+        ssize_t sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+        
+        if (sent >= 0)
+        {
+            buffer->reader_index += (uint32_t) sent;
+            *written = (uint32_t) sent;
+            
+            return FS_OKAY;
+        }
+        
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        
+        return errno == EAGAIN || errno == EWOULDBLOCK ? FS_OKAY : FS_ERR_IO;
+    }
+}
@@ -0,0 +1,54 @@
+//
+//  fs_thread.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 26/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#ifdef __linux__
+/* pthread_setaffinity_np */
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "fuse_private.h"
+
+int fs_thread_cpu_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    return count > 0 ? (int) count : 1;
+}
+
+int fs_thread_pin(int cpu)
+{
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    cpu_set_t set;
+    
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    
+    if (result != 0)
+    {
+        errno = result;
+        return FS_ERR_IO;
+    }
+    
+    return FS_OKAY;
+#else
+    /* no hard affinity to ask for */
+    errno = ENOSYS;
+    return FS_ERR_IO;
+#endif
+}
@@ -0,0 +1,688 @@
+//
+//  fs_uring.c
+//  Fuse
+//
+//  Created by Jairo Tylera on 26/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include "fuse_private.h"
+
+#ifdef __linux__
+
+/* every request carries its context with the op in the low
+ * bits, contexts must be aligned to at least 8 bytes */
+#define URING_OP_MASK 0x7ull
+
+/* the provided buffer group every receive takes from */
+#define URING_BUFFER_GROUP 0
+
+static int fs_uring_enter(int fd, uint32_t submit, uint32_t wait, uint32_t flags)
+{
+    return (int) syscall(__NR_io_uring_enter, fd, submit, wait, flags, NULL, 0);
+}
+
+static void fs_uring_unmap(fs_uring_t *ring)
+{
+    if (ring->sqes != NULL)
+    {
+        munmap(ring->sqes, ring->sqes_map_length);
+    }
+    
+    if (ring->cq_map != NULL && ring->cq_map != ring->sq_map)
+    {
+        munmap(ring->cq_map, ring->cq_map_length);
+    }
+    
+    if (ring->sq_map != NULL)
+    {
+        munmap(ring->sq_map, ring->sq_map_length);
+    }
+}
+
+static int fs_uring_map(fs_uring_t *ring, struct io_uring_params *params)
+{
+    ring->sq_map_length = params->sq_off.array + params->sq_entries * sizeof(uint32_t);
+    ring->cq_map_length = params->cq_off.cqes  + params->cq_entries * sizeof(struct io_uring_cqe);
+    
+    /* both rings in one mapping since 5.4 */
+    if (params->features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (ring->cq_map_length > ring->sq_map_length)
+        {
+            ring->sq_map_length = ring->cq_map_length;
+        }
+        
+        ring->cq_map_length = ring->sq_map_length;
+    }
+    
+    ring->sq_map = mmap(NULL, ring->sq_map_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    
+    if (ring->sq_map == MAP_FAILED)
+    {
+        ring->sq_map = NULL;
+        return FS_ERR_IO;
+    }
+    
+    if (params->features & IORING_FEAT_SINGLE_MMAP)
+    {
+        ring->cq_map = ring->sq_map;
+    }
+    else
+    {
+        ring->cq_map = mmap(NULL, ring->cq_map_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+        
+        if (ring->cq_map == MAP_FAILED)
+        {
+            ring->cq_map = NULL;
+            return FS_ERR_IO;
+        }
+    }
+    
+    ring->sqes_map_length = params->sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_map_length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    
+    if (ring->sqes == MAP_FAILED)
+    {
+        ring->sqes = NULL;
+        return FS_ERR_IO;
+    }
+    
+    char *sq = ring->sq_map;
+    char *cq = ring->cq_map;
+    
+    ring->sq_head    = (uint32_t *) (sq + params->sq_off.head);
+    ring->sq_tail    = (uint32_t *) (sq + params->sq_off.tail);
+    ring->sq_array   = (uint32_t *) (sq + params->sq_off.array);
+    ring->sq_mask    = *(uint32_t *) (sq + params->sq_off.ring_mask);
+    ring->sq_entries = params->sq_entries;
+    
+    ring->cq_head = (uint32_t *) (cq + params->cq_off.head);
+    ring->cq_tail = (uint32_t *) (cq + params->cq_off.tail);
+    ring->cq_mask = *(uint32_t *) (cq + params->cq_off.ring_mask);
+    ring->cqes    = cq + params->cq_off.cqes;
+    
+    return FS_OKAY;
+}
+
+/* hands slot `buffer` back to the kernel, seen once published */
+static void fs_uring_provide(fs_uring_t *ring, uint16_t buffer)
+{
+    struct io_uring_buf_ring *buf_ring = ring->buf_ring;
+    struct io_uring_buf *entry = &buf_ring->bufs[ring->buf_tail & (ring->buffer_count - 1)];
+    
+    entry->addr = (uint64_t) (uintptr_t) ring->buffers[buffer].heap;
+    entry->len  = ring->buffer_length;
+    entry->bid  = buffer;
+    
+    ring->buf_tail += 1;
+}
+
+static void fs_uring_publish(fs_uring_t *ring)
+{
+    struct io_uring_buf_ring *buf_ring = ring->buf_ring;
+    
+    __atomic_store_n(&buf_ring->tail, ring->buf_tail, __ATOMIC_RELEASE);
+}
+
+static int fs_uring_init_buffers(fs_uring_t *ring)
+{
+    ring->buf_ring_length = ring->buffer_count * sizeof(struct io_uring_buf);
+    ring->buf_ring = mmap(NULL, ring->buf_ring_length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    
+    if (ring->buf_ring == MAP_FAILED)
+    {
+        ring->buf_ring = NULL;
+        return FS_ERR_OOM;
+    }
+    
+    ring->buffers = calloc(ring->buffer_count, sizeof(fs_byte_buffer_t));
+    
+    if (ring->buffers == NULL)
+    {
+        return FS_ERR_OOM;
+    }
+    
+    for (uint32_t i = 0; i < ring->buffer_count; i++)
+    {
+        int result = fs_byte_buffer_init_pooled(&ring->buffers[i], ring->pool, ring->buffer_length);
+        
+        if (result != FS_OKAY)
+        {
+            return result;
+        }
+        
+        fs_uring_provide(ring, (uint16_t) i);
+    }
+    
+    fs_uring_publish(ring);
+    
+    struct io_uring_buf_reg reg;
+    
+    memset(&reg, 0, sizeof(reg));
+    
+    reg.ring_addr    = (uint64_t) (uintptr_t) ring->buf_ring;
+    reg.ring_entries = ring->buffer_count;
+    reg.bgid         = URING_BUFFER_GROUP;
+    
+    /* provided buffer rings came in 5.19 */
+    if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PBUF_RING, &reg, 1) == -1)
+    {
+        return FS_ERR_IO;
+    }
+    
+    return FS_OKAY;
+}
+
+/* multishot receive came in 6.0 with no feature flag of its
+ * own, one byte through a socket pair tells if it's there */
+static int fs_uring_probe_recv(fs_uring_t *ring)
+{
+    int pair[2];
+    
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) == -1)
+    {
+        return FS_ERR_IO;
+    }
+    
+    fs_uring_event_t events[4];
+    uint32_t count = 0;
+    char byte = 0;
+    
+    int result = fs_uring_recv(ring, pair[0], NULL);
+    
+    if (result == FS_OKAY && write(pair[1], &byte, 1) != 1)
+    {
+        result = FS_ERR_IO;
+    }
+    
+    if (result == FS_OKAY)
+    {
+        result = fs_uring_submit(ring, 1);
+    }
+    
+    if (result == FS_OKAY)
+    {
+        result = fs_uring_reap(ring, events, 1, &count);
+    }
+    
+    if (result == FS_OKAY && (count == 0 || events[0].result != 1 || !(events[0].flags & FS_URING_MORE)))
+    {
+        errno  = ENOSYS;
+        result = FS_ERR_IO;
+    }
+    
+    if (count > 0 && (events[0].flags & FS_URING_BUFFER))
+    {
+        fs_uring_provide(ring, events[0].buffer);
+        fs_uring_publish(ring);
+    }
+    
+    /* the cancel and the receive it ends */
+    if (result == FS_OKAY)
+    {
+        result = fs_uring_cancel(ring, pair[0]);
+    }
+    
+    if (result == FS_OKAY)
+    {
+        result = fs_uring_submit(ring, 2);
+    }
+    
+    if (result == FS_OKAY)
+    {
+        result = fs_uring_reap(ring, events, 4, &count);
+    }
+    
+    int error = errno;
+    
+    close(pair[0]);
+    close(pair[1]);
+    
+    errno = error;
+    
+    return result;
+}
+
+int fs_uring_init(fs_uring_t *ring, uint32_t entries, fs_byte_buffer_pool_t *pool, uint32_t buffers, uint32_t buffer_length)
+{
+    memset(ring, 0, sizeof(*ring));
+    
+    ring->fd = -1;
+    
+    if (buffers == 0 || buffers > 32768 || (buffers & (buffers - 1)) != 0 || buffer_length == 0)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    ring->pool          = pool;
+    ring->buffer_count  = buffers;
+    ring->buffer_length = buffer_length;
+    
+    struct io_uring_params params;
+    
+    memset(&params, 0, sizeof(params));
+    
+    ring->fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+    
+    if (ring->fd == -1)
+    {
+        return FS_ERR_IO;
+    }
+    
+    int result = fs_uring_map(ring, &params);
+    
+    if (result == FS_OKAY)
+    {
+        result = fs_uring_init_buffers(ring);
+    }
+    
+    if (result == FS_OKAY)
+    {
+        result = fs_uring_probe_recv(ring);
+    }
+    
+    if (result != FS_OKAY)
+    {
+        int error = errno;
+        fs_uring_free(ring);
+        errno = error;
+    }
+    
+    return result;
+}
+
+int fs_uring_free(fs_uring_t *ring)
+{
+    /* closing the ring drops whatever was still in flight,
+     * buffers are only freed once the kernel is done */
+    if (ring->fd != -1)
+    {
+        close(ring->fd);
+    }
+    
+    fs_uring_unmap(ring);
+    
+    if (ring->buffers != NULL)
+    {
+        for (uint32_t i = 0; i < ring->buffer_count; i++)
+        {
+            if (ring->buffers[i].heap != NULL)
+            {
+                fs_byte_buffer_free(&ring->buffers[i]);
+            }
+        }
+        
+        free(ring->buffers);
+    }
+    
+    if (ring->buf_ring != NULL)
+    {
+        munmap(ring->buf_ring, ring->buf_ring_length);
+    }
+    
+    memset(ring, 0, sizeof(*ring));
+    
+    ring->fd = -1;
+    
+    return FS_OKAY;
+}
+
+/* next free entry, submitting what's queued when there's none */
+static struct io_uring_sqe *fs_uring_sqe(fs_uring_t *ring, void *context, uint32_t op)
+{
+    if (((uintptr_t) context & URING_OP_MASK) != 0)
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+    
+    uint32_t tail = *ring->sq_tail;
+    
+    if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >= ring->sq_entries)
+    {
+        if (fs_uring_submit(ring, 0) != FS_OKAY)
+        {
+            return NULL;
+        }
+        
+        if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >= ring->sq_entries)
+        {
+            errno = EBUSY;
+            return NULL;
+        }
+    }
+    
+    struct io_uring_sqe *sqe = (struct io_uring_sqe *) ring->sqes + (tail & ring->sq_mask);
+    
+    memset(sqe, 0, sizeof(*sqe));
+    
+    sqe->user_data = (uint64_t) (uintptr_t) context | op;
+    
+    return sqe;
+}
+
+/* makes the entry just filled in visible to the next submit */
+static int fs_uring_queue(fs_uring_t *ring)
+{
+    uint32_t tail = *ring->sq_tail;
+    
+    ring->sq_array[tail & ring->sq_mask] = tail & ring->sq_mask;
+    
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    
+    ring->pending += 1;
+    
+    return FS_OKAY;
+}
+
+int fs_uring_accept(fs_uring_t *ring, int fd, void *context)
+{
+    struct io_uring_sqe *sqe = fs_uring_sqe(ring, context, FS_URING_OP_ACCEPT);
+    
+    if (sqe == NULL)
+    {
+        return FS_ERR_IO;
+    }
+    
+    sqe->opcode       = IORING_OP_ACCEPT;
+    sqe->fd           = fd;
+    sqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    
+    return fs_uring_queue(ring);
+}
+
+int fs_uring_recv(fs_uring_t *ring, int fd, void *context)
+{
+    struct io_uring_sqe *sqe = fs_uring_sqe(ring, context, FS_URING_OP_RECV);
+    
+    if (sqe == NULL)
+    {
+        return FS_ERR_IO;
+    }
+    
+    sqe->opcode    = IORING_OP_RECV;
+    sqe->fd        = fd;
+    sqe->ioprio    = IORING_RECV_MULTISHOT;
+    sqe->flags     = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    
+    return fs_uring_queue(ring);
+}
+
+int fs_uring_poll(fs_uring_t *ring, int fd, uint32_t events, void *context)
+{
+    struct io_uring_sqe *sqe = fs_uring_sqe(ring, context, FS_URING_OP_POLL);
+    
+    if (sqe == NULL)
+    {
+        return FS_ERR_IO;
+    }
+    
+    uint32_t mask = 0;
+    
+    if (events & FS_EVENT_READ)
+    {
+        mask |= POLLIN;
+    }
+    
+    if (events & FS_EVENT_WRITE)
+    {
+        mask |= POLLOUT;
+    }
+    
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->fd            = fd;
+    sqe->poll32_events = mask;
+    
+    return fs_uring_queue(ring);
+}
+
+int fs_uring_cancel(fs_uring_t *ring, int fd)
+{
+    struct io_uring_sqe *sqe = fs_uring_sqe(ring, NULL, FS_URING_OP_CANCEL);
+    
+    if (sqe == NULL)
+    {
+        return FS_ERR_IO;
+    }
+    
+    /* everything on the descriptor, multishot requests
+     * keep it open otherwise, closing isn't enough */
+    sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+    sqe->fd           = fd;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    
+    return fs_uring_queue(ring);
+}
+
+int fs_uring_sendmsg(fs_uring_t *ring, int fd, fs_uring_send_t *send, fs_composite_buffer_t *buffer, uint32_t max, void *context)
+{
+    uint32_t count;
+    
+    fs_composite_buffer_iovec(buffer, send->iovecs, FS_SOCKET_MAX_IOVECS, &count);
+    
+    /* bytes past max stay behind, the last entry is cut short */
+    uint32_t total = 0;
+    uint32_t used  = 0;
+    
+    while (used < count && total < max)
+    {
+        if (send->iovecs[used].iov_len > max - total)
+        {
+            send->iovecs[used].iov_len = max - total;
+        }
+        
+        total += (uint32_t) send->iovecs[used++].iov_len;
+    }
+    
+    if (used == 0)
+    {
+        return FS_ERR_OOB;
+    }
+    
+    struct io_uring_sqe *sqe = fs_uring_sqe(ring, context, FS_URING_OP_SEND);
+    
+    if (sqe == NULL)
+    {
+        return FS_ERR_IO;
+    }
+    
+    memset(&send->message, 0, sizeof(send->message));
+    
+    send->message.msg_iov    = send->iovecs;
+    send->message.msg_iovlen = used;
+    
+    sqe->opcode    = IORING_OP_SENDMSG;
+    sqe->fd        = fd;
+    sqe->addr      = (uint64_t) (uintptr_t) &send->message;
+    sqe->len       = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    
+    return fs_uring_queue(ring);
+}
+
+int fs_uring_submit(fs_uring_t *ring, uint32_t wait)
+{
+    if (ring->pending == 0 && wait == 0)
+    {
+        return FS_OKAY;
+    }
+    
+    for (;;)
+    {
+        int submitted = fs_uring_enter(ring->fd, ring->pending, wait, wait > 0 ? IORING_ENTER_GETEVENTS : 0);
+        
+        if (submitted >= 0)
+        {
+            ring->pending -= (uint32_t) submitted < ring->pending ? (uint32_t) submitted : ring->pending;
+            return FS_OKAY;
+        }
+        
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        
+        /* completions pile up, reaping them makes room */
+        if (errno == EBUSY || errno == EAGAIN)
+        {
+            return FS_OKAY;
+        }
+        
+        return FS_ERR_IO;
+    }
+}
+
+int fs_uring_reap(fs_uring_t *ring, fs_uring_event_t *events, uint32_t max, uint32_t *count)
+{
+    uint32_t head = *ring->cq_head;
+    uint32_t tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    
+    *count = 0;
+    
+    while (head != tail && *count < max)
+    {
+        struct io_uring_cqe *cqe = (struct io_uring_cqe *) ring->cqes + (head & ring->cq_mask);
+        fs_uring_event_t *event  = &events[*count];
+        
+        event->context = (void *) (uintptr_t) (cqe->user_data & ~URING_OP_MASK);
+        event->op      = (uint32_t) (cqe->user_data & URING_OP_MASK);
+        event->result  = cqe->res;
+        event->flags   = 0;
+        event->buffer  = 0;
+        
+        if (cqe->flags & IORING_CQE_F_MORE)
+        {
+            event->flags |= FS_URING_MORE;
+        }
+        
+        if (cqe->flags & IORING_CQE_F_BUFFER)
+        {
+            event->flags |= FS_URING_BUFFER;
+            event->buffer = (uint16_t) (cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        }
+        
+        head   += 1;
+        *count += 1;
+    }
+    
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+    
+    return FS_OKAY;
+}
+
+int fs_uring_take_buffer(fs_uring_t *ring, uint16_t buffer, uint32_t length, fs_byte_buffer_t *out)
+{
+    if (buffer >= ring->buffer_count || length > ring->buffer_length)
+    {
+        return FS_ERR_OOR;
+    }
+    
+    fs_byte_buffer_t fresh;
+    
+    int result = fs_byte_buffer_init_pooled(&fresh, ring->pool, ring->buffer_length);
+    
+    if (result != FS_OKAY)
+    {
+        /* the bytes are lost, the slot isn't */
+        fs_uring_provide(ring, buffer);
+        fs_uring_publish(ring);
+        return result;
+    }
+    
+    *out = ring->buffers[buffer];
+    
+    out->reader_index = 0;
+    out->writer_index = length;
+    
+    ring->buffers[buffer] = fresh;
+    
+    fs_uring_provide(ring, buffer);
+    fs_uring_publish(ring);
+    
+    return FS_OKAY;
+}
+
+#else
+
+/* no io_uring, sockets go through fs_event_loop_t instead */
+
+int fs_uring_init(fs_uring_t *ring, uint32_t entries, fs_byte_buffer_pool_t *pool, uint32_t buffers, uint32_t buffer_length)
+{
+    memset(ring, 0, sizeof(*ring));
+    
+    ring->fd = -1;
+    errno    = ENOSYS;
+    
+    return FS_ERR_IO;
+}
+
+int fs_uring_free(fs_uring_t *ring)
+{
+    return FS_OKAY;
+}
+
+int fs_uring_accept(fs_uring_t *ring, int fd, void *context)
+{
+    errno = ENOSYS;
+    return FS_ERR_IO;
+}
+
+int fs_uring_recv(fs_uring_t *ring, int fd, void *context)
+{
+    errno = ENOSYS;
+    return FS_ERR_IO;
+}
+
+int fs_uring_poll(fs_uring_t *ring, int fd, uint32_t events, void *context)
+{
+    errno = ENOSYS;
+    return FS_ERR_IO;
+}
+
+int fs_uring_cancel(fs_uring_t *ring, int fd)
+{
+    errno = ENOSYS;
+    return FS_ERR_IO;
+}
+
+int fs_uring_sendmsg(fs_uring_t *ring, int fd, fs_uring_send_t *send, fs_composite_buffer_t *buffer, uint32_t max, void *context)
+{
+    errno = ENOSYS;
+    return FS_ERR_IO;
+}
+
+int fs_uring_submit(fs_uring_t *ring, uint32_t wait)
+{
+    errno = ENOSYS;
+    return FS_ERR_IO;
+}
+
+int fs_uring_reap(fs_uring_t *ring, fs_uring_event_t *events, uint32_t max, uint32_t *count)
+{
+    *count = 0;
+    errno  = ENOSYS;
+    
+    return FS_ERR_IO;
+}
+
+int fs_uring_take_buffer(fs_uring_t *ring, uint16_t buffer, uint32_t length, fs_byte_buffer_t *out)
+{
+    errno = ENOSYS;
+    return FS_ERR_IO;
+}
+
+#endif /* __linux__ */
@@ -14,6 +14,9 @@
 #include <stdint.h>
 #include <limits.h>
 #include <strings.h>
+#include <pthread.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -28,6 +31,41 @@ extern "C" {
 #define FS_ERR_OOR -1
 #define FS_ERR_OOM -2
 #define FS_ERR_OOB -3
+#define FS_ERR_IO  -4
+#define FS_ERR_DATA -5
+#define FS_ERR_EOF  -6
+
+/* fs_byte_buffer_t storage flags */
+#define FS_BUFFER_MAPPED 0x1 // mmap'd, grows with mremap
+#define FS_BUFFER_FILE   0x2 // private mapping of a file
+#define FS_BUFFER_RING   0x4 // mirrored mapping, discards without copying
+#define FS_BUFFER_FIXED  0x8 // borrowed bytes, never grows
+
+/* Largest capacity any buffer grows to. Indices, capacities and
+ * composite component offsets are all uint32_t, so neither plain
+ * nor composite buffers hold more than 4 GiB - 1 bytes. Lifting
+ * it takes widening fs_byte_buffer_t, fs_composite_buffer_t and
+ * every offset and length in the C, C++ and Swift APIs to 64 bits */
+#define FS_BUFFER_MAX_CAPACITY UINT32_MAX
+
+/* fs_byte_buffer_growth_t policies */
+#define FS_GROWTH_DOUBLING 0 // powers of two up to step, then multiples of step
+#define FS_GROWTH_STEP     1 // multiples of step over the current capacity
+#define FS_GROWTH_PREDICT  2 // whatever predict answers, at least what's needed
+
+/* fs_byte_buffer_advise hints */
+#define FS_ADVICE_NORMAL     0
+#define FS_ADVICE_SEQUENTIAL 1
+#define FS_ADVICE_RANDOM     2
+#define FS_ADVICE_WILLNEED   3
+#define FS_ADVICE_DONTNEED   4
+
+/* LEB128 varints */
+#define FS_VARINT32_MAX_LENGTH 5
+#define FS_VARINT64_MAX_LENGTH 10
+
+/* Searches that found nothing */
+#define FS_INDEX_NOT_FOUND UINT32_MAX
 
 typedef  int8_t fs_err_t;
 typedef uint8_t fs_byte_t;
@@ -35,6 +73,63 @@ typedef uint8_t fs_byte_t;
 /* error code to char* string */
 const char *fs_error_to_string(int code);
 
+/* Number of pooled size classes, powers
+ * of two from 64 B up to 4 MiB (2^6..2^22) */
+#define FS_POOL_SIZE_CLASSES 17
+
+typedef struct fs_byte_buffer_pool_cache fs_byte_buffer_pool_cache_t;
+typedef struct fs_byte_buffer_shared fs_byte_buffer_shared_t;
+
+/* capacity to grow to from capacity, when required bytes are
+ * needed. Answers below required are rounded up to it */
+typedef uint64_t (*fs_byte_buffer_predict_t)(void* context, uint32_t capacity, uint64_t required);
+
+/* How writes grow a full buffer, shared by any number of them */
+typedef struct {
+    int policy;
+    
+    /* doubling threshold or fixed step, in bytes */
+    uint32_t step;
+    
+    /* writes needing more than this fail with FS_ERR_OOB */
+    uint32_t max_capacity;
+    
+    /* FS_GROWTH_PREDICT only */
+    fs_byte_buffer_predict_t predict;
+    void* context;
+} fs_byte_buffer_growth_t;
+
+/* called once per byte by the for_each_byte functions,
+ * answers FS_YES to go on or FS_NO to stop there */
+typedef int (*fs_byte_visitor_t)(void* context, fs_byte_t value);
+
+/* The fs_byte_buffer_pool structure */
+typedef struct fs_byte_buffer_pool {
+    pthread_key_t   cache_key;
+    pthread_mutex_t lock;
+    
+    /* shared arena, one free list
+     * per size class, guarded by lock */
+    void*    arena[FS_POOL_SIZE_CLASSES];
+    uint32_t arena_count[FS_POOL_SIZE_CLASSES];
+    
+    /* live per-thread caches, guarded by lock */
+    fs_byte_buffer_pool_cache_t* caches;
+    
+    uint64_t max_retained;
+    uint64_t retained;
+    
+    /* stats of exited threads */
+    uint64_t hits;
+    uint64_t misses;
+} fs_byte_buffer_pool_t;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t bytes_retained;
+} fs_byte_buffer_pool_stats_t;
+
 /* The fs_byte_buffer structure */
 typedef struct {
     fs_byte_t* heap;
@@ -46,13 +141,76 @@ typedef struct {
     
     uint32_t reader_index;
     uint32_t writer_index;
+    
+    /* owning pool, NULL if heap was malloc'd */
+    fs_byte_buffer_pool_t* pool;
+    
+    /* reference counted storage shared with
+     * slices, NULL while this is the sole owner */
+    fs_byte_buffer_shared_t* shared;
+    
+    /* FS_BUFFER_* storage flags */
+    uint32_t flags;
+    
+    /* how writes grow it, NULL doubles up to 4 MiB
+     * then steps by 4 MiB. Never shared with slices */
+    const fs_byte_buffer_growth_t* growth;
 } fs_byte_buffer_t;
     
+/* A component of a fs_composite_buffer */
+typedef struct {
+    /* slice over the component's readable bytes */
+    fs_byte_buffer_t buffer;
+    
+    /* where it starts within the composite */
+    uint32_t offset;
+} fs_composite_component_t;
+
+/* The fs_composite_buffer structure */
+typedef struct {
+    fs_composite_component_t* components;
+    
+    uint32_t count;
+    uint32_t slots;
+    
+    uint32_t reader_mark;
+    uint32_t writer_mark;
+    
+    uint32_t reader_index;
+    uint32_t writer_index;
+} fs_composite_buffer_t;
+    
+/* --> pool management functions <-- */
+int fs_byte_buffer_pool_init (fs_byte_buffer_pool_t* pool, uint64_t max_retained);
+int fs_byte_buffer_pool_free (fs_byte_buffer_pool_t* pool);
+int fs_byte_buffer_pool_stats(fs_byte_buffer_pool_t* pool, fs_byte_buffer_pool_stats_t* out);
+    
 /* --> memory management functions <-- */
 int fs_byte_buffer_free(fs_byte_buffer_t* buffer);
 int fs_byte_buffer_init(fs_byte_buffer_t* buffer, uint32_t capacity);
+int fs_byte_buffer_init_pooled(fs_byte_buffer_t* buffer, fs_byte_buffer_pool_t* pool, uint32_t capacity);
+int fs_byte_buffer_init_mmap(fs_byte_buffer_t* buffer, uint32_t capacity);
+int fs_byte_buffer_init_mmap_file(fs_byte_buffer_t* buffer, const char* path);
+int fs_byte_buffer_init_ring(fs_byte_buffer_t* buffer, uint32_t capacity);
 int fs_byte_buffer_copy(fs_byte_buffer_t* dst, fs_byte_buffer_t* src);
 int fs_byte_buffer_resize(fs_byte_buffer_t *buffer, uint32_t capacity);
+int fs_byte_buffer_advise(fs_byte_buffer_t *buffer, int advice);
+int fs_byte_buffer_discard_read_bytes(fs_byte_buffer_t *buffer);
+
+/* --> Growth functions <-- */
+int fs_byte_buffer_growth_init        (fs_byte_buffer_growth_t* growth, int policy, uint32_t step, uint32_t max_capacity);
+int fs_byte_buffer_growth_init_predict(fs_byte_buffer_growth_t* growth, fs_byte_buffer_predict_t predict, void* context, uint32_t max_capacity);
+
+/* grows buffer, as its growth policy says, until length
+ * more bytes can be written. Every write_* calls it */
+int fs_byte_buffer_ensure_writable(fs_byte_buffer_t* buffer, uint32_t length);
+
+/* --> Reference counting functions <-- */
+/* retain before copying the struct around, every copy
+ * (and every slice) must be released or freed once */
+int fs_byte_buffer_retain   (fs_byte_buffer_t* buffer);
+int fs_byte_buffer_release  (fs_byte_buffer_t* buffer);
+int fs_byte_buffer_ref_count(fs_byte_buffer_t* buffer);
 
 /* --> Capacity functions <-- */
 int fs_byte_buffer_is_readable (fs_byte_buffer_t* buffer);
@@ -78,6 +236,16 @@ int fs_byte_buffer_get_int64_be(fs_byte_buffer_t *buffer, uint32_t offset, int64
 int fs_byte_buffer_get_int64_le(fs_byte_buffer_t *buffer, uint32_t offset, int64_t *out);
 int fs_byte_buffer_get_bytes   (fs_byte_buffer_t *buffer, uint32_t offset, uint32_t length, fs_byte_t *out);
 int fs_byte_buffer_get_slice   (fs_byte_buffer_t *buffer, uint32_t offset, uint32_t length, fs_byte_buffer_t *out);
+
+int fs_byte_buffer_get_int16_be_array(fs_byte_buffer_t *buffer, uint32_t offset, int16_t *out, uint32_t count);
+int fs_byte_buffer_get_int16_le_array(fs_byte_buffer_t *buffer, uint32_t offset, int16_t *out, uint32_t count);
+int fs_byte_buffer_get_int32_be_array(fs_byte_buffer_t *buffer, uint32_t offset, int32_t *out, uint32_t count);
+int fs_byte_buffer_get_int32_le_array(fs_byte_buffer_t *buffer, uint32_t offset, int32_t *out, uint32_t count);
+int fs_byte_buffer_get_int64_be_array(fs_byte_buffer_t *buffer, uint32_t offset, int64_t *out, uint32_t count);
+int fs_byte_buffer_get_int64_le_array(fs_byte_buffer_t *buffer, uint32_t offset, int64_t *out, uint32_t count);
+
+int fs_byte_buffer_get_varint32(fs_byte_buffer_t *buffer, uint32_t offset, uint32_t *out, uint32_t *length);
+int fs_byte_buffer_get_varint64(fs_byte_buffer_t *buffer, uint32_t offset, uint64_t *out, uint32_t *length);
     
 int fs_byte_buffer_read_int8    (fs_byte_buffer_t *buffer, int8_t  *out);
 int fs_byte_buffer_read_int16_be(fs_byte_buffer_t *buffer, int16_t *out);
@@ -89,6 +257,54 @@ int fs_byte_buffer_read_int64_le(fs_byte_buffer_t *buffer, int64_t *out);
 int fs_byte_buffer_read_bytes   (fs_byte_buffer_t *buffer, uint32_t length, fs_byte_t *out);
 int fs_byte_buffer_read_slice   (fs_byte_buffer_t *buffer, uint32_t length, fs_byte_buffer_t *out);
 
+int fs_byte_buffer_read_int16_be_array(fs_byte_buffer_t *buffer, int16_t *out, uint32_t count);
+int fs_byte_buffer_read_int16_le_array(fs_byte_buffer_t *buffer, int16_t *out, uint32_t count);
+int fs_byte_buffer_read_int32_be_array(fs_byte_buffer_t *buffer, int32_t *out, uint32_t count);
+int fs_byte_buffer_read_int32_le_array(fs_byte_buffer_t *buffer, int32_t *out, uint32_t count);
+int fs_byte_buffer_read_int64_be_array(fs_byte_buffer_t *buffer, int64_t *out, uint32_t count);
+int fs_byte_buffer_read_int64_le_array(fs_byte_buffer_t *buffer, int64_t *out, uint32_t count);
+
+int fs_byte_buffer_read_varint32(fs_byte_buffer_t *buffer, uint32_t *out);
+int fs_byte_buffer_read_varint64(fs_byte_buffer_t *buffer, uint64_t *out);
+int fs_byte_buffer_read_zigzag32(fs_byte_buffer_t *buffer, int32_t  *out);
+int fs_byte_buffer_read_zigzag64(fs_byte_buffer_t *buffer, int64_t  *out);
+
+int fs_byte_buffer_read_varint32_array(fs_byte_buffer_t *buffer, uint32_t *out, uint32_t count);
+int fs_byte_buffer_read_varint64_array(fs_byte_buffer_t *buffer, uint64_t *out, uint32_t count);
+
+/* --> Searching functions <-- */
+/* search [from, to) among the written bytes, `out` gets the
+ * absolute offset of the match or FS_INDEX_NOT_FOUND */
+int fs_byte_buffer_index_of         (fs_byte_buffer_t *buffer, uint32_t from, uint32_t to, fs_byte_t value, uint32_t *out);
+int fs_byte_buffer_index_of_sequence(fs_byte_buffer_t *buffer, uint32_t from, uint32_t to, const fs_byte_t *sequence, uint32_t length, uint32_t *out);
+int fs_byte_buffer_for_each_byte    (fs_byte_buffer_t *buffer, uint32_t from, uint32_t to, fs_byte_visitor_t visitor, void *context, uint32_t *out);
+
+/* --> Checksum functions <-- */
+/* CRC-32C (Castagnoli) of [offset, offset + length), seed
+ * being the crc of the bytes before them, 0 for none */
+int fs_byte_buffer_crc32c  (fs_byte_buffer_t *buffer, uint32_t offset, uint32_t length, uint32_t seed, uint32_t *out);
+/* xxHash64 of [offset, offset + length), for hashing rather
+ * than integrity, it's not meant to be sent over the wire */
+int fs_byte_buffer_xxhash64(fs_byte_buffer_t *buffer, uint32_t offset, uint32_t length, uint64_t seed, uint64_t *out);
+
+/* --> Text functions <-- */
+/* FS_ERR_DATA unless [offset, offset + length) is well formed
+ * UTF-8. ascii, when not NULL, tells if it's all ascii */
+int fs_byte_buffer_validate_utf8(fs_byte_buffer_t *buffer, uint32_t offset, uint32_t length, int *ascii);
+
+/* --> Compression functions <-- */
+/* most bytes compressing length bytes may take, for
+ * data that doesn't compress at all */
+#define FS_COMPRESS_BOUND(length) ((uint64_t) (length) + (length) / 255 + 16)
+
+/* compresses length readable bytes of src (LZ4 block format)
+ * into buffer, advancing both. Hash table scratch space comes
+ * from pool when not NULL. written is the compressed length */
+int fs_byte_buffer_write_compressed  (fs_byte_buffer_t *buffer, fs_byte_buffer_t *src, uint32_t length, fs_byte_buffer_pool_t *pool, uint32_t *written);
+/* decompresses a length bytes block off src into buffer,
+ * FS_ERR_DATA unless it's well formed and exactly that long */
+int fs_byte_buffer_write_decompressed(fs_byte_buffer_t *buffer, fs_byte_buffer_t *src, uint32_t length, uint32_t decompressed);
+
 /* --> Writing functions <-- */
 int fs_byte_buffer_set_int8    (fs_byte_buffer_t *buffer, uint32_t offset, int8_t  value);
 int fs_byte_buffer_set_int16_be(fs_byte_buffer_t *buffer, uint32_t offset, int16_t value);
@@ -99,6 +315,13 @@ int fs_byte_buffer_set_int64_be(fs_byte_buffer_t *buffer, uint32_t offset, int64
 int fs_byte_buffer_set_int64_le(fs_byte_buffer_t *buffer, uint32_t offset, int64_t value);
 int fs_byte_buffer_set_bytes   (fs_byte_buffer_t *buffer, uint32_t length, uint32_t offset, const fs_byte_t *in);
 
+int fs_byte_buffer_set_int16_be_array(fs_byte_buffer_t *buffer, uint32_t offset, const int16_t *in, uint32_t count);
+int fs_byte_buffer_set_int16_le_array(fs_byte_buffer_t *buffer, uint32_t offset, const int16_t *in, uint32_t count);
+int fs_byte_buffer_set_int32_be_array(fs_byte_buffer_t *buffer, uint32_t offset, const int32_t *in, uint32_t count);
+int fs_byte_buffer_set_int32_le_array(fs_byte_buffer_t *buffer, uint32_t offset, const int32_t *in, uint32_t count);
+int fs_byte_buffer_set_int64_be_array(fs_byte_buffer_t *buffer, uint32_t offset, const int64_t *in, uint32_t count);
+int fs_byte_buffer_set_int64_le_array(fs_byte_buffer_t *buffer, uint32_t offset, const int64_t *in, uint32_t count);
+
 int fs_byte_buffer_write_int8    (fs_byte_buffer_t *buffer, int8_t  value);
 int fs_byte_buffer_write_int16_be(fs_byte_buffer_t *buffer, int16_t value);
 int fs_byte_buffer_write_int16_le(fs_byte_buffer_t *buffer, int16_t value);
@@ -107,6 +330,251 @@ int fs_byte_buffer_write_int32_le(fs_byte_buffer_t *buffer, int32_t value);
 int fs_byte_buffer_write_int64_be(fs_byte_buffer_t *buffer, int64_t value);
 int fs_byte_buffer_write_int64_le(fs_byte_buffer_t *buffer, int64_t value);
 int fs_byte_buffer_write_bytes   (fs_byte_buffer_t *buffer, uint32_t length, const fs_byte_t *in);
+
+int fs_byte_buffer_write_int16_be_array(fs_byte_buffer_t *buffer, const int16_t *in, uint32_t count);
+int fs_byte_buffer_write_int16_le_array(fs_byte_buffer_t *buffer, const int16_t *in, uint32_t count);
+int fs_byte_buffer_write_int32_be_array(fs_byte_buffer_t *buffer, const int32_t *in, uint32_t count);
+int fs_byte_buffer_write_int32_le_array(fs_byte_buffer_t *buffer, const int32_t *in, uint32_t count);
+int fs_byte_buffer_write_int64_be_array(fs_byte_buffer_t *buffer, const int64_t *in, uint32_t count);
+int fs_byte_buffer_write_int64_le_array(fs_byte_buffer_t *buffer, const int64_t *in, uint32_t count);
+
+int fs_byte_buffer_write_varint32(fs_byte_buffer_t *buffer, uint32_t value);
+int fs_byte_buffer_write_varint64(fs_byte_buffer_t *buffer, uint64_t value);
+int fs_byte_buffer_write_zigzag32(fs_byte_buffer_t *buffer, int32_t  value);
+int fs_byte_buffer_write_zigzag64(fs_byte_buffer_t *buffer, int64_t  value);
+
+/* --> Composite memory management functions <-- */
+int fs_composite_buffer_init (fs_composite_buffer_t* buffer, uint32_t components);
+int fs_composite_buffer_free (fs_composite_buffer_t* buffer);
+int fs_composite_buffer_add_component(fs_composite_buffer_t* buffer, fs_byte_buffer_t* component);
+int fs_composite_buffer_add_composite(fs_composite_buffer_t* buffer, fs_composite_buffer_t* components);
+int fs_composite_buffer_discard_read_components(fs_composite_buffer_t* buffer);
+int fs_composite_buffer_consolidate(fs_composite_buffer_t* buffer, fs_byte_buffer_pool_t* pool);
+
+/* --> Composite capacity functions <-- */
+int fs_composite_buffer_is_readable_by_length_at_offset(fs_composite_buffer_t* buffer, uint32_t length, uint32_t offset);
+
+/* --> Composite reading functions <-- */
+int fs_composite_buffer_get_int8    (fs_composite_buffer_t *buffer, uint32_t offset, int8_t  *out);
+int fs_composite_buffer_get_int16_be(fs_composite_buffer_t *buffer, uint32_t offset, int16_t *out);
+int fs_composite_buffer_get_int16_le(fs_composite_buffer_t *buffer, uint32_t offset, int16_t *out);
+int fs_composite_buffer_get_int32_be(fs_composite_buffer_t *buffer, uint32_t offset, int32_t *out);
+int fs_composite_buffer_get_int32_le(fs_composite_buffer_t *buffer, uint32_t offset, int32_t *out);
+int fs_composite_buffer_get_int64_be(fs_composite_buffer_t *buffer, uint32_t offset, int64_t *out);
+int fs_composite_buffer_get_int64_le(fs_composite_buffer_t *buffer, uint32_t offset, int64_t *out);
+int fs_composite_buffer_get_bytes   (fs_composite_buffer_t *buffer, uint32_t offset, uint32_t length, fs_byte_t *out);
+int fs_composite_buffer_get_slice   (fs_composite_buffer_t *buffer, uint32_t offset, uint32_t length, fs_composite_buffer_t *out);
+
+int fs_composite_buffer_get_varint32(fs_composite_buffer_t *buffer, uint32_t offset, uint32_t *out, uint32_t *length);
+int fs_composite_buffer_get_varint64(fs_composite_buffer_t *buffer, uint32_t offset, uint64_t *out, uint32_t *length);
+
+int fs_composite_buffer_read_int8    (fs_composite_buffer_t *buffer, int8_t  *out);
+int fs_composite_buffer_read_int16_be(fs_composite_buffer_t *buffer, int16_t *out);
+int fs_composite_buffer_read_int16_le(fs_composite_buffer_t *buffer, int16_t *out);
+int fs_composite_buffer_read_int32_be(fs_composite_buffer_t *buffer, int32_t *out);
+int fs_composite_buffer_read_int32_le(fs_composite_buffer_t *buffer, int32_t *out);
+int fs_composite_buffer_read_int64_be(fs_composite_buffer_t *buffer, int64_t *out);
+int fs_composite_buffer_read_int64_le(fs_composite_buffer_t *buffer, int64_t *out);
+int fs_composite_buffer_read_bytes   (fs_composite_buffer_t *buffer, uint32_t length, fs_byte_t *out);
+int fs_composite_buffer_read_slice   (fs_composite_buffer_t *buffer, uint32_t length, fs_composite_buffer_t *out);
+
+int fs_composite_buffer_read_varint32(fs_composite_buffer_t *buffer, uint32_t *out);
+int fs_composite_buffer_read_varint64(fs_composite_buffer_t *buffer, uint64_t *out);
+
+/* --> Composite searching functions <-- */
+/* same as the fs_byte_buffer ones, matches may span components */
+int fs_composite_buffer_index_of         (fs_composite_buffer_t *buffer, uint32_t from, uint32_t to, fs_byte_t value, uint32_t *out);
+int fs_composite_buffer_index_of_sequence(fs_composite_buffer_t *buffer, uint32_t from, uint32_t to, const fs_byte_t *sequence, uint32_t length, uint32_t *out);
+int fs_composite_buffer_for_each_byte    (fs_composite_buffer_t *buffer, uint32_t from, uint32_t to, fs_byte_visitor_t visitor, void *context, uint32_t *out);
+
+/* --> Composite checksum functions <-- */
+int fs_composite_buffer_crc32c  (fs_composite_buffer_t *buffer, uint32_t offset, uint32_t length, uint32_t seed, uint32_t *out);
+int fs_composite_buffer_xxhash64(fs_composite_buffer_t *buffer, uint32_t offset, uint32_t length, uint64_t seed, uint64_t *out);
+
+/* --> Composite text functions <-- */
+/* sequences may span components */
+int fs_composite_buffer_validate_utf8(fs_composite_buffer_t *buffer, uint32_t offset, uint32_t length, int *ascii);
+
+/* --> Composite writing functions <-- */
+/* components are fixed in size, sets only
+ * overwrite bytes that are already there */
+int fs_composite_buffer_set_int8    (fs_composite_buffer_t *buffer, uint32_t offset, int8_t  value);
+int fs_composite_buffer_set_int16_be(fs_composite_buffer_t *buffer, uint32_t offset, int16_t value);
+int fs_composite_buffer_set_int16_le(fs_composite_buffer_t *buffer, uint32_t offset, int16_t value);
+int fs_composite_buffer_set_int32_be(fs_composite_buffer_t *buffer, uint32_t offset, int32_t value);
+int fs_composite_buffer_set_int32_le(fs_composite_buffer_t *buffer, uint32_t offset, int32_t value);
+int fs_composite_buffer_set_int64_be(fs_composite_buffer_t *buffer, uint32_t offset, int64_t value);
+int fs_composite_buffer_set_int64_le(fs_composite_buffer_t *buffer, uint32_t offset, int64_t value);
+int fs_composite_buffer_set_bytes   (fs_composite_buffer_t *buffer, uint32_t length, uint32_t offset, const fs_byte_t *in);
+
+/* --> Composite gathering functions <-- */
+/* fills `out` with up to `max` entries covering the readable
+ * bytes, in order, ready for writev(2). `count` gets the
+ * number of entries used */
+int fs_composite_buffer_iovec(fs_composite_buffer_t *buffer, struct iovec *out, uint32_t max, uint32_t *count);
+
+/* fs_event_t readiness flags */
+#define FS_EVENT_READ   0x1
+#define FS_EVENT_WRITE  0x2
+#define FS_EVENT_HANGUP 0x4 // peer closed, reads drain what's left
+#define FS_EVENT_ERROR  0x8
+
+/* Most iovecs gathered by a single fs_socket_writev */
+#define FS_SOCKET_MAX_IOVECS 64
+
+typedef struct {
+    int      nodelay;
+    int      keepalive;
+    uint32_t sndbuf; // 0 keeps the kernel's default
+    uint32_t rcvbuf;
+} fs_socket_options_t;
+
+typedef struct {
+    int fd;
+    int wakeup;
+} fs_event_loop_t;
+
+typedef struct {
+    void*    context;
+    uint32_t events;
+} fs_event_t;
+
+/* fs_uring_event_t operations */
+#define FS_URING_OP_ACCEPT 0x1
+#define FS_URING_OP_RECV   0x2
+#define FS_URING_OP_SEND   0x3
+#define FS_URING_OP_POLL   0x4
+#define FS_URING_OP_CANCEL 0x5
+
+/* fs_uring_event_t flags */
+#define FS_URING_MORE   0x1 // a multishot request goes on
+#define FS_URING_BUFFER 0x2 // `buffer` holds the bytes received
+
+/* An io_uring and the ring of pooled buffers it receives into,
+ * Linux only. Everything here is mapped from or shared with
+ * the kernel, and only ever touched through fs_uring_* */
+typedef struct {
+    int fd;
+    
+    uint32_t* sq_head;
+    uint32_t* sq_tail;
+    uint32_t* sq_array;
+    uint32_t  sq_mask;
+    uint32_t  sq_entries;
+    void*     sqes;
+    
+    uint32_t* cq_head;
+    uint32_t* cq_tail;
+    uint32_t  cq_mask;
+    void*     cqes;
+    
+    void*  sq_map;
+    size_t sq_map_length;
+    void*  cq_map;
+    size_t cq_map_length;
+    size_t sqes_map_length;
+    
+    /* queued since the last submit */
+    uint32_t pending;
+    
+    /* provided buffers, slot `n` of the
+     * ring is buffers[n], taken from pool */
+    void*                  buf_ring;
+    size_t                 buf_ring_length;
+    fs_byte_buffer_t*      buffers;
+    fs_byte_buffer_pool_t* pool;
+    uint32_t               buffer_count;
+    uint32_t               buffer_length;
+    uint16_t               buf_tail;
+} fs_uring_t;
+
+typedef struct {
+    void*    context;
+    uint32_t op;
+    uint32_t flags;
+    
+    /* bytes or descriptor, -errno on failure */
+    int32_t  result;
+    
+    /* FS_URING_BUFFER only */
+    uint16_t buffer;
+} fs_uring_event_t;
+
+/* What a send reads from, it must stay put until it completes */
+typedef struct {
+    struct msghdr message;
+    struct iovec  iovecs[FS_SOCKET_MAX_IOVECS];
+} fs_uring_send_t;
+
+/* --> Socket functions <-- */
+/* non-blocking TCP sockets. Reads and writes that would block
+ * succeed with 0 bytes, a closed peer is FS_ERR_EOF and any
+ * other failure FS_ERR_IO, with errno left as the call set it */
+int fs_socket_connect(const char *host, uint16_t port, const fs_socket_options_t *options, int *fd);
+int fs_socket_finish_connect(int fd);
+int fs_socket_listen(const char *host, uint16_t port, int backlog, int *fd, uint16_t *bound);
+int fs_socket_accept(int fd, const fs_socket_options_t *options, int *out);
+int fs_socket_set_options(int fd, const fs_socket_options_t *options);
+int fs_socket_close(int fd);
+
+/* reads up to `max` bytes into the writable bytes of `buffer` */
+int fs_socket_read(int fd, fs_byte_buffer_t *buffer, uint32_t max, uint32_t *read);
+
+/* sends up to `max` readable bytes of `buffer` in one gathering
+ * write, advancing its reader index past what the socket took */
+int fs_socket_writev(int fd, fs_composite_buffer_t *buffer, uint32_t max, uint32_t *written);
+
+/* --> Event loop functions <-- */
+/* edge triggered epoll, Linux only, FS_ERR_IO elsewhere. Every
+ * descriptor is watched for reads and writes at once, so each
+ * event must be drained until it would block */
+int fs_event_loop_init  (fs_event_loop_t *loop);
+int fs_event_loop_free  (fs_event_loop_t *loop);
+int fs_event_loop_add   (fs_event_loop_t *loop, int fd, void *context);
+int fs_event_loop_remove(fs_event_loop_t *loop, int fd);
+
+/* waits up to `timeout` ms, -1 for ever, and fills `events` with
+ * up to `max` ready descriptors. Returns early, maybe with none,
+ * once woken up */
+int fs_event_loop_wait  (fs_event_loop_t *loop, fs_event_t *events, uint32_t max, int timeout, uint32_t *count);
+int fs_event_loop_wakeup(fs_event_loop_t *loop);
+
+/* --> Ring functions <-- */
+/* io_uring, Linux only, FS_ERR_IO with errno ENOSYS elsewhere.
+ * `buffers` receive buffers of `buffer_length` bytes are taken
+ * from `pool`, and `buffers` must be a power of two. FS_ERR_IO
+ * from init means the kernel can't, callers fall back to epoll */
+int fs_uring_init(fs_uring_t *ring, uint32_t entries, fs_byte_buffer_pool_t *pool, uint32_t buffers, uint32_t buffer_length);
+int fs_uring_free(fs_uring_t *ring);
+
+/* queue requests, nothing reaches the kernel until the next
+ * submit. `context` comes back with every completion */
+int fs_uring_accept (fs_uring_t *ring, int fd, void *context); // multishot
+int fs_uring_recv   (fs_uring_t *ring, int fd, void *context); // multishot, into provided buffers
+int fs_uring_poll   (fs_uring_t *ring, int fd, uint32_t events, void *context); // FS_EVENT_*, once
+int fs_uring_cancel (fs_uring_t *ring, int fd); // everything in flight on fd
+
+/* sends up to `max` readable bytes of `buffer` in one gathering
+ * write. Its reader index is left alone, the completion says
+ * how much went out */
+int fs_uring_sendmsg(fs_uring_t *ring, int fd, fs_uring_send_t *send, fs_composite_buffer_t *buffer, uint32_t max, void *context);
+
+/* hands everything queued to the kernel in one call, waiting
+ * for `wait` completions, 0 to return right away */
+int fs_uring_submit(fs_uring_t *ring, uint32_t wait);
+
+/* fills `events` with up to `max` completions, no syscall */
+int fs_uring_reap(fs_uring_t *ring, fs_uring_event_t *events, uint32_t max, uint32_t *count);
+
+/* moves the received bytes of a FS_URING_BUFFER completion into
+ * `out`, and gives its slot a fresh buffer from the pool */
+int fs_uring_take_buffer(fs_uring_t *ring, uint16_t buffer, uint32_t length, fs_byte_buffer_t *out);
+
+/* --> Thread functions <-- */
+int fs_thread_cpu_count(void);
+
+/* binds the calling thread to one cpu, Linux only, FS_ERR_IO elsewhere */
+int fs_thread_pin(int cpu);
 #ifdef __cplusplus
 }
 #endif
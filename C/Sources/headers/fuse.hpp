@@ -0,0 +1,232 @@
+//
+//  fuse.hpp
+//  Fuse
+//
+//  Created by Jairo Tylera on 18/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+//  C++ view over fs_byte_buffer_t with the byte order fixed at
+//  compile time. fs::ByteBuffer<E> has the exact layout of the C
+//  struct, so any fs_byte_buffer_t can be used through it without
+//  copying, and every accessor is inlined into the caller.
+//
+
+#ifndef FS_HPP_
+#define FS_HPP_
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#include "fuse_inline.h"
+
+namespace fs {
+
+enum class Endianness
+{
+    big,
+    little,
+    native
+};
+
+namespace detail {
+
+constexpr bool host_is_little_endian()
+{
+    return __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+}
+
+template <typename T>
+inline T byte_swap(T value);
+
+template <>
+inline uint8_t byte_swap<uint8_t>(uint8_t value)
+{
+    return value;
+}
+
+template <>
+inline uint16_t byte_swap<uint16_t>(uint16_t value)
+{
+    return __builtin_bswap16(value);
+}
+
+template <>
+inline uint32_t byte_swap<uint32_t>(uint32_t value)
+{
+    return __builtin_bswap32(value);
+}
+
+template <>
+inline uint64_t byte_swap<uint64_t>(uint64_t value)
+{
+    return __builtin_bswap64(value);
+}
+
+/* converts between host and E byte order, the
+ * branch folds away since both sides are constant */
+template <Endianness E, typename T>
+inline T byte_order(T value)
+{
+    typedef typename std::make_unsigned<T>::type U;
+    
+    if (E == Endianness::native ||
+       (E == Endianness::little) == host_is_little_endian())
+    {
+        return value;
+    }
+    
+    return static_cast<T>(byte_swap<U>(static_cast<U>(value)));
+}
+
+} // namespace detail
+
+template <Endianness E = Endianness::big>
+class ByteBuffer
+{
+public:
+    /* views over C buffers, never constructed on their own */
+    ByteBuffer() = delete;
+    ByteBuffer(const ByteBuffer&) = delete;
+    ByteBuffer& operator=(const ByteBuffer&) = delete;
+    
+    static ByteBuffer& wrap(fs_byte_buffer_t& buffer)
+    {
+        return reinterpret_cast<ByteBuffer&>(buffer);
+    }
+    
+    static const ByteBuffer& wrap(const fs_byte_buffer_t& buffer)
+    {
+        return reinterpret_cast<const ByteBuffer&>(buffer);
+    }
+    
+    fs_byte_buffer_t* handle()
+    {
+        return &handle_;
+    }
+    
+    const fs_byte_buffer_t* handle() const
+    {
+        return &handle_;
+    }
+    
+    /* same bytes, read in another byte order */
+    template <Endianness O>
+    ByteBuffer<O>& as()
+    {
+        return ByteBuffer<O>::wrap(handle_);
+    }
+    
+    uint32_t capacity() const
+    {
+        return handle_.capacity;
+    }
+    
+    uint32_t reader_index() const
+    {
+        return handle_.reader_index;
+    }
+    
+    uint32_t writer_index() const
+    {
+        return handle_.writer_index;
+    }
+    
+    uint32_t readable_bytes() const
+    {
+        return handle_.writer_index - handle_.reader_index;
+    }
+    
+    uint32_t writable_bytes() const
+    {
+        return handle_.capacity - handle_.writer_index;
+    }
+    
+    template <typename T>
+    int get(uint32_t offset, T& out) const
+    {
+        check<T>();
+        
+        if (__builtin_expect(fs_byte_buffer_is_readable_by_length_at_offset_inline(&handle_, sizeof(T), offset) == FS_NO, 0))
+        {
+            return FS_ERR_OOB;
+        }
+        
+        T value;
+        std::memcpy(&value, handle_.heap + offset, sizeof(T));
+        out = detail::byte_order<E>(value);
+        
+        return FS_OKAY;
+    }
+    
+    template <typename T>
+    int read(T& out)
+    {
+        int result = get(handle_.reader_index, out);
+        
+        if (result == FS_OKAY)
+        {
+            handle_.reader_index += sizeof(T);
+        }
+        
+        return result;
+    }
+    
+    template <typename T>
+    int set(uint32_t offset, T value)
+    {
+        check<T>();
+        
+        if (__builtin_expect(fs_byte_buffer_is_writable_by_length_at_offset_inline(&handle_, sizeof(T), offset) == FS_NO, 0))
+        {
+            return FS_ERR_OOB;
+        }
+        
+        T encoded = detail::byte_order<E>(value);
+        std::memcpy(handle_.heap + offset, &encoded, sizeof(T));
+        
+        return FS_OKAY;
+    }
+    
+    template <typename T>
+    int write(T value)
+    {
+        int result = fs_byte_buffer_ensure_writable_inline(&handle_, sizeof(T));
+        
+        if (__builtin_expect(result != FS_OKAY, 0))
+        {
+            return result;
+        }
+        
+        result = set(handle_.writer_index, value);
+        
+        if (result == FS_OKAY)
+        {
+            handle_.writer_index += sizeof(T);
+        }
+        
+        return result;
+    }
+
+private:
+    template <typename T>
+    static void check()
+    {
+        static_assert(std::is_integral<T>::value, "fs::ByteBuffer only encodes integers");
+        static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "unsupported integer width");
+    }
+    
+    fs_byte_buffer_t handle_;
+};
+
+/* fs::ByteBuffer must stay layout compatible with fs_byte_buffer_t */
+static_assert(sizeof(ByteBuffer<>) == sizeof(fs_byte_buffer_t), "fs::ByteBuffer size mismatch");
+static_assert(std::is_standard_layout<ByteBuffer<>>::value, "fs::ByteBuffer must be standard layout");
+
+typedef ByteBuffer<Endianness::big>    BigEndianByteBuffer;
+typedef ByteBuffer<Endianness::little> LittleEndianByteBuffer;
+typedef ByteBuffer<Endianness::native> NativeByteBuffer;
+
+} // namespace fs
+
+#endif /* FS_HPP_ */
@@ -0,0 +1,706 @@
+//
+//  fuse_inline.h
+//  Fuse
+//
+//  Created by Jairo Tylera on 18/06/18.
+//  Copyright © 2018 Tylerian. All rights reserved.
+//
+//  Header-only twins of the primitive accessors in fuse.h. Same
+//  semantics and error codes, but inlined into the caller so they
+//  compile down to one bounds check and one load/store plus bswap.
+//  The _ne variants use host byte order and skip the swap.
+//
+
+#ifndef FS_INLINE_H_
+#define FS_INLINE_H_
+
+#include <string.h>
+
+#include "fuse.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FS_INLINE_UNLIKELY(x) __builtin_expect(!!(x), 0)
+
+/* host <-> wire byte order */
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define FS_INLINE_BE16(x) __builtin_bswap16(x)
+#define FS_INLINE_BE32(x) __builtin_bswap32(x)
+#define FS_INLINE_BE64(x) __builtin_bswap64(x)
+#define FS_INLINE_LE16(x) (x)
+#define FS_INLINE_LE32(x) (x)
+#define FS_INLINE_LE64(x) (x)
+#else
+#define FS_INLINE_BE16(x) (x)
+#define FS_INLINE_BE32(x) (x)
+#define FS_INLINE_BE64(x) (x)
+#define FS_INLINE_LE16(x) __builtin_bswap16(x)
+#define FS_INLINE_LE32(x) __builtin_bswap32(x)
+#define FS_INLINE_LE64(x) __builtin_bswap64(x)
+#endif
+
+#define FS_INLINE_NE16(x) (x)
+#define FS_INLINE_NE32(x) (x)
+#define FS_INLINE_NE64(x) (x)
+
+/* --> Varint helpers <-- */
+static inline uint32_t fs_zigzag_encode32(int32_t value)
+{
+    return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+}
+
+static inline uint64_t fs_zigzag_encode64(int64_t value)
+{
+    return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+}
+
+static inline int32_t fs_zigzag_decode32(uint32_t value)
+{
+    return (int32_t) ((value >> 1) ^ (0u - (value & 1)));
+}
+
+static inline int64_t fs_zigzag_decode64(uint64_t value)
+{
+    return (int64_t) ((value >> 1) ^ (0ull - (value & 1)));
+}
+
+/* encoded LEB128 length of value */
+static inline uint32_t fs_varint_length64(uint64_t value)
+{
+    /* 7 bits per byte, (bits * 9 + 64) / 64 avoids the division */
+    return (uint32_t) ((64 - __builtin_clzll(value | 1)) * 9 + 64) / 64;
+}
+
+static inline uint32_t fs_varint_length32(uint32_t value)
+{
+    return fs_varint_length64(value);
+}
+
+/* --> Checking functions <-- */
+static inline int fs_byte_buffer_is_readable_by_length_at_offset_inline(const fs_byte_buffer_t *buffer, uint32_t length, uint32_t offset)
+{
+    /* offset past writer_index would wrap around */
+    return (offset <= buffer->writer_index && buffer->writer_index - offset >= length) ? FS_YES : FS_NO;
+}
+
+static inline int fs_byte_buffer_is_writable_by_length_at_offset_inline(const fs_byte_buffer_t *buffer, uint32_t length, uint32_t offset)
+{
+    /* offset past capacity would wrap around */
+    return (offset <= buffer->capacity && buffer->capacity - offset >= length) ? FS_YES : FS_NO;
+}
+
+/* growing is rare, and stays out of line */
+static inline int fs_byte_buffer_ensure_writable_inline(fs_byte_buffer_t *buffer, uint32_t length)
+{
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_writable_by_length_at_offset_inline(buffer, length, buffer->writer_index) == FS_NO))
+    {
+        return fs_byte_buffer_ensure_writable(buffer, length);
+    }
+    
+    return FS_OKAY;
+}
+
+/* --> Reading functions <-- */
+static inline int fs_byte_buffer_get_int8_inline(const fs_byte_buffer_t *buffer, uint32_t offset, int8_t *out)
+{
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_readable_by_length_at_offset_inline(buffer, sizeof(int8_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    *out = (int8_t) buffer->heap[offset];
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_get_int16_be_inline(const fs_byte_buffer_t *buffer, uint32_t offset, int16_t *out)
+{
+    uint16_t value;
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_readable_by_length_at_offset_inline(buffer, sizeof(int16_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(&value, buffer->heap + offset, sizeof(value));
+    *out = (int16_t) FS_INLINE_BE16(value);
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_get_int16_le_inline(const fs_byte_buffer_t *buffer, uint32_t offset, int16_t *out)
+{
+    uint16_t value;
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_readable_by_length_at_offset_inline(buffer, sizeof(int16_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(&value, buffer->heap + offset, sizeof(value));
+    *out = (int16_t) FS_INLINE_LE16(value);
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_get_int16_ne_inline(const fs_byte_buffer_t *buffer, uint32_t offset, int16_t *out)
+{
+    uint16_t value;
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_readable_by_length_at_offset_inline(buffer, sizeof(int16_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(&value, buffer->heap + offset, sizeof(value));
+    *out = (int16_t) FS_INLINE_NE16(value);
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_get_int32_be_inline(const fs_byte_buffer_t *buffer, uint32_t offset, int32_t *out)
+{
+    uint32_t value;
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_readable_by_length_at_offset_inline(buffer, sizeof(int32_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(&value, buffer->heap + offset, sizeof(value));
+    *out = (int32_t) FS_INLINE_BE32(value);
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_get_int32_le_inline(const fs_byte_buffer_t *buffer, uint32_t offset, int32_t *out)
+{
+    uint32_t value;
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_readable_by_length_at_offset_inline(buffer, sizeof(int32_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(&value, buffer->heap + offset, sizeof(value));
+    *out = (int32_t) FS_INLINE_LE32(value);
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_get_int32_ne_inline(const fs_byte_buffer_t *buffer, uint32_t offset, int32_t *out)
+{
+    uint32_t value;
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_readable_by_length_at_offset_inline(buffer, sizeof(int32_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(&value, buffer->heap + offset, sizeof(value));
+    *out = (int32_t) FS_INLINE_NE32(value);
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_get_int64_be_inline(const fs_byte_buffer_t *buffer, uint32_t offset, int64_t *out)
+{
+    uint64_t value;
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_readable_by_length_at_offset_inline(buffer, sizeof(int64_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(&value, buffer->heap + offset, sizeof(value));
+    *out = (int64_t) FS_INLINE_BE64(value);
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_get_int64_le_inline(const fs_byte_buffer_t *buffer, uint32_t offset, int64_t *out)
+{
+    uint64_t value;
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_readable_by_length_at_offset_inline(buffer, sizeof(int64_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(&value, buffer->heap + offset, sizeof(value));
+    *out = (int64_t) FS_INLINE_LE64(value);
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_get_int64_ne_inline(const fs_byte_buffer_t *buffer, uint32_t offset, int64_t *out)
+{
+    uint64_t value;
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_readable_by_length_at_offset_inline(buffer, sizeof(int64_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(&value, buffer->heap + offset, sizeof(value));
+    *out = (int64_t) FS_INLINE_NE64(value);
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_read_int8_inline(fs_byte_buffer_t *buffer, int8_t *out)
+{
+    int result = fs_byte_buffer_get_int8_inline(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int8_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_read_int16_be_inline(fs_byte_buffer_t *buffer, int16_t *out)
+{
+    int result = fs_byte_buffer_get_int16_be_inline(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int16_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_read_int16_le_inline(fs_byte_buffer_t *buffer, int16_t *out)
+{
+    int result = fs_byte_buffer_get_int16_le_inline(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int16_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_read_int16_ne_inline(fs_byte_buffer_t *buffer, int16_t *out)
+{
+    int result = fs_byte_buffer_get_int16_ne_inline(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int16_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_read_int32_be_inline(fs_byte_buffer_t *buffer, int32_t *out)
+{
+    int result = fs_byte_buffer_get_int32_be_inline(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int32_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_read_int32_le_inline(fs_byte_buffer_t *buffer, int32_t *out)
+{
+    int result = fs_byte_buffer_get_int32_le_inline(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int32_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_read_int32_ne_inline(fs_byte_buffer_t *buffer, int32_t *out)
+{
+    int result = fs_byte_buffer_get_int32_ne_inline(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int32_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_read_int64_be_inline(fs_byte_buffer_t *buffer, int64_t *out)
+{
+    int result = fs_byte_buffer_get_int64_be_inline(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int64_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_read_int64_le_inline(fs_byte_buffer_t *buffer, int64_t *out)
+{
+    int result = fs_byte_buffer_get_int64_le_inline(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int64_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_read_int64_ne_inline(fs_byte_buffer_t *buffer, int64_t *out)
+{
+    int result = fs_byte_buffer_get_int64_ne_inline(buffer, buffer->reader_index, out);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->reader_index += sizeof(int64_t);
+    }
+    
+    return result;
+}
+
+/* --> Writing functions <-- */
+static inline int fs_byte_buffer_set_int8_inline(fs_byte_buffer_t *buffer, uint32_t offset, int8_t value)
+{
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_writable_by_length_at_offset_inline(buffer, sizeof(int8_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    buffer->heap[offset] = (fs_byte_t) value;
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_set_int16_be_inline(fs_byte_buffer_t *buffer, uint32_t offset, int16_t value)
+{
+    uint16_t encoded = FS_INLINE_BE16((uint16_t) value);
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_writable_by_length_at_offset_inline(buffer, sizeof(int16_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(buffer->heap + offset, &encoded, sizeof(encoded));
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_set_int16_le_inline(fs_byte_buffer_t *buffer, uint32_t offset, int16_t value)
+{
+    uint16_t encoded = FS_INLINE_LE16((uint16_t) value);
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_writable_by_length_at_offset_inline(buffer, sizeof(int16_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(buffer->heap + offset, &encoded, sizeof(encoded));
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_set_int16_ne_inline(fs_byte_buffer_t *buffer, uint32_t offset, int16_t value)
+{
+    uint16_t encoded = FS_INLINE_NE16((uint16_t) value);
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_writable_by_length_at_offset_inline(buffer, sizeof(int16_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(buffer->heap + offset, &encoded, sizeof(encoded));
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_set_int32_be_inline(fs_byte_buffer_t *buffer, uint32_t offset, int32_t value)
+{
+    uint32_t encoded = FS_INLINE_BE32((uint32_t) value);
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_writable_by_length_at_offset_inline(buffer, sizeof(int32_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(buffer->heap + offset, &encoded, sizeof(encoded));
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_set_int32_le_inline(fs_byte_buffer_t *buffer, uint32_t offset, int32_t value)
+{
+    uint32_t encoded = FS_INLINE_LE32((uint32_t) value);
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_writable_by_length_at_offset_inline(buffer, sizeof(int32_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(buffer->heap + offset, &encoded, sizeof(encoded));
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_set_int32_ne_inline(fs_byte_buffer_t *buffer, uint32_t offset, int32_t value)
+{
+    uint32_t encoded = FS_INLINE_NE32((uint32_t) value);
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_writable_by_length_at_offset_inline(buffer, sizeof(int32_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(buffer->heap + offset, &encoded, sizeof(encoded));
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_set_int64_be_inline(fs_byte_buffer_t *buffer, uint32_t offset, int64_t value)
+{
+    uint64_t encoded = FS_INLINE_BE64((uint64_t) value);
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_writable_by_length_at_offset_inline(buffer, sizeof(int64_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(buffer->heap + offset, &encoded, sizeof(encoded));
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_set_int64_le_inline(fs_byte_buffer_t *buffer, uint32_t offset, int64_t value)
+{
+    uint64_t encoded = FS_INLINE_LE64((uint64_t) value);
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_writable_by_length_at_offset_inline(buffer, sizeof(int64_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(buffer->heap + offset, &encoded, sizeof(encoded));
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_set_int64_ne_inline(fs_byte_buffer_t *buffer, uint32_t offset, int64_t value)
+{
+    uint64_t encoded = FS_INLINE_NE64((uint64_t) value);
+    
+    if (FS_INLINE_UNLIKELY(fs_byte_buffer_is_writable_by_length_at_offset_inline(buffer, sizeof(int64_t), offset) == FS_NO))
+    {
+        return FS_ERR_OOB;
+    }
+    
+    memcpy(buffer->heap + offset, &encoded, sizeof(encoded));
+    
+    return FS_OKAY;
+}
+
+static inline int fs_byte_buffer_write_int8_inline(fs_byte_buffer_t *buffer, int8_t value)
+{
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int8_t));
+    
+    if (FS_INLINE_UNLIKELY(result != FS_OKAY))
+    {
+        return result;
+    }
+    
+    result = fs_byte_buffer_set_int8_inline(buffer, buffer->writer_index, value);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->writer_index += sizeof(int8_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_write_int16_be_inline(fs_byte_buffer_t *buffer, int16_t value)
+{
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int16_t));
+    
+    if (FS_INLINE_UNLIKELY(result != FS_OKAY))
+    {
+        return result;
+    }
+    
+    result = fs_byte_buffer_set_int16_be_inline(buffer, buffer->writer_index, value);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->writer_index += sizeof(int16_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_write_int16_le_inline(fs_byte_buffer_t *buffer, int16_t value)
+{
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int16_t));
+    
+    if (FS_INLINE_UNLIKELY(result != FS_OKAY))
+    {
+        return result;
+    }
+    
+    result = fs_byte_buffer_set_int16_le_inline(buffer, buffer->writer_index, value);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->writer_index += sizeof(int16_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_write_int16_ne_inline(fs_byte_buffer_t *buffer, int16_t value)
+{
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int16_t));
+    
+    if (FS_INLINE_UNLIKELY(result != FS_OKAY))
+    {
+        return result;
+    }
+    
+    result = fs_byte_buffer_set_int16_ne_inline(buffer, buffer->writer_index, value);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->writer_index += sizeof(int16_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_write_int32_be_inline(fs_byte_buffer_t *buffer, int32_t value)
+{
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int32_t));
+    
+    if (FS_INLINE_UNLIKELY(result != FS_OKAY))
+    {
+        return result;
+    }
+    
+    result = fs_byte_buffer_set_int32_be_inline(buffer, buffer->writer_index, value);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->writer_index += sizeof(int32_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_write_int32_le_inline(fs_byte_buffer_t *buffer, int32_t value)
+{
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int32_t));
+    
+    if (FS_INLINE_UNLIKELY(result != FS_OKAY))
+    {
+        return result;
+    }
+    
+    result = fs_byte_buffer_set_int32_le_inline(buffer, buffer->writer_index, value);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->writer_index += sizeof(int32_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_write_int32_ne_inline(fs_byte_buffer_t *buffer, int32_t value)
+{
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int32_t));
+    
+    if (FS_INLINE_UNLIKELY(result != FS_OKAY))
+    {
+        return result;
+    }
+    
+    result = fs_byte_buffer_set_int32_ne_inline(buffer, buffer->writer_index, value);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->writer_index += sizeof(int32_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_write_int64_be_inline(fs_byte_buffer_t *buffer, int64_t value)
+{
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int64_t));
+    
+    if (FS_INLINE_UNLIKELY(result != FS_OKAY))
+    {
+        return result;
+    }
+    
+    result = fs_byte_buffer_set_int64_be_inline(buffer, buffer->writer_index, value);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->writer_index += sizeof(int64_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_write_int64_le_inline(fs_byte_buffer_t *buffer, int64_t value)
+{
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int64_t));
+    
+    if (FS_INLINE_UNLIKELY(result != FS_OKAY))
+    {
+        return result;
+    }
+    
+    result = fs_byte_buffer_set_int64_le_inline(buffer, buffer->writer_index, value);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->writer_index += sizeof(int64_t);
+    }
+    
+    return result;
+}
+
+static inline int fs_byte_buffer_write_int64_ne_inline(fs_byte_buffer_t *buffer, int64_t value)
+{
+    int result = fs_byte_buffer_ensure_writable_inline(buffer, sizeof(int64_t));
+    
+    if (FS_INLINE_UNLIKELY(result != FS_OKAY))
+    {
+        return result;
+    }
+    
+    result = fs_byte_buffer_set_int64_ne_inline(buffer, buffer->writer_index, value);
+    
+    if (result == FS_OKAY)
+    {
+        buffer->writer_index += sizeof(int64_t);
+    }
+    
+    return result;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FS_INLINE_H_ */
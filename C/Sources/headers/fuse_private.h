@@ -9,7 +9,10 @@
 #ifndef FS_PRIVATE_H_
 #define FS_PRIVATE_H_
 
+#include <string.h>
+
 #include "fuse.h"
+#include "fuse_inline.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,7 +25,227 @@ extern "C" {
 #endif
 
 /* fs_byte_buffer_t constants */
-#define BUFFER_CAPACITY_THRESHOLD 1024 * 1024 * 4 // 4 MiB page
+#define BUFFER_CAPACITY_THRESHOLD (1024 * 1024 * 4) // 4 MiB page
+#define BUFFER_CAPACITY_MINIMUM   64
+
+/* fs_byte_buffer_pool_t constants */
+#define POOL_CLASS_SHIFT       6                 // 64 B smallest class
+#define POOL_CACHE_CLASS_BYTES (1024 * 256)      // per class, per thread
+#define POOL_CACHE_CLASS_LIMIT 64                // blocks per class, per thread
+#define POOL_DEFAULT_MAX_RETAINED (1024 * 1024 * 64) // 64 MiB in the shared arena
+
+/* per-thread cache sitting in front of the shared arena */
+struct fs_byte_buffer_pool_cache {
+    fs_byte_buffer_pool_t* pool;
+    
+    fs_byte_buffer_pool_cache_t* prev;
+    fs_byte_buffer_pool_cache_t* next;
+    
+    void*    bins[FS_POOL_SIZE_CLASSES];
+    uint32_t counts[FS_POOL_SIZE_CLASSES];
+    
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t retained;
+};
+
+/* storage shared between a buffer and its slices */
+struct fs_byte_buffer_shared {
+    fs_byte_t* heap;
+    uint32_t   capacity;
+    uint32_t   refcnt;
+    uint32_t   flags;
+    
+    fs_byte_buffer_pool_t* pool;
+};
+
+/* size class index for capacity, -1 if over threshold */
+static inline int fs_byte_buffer_pool_class(uint32_t capacity)
+{
+    if (capacity <= BUFFER_CAPACITY_MINIMUM)
+    {
+        return 0;
+    }
+    
+    if (capacity > BUFFER_CAPACITY_THRESHOLD)
+    {
+        return -1;
+    }
+    
+    /* ceil(log2(capacity)) - 6 */
+    return (32 - __builtin_clz(capacity - 1)) - POOL_CLASS_SHIFT;
+}
+
+/* next capacity following the 64 -> 4 MiB doubling,
+ * then growing by 4 MiB steps above the threshold */
+static inline uint32_t fs_byte_buffer_capacity_for(uint32_t capacity)
+{
+    if (capacity > BUFFER_CAPACITY_THRESHOLD)
+    {
+        uint64_t next = (uint64_t) capacity / BUFFER_CAPACITY_THRESHOLD * BUFFER_CAPACITY_THRESHOLD + BUFFER_CAPACITY_THRESHOLD;
+        
+        /* the last step stops short at the index limit */
+        return next < FS_BUFFER_MAX_CAPACITY ? (uint32_t) next : FS_BUFFER_MAX_CAPACITY;
+    }
+    
+    return (uint32_t) BUFFER_CAPACITY_MINIMUM << fs_byte_buffer_pool_class(capacity);
+}
+
+/* raw block management, capacity must be a class size */
+fs_byte_t* fs_byte_buffer_pool_alloc  (fs_byte_buffer_pool_t* pool, uint32_t capacity);
+void       fs_byte_buffer_pool_release(fs_byte_buffer_pool_t* pool, fs_byte_t* heap, uint32_t capacity);
+
+/* storage management, pool may be NULL */
+fs_byte_t* fs_byte_buffer_storage_alloc  (fs_byte_buffer_pool_t* pool, uint32_t capacity);
+void       fs_byte_buffer_storage_release(fs_byte_buffer_pool_t* pool, fs_byte_t* heap, uint32_t capacity);
+
+/* moves storage to exactly capacity bytes, keeping written ones */
+int fs_byte_buffer_reallocate(fs_byte_buffer_t* buffer, uint32_t capacity);
+
+/* mmap'd storage management */
+int  fs_byte_buffer_map_resize (fs_byte_buffer_t* buffer, uint32_t capacity);
+void fs_byte_buffer_map_release(fs_byte_t* heap, uint32_t capacity);
+
+/* mirrored ring storage management, rings always have a
+ * shared block holding the start of their mapping */
+int  fs_byte_buffer_ring_rotate (fs_byte_buffer_t* buffer);
+int  fs_byte_buffer_ring_move   (fs_byte_buffer_t* buffer, uint32_t capacity, uint32_t from);
+void fs_byte_buffer_ring_release(fs_byte_t* heap, uint32_t capacity);
+
+/* wraps raw bytes in a stack buffer view, never freed */
+static inline void fs_byte_buffer_wrap(fs_byte_buffer_t* buffer, fs_byte_t* heap, uint32_t capacity, uint32_t length)
+{
+    buffer->heap = heap;
+    buffer->capacity = capacity;
+    
+    buffer->reader_mark = 0;
+    buffer->writer_mark = 0;
+    
+    buffer->reader_index = 0;
+    buffer->writer_index = length;
+    
+    buffer->pool = NULL;
+    buffer->shared = NULL;
+    buffer->flags = FS_BUFFER_FIXED;
+    buffer->growth = NULL;
+}
+
+/* byte order kernels, picked at runtime among
+ * avx2/sse2/neon and a scalar fallback */
+void fs_byte_swap16(void* dst, const void* src, uint32_t count);
+void fs_byte_swap32(void* dst, const void* src, uint32_t count);
+void fs_byte_swap64(void* dst, const void* src, uint32_t count);
+
+/* byte search kernels, same dispatch as the ones above. Both
+ * answer the offset of the first match, or length if none */
+uint32_t fs_byte_search(const fs_byte_t *heap, uint32_t length, fs_byte_t value);
+uint32_t fs_byte_search_sequence(const fs_byte_t *heap, uint32_t length, const fs_byte_t *sequence, uint32_t count);
+
+/* CRC-32C kernel, hardware crc32 instructions when the
+ * cpu has them, tables otherwise. crc of what came before,
+ * 0 to start a new one */
+uint32_t fs_byte_crc32c(uint32_t crc, const fs_byte_t *heap, uint32_t length);
+
+/* streaming xxHash64, for bytes spread over several components */
+typedef struct {
+    uint64_t  v[4];
+    uint64_t  seed;
+    uint64_t  total;
+    fs_byte_t stripe[32];
+    uint32_t  buffered;
+} fs_byte_xxhash64_t;
+
+void     fs_byte_xxhash64_init  (fs_byte_xxhash64_t *state, uint64_t seed);
+void     fs_byte_xxhash64_update(fs_byte_xxhash64_t *state, const fs_byte_t *heap, uint32_t length);
+uint64_t fs_byte_xxhash64_digest(const fs_byte_xxhash64_t *state);
+
+/* UTF-8 validation kernel, same dispatch as the ones above.
+ * FS_YES if well formed, ascii set to FS_YES if it's all ascii */
+int fs_byte_utf8_validate(const fs_byte_t *heap, uint32_t length, int *ascii);
+
+/* trailing bytes of a sequence that doesn't end within length */
+uint32_t fs_byte_utf8_incomplete(const fs_byte_t *heap, uint32_t length);
+
+/* bytes in the sequence lead starts, as told by its high bits */
+static inline uint32_t fs_byte_utf8_sequence_length(fs_byte_t lead)
+{
+    return lead >= 0xf0 ? 4 : lead >= 0xe0 ? 3 : lead >= 0xc0 ? 2 : 1;
+}
+
+/* LZ4 block codec. dst must take FS_COMPRESS_BOUND(length)
+ * bytes, table 1 << FS_BLOCK_HASH_LOG entries. Decompression
+ * checks every length, malformed blocks are FS_ERR_DATA */
+#define FS_BLOCK_HASH_LOG 12
+
+uint32_t fs_block_compress  (const fs_byte_t *src, uint32_t length, fs_byte_t *dst, uint32_t *table);
+int      fs_block_decompress(const fs_byte_t *src, uint32_t length, fs_byte_t *dst, uint32_t capacity, uint32_t *out);
+
+/* converts count values between host and wire byte order */
+static inline void fs_byte_order_be16(void* dst, const void* src, uint32_t count)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    fs_byte_swap16(dst, src, count);
+#else
+    memcpy(dst, src, count * sizeof(uint16_t));
+#endif
+}
+
+static inline void fs_byte_order_be32(void* dst, const void* src, uint32_t count)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    fs_byte_swap32(dst, src, count);
+#else
+    memcpy(dst, src, count * sizeof(uint32_t));
+#endif
+}
+
+static inline void fs_byte_order_be64(void* dst, const void* src, uint32_t count)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    fs_byte_swap64(dst, src, count);
+#else
+    memcpy(dst, src, count * sizeof(uint64_t));
+#endif
+}
+
+static inline void fs_byte_order_le16(void* dst, const void* src, uint32_t count)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    fs_byte_swap16(dst, src, count);
+#else
+    memcpy(dst, src, count * sizeof(uint16_t));
+#endif
+}
+
+static inline void fs_byte_order_le32(void* dst, const void* src, uint32_t count)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    fs_byte_swap32(dst, src, count);
+#else
+    memcpy(dst, src, count * sizeof(uint32_t));
+#endif
+}
+
+static inline void fs_byte_order_le64(void* dst, const void* src, uint32_t count)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    fs_byte_swap64(dst, src, count);
+#else
+    memcpy(dst, src, count * sizeof(uint64_t));
+#endif
+}
+
+/* component index holding offset, offset must be readable */
+uint32_t fs_composite_buffer_locate(fs_composite_buffer_t* buffer, uint32_t offset);
+
+/* points view/at to the component holding [offset, offset + length),
+ * view is NULL if that range spans more than one component */
+int fs_composite_buffer_find(fs_composite_buffer_t* buffer, uint32_t offset, uint32_t length, fs_byte_buffer_t** view, uint32_t* at);
+
+/* promotes buffer storage to shared, refcnt starts at 1 */
+int  fs_byte_buffer_share(fs_byte_buffer_t* buffer);
+/* drops a reference, returns storage once it hits 0 */
+void fs_byte_buffer_unshare(fs_byte_buffer_shared_t* shared);
     
 #ifdef __cplusplus
 }
@@ -1,27 +1,55 @@
 import Foundation
 
 public final class Bootstrap {
+    private let _group: EventLoopGroup
+    private let _options: ChannelOptions
     private let _initializer: ChannelInitializer
     
-    public init(initializer: @escaping ChannelInitializer) {
+    /// - parameter group: every channel gets one of its loops
+    public init(group: EventLoopGroup = .default, options: ChannelOptions = ChannelOptions(), initializer: @escaping ChannelInitializer) {
+        self._group       = group
+        self._options     = options
         self._initializer = initializer
     }
 }
 
 extension Bootstrap {
-    public func connect(to host: String, port: Int) throws -> Channel {
-        let channel = Channel(socket: { channel in
-            let socket = TCPSocket(queue: channel.pipeline.executor)
+    /// The channel, once its connection is open. Initializers
+    /// throwing, or the connection failing, fail it.
+    public func connect(to host: String, port: Int) -> EventLoopFuture<Channel> {
+        let channel = Channel(eventLoop: self._group.next(), options: self._options, socket: { channel in
+            let socket = makeSocket(eventLoop: channel.eventLoop, options: channel.options)
                 socket.delegate = channel
          return socket
         })
         
-        try self._initializer(channel)
-    
-        channel.pipeline.connect(to: host, port: port)
+        do {
+            try self._initializer(channel)
+        } catch let error {
+            return EventLoopFuture(eventLoop: channel.eventLoop, value: .failure(error))
+        }
         
-        return channel
+        return channel.connect(to: host, port: port).map { channel }
     }
 }
 
 public typealias ChannelInitializer = (Channel) throws -> Void
+
+#if os(Linux)
+internal typealias DefaultSocket = EpollSocket
+
+/// io_uring when asked for and the loop has it, epoll otherwise.
+fileprivate func makeSocket(eventLoop: EventLoop, options: ChannelOptions) -> Socket {
+    if  options.useIoUring, eventLoop.supportsIoUring {
+        return UringSocket(eventLoop: eventLoop, options: options)
+    }
+    
+    return DefaultSocket(eventLoop: eventLoop, options: options)
+}
+#else
+internal typealias DefaultSocket = TCPSocket
+
+fileprivate func makeSocket(eventLoop: EventLoop, options: ChannelOptions) -> Socket {
+    return DefaultSocket(eventLoop: eventLoop, options: options)
+}
+#endif
@@ -28,12 +28,89 @@ public protocol ByteBufferReadable {
     func getInt32(at offset: Int, endianness: Endianness) -> Int32
     func getInt64(at offset: Int, endianness: Endianness) -> Int64
     func getBytes(at offset: Int, length: Int) -> [UInt8]
+    func getSlice(at offset: Int, length: Int) -> ByteBuffer
+    /// nil unless the bytes are well formed UTF-8
+    func getString(at offset: Int, length: Int) -> String?
+    
+    func getInt16s(at offset: Int, count: Int, endianness: Endianness) -> [Int16]
+    func getInt32s(at offset: Int, count: Int, endianness: Endianness) -> [Int32]
+    func getInt64s(at offset: Int, count: Int, endianness: Endianness) -> [Int64]
+    
+    func index(of value: UInt8, from: Int, to: Int) -> Int?
+    func index(of sequence: [UInt8], from: Int, to: Int) -> Int?
+    func forEachByte(from: Int, to: Int, _ body: (UInt8) -> Bool) -> Int?
+    
+    func crc32c(at offset: Int, length: Int, seed: UInt32) -> UInt32
+    func xxHash64(at offset: Int, length: Int, seed: UInt64) -> UInt64
     
     func readInt8 () -> Int8
     func readInt16(endianness: Endianness) -> Int16
     func readInt32(endianness: Endianness) -> Int32
     func readInt64(endianness: Endianness) -> Int64
     func readBytes(_ length: Int) -> [UInt8]
+    func readSlice(_ length: Int) -> ByteBuffer
+    /// nil, reading nothing, unless the bytes are well formed UTF-8
+    func readString(length: Int) -> String?
+    
+    func readInt16s(count: Int, endianness: Endianness) -> [Int16]
+    func readInt32s(count: Int, endianness: Endianness) -> [Int32]
+    func readInt64s(count: Int, endianness: Endianness) -> [Int64]
+    
+    func readVarint32() -> UInt32
+    func readVarint64() -> UInt64
+    func readZigZag32() -> Int32
+    func readZigZag64() -> Int64
+    func readVarint32s(count: Int) -> [UInt32]
+    func readVarint64s(count: Int) -> [UInt64]
+}
+
+extension ByteBufferReadable {
+    /// Offset of the first `value` among the readable bytes.
+    public func index(of value: UInt8) -> Int? {
+        return self.index(of: value, from: self.readerIndex, to: self.readerIndex + self.readableBytes)
+    }
+    
+    /// Offset where `sequence` first shows up among the readable bytes.
+    public func index(of sequence: [UInt8]) -> Int? {
+        return self.index(of: sequence, from: self.readerIndex, to: self.readerIndex + self.readableBytes)
+    }
+    
+    /// Calls `body` with every readable byte until it answers
+    /// false, returning the offset it stopped at.
+    public func forEachByte(_ body: (UInt8) -> Bool) -> Int? {
+        return self.forEachByte(from: self.readerIndex, to: self.readerIndex + self.readableBytes, body)
+    }
+    
+    /// CRC-32C of the readable bytes.
+    public func crc32c() -> UInt32 {
+        return self.crc32c(at: self.readerIndex, length: self.readableBytes, seed: 0)
+    }
+    
+    /// xxHash64 of the readable bytes.
+    public func xxHash64() -> UInt64 {
+        return self.xxHash64(at: self.readerIndex, length: self.readableBytes, seed: 0)
+    }
+}
+
+/* strings out of bytes already validated, ascii
+ * ones skip the multi-byte decoding altogether */
+internal func makeString(_ bytes: UnsafeBufferPointer<UInt8>, ascii: Bool) -> String {
+    return ascii ? String(decoding: bytes, as: Unicode.ASCII.self) : String(decoding: bytes, as: UTF8.self)
+}
+
+/* runs visit with a C visitor calling body back through context */
+internal func withByteVisitor(_ body: (UInt8) -> Bool, _ visit: (fs_byte_visitor_t, UnsafeMutableRawPointer) -> Int32) -> Int32 {
+    return withoutActuallyEscaping(body) { body in
+        var body = body
+        
+        return withUnsafeMutablePointer(to: &body) { context in
+            return visit({ context, value in
+                let body = context!.assumingMemoryBound(to: ((UInt8) -> Bool).self).pointee
+                
+                return body(value) ? FS_YES : FS_NO
+            }, UnsafeMutableRawPointer(context))
+        }
+    }
 }
 
 public protocol ByteBufferWritable {
@@ -50,16 +127,32 @@ public protocol ByteBufferWritable {
     mutating func set(int64 value: Int64,   at offset: Int, endianness: Endianness) -> Self
     mutating func set(bytes value: [UInt8], at offset: Int) -> Self
     
+    mutating func set(int16s value: [Int16], at offset: Int, endianness: Endianness) -> Self
+    mutating func set(int32s value: [Int32], at offset: Int, endianness: Endianness) -> Self
+    mutating func set(int64s value: [Int64], at offset: Int, endianness: Endianness) -> Self
+    
     mutating func write(int8  value: Int8) -> Self
     mutating func write(int16 value: Int16, endianness: Endianness) -> Self
     mutating func write(int32 value: Int32, endianness: Endianness) -> Self
     mutating func write(int64 value: Int64, endianness: Endianness) -> Self
     mutating func write(bytes value: [UInt8]) -> Self
     mutating func write(bytes value: ByteBuffer) -> Self
+    mutating func write(string value: String) -> Self
+    
+    mutating func write(int16s value: [Int16], endianness: Endianness) -> Self
+    mutating func write(int32s value: [Int32], endianness: Endianness) -> Self
+    mutating func write(int64s value: [Int64], endianness: Endianness) -> Self
+    
+    mutating func write(varint32 value: UInt32) -> Self
+    mutating func write(varint64 value: UInt64) -> Self
+    mutating func write(zigzag32 value: Int32) -> Self
+    mutating func write(zigzag64 value: Int64) -> Self
 }
 
 public final class UnsafeByteBuffer: ByteBuffer {
-    private var handle: fs_byte_buffer_t
+    internal var handle: fs_byte_buffer_t
+    private let _pool: ByteBufferPool?
+    private var _growthPolicy: ByteBufferGrowthPolicy?
     
     public  var capacity: Int {
         get {
@@ -84,9 +177,14 @@ public final class UnsafeByteBuffer: ByteBuffer {
         self.init(capacity: kDefaultCapacity)
     }
     
-    public required init(capacity: Int) {
+    public required convenience init(capacity: Int) {
+        self.init(capacity: capacity, pool: nil)
+    }
+    
+    public init(capacity: Int, pool: ByteBufferPool?) {
         self.handle = fs_byte_buffer_t()
-        let  result = fs_byte_buffer_init(&self.handle, UInt32(capacity));
+        self._pool  = pool
+        let  result = fs_byte_buffer_init_pooled(&self.handle, pool?.handle, UInt32(capacity));
         
         guard result == FS_OKAY else {
             let message = String(cString: fs_error_to_string(result))
@@ -94,13 +192,130 @@ public final class UnsafeByteBuffer: ByteBuffer {
         }
     }
     
+    /// Anonymous memory mapping, meant for large payloads.
+    /// Grows in place with mremap(2) instead of copying.
+    public init(mappedCapacity capacity: Int) {
+        self.handle = fs_byte_buffer_t()
+        self._pool  = nil
+        let  result = fs_byte_buffer_init_mmap(&self.handle, UInt32(capacity))
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while mapping underlying memory storage. Reason: \(message)")
+        }
+    }
+    
+    /// Maps the same pages twice back to back, so the window
+    /// wraps around without copying: `discardReadBytes()`
+    /// just moves it forward. Capacity is rounded to pages.
+    public init(ringCapacity capacity: Int) {
+        self.handle = fs_byte_buffer_t()
+        self._pool  = nil
+        let  result = fs_byte_buffer_init_ring(&self.handle, UInt32(capacity))
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while mapping ring memory storage. Reason: \(message)")
+        }
+    }
+    
+    /// Maps the file at `path` without reading it, its
+    /// contents become the readable bytes. The file is
+    /// opened read-only and never written back to.
+    public init?(contentsOfFile path: String) {
+        self.handle = fs_byte_buffer_t()
+        self._pool  = nil
+        let  result = fs_byte_buffer_init_mmap_file(&self.handle, path)
+        
+        guard result != FS_ERR_IO else {
+            return nil
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while mapping file at path: \(path). Reason: \(message)")
+        }
+    }
+    
+    /// Takes ownership of `handle`, freed along with this.
+    internal init(handle: fs_byte_buffer_t, pool: ByteBufferPool?) {
+        self.handle = handle
+        self._pool  = pool
+    }
+    
     deinit {
         fs_byte_buffer_free(&self.handle)
     }
     
+    public var pool: ByteBufferPool? {
+        return self._pool
+    }
+    
+    /// How writes grow this buffer once it's full, nil
+    /// doubles it up to 4 MiB then steps by 4 MiB.
+    public var growthPolicy: ByteBufferGrowthPolicy? {
+        get {
+            return self._growthPolicy
+        }
+        
+        set(value) {
+            self._growthPolicy = value
+            self.handle.growth = UnsafePointer(value?.handle)
+        }
+    }
+    
+    /// Number of buffers (this one and its slices)
+    /// sharing the underlying memory storage.
+    public var referenceCount: Int {
+        return Int(fs_byte_buffer_ref_count(&self.handle))
+    }
+    
+    /// Calls `body` with the readable bytes, in place. The
+    /// pointer must not escape it, storage may move later.
+    public func withUnsafeReadableBytes<T>(_ body: (UnsafeRawBufferPointer) throws -> T) rethrows -> T {
+        return try body(UnsafeRawBufferPointer(start: self.unsafe + self.readerIndex, count: self.readableBytes))
+    }
+    
+    /// Calls `body` with the writable bytes, for reading into
+    /// them in place. Move `writerIndex` past what it wrote.
+    public func withUnsafeMutableWritableBytes<T>(_ body: (UnsafeMutableRawBufferPointer) throws -> T) rethrows -> T {
+        return try body(UnsafeMutableRawBufferPointer(start: self.unsafe + self.writerIndex, count: self.writableBytes))
+    }
+    
+    /// The readable bytes as a collection, without copying them.
+    public var readableBytesView: ByteBufferView {
+        return ByteBufferView(buffer: self, range: self.readerIndex ..< self.writerIndex)
+    }
+    
+    public func viewBytes(at offset: Int, length: Int) -> ByteBufferView {
+        let result = fs_byte_buffer_is_readable_by_length_at_offset(&self.handle, UInt32(length), UInt32(offset))
+        
+        guard result == FS_YES else {
+            let message = String(cString: fs_error_to_string(FS_ERR_OOB))
+            fatalError("Fatal error while viewing bytes of byte buffer at offset: \(offset). Reason: \(message)")
+        }
+        
+        return ByteBufferView(buffer: self, range: offset ..< offset + length)
+    }
+    
+    /// Hints the kernel about how a memory mapped
+    /// buffer is about to be accessed.
+    public func advise(_ advice: ByteBufferAdvice) -> Self {
+        let result = fs_byte_buffer_advise(&self.handle, advice.rawValue)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while advising memory storage. Reason: \(message)")
+        }
+        
+        return self
+    }
+    
     public func copy() -> ByteBuffer {
-        let copy   = UnsafeByteBuffer()
-        let result = fs_byte_buffer_copy(&self.handle, &copy.handle)
+        let copy   = UnsafeByteBuffer(capacity: self.capacity, pool: self._pool)
+        let result = fs_byte_buffer_copy(&copy.handle, &self.handle)
+        
+        copy.growthPolicy = self._growthPolicy
         
         guard result == FS_OKAY else {
             let message = String(cString: fs_error_to_string(result))
@@ -138,18 +353,11 @@ extension UnsafeByteBuffer: ByteBufferReadable {
     }
     
     public func discardReadBytes() -> Self {
-        guard self.readerIndex != 0 else {
-            return self
-        }
+        let result = fs_byte_buffer_discard_read_bytes(&self.handle)
         
-        if self.readerIndex == self.writerIndex {
-            self.readerIndex = 0
-            self.writerIndex = 0
-        } else {
-            // TODO: Use memmove cuz superposed bytes!!
-            _ = self.set(bytes: self, at: 0, length: self.writerIndex)
-            self.writerIndex -= self.readerIndex
-            self.readerIndex  = 0
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while discarding read bytes. Reason: \(message)")
         }
         
         return self
@@ -157,7 +365,7 @@ extension UnsafeByteBuffer: ByteBufferReadable {
     
     public func getInt8(at offset: Int) -> Int8 {
         var value  = Int8()
-        let result = fs_byte_buffer_get_int8(&self.handle, UInt32(offset), &value)
+        let result = fs_byte_buffer_get_int8_inline(&self.handle, UInt32(offset), &value)
         
         guard result == FS_OKAY else {
             let message = String(cString: fs_error_to_string(result))
@@ -172,9 +380,9 @@ extension UnsafeByteBuffer: ByteBufferReadable {
         let result: Int32
         
         if endianness == .bigEndian {
-            result = fs_byte_buffer_get_int16_be(&self.handle, UInt32(offset), &value)
+            result = fs_byte_buffer_get_int16_be_inline(&self.handle, UInt32(offset), &value)
         } else {
-            result = fs_byte_buffer_get_int16_le(&self.handle, UInt32(offset), &value)
+            result = fs_byte_buffer_get_int16_le_inline(&self.handle, UInt32(offset), &value)
         }
         
         guard result == FS_OKAY else {
@@ -190,9 +398,9 @@ extension UnsafeByteBuffer: ByteBufferReadable {
         let result: Int32
         
         if endianness == .bigEndian {
-            result = fs_byte_buffer_get_int32_be(&self.handle, UInt32(offset), &value)
+            result = fs_byte_buffer_get_int32_be_inline(&self.handle, UInt32(offset), &value)
         } else {
-            result = fs_byte_buffer_get_int32_le(&self.handle, UInt32(offset), &value)
+            result = fs_byte_buffer_get_int32_le_inline(&self.handle, UInt32(offset), &value)
         }
         
         guard result == FS_OKAY else {
@@ -208,9 +416,9 @@ extension UnsafeByteBuffer: ByteBufferReadable {
         let result: Int32
         
         if endianness == .bigEndian {
-            result = fs_byte_buffer_get_int64_be(&self.handle, UInt32(offset), &value)
+            result = fs_byte_buffer_get_int64_be_inline(&self.handle, UInt32(offset), &value)
         } else {
-            result = fs_byte_buffer_get_int64_le(&self.handle, UInt32(offset), &value)
+            result = fs_byte_buffer_get_int64_le_inline(&self.handle, UInt32(offset), &value)
         }
         
         guard result == FS_OKAY else {
@@ -222,12 +430,157 @@ extension UnsafeByteBuffer: ByteBufferReadable {
     }
     
     public func getBytes(at offset: Int, length: Int) -> [UInt8] {
-        var value  = [UInt8](repeating: 0, count: length)
-        let result = fs_byte_buffer_get_bytes(&self.handle, UInt32(offset), UInt32(length), &value)
+        let result = fs_byte_buffer_is_readable_by_length_at_offset(&self.handle, UInt32(length), UInt32(offset))
+        
+        guard result == FS_YES else {
+            let message = String(cString: fs_error_to_string(FS_ERR_OOB))
+            fatalError("Fatal error while getting [UInt8] from byte buffer at offset: \(offset). Reason: \(message)")
+        }
+        
+        // Copied once, straight out of storage, instead
+        // of into an array that's been zero filled first
+        return Array(UnsafeBufferPointer(start: self.unsafe + offset, count: length))
+    }
+    
+    public func getSlice(at offset: Int, length: Int) -> ByteBuffer {
+        var slice  = fs_byte_buffer_t()
+        let result = fs_byte_buffer_get_slice(&self.handle, UInt32(offset), UInt32(length), &slice)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while getting slice from byte buffer at offset: \(offset). Reason: \(message)")
+        }
+        
+        return UnsafeByteBuffer(handle: slice, pool: self._pool)
+    }
+    
+    public func getString(at offset: Int, length: Int) -> String? {
+        var ascii  = Int32()
+        let result = fs_byte_buffer_validate_utf8(&self.handle, UInt32(offset), UInt32(length), &ascii)
+        
+        guard result != FS_ERR_DATA else {
+            return nil
+        }
         
         guard result == FS_OKAY else {
             let message = String(cString: fs_error_to_string(result))
-            fatalError("Fatal error while getting [UInt64] from byte buffer at offset: \(offset). Reason: \(message)")
+            fatalError("Fatal error while getting String from byte buffer at offset: \(offset). Reason: \(message)")
+        }
+        
+        return makeString(UnsafeBufferPointer(start: self.unsafe + offset, count: length), ascii: ascii == FS_YES)
+    }
+    
+    public func getInt16s(at offset: Int, count: Int, endianness: Endianness) -> [Int16] {
+        var value = [Int16](repeating: 0, count: count)
+        let result: Int32
+        
+        if endianness == .bigEndian {
+            result = fs_byte_buffer_get_int16_be_array(&self.handle, UInt32(offset), &value, UInt32(count))
+        } else {
+            result = fs_byte_buffer_get_int16_le_array(&self.handle, UInt32(offset), &value, UInt32(count))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while getting [Int16] from byte buffer at offset: \(offset). Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func getInt32s(at offset: Int, count: Int, endianness: Endianness) -> [Int32] {
+        var value = [Int32](repeating: 0, count: count)
+        let result: Int32
+        
+        if endianness == .bigEndian {
+            result = fs_byte_buffer_get_int32_be_array(&self.handle, UInt32(offset), &value, UInt32(count))
+        } else {
+            result = fs_byte_buffer_get_int32_le_array(&self.handle, UInt32(offset), &value, UInt32(count))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while getting [Int32] from byte buffer at offset: \(offset). Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func getInt64s(at offset: Int, count: Int, endianness: Endianness) -> [Int64] {
+        var value = [Int64](repeating: 0, count: count)
+        let result: Int32
+        
+        if endianness == .bigEndian {
+            result = fs_byte_buffer_get_int64_be_array(&self.handle, UInt32(offset), &value, UInt32(count))
+        } else {
+            result = fs_byte_buffer_get_int64_le_array(&self.handle, UInt32(offset), &value, UInt32(count))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while getting [Int64] from byte buffer at offset: \(offset). Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func index(of value: UInt8, from: Int, to: Int) -> Int? {
+        var found  = UInt32()
+        let result = fs_byte_buffer_index_of(&self.handle, UInt32(from), UInt32(to), value, &found)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while searching UInt8 in byte buffer from offset: \(from). Reason: \(message)")
+        }
+        
+        return found == UInt32.max ? nil : Int(found)
+    }
+    
+    public func index(of sequence: [UInt8], from: Int, to: Int) -> Int? {
+        var found  = UInt32()
+        let result = fs_byte_buffer_index_of_sequence(&self.handle, UInt32(from), UInt32(to), sequence, UInt32(sequence.count), &found)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while searching [UInt8] in byte buffer from offset: \(from). Reason: \(message)")
+        }
+        
+        return found == UInt32.max ? nil : Int(found)
+    }
+    
+    public func forEachByte(from: Int, to: Int, _ body: (UInt8) -> Bool) -> Int? {
+        var found  = UInt32()
+        let result = withByteVisitor(body) { visitor, context in
+            return fs_byte_buffer_for_each_byte(&self.handle, UInt32(from), UInt32(to), visitor, context, &found)
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while visiting bytes of byte buffer from offset: \(from). Reason: \(message)")
+        }
+        
+        return found == UInt32.max ? nil : Int(found)
+    }
+    
+    public func crc32c(at offset: Int, length: Int, seed: UInt32) -> UInt32 {
+        var value  = UInt32()
+        let result = fs_byte_buffer_crc32c(&self.handle, UInt32(offset), UInt32(length), seed, &value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while computing CRC-32C of byte buffer at offset: \(offset). Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func xxHash64(at offset: Int, length: Int, seed: UInt64) -> UInt64 {
+        var value  = UInt64()
+        let result = fs_byte_buffer_xxhash64(&self.handle, UInt32(offset), UInt32(length), seed, &value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while computing xxHash64 of byte buffer at offset: \(offset). Reason: \(message)")
         }
         
         return value
@@ -235,7 +588,7 @@ extension UnsafeByteBuffer: ByteBufferReadable {
     
     public func readInt8() -> Int8 {
         var value  = Int8()
-        let result = fs_byte_buffer_read_int8(&self.handle, &value)
+        let result = fs_byte_buffer_read_int8_inline(&self.handle, &value)
         
         guard result == FS_OKAY else {
             let message = String(cString: fs_error_to_string(result))
@@ -250,9 +603,9 @@ extension UnsafeByteBuffer: ByteBufferReadable {
         let result: Int32
         
         if endianness == .bigEndian {
-            result = fs_byte_buffer_read_int16_be(&self.handle, &value)
+            result = fs_byte_buffer_read_int16_be_inline(&self.handle, &value)
         } else {
-            result = fs_byte_buffer_read_int16_le(&self.handle, &value)
+            result = fs_byte_buffer_read_int16_le_inline(&self.handle, &value)
         }
         
         guard result == FS_OKAY else {
@@ -268,9 +621,9 @@ extension UnsafeByteBuffer: ByteBufferReadable {
         let result: Int32
         
         if endianness == .bigEndian {
-            result = fs_byte_buffer_read_int32_be(&self.handle, &value)
+            result = fs_byte_buffer_read_int32_be_inline(&self.handle, &value)
         } else {
-            result = fs_byte_buffer_read_int32_le(&self.handle, &value)
+            result = fs_byte_buffer_read_int32_le_inline(&self.handle, &value)
         }
         
         guard result == FS_OKAY else {
@@ -286,9 +639,9 @@ extension UnsafeByteBuffer: ByteBufferReadable {
         let result: Int32
         
         if endianness == .bigEndian {
-            result = fs_byte_buffer_read_int64_be(&self.handle, &value)
+            result = fs_byte_buffer_read_int64_be_inline(&self.handle, &value)
         } else {
-            result = fs_byte_buffer_read_int64_le(&self.handle, &value)
+            result = fs_byte_buffer_read_int64_le_inline(&self.handle, &value)
         }
         
         guard result == FS_OKAY else {
@@ -300,14 +653,155 @@ extension UnsafeByteBuffer: ByteBufferReadable {
     }
     
     public func readBytes(_ length: Int) -> [UInt8] {
-        var value  = [UInt8](repeating: 0, count: length)
-        let result = fs_byte_buffer_read_bytes(&self.handle, UInt32(length), &value)
+        let value = self.getBytes(at: self.readerIndex, length: length)
+        self.readerIndex += length
+        return value
+    }
+    
+    public func readSlice(_ length: Int) -> ByteBuffer {
+        var slice  = fs_byte_buffer_t()
+        let result = fs_byte_buffer_read_slice(&self.handle, UInt32(length), &slice)
         
         guard result == FS_OKAY else {
             let message = String(cString: fs_error_to_string(result))
             fatalError("Fatal error while reading slice from byte buffer. Reason: \(message)")
         }
         
+        return UnsafeByteBuffer(handle: slice, pool: self._pool)
+    }
+    
+    public func readString(length: Int) -> String? {
+        guard let value = self.getString(at: self.readerIndex, length: length) else {
+            return nil
+        }
+        
+        self.readerIndex += length
+        return value
+    }
+    
+    public func readInt16s(count: Int, endianness: Endianness) -> [Int16] {
+        var value = [Int16](repeating: 0, count: count)
+        let result: Int32
+        
+        if endianness == .bigEndian {
+            result = fs_byte_buffer_read_int16_be_array(&self.handle, &value, UInt32(count))
+        } else {
+            result = fs_byte_buffer_read_int16_le_array(&self.handle, &value, UInt32(count))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading [Int16] from byte buffer. Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func readInt32s(count: Int, endianness: Endianness) -> [Int32] {
+        var value = [Int32](repeating: 0, count: count)
+        let result: Int32
+        
+        if endianness == .bigEndian {
+            result = fs_byte_buffer_read_int32_be_array(&self.handle, &value, UInt32(count))
+        } else {
+            result = fs_byte_buffer_read_int32_le_array(&self.handle, &value, UInt32(count))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading [Int32] from byte buffer. Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func readInt64s(count: Int, endianness: Endianness) -> [Int64] {
+        var value = [Int64](repeating: 0, count: count)
+        let result: Int32
+        
+        if endianness == .bigEndian {
+            result = fs_byte_buffer_read_int64_be_array(&self.handle, &value, UInt32(count))
+        } else {
+            result = fs_byte_buffer_read_int64_le_array(&self.handle, &value, UInt32(count))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading [Int64] from byte buffer. Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func readVarint32() -> UInt32 {
+        var value  = UInt32()
+        let result = fs_byte_buffer_read_varint32(&self.handle, &value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading UInt32 varint from byte buffer. Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func readVarint64() -> UInt64 {
+        var value  = UInt64()
+        let result = fs_byte_buffer_read_varint64(&self.handle, &value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading UInt64 varint from byte buffer. Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func readZigZag32() -> Int32 {
+        var value  = Int32()
+        let result = fs_byte_buffer_read_zigzag32(&self.handle, &value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading Int32 zigzag varint from byte buffer. Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func readZigZag64() -> Int64 {
+        var value  = Int64()
+        let result = fs_byte_buffer_read_zigzag64(&self.handle, &value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading Int64 zigzag varint from byte buffer. Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func readVarint32s(count: Int) -> [UInt32] {
+        var value  = [UInt32](repeating: 0, count: count)
+        let result = fs_byte_buffer_read_varint32_array(&self.handle, &value, UInt32(count))
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading [UInt32] varints from byte buffer. Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func readVarint64s(count: Int) -> [UInt64] {
+        var value  = [UInt64](repeating: 0, count: count)
+        let result = fs_byte_buffer_read_varint64_array(&self.handle, &value, UInt32(count))
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading [UInt64] varints from byte buffer. Reason: \(message)")
+        }
+        
         return value
     }
 }
@@ -340,7 +834,7 @@ extension UnsafeByteBuffer: ByteBufferWritable {
     }
     
     public func set(int8 value: Int8, at offset: Int) -> Self {
-        let result = fs_byte_buffer_set_int8(&self.handle, UInt32(offset), value)
+        let result = fs_byte_buffer_set_int8_inline(&self.handle, UInt32(offset), value)
         
         guard result == FS_OKAY else {
             let message = String(cString: fs_error_to_string(result))
@@ -354,9 +848,9 @@ extension UnsafeByteBuffer: ByteBufferWritable {
         let result: Int32
         
         if endianness == .bigEndian {
-            result = fs_byte_buffer_set_int16_be(&self.handle, UInt32(offset), value)
+            result = fs_byte_buffer_set_int16_be_inline(&self.handle, UInt32(offset), value)
         } else {
-            result = fs_byte_buffer_set_int16_le(&self.handle, UInt32(offset), value)
+            result = fs_byte_buffer_set_int16_le_inline(&self.handle, UInt32(offset), value)
         }
         
         guard result == FS_OKAY else {
@@ -371,9 +865,9 @@ extension UnsafeByteBuffer: ByteBufferWritable {
         let result: Int32
         
         if endianness == .bigEndian {
-            result = fs_byte_buffer_set_int32_be(&self.handle, UInt32(offset), value)
+            result = fs_byte_buffer_set_int32_be_inline(&self.handle, UInt32(offset), value)
         } else {
-            result = fs_byte_buffer_set_int32_le(&self.handle, UInt32(offset), value)
+            result = fs_byte_buffer_set_int32_le_inline(&self.handle, UInt32(offset), value)
         }
         
         guard result == FS_OKAY else {
@@ -388,9 +882,9 @@ extension UnsafeByteBuffer: ByteBufferWritable {
         let result: Int32
         
         if endianness == .bigEndian {
-            result = fs_byte_buffer_set_int64_be(&self.handle, UInt32(offset), value)
+            result = fs_byte_buffer_set_int64_be_inline(&self.handle, UInt32(offset), value)
         } else {
-            result = fs_byte_buffer_set_int64_le(&self.handle, UInt32(offset), value)
+            result = fs_byte_buffer_set_int64_le_inline(&self.handle, UInt32(offset), value)
         }
         
         guard result == FS_OKAY else {
@@ -423,8 +917,59 @@ extension UnsafeByteBuffer: ByteBufferWritable {
         return self
     }
     
+    public func set(int16s value: [Int16], at offset: Int, endianness: Endianness = .bigEndian) -> Self {
+        let result: Int32
+        
+        if endianness == .bigEndian {
+            result = fs_byte_buffer_set_int16_be_array(&self.handle, UInt32(offset), value, UInt32(value.count))
+        } else {
+            result = fs_byte_buffer_set_int16_le_array(&self.handle, UInt32(offset), value, UInt32(value.count))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while setting [Int16] to byte buffer. Reason: \(message)")
+        }
+        
+        return self
+    }
+    
+    public func set(int32s value: [Int32], at offset: Int, endianness: Endianness = .bigEndian) -> Self {
+        let result: Int32
+        
+        if endianness == .bigEndian {
+            result = fs_byte_buffer_set_int32_be_array(&self.handle, UInt32(offset), value, UInt32(value.count))
+        } else {
+            result = fs_byte_buffer_set_int32_le_array(&self.handle, UInt32(offset), value, UInt32(value.count))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while setting [Int32] to byte buffer. Reason: \(message)")
+        }
+        
+        return self
+    }
+    
+    public func set(int64s value: [Int64], at offset: Int, endianness: Endianness = .bigEndian) -> Self {
+        let result: Int32
+        
+        if endianness == .bigEndian {
+            result = fs_byte_buffer_set_int64_be_array(&self.handle, UInt32(offset), value, UInt32(value.count))
+        } else {
+            result = fs_byte_buffer_set_int64_le_array(&self.handle, UInt32(offset), value, UInt32(value.count))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while setting [Int64] to byte buffer. Reason: \(message)")
+        }
+        
+        return self
+    }
+    
     public func write(int8 value: Int8) -> Self {
-        let result = fs_byte_buffer_write_int8(&self.handle, value)
+        let result = fs_byte_buffer_write_int8_inline(&self.handle, value)
         
         guard result == FS_OKAY else {
             let message = String(cString: fs_error_to_string(result))
@@ -438,9 +983,9 @@ extension UnsafeByteBuffer: ByteBufferWritable {
         let result: Int32
         
         if endianness == .bigEndian {
-            result = fs_byte_buffer_write_int16_be(&self.handle, value)
+            result = fs_byte_buffer_write_int16_be_inline(&self.handle, value)
         } else {
-            result = fs_byte_buffer_write_int16_le(&self.handle, value)
+            result = fs_byte_buffer_write_int16_le_inline(&self.handle, value)
         }
         
         guard result == FS_OKAY else {
@@ -455,9 +1000,9 @@ extension UnsafeByteBuffer: ByteBufferWritable {
         let result: Int32
         
         if endianness == .bigEndian {
-            result = fs_byte_buffer_write_int32_be(&self.handle, value)
+            result = fs_byte_buffer_write_int32_be_inline(&self.handle, value)
         } else {
-            result = fs_byte_buffer_write_int32_le(&self.handle, value)
+            result = fs_byte_buffer_write_int32_le_inline(&self.handle, value)
         }
         
         guard result == FS_OKAY else {
@@ -472,9 +1017,9 @@ extension UnsafeByteBuffer: ByteBufferWritable {
         let result: Int32
         
         if endianness == .bigEndian {
-            result = fs_byte_buffer_write_int64_be(&self.handle, value)
+            result = fs_byte_buffer_write_int64_be_inline(&self.handle, value)
         } else {
-            result = fs_byte_buffer_write_int64_le(&self.handle, value)
+            result = fs_byte_buffer_write_int64_le_inline(&self.handle, value)
         }
         
         guard result == FS_OKAY else {
@@ -486,7 +1031,6 @@ extension UnsafeByteBuffer: ByteBufferWritable {
     }
     
     public func write(bytes value: [UInt8]) -> Self {
-        print("Writing bytes: \(value) -- \(value.count)")
         let result = fs_byte_buffer_write_bytes(&self.handle, UInt32(value.count), value)
         
         guard result == FS_OKAY else {
@@ -497,8 +1041,39 @@ extension UnsafeByteBuffer: ByteBufferWritable {
         return self
     }
     
+    public func write(bytes value: ArraySlice<UInt8>) -> Self {
+        let result = value.withUnsafeBufferPointer { pointer in
+            return fs_byte_buffer_write_bytes(&self.handle, UInt32(pointer.count), pointer.baseAddress)
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while writing ArraySlice<UInt8> to byte buffer. Reason: \(message)")
+        }
+        
+        return self
+    }
+    
+    /// Copies the readable bytes of `value`, starting at its
+    /// reader index, and leaves its indices alone. Bytes it has
+    /// already read, before its reader index, aren't copied.
     public func write(bytes value: ByteBuffer) -> Self {
-        let result = fs_byte_buffer_write_bytes(&self.handle, UInt32(value.writerIndex), value.unsafe)
+        var result: Int32
+        
+        if let composite = value as? CompositeByteBuffer {
+            // Gather straight into our storage, no consolidation
+            result = fs_byte_buffer_ensure_writable(&self.handle, UInt32(composite.readableBytes))
+            
+            if result == FS_OKAY {
+                result = composite.getBytes(at: composite.readerIndex, length: composite.readableBytes, into: self.unsafe + self.writerIndex)
+            }
+            
+            if result == FS_OKAY {
+                self.writerIndex += composite.readableBytes
+            }
+        } else {
+            result = fs_byte_buffer_write_bytes(&self.handle, UInt32(value.readableBytes), value.unsafe + value.readerIndex)
+        }
         
         guard result == FS_OKAY else {
             let message = String(cString: fs_error_to_string(result))
@@ -507,6 +1082,157 @@ extension UnsafeByteBuffer: ByteBufferWritable {
         
         return self
     }
+    
+    public func write(string value: String) -> Self {
+        let length = value.utf8.count
+        let result = fs_byte_buffer_ensure_writable(&self.handle, UInt32(length))
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while writing String to byte buffer. Reason: \(message)")
+        }
+        
+        // Straight from the string's UTF-8 view into our storage
+        _ = UnsafeMutableBufferPointer(start: self.unsafe + self.writerIndex, count: length).initialize(from: value.utf8)
+        
+        self.writerIndex += length
+        return self
+    }
+    
+    public func write(int16s value: [Int16], endianness: Endianness = .bigEndian) -> Self {
+        let result: Int32
+        
+        if endianness == .bigEndian {
+            result = fs_byte_buffer_write_int16_be_array(&self.handle, value, UInt32(value.count))
+        } else {
+            result = fs_byte_buffer_write_int16_le_array(&self.handle, value, UInt32(value.count))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while writing [Int16] to byte buffer. Reason: \(message)")
+        }
+        
+        return self
+    }
+    
+    public func write(int32s value: [Int32], endianness: Endianness = .bigEndian) -> Self {
+        let result: Int32
+        
+        if endianness == .bigEndian {
+            result = fs_byte_buffer_write_int32_be_array(&self.handle, value, UInt32(value.count))
+        } else {
+            result = fs_byte_buffer_write_int32_le_array(&self.handle, value, UInt32(value.count))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while writing [Int32] to byte buffer. Reason: \(message)")
+        }
+        
+        return self
+    }
+    
+    public func write(int64s value: [Int64], endianness: Endianness = .bigEndian) -> Self {
+        let result: Int32
+        
+        if endianness == .bigEndian {
+            result = fs_byte_buffer_write_int64_be_array(&self.handle, value, UInt32(value.count))
+        } else {
+            result = fs_byte_buffer_write_int64_le_array(&self.handle, value, UInt32(value.count))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while writing [Int64] to byte buffer. Reason: \(message)")
+        }
+        
+        return self
+    }
+    
+    public func write(varint32 value: UInt32) -> Self {
+        let result = fs_byte_buffer_write_varint32(&self.handle, value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while writing UInt32 varint to byte buffer. Reason: \(message)")
+        }
+        
+        return self
+    }
+    
+    public func write(varint64 value: UInt64) -> Self {
+        let result = fs_byte_buffer_write_varint64(&self.handle, value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while writing UInt64 varint to byte buffer. Reason: \(message)")
+        }
+        
+        return self
+    }
+    
+    public func write(zigzag32 value: Int32) -> Self {
+        let result = fs_byte_buffer_write_zigzag32(&self.handle, value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while writing Int32 zigzag varint to byte buffer. Reason: \(message)")
+        }
+        
+        return self
+    }
+    
+    public func write(zigzag64 value: Int64) -> Self {
+        let result = fs_byte_buffer_write_zigzag64(&self.handle, value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while writing Int64 zigzag varint to byte buffer. Reason: \(message)")
+        }
+        
+        return self
+    }
+}
+
+extension UnsafeByteBuffer {
+    /// Compresses `length` readable bytes of `source` onto the
+    /// writable ones, as one LZ4 block, reading them off `source`.
+    /// Hash table scratch space comes from `pool` when given.
+    /// Returns the compressed length.
+    public func write(compressing source: UnsafeByteBuffer, length: Int, pool: ByteBufferPool? = nil) -> Int {
+        precondition(source !== self, "Cannot compress a byte buffer onto itself")
+        
+        var written: UInt32 = 0
+        let result = fs_byte_buffer_write_compressed(&self.handle, &source.handle, UInt32(length), pool?.handle, &written)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while compressing bytes into byte buffer. Reason: \(message)")
+        }
+        
+        return Int(written)
+    }
+    
+    /// Decompresses the `length` bytes long block read off `source`
+    /// onto the writable bytes. Returns false, leaving both buffers
+    /// alone, unless it's well formed and `decompressedLength` long.
+    public func write(decompressing source: UnsafeByteBuffer, length: Int, decompressedLength: Int) -> Bool {
+        precondition(source !== self, "Cannot decompress a byte buffer onto itself")
+        
+        let result = fs_byte_buffer_write_decompressed(&self.handle, &source.handle, UInt32(length), UInt32(decompressedLength))
+        
+        guard result != FS_ERR_DATA else {
+            return false
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while decompressing bytes into byte buffer. Reason: \(message)")
+        }
+        
+        return true
+    }
 }
 
 fileprivate let kDefaultCapacity: Int = 256
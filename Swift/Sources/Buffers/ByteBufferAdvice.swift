@@ -0,0 +1,26 @@
+import Foundation
+import CFuse
+
+/// Access pattern hints for memory mapped buffers.
+public enum ByteBufferAdvice {
+    case normal
+    case sequential
+    case random
+    case willNeed
+    case dontNeed
+    
+    internal var rawValue: Int32 {
+        switch self {
+        case .normal:
+            return FS_ADVICE_NORMAL
+        case .sequential:
+            return FS_ADVICE_SEQUENTIAL
+        case .random:
+            return FS_ADVICE_RANDOM
+        case .willNeed:
+            return FS_ADVICE_WILLNEED
+        case .dontNeed:
+            return FS_ADVICE_DONTNEED
+        }
+    }
+}
@@ -0,0 +1,63 @@
+import Foundation
+import CFuse
+
+/// How writes grow a full `UnsafeByteBuffer`. Any number
+/// of buffers can share one policy.
+public final class ByteBufferGrowthPolicy {
+    internal let handle: UnsafeMutablePointer<fs_byte_buffer_growth_t>
+    
+    private var _predictor: ((Int, Int) -> Int)?
+    
+    /// Powers of two up to `threshold`, multiples of it past that.
+    public convenience init(doublingUpTo threshold: Int = 4 * 1024 * 1024, maxCapacity: Int = Int(UInt32.max)) {
+        self.init(policy: FS_GROWTH_DOUBLING, step: threshold, maxCapacity: maxCapacity)
+    }
+    
+    /// Grows by multiples of `step`.
+    public convenience init(step: Int, maxCapacity: Int = Int(UInt32.max)) {
+        self.init(policy: FS_GROWTH_STEP, step: step, maxCapacity: maxCapacity)
+    }
+    
+    /// Asks `predictor` for the next capacity, given the current
+    /// one and the bytes needed. Answers below that are rounded up.
+    public init(maxCapacity: Int = Int(UInt32.max), predictor: @escaping (_ capacity: Int, _ required: Int) -> Int) {
+        self.handle = UnsafeMutablePointer<fs_byte_buffer_growth_t>.allocate(capacity: 1)
+        self.handle.initialize(to: fs_byte_buffer_growth_t())
+        self._predictor = predictor
+        
+        let context = Unmanaged.passUnretained(self).toOpaque()
+        let result  = fs_byte_buffer_growth_init_predict(self.handle, { context, capacity, required in
+            let policy = Unmanaged<ByteBufferGrowthPolicy>.fromOpaque(context!).takeUnretainedValue()
+            
+            return UInt64(max(0, policy._predictor!(Int(capacity), Int(required))))
+        }, context, UInt32(maxCapacity))
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while initializing growth policy. Reason: \(message)")
+        }
+    }
+    
+    private init(policy: Int32, step: Int, maxCapacity: Int) {
+        self.handle = UnsafeMutablePointer<fs_byte_buffer_growth_t>.allocate(capacity: 1)
+        self.handle.initialize(to: fs_byte_buffer_growth_t())
+        
+        let result = fs_byte_buffer_growth_init(self.handle, policy, UInt32(step), UInt32(maxCapacity))
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while initializing growth policy. Reason: \(message)")
+        }
+    }
+    
+    deinit {
+        self.handle.deinitialize(count: 1)
+        self.handle.deallocate()
+    }
+}
+
+extension ByteBufferGrowthPolicy {
+    public var maxCapacity: Int {
+        return Int(self.handle.pointee.max_capacity)
+    }
+}
@@ -0,0 +1,46 @@
+import Foundation
+import CFuse
+
+public struct ByteBufferPoolStats {
+    public let hits: Int
+    public let misses: Int
+    public let bytesRetained: Int
+}
+
+public final class ByteBufferPool {
+    internal let handle: UnsafeMutablePointer<fs_byte_buffer_pool_t>
+
+    public static let `default` = ByteBufferPool()
+
+    public init(maxRetainedBytes: Int = 64 * 1024 * 1024) {
+        // The pool holds a mutex, so it must
+        // never move once it's been initialized
+        self.handle = UnsafeMutablePointer<fs_byte_buffer_pool_t>.allocate(capacity: 1)
+        self.handle.initialize(to: fs_byte_buffer_pool_t())
+
+        let result = fs_byte_buffer_pool_init(self.handle, UInt64(maxRetainedBytes))
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while initializing byte buffer pool. Reason: \(message)")
+        }
+    }
+
+    deinit {
+        fs_byte_buffer_pool_free(self.handle)
+        self.handle.deinitialize(count: 1)
+        self.handle.deallocate()
+    }
+}
+
+extension ByteBufferPool {
+    public var stats: ByteBufferPoolStats {
+        var stats = fs_byte_buffer_pool_stats_t()
+        fs_byte_buffer_pool_stats(self.handle, &stats)
+
+        return ByteBufferPoolStats(
+            hits: Int(stats.hits),
+            misses: Int(stats.misses),
+            bytesRetained: Int(stats.bytes_retained))
+    }
+}
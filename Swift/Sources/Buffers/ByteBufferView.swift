@@ -0,0 +1,54 @@
+import Foundation
+
+/// Bytes of an `UnsafeByteBuffer` seen in place, as a collection.
+/// Indices are the buffer's own offsets. Views read the live
+/// storage, so they're only good until the bytes they cover are
+/// discarded or overwritten, take a slice to keep them around.
+public struct ByteBufferView: RandomAccessCollection {
+    public typealias Element = UInt8
+    public typealias Index   = Int
+    public typealias Indices = CountableRange<Int>
+    
+    private let _buffer: UnsafeByteBuffer
+    private let _range: CountableRange<Int>
+    
+    internal init(buffer: UnsafeByteBuffer, range: CountableRange<Int>) {
+        self._buffer = buffer
+        self._range  = range
+    }
+    
+    public var startIndex: Int {
+        return self._range.lowerBound
+    }
+    
+    public var endIndex: Int {
+        return self._range.upperBound
+    }
+    
+    public var indices: CountableRange<Int> {
+        return self._range
+    }
+    
+    public func index(after i: Int) -> Int {
+        return i + 1
+    }
+    
+    public func index(before i: Int) -> Int {
+        return i - 1
+    }
+    
+    public subscript(position: Int) -> UInt8 {
+        precondition(self._range.contains(position), "Index out of range")
+        return self._buffer.unsafe[position]
+    }
+    
+    public subscript(bounds: Range<Int>) -> ByteBufferView {
+        precondition(bounds.lowerBound >= self._range.lowerBound && bounds.upperBound <= self._range.upperBound, "Range out of bounds")
+        return ByteBufferView(buffer: self._buffer, range: CountableRange(bounds))
+    }
+    
+    /// Calls `body` with the viewed bytes, in place.
+    public func withUnsafeBytes<T>(_ body: (UnsafeRawBufferPointer) throws -> T) rethrows -> T {
+        return try body(UnsafeRawBufferPointer(start: self._buffer.unsafe + self._range.lowerBound, count: self._range.count))
+    }
+}
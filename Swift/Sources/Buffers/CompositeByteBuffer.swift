@@ -0,0 +1,721 @@
+import Foundation
+import CFuse
+
+/// A `ByteBuffer` chaining several buffers together without
+/// copying them. Components are zero-copy slices over the
+/// readable bytes of the added buffers, so those bytes must
+/// not be modified once they've been added.
+public final class CompositeByteBuffer: ByteBuffer {
+    internal var handle: fs_composite_buffer_t
+
+    // Pools owning the components' storage
+    // must outlive the composite itself
+    private var _pools: [ObjectIdentifier: ByteBufferPool]
+
+    public var capacity: Int {
+        get {
+            return self.writerIndex
+        }
+
+        set(value) {
+            fatalError("Fatal error while setting capacity of composite byte buffer. Reason: composites grow by adding components, not by resizing")
+        }
+    }
+
+    /// Contiguous view of the composite. Merges all
+    /// components into a single one, copying them.
+    public var unsafe: UnsafeMutablePointer<UInt8> {
+        let result = fs_composite_buffer_consolidate(&self.handle, nil)
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while consolidating composite byte buffer. Reason: \(message)")
+        }
+
+        return self.handle.components[0].buffer.heap
+    }
+
+    public required convenience init() {
+        self.init(capacity: kDefaultComponents)
+    }
+
+    /// - parameter capacity: number of components to make room for
+    public required init(capacity: Int) {
+        self.handle = fs_composite_buffer_t()
+        self._pools = [:]
+        let  result = fs_composite_buffer_init(&self.handle, UInt32(capacity))
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while initializing composite byte buffer. Reason: \(message)")
+        }
+    }
+
+    private init(handle: fs_composite_buffer_t, pools: [ObjectIdentifier: ByteBufferPool]) {
+        self.handle = handle
+        self._pools = pools
+    }
+
+    deinit {
+        fs_composite_buffer_free(&self.handle)
+    }
+
+    public func copy() -> ByteBuffer {
+        let copy   = UnsafeByteBuffer(capacity: self.writerIndex)
+        let result = fs_composite_buffer_get_bytes(&self.handle, 0, UInt32(self.writerIndex), copy.unsafe)
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while creating a copy of this CompositeByteBuffer: \(String(describing: self)).\nReason: \(message)")
+        }
+
+        copy.writerIndex = self.writerIndex
+        copy.readerIndex = self.readerIndex
+
+        return copy
+    }
+}
+
+extension CompositeByteBuffer {
+    public var numberOfComponents: Int {
+        return Int(self.handle.count)
+    }
+
+    /// Appends the readable bytes of `buffer` as new
+    /// component(s). No bytes are copied unless `buffer`
+    /// isn't backed by Fuse's own memory storage.
+    public func addComponent(_ buffer: ByteBuffer) -> Self {
+        let result: Int32
+
+        switch buffer {
+        case let buffer as UnsafeByteBuffer:
+            if let pool = buffer.pool {
+                self._pools[ObjectIdentifier(pool)] = pool
+            }
+            result = fs_composite_buffer_add_component(&self.handle, &buffer.handle)
+        case let buffer as CompositeByteBuffer:
+            for (key, pool) in buffer._pools {
+                self._pools[key] = pool
+            }
+            result = fs_composite_buffer_add_composite(&self.handle, &buffer.handle)
+        default:
+            let copy = UnsafeByteBuffer(capacity: buffer.readableBytes)
+            _ = copy.write(bytes: buffer.getBytes(at: buffer.readerIndex, length: buffer.readableBytes))
+            result = fs_composite_buffer_add_component(&self.handle, &copy.handle)
+        }
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while adding component to composite byte buffer. Reason: \(message)")
+        }
+
+        return self
+    }
+
+    /// Releases components which have been fully read.
+    public func discardReadComponents() -> Self {
+        fs_composite_buffer_discard_read_components(&self.handle)
+        return self
+    }
+
+    /// Calls `body` with the readable bytes laid out as
+    /// `iovec`s, ready for a gathering `writev(2)`.
+    public func withUnsafeReadableIovecs<T>(maxCount: Int = 64, _ body: (UnsafeBufferPointer<iovec>) throws -> T) rethrows -> T {
+        var iovecs = [iovec](repeating: iovec(), count: maxCount)
+        var count  = UInt32()
+
+        fs_composite_buffer_iovec(&self.handle, &iovecs, UInt32(maxCount), &count)
+
+        return try iovecs.withUnsafeBufferPointer { pointer in
+            return try body(UnsafeBufferPointer(rebasing: pointer[0 ..< Int(count)]))
+        }
+    }
+
+    internal func getBytes(at offset: Int, length: Int, into pointer: UnsafeMutablePointer<UInt8>) -> Int32 {
+        return fs_composite_buffer_get_bytes(&self.handle, UInt32(offset), UInt32(length), pointer)
+    }
+}
+
+extension CompositeByteBuffer: ByteBufferReadable {
+    public var readable: Bool {
+        return self.writerIndex > self.readerIndex
+    }
+
+    public var readerIndex: Int {
+        get {
+            return Int(self.handle.reader_index)
+        }
+        set (value) {
+            self.handle.reader_index = UInt32(value)
+        }
+    }
+
+    public var readableBytes: Int {
+        return self.writerIndex - self.readerIndex
+    }
+
+    public func markReaderIndex() -> Self {
+        return self
+    }
+
+    public func resetReaderIndex() -> Self {
+        return self
+    }
+
+    public func discardReadBytes() -> Self {
+        return self.discardReadComponents()
+    }
+
+    public func getInt8(at offset: Int) -> Int8 {
+        var value  = Int8()
+        let result = fs_composite_buffer_get_int8(&self.handle, UInt32(offset), &value)
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while getting Int8 from composite byte buffer at offset: \(offset). Reason: \(message)")
+        }
+
+        return value
+    }
+
+    public func getInt16(at offset: Int, endianness: Endianness) -> Int16 {
+        var value = Int16()
+        let result: Int32
+
+        if endianness == .bigEndian {
+            result = fs_composite_buffer_get_int16_be(&self.handle, UInt32(offset), &value)
+        } else {
+            result = fs_composite_buffer_get_int16_le(&self.handle, UInt32(offset), &value)
+        }
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while getting Int16 from composite byte buffer at offset: \(offset). Reason: \(message)")
+        }
+
+        return value
+    }
+
+    public func getInt32(at offset: Int, endianness: Endianness) -> Int32 {
+        var value = Int32()
+        let result: Int32
+
+        if endianness == .bigEndian {
+            result = fs_composite_buffer_get_int32_be(&self.handle, UInt32(offset), &value)
+        } else {
+            result = fs_composite_buffer_get_int32_le(&self.handle, UInt32(offset), &value)
+        }
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while getting Int32 from composite byte buffer at offset: \(offset). Reason: \(message)")
+        }
+
+        return value
+    }
+
+    public func getInt64(at offset: Int, endianness: Endianness) -> Int64 {
+        var value = Int64()
+        let result: Int32
+
+        if endianness == .bigEndian {
+            result = fs_composite_buffer_get_int64_be(&self.handle, UInt32(offset), &value)
+        } else {
+            result = fs_composite_buffer_get_int64_le(&self.handle, UInt32(offset), &value)
+        }
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while getting Int64 from composite byte buffer at offset: \(offset). Reason: \(message)")
+        }
+
+        return value
+    }
+
+    public func getBytes(at offset: Int, length: Int) -> [UInt8] {
+        var value  = [UInt8](repeating: 0, count: length)
+        let result = fs_composite_buffer_get_bytes(&self.handle, UInt32(offset), UInt32(length), &value)
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while getting [UInt8] from composite byte buffer at offset: \(offset). Reason: \(message)")
+        }
+
+        return value
+    }
+
+    public func getSlice(at offset: Int, length: Int) -> ByteBuffer {
+        var slice  = fs_composite_buffer_t()
+        let result = fs_composite_buffer_get_slice(&self.handle, UInt32(offset), UInt32(length), &slice)
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while getting slice from composite byte buffer at offset: \(offset). Reason: \(message)")
+        }
+
+        return CompositeByteBuffer(handle: slice, pools: self._pools)
+    }
+
+    public func getString(at offset: Int, length: Int) -> String? {
+        var ascii  = Int32()
+        var result = fs_composite_buffer_validate_utf8(&self.handle, UInt32(offset), UInt32(length), &ascii)
+        
+        guard result != FS_ERR_DATA else {
+            return nil
+        }
+        
+        // Components aren't contiguous, so they're gathered first
+        let bytes = UnsafeMutablePointer<UInt8>.allocate(capacity: max(length, 1))
+        
+        defer {
+            bytes.deallocate()
+        }
+        
+        if result == FS_OKAY {
+            result = self.getBytes(at: offset, length: length, into: bytes)
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while getting String from composite byte buffer at offset: \(offset). Reason: \(message)")
+        }
+        
+        return makeString(UnsafeBufferPointer(start: bytes, count: length), ascii: ascii == FS_YES)
+    }
+    
+    public func getInt16s(at offset: Int, count: Int, endianness: Endianness) -> [Int16] {
+        return self.getIntegers(at: offset, count: count, endianness: endianness)
+    }
+    
+    public func getInt32s(at offset: Int, count: Int, endianness: Endianness) -> [Int32] {
+        return self.getIntegers(at: offset, count: count, endianness: endianness)
+    }
+    
+    public func getInt64s(at offset: Int, count: Int, endianness: Endianness) -> [Int64] {
+        return self.getIntegers(at: offset, count: count, endianness: endianness)
+    }
+    
+    // Arrays are gathered as raw bytes and then swapped
+    // in place, there's no C bulk codec spanning components
+    private func getIntegers<T: FixedWidthInteger>(at offset: Int, count: Int, endianness: Endianness) -> [T] {
+        var value  = [T](repeating: 0, count: count)
+        let result = value.withUnsafeMutableBytes { bytes in
+            return fs_composite_buffer_get_bytes(&self.handle, UInt32(offset), UInt32(bytes.count), bytes.baseAddress?.assumingMemoryBound(to: UInt8.self))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while getting [\(T.self)] from composite byte buffer at offset: \(offset). Reason: \(message)")
+        }
+        
+        for i in 0 ..< count {
+            value[i] = endianness == .bigEndian ? T(bigEndian: value[i]) : T(littleEndian: value[i])
+        }
+        
+        return value
+    }
+    
+    public func index(of value: UInt8, from: Int, to: Int) -> Int? {
+        var found  = UInt32()
+        let result = fs_composite_buffer_index_of(&self.handle, UInt32(from), UInt32(to), value, &found)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while searching UInt8 in composite byte buffer from offset: \(from). Reason: \(message)")
+        }
+        
+        return found == UInt32.max ? nil : Int(found)
+    }
+    
+    public func index(of sequence: [UInt8], from: Int, to: Int) -> Int? {
+        var found  = UInt32()
+        let result = fs_composite_buffer_index_of_sequence(&self.handle, UInt32(from), UInt32(to), sequence, UInt32(sequence.count), &found)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while searching [UInt8] in composite byte buffer from offset: \(from). Reason: \(message)")
+        }
+        
+        return found == UInt32.max ? nil : Int(found)
+    }
+    
+    public func forEachByte(from: Int, to: Int, _ body: (UInt8) -> Bool) -> Int? {
+        var found  = UInt32()
+        let result = withByteVisitor(body) { visitor, context in
+            return fs_composite_buffer_for_each_byte(&self.handle, UInt32(from), UInt32(to), visitor, context, &found)
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while visiting bytes of composite byte buffer from offset: \(from). Reason: \(message)")
+        }
+        
+        return found == UInt32.max ? nil : Int(found)
+    }
+    
+    public func crc32c(at offset: Int, length: Int, seed: UInt32) -> UInt32 {
+        var value  = UInt32()
+        let result = fs_composite_buffer_crc32c(&self.handle, UInt32(offset), UInt32(length), seed, &value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while computing CRC-32C of composite byte buffer at offset: \(offset). Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func xxHash64(at offset: Int, length: Int, seed: UInt64) -> UInt64 {
+        var value  = UInt64()
+        let result = fs_composite_buffer_xxhash64(&self.handle, UInt32(offset), UInt32(length), seed, &value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while computing xxHash64 of composite byte buffer at offset: \(offset). Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func readInt8() -> Int8 {
+        var value  = Int8()
+        let result = fs_composite_buffer_read_int8(&self.handle, &value)
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading Int8 from composite byte buffer. Reason: \(message)")
+        }
+
+        return value
+    }
+
+    public func readInt16(endianness: Endianness) -> Int16 {
+        var value = Int16()
+        let result: Int32
+
+        if endianness == .bigEndian {
+            result = fs_composite_buffer_read_int16_be(&self.handle, &value)
+        } else {
+            result = fs_composite_buffer_read_int16_le(&self.handle, &value)
+        }
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading Int16 from composite byte buffer. Reason: \(message)")
+        }
+
+        return value
+    }
+
+    public func readInt32(endianness: Endianness) -> Int32 {
+        var value = Int32()
+        let result: Int32
+
+        if endianness == .bigEndian {
+            result = fs_composite_buffer_read_int32_be(&self.handle, &value)
+        } else {
+            result = fs_composite_buffer_read_int32_le(&self.handle, &value)
+        }
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading Int32 from composite byte buffer. Reason: \(message)")
+        }
+
+        return value
+    }
+
+    public func readInt64(endianness: Endianness) -> Int64 {
+        var value = Int64()
+        let result: Int32
+
+        if endianness == .bigEndian {
+            result = fs_composite_buffer_read_int64_be(&self.handle, &value)
+        } else {
+            result = fs_composite_buffer_read_int64_le(&self.handle, &value)
+        }
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading Int64 from composite byte buffer. Reason: \(message)")
+        }
+
+        return value
+    }
+
+    public func readBytes(_ length: Int) -> [UInt8] {
+        var value  = [UInt8](repeating: 0, count: length)
+        let result = fs_composite_buffer_read_bytes(&self.handle, UInt32(length), &value)
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading [UInt8] from composite byte buffer. Reason: \(message)")
+        }
+
+        return value
+    }
+
+    public func readSlice(_ length: Int) -> ByteBuffer {
+        var slice  = fs_composite_buffer_t()
+        let result = fs_composite_buffer_read_slice(&self.handle, UInt32(length), &slice)
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading slice from composite byte buffer. Reason: \(message)")
+        }
+
+        return CompositeByteBuffer(handle: slice, pools: self._pools)
+    }
+    
+    public func readString(length: Int) -> String? {
+        guard let value = self.getString(at: self.readerIndex, length: length) else {
+            return nil
+        }
+        
+        self.readerIndex += length
+        return value
+    }
+    
+    public func readInt16s(count: Int, endianness: Endianness) -> [Int16] {
+        let value: [Int16] = self.getIntegers(at: self.readerIndex, count: count, endianness: endianness)
+        self.readerIndex += count * MemoryLayout<Int16>.size
+        
+        return value
+    }
+    
+    public func readInt32s(count: Int, endianness: Endianness) -> [Int32] {
+        let value: [Int32] = self.getIntegers(at: self.readerIndex, count: count, endianness: endianness)
+        self.readerIndex += count * MemoryLayout<Int32>.size
+        
+        return value
+    }
+    
+    public func readInt64s(count: Int, endianness: Endianness) -> [Int64] {
+        let value: [Int64] = self.getIntegers(at: self.readerIndex, count: count, endianness: endianness)
+        self.readerIndex += count * MemoryLayout<Int64>.size
+        
+        return value
+    }
+    
+    public func readVarint32() -> UInt32 {
+        var value  = UInt32()
+        let result = fs_composite_buffer_read_varint32(&self.handle, &value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading UInt32 varint from composite byte buffer. Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func readVarint64() -> UInt64 {
+        var value  = UInt64()
+        let result = fs_composite_buffer_read_varint64(&self.handle, &value)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while reading UInt64 varint from composite byte buffer. Reason: \(message)")
+        }
+        
+        return value
+    }
+    
+    public func readZigZag32() -> Int32 {
+        return fs_zigzag_decode32(self.readVarint32())
+    }
+    
+    public func readZigZag64() -> Int64 {
+        return fs_zigzag_decode64(self.readVarint64())
+    }
+    
+    public func readVarint32s(count: Int) -> [UInt32] {
+        return (0 ..< count).map { _ in self.readVarint32() }
+    }
+    
+    public func readVarint64s(count: Int) -> [UInt64] {
+        return (0 ..< count).map { _ in self.readVarint64() }
+    }
+}
+
+extension CompositeByteBuffer: ByteBufferWritable {
+    public var writable: Bool {
+        return true
+    }
+
+    public var writerIndex: Int {
+        return Int(self.handle.writer_index)
+    }
+
+    public var writableBytes: Int {
+        return Int(UInt32.max) - self.writerIndex
+    }
+
+    public func markWriterIndex() -> Self {
+        return self
+    }
+
+    public func resetWriterIndex() -> Self {
+        return self
+    }
+
+    public func set(int8 value: Int8, at offset: Int) -> Self {
+        let result = fs_composite_buffer_set_int8(&self.handle, UInt32(offset), value)
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while setting Int8 to composite byte buffer. Reason: \(message)")
+        }
+
+        return self
+    }
+
+    public func set(int16 value: Int16, at offset: Int, endianness: Endianness = .bigEndian) -> Self {
+        let result: Int32
+
+        if endianness == .bigEndian {
+            result = fs_composite_buffer_set_int16_be(&self.handle, UInt32(offset), value)
+        } else {
+            result = fs_composite_buffer_set_int16_le(&self.handle, UInt32(offset), value)
+        }
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while setting Int16 to composite byte buffer. Reason: \(message)")
+        }
+
+        return self
+    }
+
+    public func set(int32 value: Int32, at offset: Int, endianness: Endianness = .bigEndian) -> Self {
+        let result: Int32
+
+        if endianness == .bigEndian {
+            result = fs_composite_buffer_set_int32_be(&self.handle, UInt32(offset), value)
+        } else {
+            result = fs_composite_buffer_set_int32_le(&self.handle, UInt32(offset), value)
+        }
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while setting Int32 to composite byte buffer. Reason: \(message)")
+        }
+
+        return self
+    }
+
+    public func set(int64 value: Int64, at offset: Int, endianness: Endianness = .bigEndian) -> Self {
+        let result: Int32
+
+        if endianness == .bigEndian {
+            result = fs_composite_buffer_set_int64_be(&self.handle, UInt32(offset), value)
+        } else {
+            result = fs_composite_buffer_set_int64_le(&self.handle, UInt32(offset), value)
+        }
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while setting Int64 to composite byte buffer. Reason: \(message)")
+        }
+
+        return self
+    }
+
+    public func set(bytes value: [UInt8], at offset: Int) -> Self {
+        let result = fs_composite_buffer_set_bytes(&self.handle, UInt32(value.count), UInt32(offset), value)
+
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while setting [UInt8] to composite byte buffer. Reason: \(message)")
+        }
+
+        return self
+    }
+
+    public func set(int16s value: [Int16], at offset: Int, endianness: Endianness = .bigEndian) -> Self {
+        return self.setIntegers(value, at: offset, endianness: endianness)
+    }
+    
+    public func set(int32s value: [Int32], at offset: Int, endianness: Endianness = .bigEndian) -> Self {
+        return self.setIntegers(value, at: offset, endianness: endianness)
+    }
+    
+    public func set(int64s value: [Int64], at offset: Int, endianness: Endianness = .bigEndian) -> Self {
+        return self.setIntegers(value, at: offset, endianness: endianness)
+    }
+    
+    private func setIntegers<T: FixedWidthInteger>(_ value: [T], at offset: Int, endianness: Endianness) -> Self {
+        let encoded = value.map { endianness == .bigEndian ? $0.bigEndian : $0.littleEndian }
+        let result  = encoded.withUnsafeBytes { bytes in
+            return fs_composite_buffer_set_bytes(&self.handle, UInt32(bytes.count), UInt32(offset), bytes.baseAddress?.assumingMemoryBound(to: UInt8.self))
+        }
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while setting [\(T.self)] to composite byte buffer. Reason: \(message)")
+        }
+        
+        return self
+    }
+    
+    // Primitive writes land in a small component of their own,
+    // prefer composing buffers which are already encoded.
+
+    public func write(int8 value: Int8) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: 1, pool: .default).write(int8: value))
+    }
+
+    public func write(int16 value: Int16, endianness: Endianness = .bigEndian) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: 2, pool: .default).write(int16: value, endianness: endianness))
+    }
+
+    public func write(int32 value: Int32, endianness: Endianness = .bigEndian) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: 4, pool: .default).write(int32: value, endianness: endianness))
+    }
+
+    public func write(int64 value: Int64, endianness: Endianness = .bigEndian) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: 8, pool: .default).write(int64: value, endianness: endianness))
+    }
+
+    public func write(bytes value: [UInt8]) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: value.count, pool: .default).write(bytes: value))
+    }
+
+    public func write(bytes value: ByteBuffer) -> Self {
+        return self.addComponent(value)
+    }
+    
+    public func write(string value: String) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: value.utf8.count, pool: .default).write(string: value))
+    }
+    
+    public func write(int16s value: [Int16], endianness: Endianness = .bigEndian) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: value.count * 2, pool: .default).write(int16s: value, endianness: endianness))
+    }
+    
+    public func write(int32s value: [Int32], endianness: Endianness = .bigEndian) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: value.count * 4, pool: .default).write(int32s: value, endianness: endianness))
+    }
+    
+    public func write(int64s value: [Int64], endianness: Endianness = .bigEndian) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: value.count * 8, pool: .default).write(int64s: value, endianness: endianness))
+    }
+    
+    public func write(varint32 value: UInt32) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: 5, pool: .default).write(varint32: value))
+    }
+    
+    public func write(varint64 value: UInt64) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: 10, pool: .default).write(varint64: value))
+    }
+    
+    public func write(zigzag32 value: Int32) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: 5, pool: .default).write(zigzag32: value))
+    }
+    
+    public func write(zigzag64 value: Int64) -> Self {
+        return self.addComponent(UnsafeByteBuffer(capacity: 10, pool: .default).write(zigzag64: value))
+    }
+}
+
+fileprivate let kDefaultComponents: Int = 4
@@ -0,0 +1,116 @@
+import Foundation
+
+/// Compresses every outbound buffer into one block frame: the
+/// block length and the uncompressed length, both as 4 byte big
+/// endian fields, then the LZ4 block itself. Buffers that don't
+/// shrink go out as they are, with both lengths equal.
+public final class BlockCompressionHandler {
+    private let _pool: ByteBufferPool?
+    private let _minLength: Int
+    
+    /// - parameter minLength: shorter buffers aren't worth compressing
+    /// - parameter pool: frames and scratch space are taken from it
+    public init(minLength: Int = 64, pool: ByteBufferPool? = .default) {
+        self._pool      = pool
+        self._minLength = minLength
+    }
+}
+
+extension BlockCompressionHandler: TypedOutboundChannelHandler {
+    public typealias OutboundIn = ByteBuffer
+    
+    public func channel(_ context: ChannelHandlerContext, write buffer: ByteBuffer, promise: EventLoopPromise<Void>) throws {
+        let length = buffer.readableBytes
+        
+        guard length >= self._minLength else {
+            return self.store(buffer, context, promise)
+        }
+        
+        // The codec works on contiguous bytes, components are gathered
+        let source = buffer as? UnsafeByteBuffer ?? UnsafeByteBuffer(capacity: length, pool: self._pool).write(bytes: buffer)
+        let frame  = UnsafeByteBuffer(capacity: kBlockHeaderLength + length + length / 255 + 16, pool: self._pool)
+            .write(int32: 0)
+            .write(int32: Int32(length))
+        
+        let compressed = frame.write(compressing: source, length: length, pool: self._pool)
+        
+        guard compressed < length else {
+            // Handed on untouched, the frame goes back to the pool
+            source.readerIndex -= length
+            return self.store(buffer, context, promise)
+        }
+        
+        context.write(frame.set(int32: Int32(compressed), at: 0), promise: promise)
+    }
+    
+    private func store(_ buffer: ByteBuffer, _ context: ChannelHandlerContext, _ promise: EventLoopPromise<Void>) {
+        let header = UnsafeByteBuffer(capacity: kBlockHeaderLength, pool: self._pool)
+            .write(int32: Int32(buffer.readableBytes))
+            .write(int32: Int32(buffer.readableBytes))
+        
+        // Chained, stored payloads are never copied
+        context.write(CompositeByteBuffer(capacity: 2)
+            .addComponent(header)
+            .addComponent(buffer), promise: promise)
+    }
+}
+
+/// Splits the inbound stream into the block frames written by
+/// `BlockCompressionHandler`, firing each one decompressed into
+/// a buffer of its own. Goes in a `ByteToMessageHandler`, which
+/// keeps fragmented frames until they're whole.
+public final class BlockDecompressor: ByteToMessageDecoder {
+    private let _pool: ByteBufferPool?
+    private let _maxLength: Int
+    
+    /// - parameter maxLength: longest uncompressed frame accepted
+    /// - parameter pool: decompressed frames are taken from it
+    public init(maxLength: Int = 8 * 1024 * 1024, pool: ByteBufferPool? = .default) {
+        self._pool      = pool
+        self._maxLength = maxLength
+    }
+    
+    public func decode(_ buffer: inout ByteBuffer) throws -> ByteBuffer? {
+        guard buffer.readableBytes >= kBlockHeaderLength else {
+            return nil
+        }
+        
+        let compressed   = Int(UInt32(bitPattern: buffer.getInt32(at: buffer.readerIndex,     endianness: .bigEndian)))
+        let decompressed = Int(UInt32(bitPattern: buffer.getInt32(at: buffer.readerIndex + 4, endianness: .bigEndian)))
+        
+        guard decompressed <= self._maxLength else {
+            throw DecoderError.frameTooLong(decompressed)
+        }
+        
+        // Blocks are only ever sent when they're shorter
+        guard compressed <= decompressed else {
+            throw DecoderError.invalidLengthField(Int64(compressed))
+        }
+        
+        guard buffer.readableBytes >= kBlockHeaderLength + compressed else {
+            return nil
+        }
+        
+        buffer.readerIndex += kBlockHeaderLength
+        
+        guard compressed < decompressed else {
+            return buffer.readSlice(compressed)
+        }
+        
+        let block  = buffer.readSlice(compressed)
+        let source = block as? UnsafeByteBuffer ?? UnsafeByteBuffer(capacity: compressed, pool: self._pool).write(bytes: block)
+        let frame  = UnsafeByteBuffer(capacity: decompressed, pool: self._pool)
+        
+        guard frame.write(decompressing: source, length: compressed, decompressedLength: decompressed) else {
+            throw CompressionError.malformedBlock
+        }
+        
+        return frame
+    }
+}
+
+public enum CompressionError: Error {
+    case malformedBlock
+}
+
+fileprivate let kBlockHeaderLength: Int = 8
@@ -0,0 +1,115 @@
+import Foundation
+
+/// Splits a stream of bytes into frames.
+public protocol ByteToMessageDecoder: class {
+    /// Reads one frame off the readable bytes of `buffer`. Returns
+    /// nil, leaving `buffer` alone, until a whole frame is there.
+    func decode(_ buffer: inout ByteBuffer) throws -> ByteBuffer?
+}
+
+/// Inbound handler accumulating the bytes read into one
+/// buffer, firing every frame `decoder` finds in them as
+/// a slice of that buffer, so frames are never copied.
+public final class ByteToMessageHandler {
+    public enum Cumulation {
+        /// Bytes are appended to one reusable `UnsafeByteBuffer`
+        case merge
+        /// Buffers read are chained as `CompositeByteBuffer` components
+        case composite
+    }
+    
+    private let _decoder: ByteToMessageDecoder
+    private let _cumulation: Cumulation
+    
+    private var _buffer: ByteBuffer?
+    
+    public init(decoder: ByteToMessageDecoder, cumulation: Cumulation = .merge) {
+        self._decoder    = decoder
+        self._cumulation = cumulation
+    }
+}
+
+extension ByteToMessageHandler {
+    public var decoder: ByteToMessageDecoder {
+        return self._decoder
+    }
+}
+
+extension ByteToMessageHandler {
+    private func cumulate(_ data: ChannelPayload) throws -> ByteBuffer {
+        switch (self._cumulation, data) {
+        case (.merge, .message(let bytes as ArraySlice<UInt8>)):
+            let buffer = self._buffer as? UnsafeByteBuffer ?? UnsafeByteBuffer(capacity: kDefaultCumulationCapacity)
+            self._buffer = buffer.write(bytes: bytes)
+        case (.merge, .bytes(let bytes)):
+            let buffer = self._buffer as? UnsafeByteBuffer ?? UnsafeByteBuffer(capacity: max(bytes.readableBytes, kDefaultCumulationCapacity))
+            self._buffer = buffer.write(bytes: bytes)
+        case (.composite, .message(let bytes as ArraySlice<UInt8>)):
+            let buffer = self._buffer as? CompositeByteBuffer ?? CompositeByteBuffer()
+            self._buffer = bytes.isEmpty ? buffer : buffer.addComponent(UnsafeByteBuffer(capacity: bytes.count).write(bytes: bytes))
+        case (.composite, .bytes(let bytes)):
+            let buffer = self._buffer as? CompositeByteBuffer ?? CompositeByteBuffer()
+            self._buffer = buffer.addComponent(bytes)
+        default:
+            throw DecoderError.notSupportedInboundDataType
+        }
+        
+        return self._buffer!
+    }
+    
+    /// Gives back the space taken by decoded frames, once per
+    /// read instead of once per frame. Storage still seen by
+    /// frames in flight is left to them, never overwritten.
+    private func reclaim() {
+        switch self._buffer {
+        case let buffer as UnsafeByteBuffer where buffer.readerIndex > 0:
+            _ = buffer.discardReadBytes()
+        case let buffer as CompositeByteBuffer:
+            _ = buffer.discardReadComponents()
+        default:
+            break
+        }
+    }
+}
+
+extension ByteToMessageHandler: InboundChannelHandler {
+    public func handler(removed context: ChannelHandlerContext) throws {
+        // Hand whatever wasn't a whole frame on to the next handler
+        if let buffer = self._buffer, buffer.readable {
+            context.fireChannelRead(buffer.readSlice(buffer.readableBytes))
+        }
+        
+        self._buffer = nil
+    }
+    
+    public func channel(inactive context: ChannelHandlerContext) throws {
+        self._buffer = nil
+        context.fireChannelInactive()
+    }
+    
+    public func channel(_ context: ChannelHandlerContext, read data: ChannelPayload) throws {
+        var buffer = try self.cumulate(data)
+        
+        defer {
+            self.reclaim()
+        }
+        
+        do {
+            while buffer.readable, let frame = try self._decoder.decode(&buffer) {
+                context.fireChannelRead(frame)
+            }
+        } catch let error {
+            // Framing is lost, drop what's been read so far
+            buffer.readerIndex = buffer.writerIndex
+            throw error
+        }
+    }
+}
+
+public enum DecoderError: Error {
+    case frameTooLong(_: Int)
+    case invalidLengthField(_: Int64)
+    case notSupportedInboundDataType
+}
+
+fileprivate let kDefaultCumulationCapacity: Int = 4 * 1024
@@ -0,0 +1,50 @@
+import Foundation
+
+/// Checks and strips the CRC-32C trailing every inbound frame,
+/// and trails every outbound buffer with its own. Inbound frames
+/// must be whole, so it goes right after a frame decoder.
+public final class CRC32CHandler {
+    private let _endianness: Endianness
+    
+    public init(endianness: Endianness = .bigEndian) {
+        self._endianness = endianness
+    }
+}
+
+extension CRC32CHandler: TypedInboundChannelHandler, TypedOutboundChannelHandler {
+    public typealias InboundIn  = ByteBuffer
+    public typealias OutboundIn = ByteBuffer
+    
+    public func channel(_ context: ChannelHandlerContext, read frame: ByteBuffer) throws {
+        guard frame.readableBytes >= kChecksumLength else {
+            throw ChecksumError.frameTooShort(frame.readableBytes)
+        }
+        
+        let length   = frame.readableBytes - kChecksumLength
+        let expected = UInt32(bitPattern: frame.getInt32(at: frame.readerIndex + length, endianness: self._endianness))
+        let actual   = frame.crc32c(at: frame.readerIndex, length: length, seed: 0)
+        
+        guard expected == actual else {
+            throw ChecksumError.mismatch(expected: expected, actual: actual)
+        }
+        
+        context.fireChannelRead(frame.readSlice(length))
+    }
+    
+    public func channel(_ context: ChannelHandlerContext, write buffer: ByteBuffer, promise: EventLoopPromise<Void>) throws {
+        let trailer = UnsafeByteBuffer(capacity: kChecksumLength)
+            .write(int32: Int32(bitPattern: buffer.crc32c()), endianness: self._endianness)
+        
+        // Chained, the payload itself is never copied
+        context.write(CompositeByteBuffer(capacity: 2)
+            .addComponent(buffer)
+            .addComponent(trailer), promise: promise)
+    }
+}
+
+public enum ChecksumError: Error {
+    case mismatch(expected: UInt32, actual: UInt32)
+    case frameTooShort(_: Int)
+}
+
+fileprivate let kChecksumLength: Int = 4
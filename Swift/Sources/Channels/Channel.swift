@@ -1,14 +1,49 @@
 import Foundation
+import CFuse
 
 typealias SocketFactory = (Channel) -> Socket
 
 public final class Channel {
     private var _socket: Socket!
+    private var _options: ChannelOptions
     private var _pipeline: ChannelPipeline!
+    private let _eventLoop: EventLoop
+    private var _connecting: EventLoopPromise<Void>?
     
-    internal init(socket factory: SocketFactory) {
-        self._pipeline = ChannelPipeline(channel: self)
-        self._socket   = factory(self)
+    internal init(eventLoop: EventLoop = EventLoopGroup.default.next(), options: ChannelOptions = ChannelOptions(), socket factory: SocketFactory) {
+        self._options   = options
+        self._eventLoop = eventLoop
+        self._pipeline  = ChannelPipeline(channel: self)
+        self._socket    = factory(self)
+        
+        eventLoop.register(channel: self)
+    }
+    
+    deinit {
+        // Nothing else keeps an open channel alive, its socket
+        // is closed with it rather than left to the loop
+        let socket = self._socket!
+        
+        self._eventLoop.execute {
+            try? socket.close()
+        }
+        
+        self._eventLoop.deregister(channel: self)
+    }
+}
+
+extension Channel {
+    /// Runs every event of this channel, for as long as it lives.
+    public var eventLoop: EventLoop {
+        return self._eventLoop
+    }
+}
+
+extension Channel {
+    /// What the channel was created with. Changing
+    /// them afterwards doesn't affect the socket.
+    public var options: ChannelOptions {
+        return self._options
     }
 }
 
@@ -25,44 +60,144 @@ extension Channel {
 }
 
 extension Channel {
-    public func close() {
-        self.pipeline.close()
+    /// Completed when the socket opens, or fails to. Sockets only
+    /// open later on the loop, never while they're connecting.
+    internal func connecting(promise: EventLoopPromise<Void>) {
+        self._connecting = promise
+    }
+}
+
+/// Operations return a future on the channel's loop. Writes are
+/// done once their bytes have been sent, and fail if the socket
+/// closes first. Fire and forget callers pass the void promise
+/// instead and nothing gets allocated for them.
+extension Channel {
+    /// Done once the connection is open, not when it's started.
+    @discardableResult
+    public func connect(to host: String, port: Int) -> EventLoopFuture<Void> {
+        let promise = self._eventLoop.newPromise(of: Void.self)
+        self.pipeline.connect(to: host, port: port, promise: promise)
+        return promise.futureResult
+    }
+    
+    public func connect(to host: String, port: Int, promise: EventLoopPromise<Void>) {
+        self.pipeline.connect(to: host, port: port, promise: promise)
+    }
+    
+    @discardableResult
+    public func close() -> EventLoopFuture<Void> {
+        let promise = self._eventLoop.newPromise(of: Void.self)
+        self.pipeline.close(promise: promise)
+        return promise.futureResult
+    }
+    
+    public func close(promise: EventLoopPromise<Void>) {
+        self.pipeline.close(promise: promise)
+    }
+    
+    /// Queues `data`, it's only sent once flushed.
+    @discardableResult
+    public func write(_ data: ChannelPayload) -> EventLoopFuture<Void> {
+        let promise = self._eventLoop.newPromise(of: Void.self)
+        self.pipeline.write(data, promise: promise)
+        return promise.futureResult
     }
     
-    public func write(_ data: Any) -> Channel {
-        self.pipeline.write(data)
+    public func write(_ data: ChannelPayload, promise: EventLoopPromise<Void>) {
+        self.pipeline.write(data, promise: promise)
+    }
+    
+    @discardableResult
+    public func write(_ bytes: ByteBuffer) -> EventLoopFuture<Void> {
+        return self.write(.bytes(bytes))
+    }
+    
+    public func write(_ bytes: ByteBuffer, promise: EventLoopPromise<Void>) {
+        self.write(.bytes(bytes), promise: promise)
+    }
+    
+    public func flush() -> Channel {
+        self.pipeline.flush()
         return self
     }
+    
+    @discardableResult
+    public func writeAndFlush(_ data: ChannelPayload) -> EventLoopFuture<Void> {
+        let promise = self._eventLoop.newPromise(of: Void.self)
+        self.pipeline.writeAndFlush(data, promise: promise)
+        return promise.futureResult
+    }
+    
+    public func writeAndFlush(_ data: ChannelPayload, promise: EventLoopPromise<Void>) {
+        self.pipeline.writeAndFlush(data, promise: promise)
+    }
+    
+    @discardableResult
+    public func writeAndFlush(_ bytes: ByteBuffer) -> EventLoopFuture<Void> {
+        return self.writeAndFlush(.bytes(bytes))
+    }
+    
+    public func writeAndFlush(_ bytes: ByteBuffer, promise: EventLoopPromise<Void>) {
+        self.writeAndFlush(.bytes(bytes), promise: promise)
+    }
+    
+    /// False while more bytes than the high water mark wait
+    /// to be sent, until they're back under the low one.
+    public var isWritable: Bool {
+        return self.socket.isWritable
+    }
 }
 
 extension Channel: SocketDelegate {
     internal func socket(opened socket: Socket) {
+        self._connecting?.succeed()
+        self._connecting = nil
+        
         self.pipeline.fireChannelActive()
     }
     
     internal func socket(closed socket: Socket) {
+        // Closed before it ever opened
+        self._connecting?.fail(SocketError.closed)
+        self._connecting = nil
+        
         self.pipeline.fireChannelInactive()
     }
     
     internal func socket(_ socket: Socket, hasCaughtError error: Error) {
+        self._connecting?.fail(error)
+        self._connecting = nil
+        
         self.pipeline.fireError(error)
     }
     
-    internal func socket(_ socket: Socket, hasBytesAvailable bytes: ArraySlice<UInt8>) {
-        self.pipeline.fireChannelRead(bytes)
+    internal func socket(_ socket: Socket, hasBytesAvailable bytes: ByteBuffer) {
+        self.pipeline.fireChannelRead(.bytes(bytes))
+    }
+    
+    internal func socket(writabilityChanged socket: Socket) {
+        self.pipeline.fireChannelWritabilityChanged()
     }
 }
 
 internal protocol Socket: class {
     var delegate: SocketDelegate? { get set }
+    var isWritable: Bool { get }
     
-    init(queue: DispatchQueue)
+    init(eventLoop: EventLoop, options: ChannelOptions)
     
     func close() throws
     func connect(to host: String, port: Int) throws
     
     func read() throws
-    func write(data: Any) throws
+    func write(data: ByteBuffer, promise: EventLoopPromise<Void>) throws
+    func flush() throws
+}
+
+extension Socket {
+    internal func write(data: ByteBuffer) throws {
+        try self.write(data: data, promise: .void)
+    }
 }
 
 internal protocol SocketDelegate: class {
@@ -70,16 +205,79 @@ internal protocol SocketDelegate: class {
     func socket(closed socket: Socket)
     
     func socket(_ socket: Socket, hasCaughtError error: Error)
-    func socket(_ socket: Socket, hasBytesAvailable bytes: ArraySlice<UInt8>)
+    func socket(_ socket: Socket, hasBytesAvailable bytes: ByteBuffer)
+    func socket(writabilityChanged socket: Socket)
+}
+
+/// Promises of queued writes, in the order their bytes were
+/// queued. Each one is completed once the bytes sent so far
+/// reach the end of its buffer. Void promises take no room.
+internal final class WritePromiseQueue {
+    private var _promises: [(end: Int, promise: EventLoopPromise<Void>)] = []
+    private var _queued: Int = 0
+    private var _sent: Int = 0
+    
+    internal func append(_ count: Int, promise: EventLoopPromise<Void>) {
+        self._queued += count
+        
+        guard !promise.isVoid else {
+            return
+        }
+        
+        // Nothing ahead of an empty write, it's done already
+        guard self._queued > self._sent else {
+            return promise.succeed()
+        }
+        
+        self._promises.append((self._queued, promise))
+    }
+    
+    /// Callbacks may queue writes again, promises are taken
+    /// off before they're completed.
+    internal func sent(_ count: Int) {
+        self._sent += count
+        
+        var done = 0
+        
+        while done < self._promises.count, self._promises[done].end <= self._sent {
+            done += 1
+        }
+        
+        guard done > 0 else {
+            return
+        }
+        
+        let completed = self._promises[0 ..< done]
+        self._promises.removeFirst(done)
+        
+        completed.forEach { $0.promise.succeed() }
+    }
+    
+    /// For bytes that will never be sent now.
+    internal func fail(_ error: Error) {
+        let failed = self._promises
+        self._promises.removeAll()
+        
+        failed.forEach { $0.promise.fail(error) }
+    }
 }
 
 internal final class TCPSocket: NSObject, Socket {
     private var _direct: Bool
-    private var _rcvbuf: [UInt8]
-    private var _sndbuf: ByteBuffer
+    private var _rcvbuf: UnsafeByteBuffer
+    private var _allocator: RecvBufferAllocator
+    private let _maxMessagesPerRead: Int
+    private var _sndbuf: CompositeByteBuffer
+    private let _promises: WritePromiseQueue
+    private var _flushed: Int
+    private var _writable: Bool
+    private let _lowWaterMark: Int
+    private let _highWaterMark: Int
+    private var _descriptor: Int32
+    private let _socketOptions: fs_socket_options_t
     
     unowned
-    private let _queue: DispatchQueue
+    private let _eventLoop: EventLoop
     
     private var _input:  InputStream?
     private var _output: OutputStream?
@@ -87,13 +285,22 @@ internal final class TCPSocket: NSObject, Socket {
     weak
     private var _delegate: SocketDelegate?
     
-    internal required init(queue: DispatchQueue) {
-        self._queue  = queue
+    internal required init(eventLoop: EventLoop, options: ChannelOptions = ChannelOptions()) {
+        self._eventLoop = eventLoop
         self._direct = false
-        self._rcvbuf = [UInt8](repeating: 0,
-               count: kDefaultRcvBufferCapacity)
-        self._sndbuf = UnsafeByteBuffer(
-            capacity: kDefaultSndBufferCapacity)
+        self._allocator = options.recvAllocator
+        self._maxMessagesPerRead = options.maxMessagesPerRead
+        self._flushed  = 0
+        self._writable = true
+        self._promises = WritePromiseQueue()
+        self._lowWaterMark  = options.writeBufferLowWaterMark
+        self._highWaterMark = options.writeBufferHighWaterMark
+        self._descriptor    = -1
+        self._socketOptions = options.socketOptions
+        self._rcvbuf = UnsafeByteBuffer(
+            capacity: kDefaultRcvBufferCapacity, pool: .default)
+        self._sndbuf = CompositeByteBuffer(
+            capacity: kDefaultSndBufferComponents)
     }
 }
 
@@ -106,10 +313,17 @@ extension TCPSocket {
             self._delegate = value
         }
     }
+    
+    internal var isWritable: Bool {
+        return self._writable
+    }
 }
 
 extension TCPSocket {
     internal func close() throws {
+        // Queued bytes are never sent now
+        self._promises.fail(SocketError.closed)
+        
         guard let input = self._input, let output = self._output else {
             throw ChannelError.failedToGetStreams
         }
@@ -146,8 +360,8 @@ extension TCPSocket {
         input.delegate = self
         output.delegate = self
         
-        CFReadStreamSetDispatchQueue (self._input,  self._queue)
-        CFWriteStreamSetDispatchQueue(self._output, self._queue)
+        CFReadStreamSetDispatchQueue (self._input,  self._eventLoop.streamQueue)
+        CFWriteStreamSetDispatchQueue(self._output, self._eventLoop.streamQueue)
         
         input .open()
         output.open()
@@ -160,62 +374,220 @@ extension TCPSocket {
             throw SocketError.notInitialized
         }
         
-        let available = input.read(&self._rcvbuf, maxLength: kDefaultRcvBufferCapacity)
+        // Drains the stream while reads keep filling the guess,
+        // so a fast link costs one event for several reads
+        for _ in 0 ..< self._maxMessagesPerRead {
+            let capacity = self._allocator.nextCapacity
+            let rcvbuf   = self.prepareRcvBuffer(capacity)
+            
+            let available = rcvbuf.withUnsafeMutableWritableBytes { bytes in
+                input.read(bytes.baseAddress!.assumingMemoryBound(to: UInt8.self), maxLength: capacity)
+            }
+            
+            if  available == -1 {
+                throw SocketError.ioError(input.streamError)
+            } else if available == 0 {
+                break
+            }
+            
+            self._allocator.record(available)
+            
+            rcvbuf.writerIndex += available
+            // Handed on as a slice of the storage just read into,
+            // it keeps those bytes alive as long as it's around
+            self._delegate?.socket(self, hasBytesAvailable: rcvbuf.readSlice(available))
+            
+            // Closed by a handler while it had the bytes
+            guard input.streamStatus != .closed else {
+                break
+            }
+            
+            guard available == capacity, input.hasBytesAvailable else {
+                break
+            }
+        }
+    }
+    
+    /// Reuses the receive buffer from its start once no slice
+    /// sees it anymore, and swaps it for a pooled one when the
+    /// space left behind slices still in flight can't take
+    /// `capacity` bytes.
+    private func prepareRcvBuffer(_ capacity: Int) -> UnsafeByteBuffer {
+        let rcvbuf = self._rcvbuf
+        
+        if  rcvbuf.referenceCount == 1 {
+            rcvbuf.readerIndex = 0
+            rcvbuf.writerIndex = 0
+        }
         
-        if  available == -1 {
-            throw SocketError.ioError(input.streamError)
-        } else if available != 0 {
-            self._delegate?.socket(self, hasBytesAvailable: self._rcvbuf[0 ..< available])
+        if  rcvbuf.writableBytes < capacity {
+            self._rcvbuf = UnsafeByteBuffer(capacity: max(capacity, kDefaultRcvBufferCapacity), pool: .default)
         }
+        
+        return self._rcvbuf
     }
 }
 
 extension TCPSocket {
-    internal func write(data: Any) throws {
-        guard let buffer = data as? ByteBuffer else {
-            throw SocketError.notSupportedOutboundDataType
-        }
+    /// Queues `data` without copying it, so the written
+    /// buffer must not be modified until it's been sent.
+    /// Nothing goes out until the next `flush()`.
+    internal func write(data buffer: ByteBuffer, promise: EventLoopPromise<Void>) throws {
+        self._promises.append(buffer.readableBytes, promise: promise)
         
-        // Make space if needed before
-        // increasing _sndbuf capacity
-        if buffer.readableBytes > self._sndbuf.writableBytes {
-            _ = self._sndbuf.discardReadBytes()
-        }
+        _ = self._sndbuf.addComponent(buffer)
         
-        _ = self._sndbuf.write(bytes: buffer)
+        if  self._sndbuf.readableBytes > self._highWaterMark {
+            self.setWritable(false)
+        }
+    }
+    
+    internal func flush() throws {
+        self._flushed = self._sndbuf.readableBytes
         
         if self._direct {
             try self.write()
         }
     }
-
+    
     internal func write() throws {
         guard let output = self._output else {
             throw SocketError.notInitialized
         }
         
-        guard self._sndbuf.readable else {
+        guard self._flushed > 0 else {
+            self._direct = true
+            return
+        }
+        
+        self._direct = false
+        
+        guard self._descriptor >= 0 else {
+            // OutputStream has no gathering write,
+            // so send from the first component only
+            let written = self._sndbuf.withUnsafeReadableIovecs(maxCount: 1) { iovecs -> Int in
+                let base = iovecs[0].iov_base.assumingMemoryBound(to: UInt8.self)
+                
+                return output.write(base, maxLength: min(iovecs[0].iov_len, self._flushed))
+            }
+            
+            if written > 0 {
+                self.advance(written)
+            } else if written == -1 {
+                throw SocketError.ioError(output.streamError)
+            }
+            
+            return
+        }
+        
+        // Gathering writes on the socket itself, as many flushed
+        // components per call as fit, until it stops taking bytes
+        while self._flushed > 0 {
+            let written = try self.writev(self._descriptor)
+            
+            guard written > 0 else {
+                break
+            }
+            
+            self.advance(written)
+        }
+        
+        if  self._flushed == 0 {
             self._direct = true
+        } else {
+            // Asking again re-arms the stream's space available event
+            _ = output.hasSpaceAvailable
+        }
+    }
+    
+    /// Bytes taken by the socket, 0 once it would block.
+    private func writev(_ descriptor: Int32) throws -> Int {
+        let flushed = self._flushed
+        
+        return try self._sndbuf.withUnsafeReadableIovecs(maxCount: kMaxSndBufferIovecs) { iovecs -> Int in
+            var vectors = Array(iovecs)
+            var count   = 0
+            var total   = 0
+            
+            // Unflushed components stay behind
+            while count < vectors.count && total < flushed {
+                vectors[count].iov_len = min(vectors[count].iov_len, flushed - total)
+                
+                total += vectors[count].iov_len
+                count += 1
+            }
+            
+            let written = Foundation.writev(descriptor, vectors, Int32(count))
+            
+            if  written == -1 {
+                guard errno == EAGAIN || errno == EINTR else {
+                    throw SocketError.ioError(NSError(domain: NSPOSIXErrorDomain, code: Int(errno)))
+                }
+                
+                return 0
+            }
+            
+            return written
+        }
+    }
+    
+    /// Drops sent bytes, a partially sent component
+    /// stays queued from where the socket left it.
+    private func advance(_ written: Int) {
+        self._flushed -= written
+        self._sndbuf.readerIndex += written
+        
+        _ = self._sndbuf.discardReadComponents()
+        
+        if  self._sndbuf.readableBytes < self._lowWaterMark {
+            self.setWritable(true)
+        }
+        
+        self._promises.sent(written)
+    }
+    
+    private func setWritable(_ value: Bool) {
+        guard self._writable != value else {
             return
         }
         
-        let sndsize = self._sndbuf.readableBytes >= kDefaultSndBufferPageSize ? kDefaultSndBufferPageSize : self._sndbuf.readableBytes
-        let written = output.write(self._sndbuf.unsafe + self._sndbuf.readerIndex, maxLength: sndsize)
+        self._writable = value
+        self._delegate?.socket(writabilityChanged: self)
+    }
+    
+    /// The stream's socket, or -1 when it doesn't expose one.
+    private func descriptor(of output: OutputStream) -> Int32 {
+        let property = CFWriteStreamCopyProperty(output, CFStreamPropertyKey(rawValue: kCFStreamPropertySocketNativeHandle))
+        
+        guard let handle = property as? Data, handle.count == MemoryLayout<CFSocketNativeHandle>.size else {
+            return -1
+        }
         
-        if written > 0 {
-            self._direct = false
-            self._sndbuf.readerIndex += written
-        } else if written == -1 {
-            throw SocketError.ioError(output.streamError)
+        return handle.withUnsafeBytes { (pointer: UnsafePointer<CFSocketNativeHandle>) in
+            return pointer.pointee
         }
     }
 }
 
 extension TCPSocket: StreamDelegate {
     public func stream(_ stream: Stream, handle event: Stream.Event) {
+        // Streams only call back on a dispatch queue
+        self._eventLoop.execute {
+            self.handle(stream, event)
+        }
+    }
+    
+    private func handle(_ stream: Stream, _ event: Stream.Event) {
         do {
             switch (stream, event) {
             case(_output, .openCompleted):
+                self._descriptor = self.descriptor(of: self._output!)
+                
+                if  self._descriptor >= 0 {
+                    var options = self._socketOptions
+                    _ = fs_socket_set_options(self._descriptor, &options)
+                }
+                
                 self._delegate?.socket(opened: self)
                 break
             case(_, .errorOccurred):
@@ -233,6 +605,7 @@ extension TCPSocket: StreamDelegate {
                 break
             }
         } catch let error {
+            self._promises.fail(error)
             self._delegate?.socket(self, hasCaughtError: error)
         }
     }
@@ -252,6 +625,6 @@ public enum SocketError: Error {
     case notSupportedOutboundDataType
 }
 
-fileprivate let kDefaultRcvBufferCapacity: Int = 1024
-fileprivate let kDefaultSndBufferCapacity: Int = 4096
-fileprivate let kDefaultSndBufferPageSize: Int = 512
+fileprivate let kDefaultRcvBufferCapacity: Int = 64 * 1024
+fileprivate let kDefaultSndBufferComponents: Int = 16
+fileprivate let kMaxSndBufferIovecs: Int = 64
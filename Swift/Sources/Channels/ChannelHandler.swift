@@ -5,6 +5,10 @@ public protocol ChannelHandler {
     func handler(removed context: ChannelHandlerContext) throws
     
     func handler(_ context: ChannelHandlerContext, error: Error) throws
+    
+    /// Events this handler does something with, read once when
+    /// it's added. Events left out go straight past it.
+    var handledEvents: ChannelEvents { get }
 }
 
 extension ChannelHandler {
@@ -20,13 +24,30 @@ extension ChannelHandler {
         // Broadcast event to next handler in pipeline
         context.fireError(error)
     }
+    
+    /// Everything its `Inbound`/`OutboundChannelHandler` conformance
+    /// receives. Handlers keeping some of the defaults may narrow it.
+    public var handledEvents: ChannelEvents {
+        var events: ChannelEvents = []
+        
+        if self is InboundChannelHandler {
+            events.formUnion(.inbound)
+        }
+        
+        if self is OutboundChannelHandler {
+            events.formUnion(.outbound)
+        }
+        
+        return events
+    }
 }
 
 public protocol InboundChannelHandler: ChannelHandler {
     func channel(active context: ChannelHandlerContext) throws
     func channel(inactive context: ChannelHandlerContext) throws
     
-    func channel(_ context: ChannelHandlerContext, read data: Any) throws
+    func channel(_ context: ChannelHandlerContext, read data: ChannelPayload) throws
+    func channel(writabilityChanged context: ChannelHandlerContext) throws
 }
 
 extension InboundChannelHandler {
@@ -40,34 +61,153 @@ extension InboundChannelHandler {
         context.fireChannelInactive()
     }
     
-    public func channel(_ context: ChannelHandlerContext, read data: Any) throws {
+    public func channel(_ context: ChannelHandlerContext, read data: ChannelPayload) throws {
         // Broadcast event to next handler in pipeline
         context.fireChannelRead(data)
     }
+    
+    public func channel(writabilityChanged context: ChannelHandlerContext) throws {
+        // Broadcast event to next handler in pipeline
+        context.fireChannelWritabilityChanged()
+    }
 }
 
+/// Handlers pass `promise` on along with the operation, or
+/// complete it themselves when they don't. Throwing fails it.
 public protocol OutboundChannelHandler: ChannelHandler {
-    func channel(close context: ChannelHandlerContext) throws
-    func channel(connect context: ChannelHandlerContext, to host: String, port: Int) throws
+    func channel(close context: ChannelHandlerContext, promise: EventLoopPromise<Void>) throws
+    func channel(connect context: ChannelHandlerContext, to host: String, port: Int, promise: EventLoopPromise<Void>) throws
     
-    func channel(_ context: ChannelHandlerContext, write data: Any) throws
+    func channel(_ context: ChannelHandlerContext, write data: ChannelPayload, promise: EventLoopPromise<Void>) throws
+    func channel(flush context: ChannelHandlerContext) throws
 }
 
 extension OutboundChannelHandler {
-    public func channel(close context: ChannelHandlerContext) throws {
+    public func channel(close context: ChannelHandlerContext, promise: EventLoopPromise<Void>) throws {
         // Broadcast event to next handler in pipeline
-        context.close()
+        context.close(promise: promise)
     }
     
-    public func channel(connect context: ChannelHandlerContext, to host: String, port: Int) throws {
+    public func channel(connect context: ChannelHandlerContext, to host: String, port: Int, promise: EventLoopPromise<Void>) throws {
         // Broadcast event to next handler in pipeline
-        context.connect(to: host, port: port)
+        context.connect(to: host, port: port, promise: promise)
     }
  
-    public func channel(_ context: ChannelHandlerContext, write data: Any) throws {
+    public func channel(_ context: ChannelHandlerContext, write data: ChannelPayload, promise: EventLoopPromise<Void>) throws {
         // Broadcast event to next handler in pipeline
-        context.write(data)
+        context.write(data, promise: promise)
+    }
+    
+    public func channel(flush context: ChannelHandlerContext) throws {
+        // Broadcast event to next handler in pipeline
+        context.flush()
     }
 }
 
 public typealias DuplexChannelHandler = InboundChannelHandler & OutboundChannelHandler
+
+/// Inbound handler reading `InboundIn` messages only. Anything
+/// else read fails with `ChannelPipelineError.unexpectedPayload`.
+public protocol TypedInboundChannelHandler: InboundChannelHandler {
+    associatedtype InboundIn
+    associatedtype InboundOut = InboundIn
+    
+    func channel(_ context: ChannelHandlerContext, read data: InboundIn) throws
+}
+
+extension TypedInboundChannelHandler {
+    public func channel(_ context: ChannelHandlerContext, read data: ChannelPayload) throws {
+        guard let message = data.unwrap(as: InboundIn.self) else {
+            throw ChannelPipelineError.unexpectedPayload(expected: InboundIn.self)
+        }
+        
+        try self.channel(context, read: message)
+    }
+    
+    public func wrapInboundOut(_ value: InboundOut) -> ChannelPayload {
+        return ChannelPayload(value)
+    }
+}
+
+/// Buffer handlers, the common case, match the payload directly
+/// instead of casting through the generic unwrap.
+extension TypedInboundChannelHandler where InboundIn == ByteBuffer {
+    @inlinable
+    public func channel(_ context: ChannelHandlerContext, read data: ChannelPayload) throws {
+        guard let bytes = data.bytes else {
+            throw ChannelPipelineError.unexpectedPayload(expected: ByteBuffer.self)
+        }
+        
+        try self.channel(context, read: bytes)
+    }
+}
+
+extension TypedInboundChannelHandler where InboundOut == ByteBuffer {
+    @inlinable
+    public func wrapInboundOut(_ value: ByteBuffer) -> ChannelPayload {
+        return .bytes(value)
+    }
+}
+
+/// Outbound handler writing `OutboundIn` messages only. Anything
+/// else written fails with `ChannelPipelineError.unexpectedPayload`.
+public protocol TypedOutboundChannelHandler: OutboundChannelHandler {
+    associatedtype OutboundIn
+    associatedtype OutboundOut = OutboundIn
+    
+    func channel(_ context: ChannelHandlerContext, write data: OutboundIn, promise: EventLoopPromise<Void>) throws
+}
+
+extension TypedOutboundChannelHandler {
+    public func channel(_ context: ChannelHandlerContext, write data: ChannelPayload, promise: EventLoopPromise<Void>) throws {
+        guard let message = data.unwrap(as: OutboundIn.self) else {
+            throw ChannelPipelineError.unexpectedPayload(expected: OutboundIn.self)
+        }
+        
+        try self.channel(context, write: message, promise: promise)
+    }
+    
+    public func wrapOutboundOut(_ value: OutboundOut) -> ChannelPayload {
+        return ChannelPayload(value)
+    }
+}
+
+extension TypedOutboundChannelHandler where OutboundIn == ByteBuffer {
+    @inlinable
+    public func channel(_ context: ChannelHandlerContext, write data: ChannelPayload, promise: EventLoopPromise<Void>) throws {
+        guard let bytes = data.bytes else {
+            throw ChannelPipelineError.unexpectedPayload(expected: ByteBuffer.self)
+        }
+        
+        try self.channel(context, write: bytes, promise: promise)
+    }
+}
+
+extension TypedOutboundChannelHandler where OutboundOut == ByteBuffer {
+    @inlinable
+    public func wrapOutboundOut(_ value: ByteBuffer) -> ChannelPayload {
+        return .bytes(value)
+    }
+}
+
+public struct ChannelEvents: OptionSet {
+    public let rawValue: UInt16
+    
+    public init(rawValue: UInt16) {
+        self.rawValue = rawValue
+    }
+    
+    public static let active             = ChannelEvents(rawValue: 1 << 0)
+    public static let inactive           = ChannelEvents(rawValue: 1 << 1)
+    public static let read               = ChannelEvents(rawValue: 1 << 2)
+    public static let writabilityChanged = ChannelEvents(rawValue: 1 << 3)
+    public static let error              = ChannelEvents(rawValue: 1 << 4)
+    
+    public static let close              = ChannelEvents(rawValue: 1 << 5)
+    public static let connect            = ChannelEvents(rawValue: 1 << 6)
+    public static let write              = ChannelEvents(rawValue: 1 << 7)
+    public static let flush              = ChannelEvents(rawValue: 1 << 8)
+    
+    public static let inbound: ChannelEvents  = [.active, .inactive, .read, .writabilityChanged, .error]
+    public static let outbound: ChannelEvents = [.close, .connect, .write, .flush]
+}
@@ -3,9 +3,12 @@ import Foundation
 public final class ChannelHandlerContext {
     private let _name: String
     private let _handler: ChannelHandler
+    private let _inbound: InboundChannelHandler?
+    private let _outbound: OutboundChannelHandler?
+    private let _events: ChannelEvents
     
     unowned
-    private let _executor: DispatchQueue
+    private let _executor: EventLoop
     
     unowned
     private let _pipeline: ChannelPipeline
@@ -13,11 +16,26 @@ public final class ChannelHandlerContext {
     private var _next: ChannelHandlerContext?
     private var _prev: ChannelHandlerContext?
     
-    internal init(name: String, handler: ChannelHandler, executor: DispatchQueue, pipeline: ChannelPipeline) {
+    internal init(name: String, handler: ChannelHandler, executor: EventLoop, pipeline: ChannelPipeline) {
         self._name     = name
         self._handler  = handler
+        self._inbound  = handler as? InboundChannelHandler
+        self._outbound = handler as? OutboundChannelHandler
         self._executor = executor
         self._pipeline = pipeline
+        
+        // Never more than the conformance can take
+        var events = handler.handledEvents
+        
+        if self._inbound == nil {
+            events.subtract(.inbound)
+        }
+        
+        if self._outbound == nil {
+            events.subtract(.outbound)
+        }
+        
+        self._events = events
     }
 }
 
@@ -40,7 +58,7 @@ extension ChannelHandlerContext {
         return self._handler
     }
     
-    internal var executor: DispatchQueue {
+    internal var executor: EventLoop {
         return self._executor
     }
     
@@ -67,185 +85,320 @@ extension ChannelHandlerContext {
 
 extension ChannelHandlerContext: InboundChannelHandlerInvoker {
     public func fireChannelActive() {
-        self._next?.triggerChannelActive()
+        self.nextContext(handling: .active)?.triggerChannelActive()
     }
     
     public func fireChannelInactive() {
-        self._next?.triggerChannelInactive()
+        self.nextContext(handling: .inactive)?.triggerChannelInactive()
     }
     
-    public func fireChannelRead(_ data: Any) {
-        self._next?.triggerChannelRead(data)
+    public func fireChannelRead(_ data: ChannelPayload) {
+        self.nextContext(handling: .read)?.triggerChannelRead(data)
+    }
+    
+    public func fireChannelWritabilityChanged() {
+        self.nextContext(handling: .writabilityChanged)?.triggerChannelWritabilityChanged()
     }
     
     public func fireError(_ error: Error) {
-        self._next?.triggerError(error)
+        self.nextContext(handling: .error)?.triggerError(error)
     }
 }
 
 extension ChannelHandlerContext {
-    private func triggerChannelActive() {
-        let cast = self._handler as? InboundChannelHandler
+    /// Walks past contexts whose handler leaves `event` to the
+    /// defaults. Masks are read as it goes, so it holds while
+    /// handlers come and go.
+    private func nextContext(handling event: ChannelEvents) -> ChannelHandlerContext? {
+        var nxt = self._next
         
-        guard let handler = cast else {
-            self.fireChannelActive()
+        while let ctx = nxt, !ctx._events.contains(event) {
+            nxt = ctx._next
+        }
+        
+        return nxt
+    }
+    
+    private func prevContext(handling event: ChannelEvents) -> ChannelHandlerContext? {
+        var prv = self._prev
+        
+        while let ctx = prv, !ctx._events.contains(event) {
+            prv = ctx._prev
+        }
+        
+        return prv
+    }
+}
+
+/// Lifecycle callbacks go to every handler, whatever its mask,
+/// on its own loop. The hop holds the context, they're never
+/// dropped.
+extension ChannelHandlerContext {
+    internal func triggerHandlerAdded() {
+        guard self._executor.inEventLoop else {
+            self._executor.execute {
+                self.triggerHandlerAdded()
+            }
             return
         }
         
-        self.executor.async(flags: .barrier) { [weak self] in
-            guard let ctx = self else {
-                return
+        do {
+            try self._handler.handler(added: self)
+        } catch let error {
+            self.triggerError(error)
+        }
+    }
+    
+    internal func triggerHandlerRemoved() {
+        guard self._executor.inEventLoop else {
+            self._executor.execute {
+                self.triggerHandlerRemoved()
             }
-            
-            do {
-                try handler.channel(active: ctx)
-            } catch let error {
-                ctx.triggerError(error)
+            return
+        }
+        
+        do {
+            try self._handler.handler(removed: self)
+        } catch let error {
+            self.triggerError(error)
+        }
+    }
+}
+
+/// Handlers run right away when their event is fired on their
+/// own loop. Only a context bound to another loop queues a hop.
+extension ChannelHandlerContext {
+    private func triggerChannelActive() {
+        guard let handler = self._inbound else {
+            self.fireChannelActive()
+            return
+        }
+        
+        guard self._executor.inEventLoop else {
+            self._executor.execute { [weak self] in
+                self?.triggerChannelActive()
             }
+            return
+        }
+        
+        do {
+            try handler.channel(active: self)
+        } catch let error {
+            self.triggerError(error)
         }
     }
     
     private func triggerChannelInactive() {
-        let cast = self._handler as? InboundChannelHandler
-        
-        guard let handler = cast else {
+        guard let handler = self._inbound else {
             self.fireChannelInactive()
             return
         }
         
-        self.executor.async(flags: .barrier) { [weak self] in
-            guard let ctx = self else {
-                return
-            }
-            
-            do {
-                try handler.channel(inactive: ctx)
-            } catch let error {
-                ctx.triggerError(error)
+        guard self._executor.inEventLoop else {
+            self._executor.execute { [weak self] in
+                self?.triggerChannelInactive()
             }
+            return
+        }
+        
+        do {
+            try handler.channel(inactive: self)
+        } catch let error {
+            self.triggerError(error)
         }
     }
     
-    private func triggerChannelRead(_ data: Any) {
-        let cast = self._handler as? InboundChannelHandler
-        
-        guard let handler = cast else {
+    private func triggerChannelRead(_ data: ChannelPayload) {
+        guard let handler = self._inbound else {
             self.fireChannelRead(data)
             return
         }
         
-        self.executor.async(flags: .barrier) { [weak self] in
-            guard let ctx = self else {
-                return
+        guard self._executor.inEventLoop else {
+            self._executor.execute { [weak self] in
+                self?.triggerChannelRead(data)
             }
-            
-            do {
-                try handler.channel(ctx, read: data)
-            } catch let error {
-                ctx.triggerError(error)
+            return
+        }
+        
+        do {
+            try handler.channel(self, read: data)
+        } catch let error {
+            self.triggerError(error)
+        }
+    }
+    
+    private func triggerChannelWritabilityChanged() {
+        guard let handler = self._inbound else {
+            self.fireChannelWritabilityChanged()
+            return
+        }
+        
+        guard self._executor.inEventLoop else {
+            self._executor.execute { [weak self] in
+                self?.triggerChannelWritabilityChanged()
             }
+            return
+        }
+        
+        do {
+            try handler.channel(writabilityChanged: self)
+        } catch let error {
+            self.triggerError(error)
         }
     }
     
     private func triggerError(_ error: Error) {
-        let cast = self._handler as? InboundChannelHandler
-        
-        guard let handler = cast else {
+        guard let handler = self._inbound else {
             self.fireError(error)
             return
         }
         
-        self.executor.async(flags: .barrier) { [weak self] in
-            guard let ctx = self else {
-                return
-            }
-            
-            do {
-                try handler.handler(ctx, error: error)
-            } catch let error {
-                print("[ERROR] -- An error was thrown by a user handler while handling an handler(error:) event.")
-                print("[ERROR] -- \(String(describing: error))")
+        guard self._executor.inEventLoop else {
+            self._executor.execute { [weak self] in
+                self?.triggerError(error)
             }
+            return
+        }
+        
+        do {
+            try handler.handler(self, error: error)
+        } catch let error {
+            print("[ERROR] -- An error was thrown by a user handler while handling an handler(error:) event.")
+            print("[ERROR] -- \(String(describing: error))")
         }
     }
 }
 
+/// Contexts cut out of a pipeline being torn down have nowhere
+/// to pass operations on. Their promises are failed rather than
+/// left for callers to wait on forever.
 extension ChannelHandlerContext: OutboundChannelHandlerInvoker {
-    public func close() {
-        self._prev?.triggerClose()
+    public func close(promise: EventLoopPromise<Void>) {
+        guard let ctx = self.prevContext(handling: .close) else {
+            return promise.fail(ChannelPipelineError.handlerRemoved)
+        }
+        
+        ctx.triggerClose(promise: promise)
     }
     
-    public func connect(to host: String, port: Int) {
-        self._prev?.triggerConnect(to: host, port: port)
+    public func connect(to host: String, port: Int, promise: EventLoopPromise<Void>) {
+        guard let ctx = self.prevContext(handling: .connect) else {
+            return promise.fail(ChannelPipelineError.handlerRemoved)
+        }
+        
+        ctx.triggerConnect(to: host, port: port, promise: promise)
+    }
+    
+    public func write(_ data: ChannelPayload, promise: EventLoopPromise<Void>) {
+        guard let ctx = self.prevContext(handling: .write) else {
+            return promise.fail(ChannelPipelineError.handlerRemoved)
+        }
+        
+        ctx.triggerWrite(data, promise: promise)
     }
     
-    public func write(_ data: Any) {
-        print("Triggerin write on #\(_prev?.name)")
-        self._prev?.triggerWrite(data)
+    public func flush() {
+        self.prevContext(handling: .flush)?.triggerFlush()
     }
 }
 
 extension ChannelHandlerContext {
-    private func triggerClose() {
-        let cast = self._handler as? OutboundChannelHandler
-        
-        guard let handler = cast else {
-            self.close()
+    /// A throwing handler fails the promise, unless it was
+    /// completed already, and the error goes inbound as well.
+    /// A context gone before its hop ran fails it too.
+    private func triggerClose(promise: EventLoopPromise<Void>) {
+        guard let handler = self._outbound else {
+            self.close(promise: promise)
             return
         }
         
-        self.executor.async(flags: .barrier) { [weak self] in
-            guard let ctx = self else {
-                return
-            }
-            
-            do {
-                try handler.channel(close: ctx)
-            } catch let error {
-                ctx.triggerError(error)
+        guard self._executor.inEventLoop else {
+            self._executor.execute { [weak self] in
+                guard let this = self else {
+                    return promise.fail(ChannelPipelineError.handlerRemoved)
+                }
+                
+                this.triggerClose(promise: promise)
             }
+            return
+        }
+        
+        do {
+            try handler.channel(close: self, promise: promise)
+        } catch let error {
+            promise.fail(error)
+            self.triggerError(error)
         }
     }
     
-    private func triggerConnect(to host: String, port: Int) {
-        let cast = self._handler as? OutboundChannelHandler
-        
-        guard let handler = cast else {
-            self.connect(to: host, port: port)
+    private func triggerConnect(to host: String, port: Int, promise: EventLoopPromise<Void>) {
+        guard let handler = self._outbound else {
+            self.connect(to: host, port: port, promise: promise)
             return
         }
         
-        self.executor.async(flags: .barrier) { [weak self] in
-            guard let ctx = self else {
-                return
-            }
-            
-            do {
-                try handler.channel(connect: ctx, to: host, port: port)
-            } catch let error {
-                ctx.triggerError(error)
+        guard self._executor.inEventLoop else {
+            self._executor.execute { [weak self] in
+                guard let this = self else {
+                    return promise.fail(ChannelPipelineError.handlerRemoved)
+                }
+                
+                this.triggerConnect(to: host, port: port, promise: promise)
             }
+            return
+        }
+        
+        do {
+            try handler.channel(connect: self, to: host, port: port, promise: promise)
+        } catch let error {
+            promise.fail(error)
+            self.triggerError(error)
         }
     }
     
-    private func triggerWrite(_ data: Any) {
-        let cast = self._handler as? OutboundChannelHandler
-        
-        guard let handler = cast else {
-            self.write(data)
+    private func triggerWrite(_ data: ChannelPayload, promise: EventLoopPromise<Void>) {
+        guard let handler = self._outbound else {
+            self.write(data, promise: promise)
             return
         }
         
-        self.executor.async(flags: .barrier) { [weak self] in
-            guard let ctx = self else {
-                return
+        guard self._executor.inEventLoop else {
+            self._executor.execute { [weak self] in
+                guard let this = self else {
+                    return promise.fail(ChannelPipelineError.handlerRemoved)
+                }
+                
+                this.triggerWrite(data, promise: promise)
             }
-            
-            do {
-                try handler.channel(ctx, write: data)
-            } catch let error {
-                ctx.triggerError(error)
+            return
+        }
+        
+        do {
+            try handler.channel(self, write: data, promise: promise)
+        } catch let error {
+            promise.fail(error)
+            self.triggerError(error)
+        }
+    }
+    
+    private func triggerFlush() {
+        guard let handler = self._outbound else {
+            self.flush()
+            return
+        }
+        
+        guard self._executor.inEventLoop else {
+            self._executor.execute { [weak self] in
+                self?.triggerFlush()
             }
+            return
+        }
+        
+        do {
+            try handler.channel(flush: self)
+        } catch let error {
+            self.triggerError(error)
         }
     }
 }
@@ -3,16 +3,54 @@ import Foundation
 public protocol InboundChannelHandlerInvoker {
     func fireChannelActive()
     func fireChannelInactive()
-    func fireChannelRead(_ data: Any)
+    func fireChannelRead(_ data: ChannelPayload)
+    func fireChannelWritabilityChanged()
     
     func fireError(_ error: Error)
 }
 
+/// Every operation but `flush` completes `promise` once the
+/// socket has taken it, or fails it with whatever stopped it.
 public protocol OutboundChannelHandlerInvoker {
-    func close()
-    func connect(to host: String, port: Int)
+    func close(promise: EventLoopPromise<Void>)
+    func connect(to host: String, port: Int, promise: EventLoopPromise<Void>)
     
-    func write(_ data: Any)
+    func write(_ data: ChannelPayload, promise: EventLoopPromise<Void>)
+    func flush()
+}
+
+extension InboundChannelHandlerInvoker {
+    public func fireChannelRead(_ bytes: ByteBuffer) {
+        self.fireChannelRead(.bytes(bytes))
+    }
+}
+
+/// Left without a promise, operations go with the void one.
+extension OutboundChannelHandlerInvoker {
+    public func close() {
+        self.close(promise: .void)
+    }
+    
+    public func connect(to host: String, port: Int) {
+        self.connect(to: host, port: port, promise: .void)
+    }
+    
+    public func write(_ data: ChannelPayload) {
+        self.write(data, promise: .void)
+    }
+    
+    public func write(_ bytes: ByteBuffer, promise: EventLoopPromise<Void> = .void) {
+        self.write(.bytes(bytes), promise: promise)
+    }
+    
+    public func writeAndFlush(_ data: ChannelPayload, promise: EventLoopPromise<Void> = .void) {
+        self.write(data, promise: promise)
+        self.flush()
+    }
+    
+    public func writeAndFlush(_ bytes: ByteBuffer, promise: EventLoopPromise<Void> = .void) {
+        self.writeAndFlush(.bytes(bytes), promise: promise)
+    }
 }
 
 public typealias ChannelHandlerInvoker = InboundChannelHandlerInvoker & OutboundChannelHandlerInvoker
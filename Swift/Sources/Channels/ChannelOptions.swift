@@ -0,0 +1,143 @@
+import Foundation
+import CFuse
+
+/// Settings a channel is created with. Options are values,
+/// every channel gets its own copy, allocator state included.
+public struct ChannelOptions {
+    /// Sizes every read from the socket.
+    public var recvAllocator: RecvBufferAllocator
+    
+    /// Reads done per readiness event, at most, before
+    /// yielding the event loop to the other channels on it.
+    public var maxMessagesPerRead: Int
+    
+    /// Bytes written but not sent yet past which the channel
+    /// stops being writable, and below which it is again.
+    public var writeBufferHighWaterMark: Int
+    public var writeBufferLowWaterMark: Int
+    
+    /// TCP_NODELAY, small writes go out without waiting.
+    public var tcpNoDelay: Bool
+    
+    /// SO_KEEPALIVE.
+    public var keepAlive: Bool
+    
+    /// SO_SNDBUF and SO_RCVBUF, 0 keeps the kernel's default.
+    public var socketSendBufferSize: Int
+    public var socketReceiveBufferSize: Int
+    
+    /// Goes through the event loop's io_uring rather than
+    /// epoll, Linux only and where the kernel has it. Reads
+    /// are then sized by the ring, not `recvAllocator`.
+    public var useIoUring: Bool
+    
+    public init(recvAllocator: RecvBufferAllocator = AdaptiveRecvBufferAllocator(), maxMessagesPerRead: Int = 16, writeBufferLowWaterMark: Int = 32 * 1024, writeBufferHighWaterMark: Int = 64 * 1024, tcpNoDelay: Bool = true, keepAlive: Bool = false, socketSendBufferSize: Int = 0, socketReceiveBufferSize: Int = 0, useIoUring: Bool = false) {
+        precondition(maxMessagesPerRead > 0, "maxMessagesPerRead must be positive")
+        precondition(writeBufferLowWaterMark <= writeBufferHighWaterMark, "low water mark must not exceed the high one")
+        
+        self.recvAllocator      = recvAllocator
+        self.maxMessagesPerRead = maxMessagesPerRead
+        self.writeBufferLowWaterMark  = writeBufferLowWaterMark
+        self.writeBufferHighWaterMark = writeBufferHighWaterMark
+        self.tcpNoDelay = tcpNoDelay
+        self.keepAlive  = keepAlive
+        self.socketSendBufferSize    = socketSendBufferSize
+        self.socketReceiveBufferSize = socketReceiveBufferSize
+        self.useIoUring = useIoUring
+    }
+}
+
+extension ChannelOptions {
+    internal var socketOptions: fs_socket_options_t {
+        return fs_socket_options_t(
+            nodelay:   self.tcpNoDelay ? 1 : 0,
+            keepalive: self.keepAlive  ? 1 : 0,
+            sndbuf:    UInt32(self.socketSendBufferSize),
+            rcvbuf:    UInt32(self.socketReceiveBufferSize))
+    }
+}
+
+/// Guesses how many bytes the next read from a socket
+/// will bring, learning from what the last reads did.
+public protocol RecvBufferAllocator {
+    var nextCapacity: Int { get }
+    
+    mutating func record(_ bytes: Int)
+}
+
+/// Always reads up to the same amount.
+public struct FixedRecvBufferAllocator: RecvBufferAllocator {
+    public let nextCapacity: Int
+    
+    public init(capacity: Int) {
+        precondition(capacity > 0, "capacity must be positive")
+        self.nextCapacity = capacity
+    }
+    
+    public mutating func record(_ bytes: Int) {
+    }
+}
+
+/// Grows the guess quickly while reads fill it and shrinks
+/// it slowly, one step after two short reads in a row, so a
+/// single small read doesn't throttle a busy connection.
+public struct AdaptiveRecvBufferAllocator: RecvBufferAllocator {
+    private let _minIndex: Int
+    private let _maxIndex: Int
+    
+    private var _index: Int
+    private var _shrink: Bool
+    
+    /// Bounds are rounded to the sizes in between reads step
+    /// through: multiples of 16 up to 512, powers of two after.
+    public init(minimum: Int = 64, initial: Int = 2048, maximum: Int = 64 * 1024) {
+        precondition(minimum > 0 && minimum <= initial && initial <= maximum, "bounds must be positive and in order")
+        
+        self._minIndex = AdaptiveRecvBufferAllocator.index(of: minimum)
+        self._maxIndex = AdaptiveRecvBufferAllocator.index(of: maximum)
+        self._index    = AdaptiveRecvBufferAllocator.index(of: initial)
+        self._shrink   = false
+    }
+    
+    public var nextCapacity: Int {
+        return kRecvBufferSizes[self._index]
+    }
+    
+    public mutating func record(_ bytes: Int) {
+        if bytes <= kRecvBufferSizes[max(self._minIndex, self._index - kRecvBufferShrinkStep)] {
+            if self._shrink {
+                self._index  = max(self._minIndex, self._index - kRecvBufferShrinkStep)
+                self._shrink = false
+            } else {
+                self._shrink = true
+            }
+        } else if bytes >= self.nextCapacity {
+            self._index  = min(self._maxIndex, self._index + kRecvBufferGrowStep)
+            self._shrink = false
+        } else {
+            self._shrink = false
+        }
+    }
+    
+    /// The smallest size holding `capacity`, or the largest one.
+    private static func index(of capacity: Int) -> Int {
+        var low  = 0
+        var high = kRecvBufferSizes.count - 1
+        
+        while low < high {
+            let middle = (low + high) / 2
+            
+            if kRecvBufferSizes[middle] < capacity {
+                low  = middle + 1
+            } else {
+                high = middle
+            }
+        }
+        
+        return low
+    }
+}
+
+fileprivate let kRecvBufferSizes: [Int] = Array(stride(from: 16, to: 512, by: 16)) + (9...30).map { 1 << $0 }
+fileprivate let kRecvBufferGrowStep: Int = 4
+fileprivate let kRecvBufferShrinkStep: Int = 1
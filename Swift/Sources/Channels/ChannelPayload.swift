@@ -0,0 +1,44 @@
+import Foundation
+
+/// What travels through a pipeline. Buffers, by far the most
+/// common message, are held as they are and reach handlers
+/// without a cast. Anything else goes as a `message`.
+public enum ChannelPayload {
+    case bytes(ByteBuffer)
+    case message(Any)
+}
+
+/// Inlinable, so handlers in other modules get them specialized
+/// for their own types rather than going through the generic ones.
+extension ChannelPayload {
+    @inlinable
+    public init<T>(_ value: T) {
+        if let bytes = value as? ByteBuffer {
+            self = .bytes(bytes)
+        } else {
+            self = .message(value)
+        }
+    }
+    
+    /// The payload as a `T`, nil when it's something else.
+    @inlinable
+    public func unwrap<T>(as type: T.Type = T.self) -> T? {
+        switch self {
+        case .bytes(let bytes):
+            return bytes as? T
+        case .message(let value):
+            return value as? T
+        }
+    }
+    
+    /// The buffer carried, cast only when it came as a `message`.
+    @inlinable
+    public var bytes: ByteBuffer? {
+        switch self {
+        case .bytes(let bytes):
+            return bytes
+        case .message(let value):
+            return value as? ByteBuffer
+        }
+    }
+}
@@ -43,14 +43,14 @@ import Foundation
 public final class ChannelPipeline {
     unowned
     private let _channel: Channel
-    private let _executor: DispatchQueue
+    private let _executor: EventLoop
     
     private var _head: ChannelHandlerContext?
     private var _tail: ChannelHandlerContext?
     
     init(channel: Channel) {
         self._channel  = channel
-        self._executor = DispatchQueue(label: "io.fuse.pipeline.executor")
+        self._executor = channel.eventLoop
         self._head = ChannelHandlerContext(name: "pipeline_head_handler", handler: HeadChannelHandler(), executor: self._executor, pipeline: self)
         self._tail = ChannelHandlerContext(name: "pipeline_tail_handler", handler: TailChannelHandler(), executor: self._executor, pipeline: self)
         
@@ -68,7 +68,7 @@ extension ChannelPipeline {
         return self._channel
     }
     
-    internal var executor: DispatchQueue {
+    internal var executor: EventLoop {
         return self._executor
     }
 }
@@ -89,21 +89,21 @@ extension ChannelPipeline {
 }
 
 extension ChannelPipeline {
-    public func add(handler: ChannelHandler, named name: String, first: Bool = false, executor: DispatchQueue? = nil) throws {
+    public func add(handler: ChannelHandler, named name: String, first: Bool = false, executor: EventLoop? = nil) throws {
         if first {
-            try self.add(handler: handler, named: name, before: TailChannelHandler.name)
+            try self.add(handler: handler, named: name, before: TailChannelHandler.name, executor: executor)
         } else {
-            try self.add(handler: handler, named: name, after: HeadChannelHandler.name)
+            try self.add(handler: handler, named: name, after: HeadChannelHandler.name, executor: executor)
         }
     }
     
-    public func add(handler: ChannelHandler, named name: String, after existing: String, executor: DispatchQueue? = nil) throws {
+    public func add(handler: ChannelHandler, named name: String, after existing: String, executor: EventLoop? = nil) throws {
         try self.executor.sync { [weak self] in
             guard let this = self else {
                 return
             }
             
-            if check(duplicity: name) {
+            if this.check(duplicity: name) {
                 throw ChannelPipelineError.handlerNameAlreadyExists
             }
             
@@ -114,16 +114,17 @@ extension ChannelPipeline {
             let context = ChannelHandlerContext(name: name, handler: handler, executor: executor ?? this.executor, pipeline: this)
             
             this.add(context: context, after: nextctx)
+            context.triggerHandlerAdded()
         }
     }
     
-    public func add(handler: ChannelHandler, named name: String, before existing: String, executor: DispatchQueue? = nil) throws {
+    public func add(handler: ChannelHandler, named name: String, before existing: String, executor: EventLoop? = nil) throws {
         try self.executor.sync { [weak self] in
             guard let this = self else {
                 return
             }
             
-            if check(duplicity: name) {
+            if this.check(duplicity: name) {
                 throw ChannelPipelineError.handlerNameAlreadyExists
             }
             
@@ -134,11 +135,11 @@ extension ChannelPipeline {
             let context = ChannelHandlerContext(name: name, handler: handler, executor: executor ?? this.executor, pipeline: this)
             
             this.add(context: context, before: prevctx)
+            context.triggerHandlerAdded()
         }
     }
     
     private func add(context: ChannelHandlerContext, after existing: ChannelHandlerContext) {
-        print("Adding context #\(context.name) after #\(existing.name)")
         context.prev = existing;
         context.next = existing.next;
         existing.next?.prev = context;
@@ -169,7 +170,7 @@ extension ChannelPipeline {
     private func find(context name: String, unsafe: Bool = false) -> ChannelHandlerContext? {
         var nxt = unsafe ? self._head : self._head?.next
         
-        while let ctx = nxt, unsafe && ctx !== self._tail {
+        while let ctx = nxt, unsafe || ctx !== self._tail {
             if ctx.name == name {
                 return ctx
             }
@@ -182,25 +183,87 @@ extension ChannelPipeline {
 }
 
 extension ChannelPipeline {
+    /// Events stop reaching the handler once this returns, the
+    /// contexts around it are walked with their own masks. Its
+    /// `handler(removed:)` still gets to fire what it holds on.
     public func remove(handler name: String) throws {
         guard name != self._head?.name,
               name != self._tail?.name else {
             return
         }
         
-        guard let ctx = self.find(context: name) else {
-            throw ChannelPipelineError.contextNotFound(name: name)
+        try self.executor.sync { [weak self] in
+            guard let this = self else {
+                return
+            }
+            
+            guard let ctx = this.find(context: name) else {
+                throw ChannelPipelineError.contextNotFound(name: name)
+            }
+            
+            this.remove(context: ctx)
+            ctx.triggerHandlerRemoved()
         }
-        
-        try self.remove(handler: ctx.handler)
     }
     
+    /// Found by identity, so only handlers that are classes,
+    /// others are removed by name.
     public func remove(handler: ChannelHandler) throws {
-        
+        try self.executor.sync { [weak self] in
+            guard let this = self else {
+                return
+            }
+            
+            guard let ctx = this.find(handler: handler) else {
+                throw ChannelPipelineError.handlerNotFound
+            }
+            
+            this.remove(context: ctx)
+            ctx.triggerHandlerRemoved()
+        }
+    }
+    
+    /// The new handler takes the old one's place and loop, with
+    /// a mask of its own.
+    public func replace(handler name: String, with handler: ChannelHandler, named newName: String) throws {
+        try self.executor.sync { [weak self] in
+            guard let this = self else {
+                return
+            }
+            
+            guard let oldctx = this.find(context: name) else {
+                throw ChannelPipelineError.contextNotFound(name: name)
+            }
+            
+            if newName != name, this.check(duplicity: newName) {
+                throw ChannelPipelineError.handlerNameAlreadyExists
+            }
+            
+            let newctx = ChannelHandlerContext(name: newName, handler: handler, executor: oldctx.executor, pipeline: this)
+            
+            this.replace(context: oldctx, with: newctx)
+            
+            newctx.triggerHandlerAdded()
+            oldctx.triggerHandlerRemoved()
+        }
     }
     
-    public func replace(handler name: String, with handler: ChannelHandler, named: String) {
+    private func find(handler: ChannelHandler) -> ChannelHandlerContext? {
+        guard type(of: handler) is AnyClass else {
+            return nil
+        }
+        
+        var nxt = self._head?.next
         
+        while let ctx = nxt, ctx !== self._tail {
+            if ctx.handler as AnyObject === handler as AnyObject {
+                return ctx
+            }
+            
+            nxt = ctx.next
+        }
+        
+        return nil
     }
     
     private func remove(context: ChannelHandlerContext) {
@@ -210,15 +273,18 @@ extension ChannelPipeline {
         prev?.next = next
         next?.prev = prev
         
-        // Break refernce cycles
-        context.next = nil
-        context.prev = nil
+        // Its own links stay, so events the removed handler
+        // still fires reach its old neighbours. Nothing in the
+        // pipeline points back at it, there's no cycle to break
     }
     
     private func replace(context oldctx: ChannelHandlerContext, with newctx: ChannelHandlerContext) {
         let prev = oldctx.prev
         let next = oldctx.next
         
+        newctx.prev = prev
+        newctx.next = next
+        
         prev?.next = newctx
         next?.prev = newctx
         
@@ -231,7 +297,6 @@ extension ChannelPipeline {
 
 extension ChannelPipeline: InboundChannelHandlerInvoker {
     public func fireChannelActive() {
-        print("Pipeline -> Firing channel active event")
         self._head?.fireChannelActive()
     }
     
@@ -239,60 +304,87 @@ extension ChannelPipeline: InboundChannelHandlerInvoker {
         self._head?.fireChannelInactive()
     }
     
-    public func fireChannelRead(_ data: Any) {
+    public func fireChannelRead(_ data: ChannelPayload) {
         self._head?.fireChannelRead(data)
     }
     
+    public func fireChannelWritabilityChanged() {
+        self._head?.fireChannelWritabilityChanged()
+    }
+    
     public func fireError(_ error: Error) {
         self._head?.fireError(error)
     }
 }
 
 extension ChannelPipeline: OutboundChannelHandlerInvoker {
-    public func close() {
-        self._tail?.close()
+    public func close(promise: EventLoopPromise<Void>) {
+        self._tail?.close(promise: promise)
     }
     
-    public func connect(to host: String, port: Int) {
-        self._tail?.connect(to: host, port: port)
+    public func connect(to host: String, port: Int, promise: EventLoopPromise<Void>) {
+        self._tail?.connect(to: host, port: port, promise: promise)
     }
     
-    public func write(_ data: Any) {
-        self._tail?.write(data)
+    public func write(_ data: ChannelPayload, promise: EventLoopPromise<Void>) {
+        self._tail?.write(data, promise: promise)
+    }
+    
+    public func flush() {
+        self._tail?.flush()
     }
 }
 
 public enum ChannelPipelineError: Error {
     case handlerNameAlreadyExists
     case contextNotFound(name: String)
+    case handlerNotFound
+    /// The handler an outbound operation went through was
+    /// removed, or its pipeline torn down, before it got on.
+    case handlerRemoved
+    case unexpectedPayload(expected: Any.Type)
 }
 
+/// Close promises complete once the socket has closed. Write
+/// promises go to the socket with their bytes, done once those
+/// are sent. Connect promises are handed to the channel, the
+/// socket tells it when the connection opens or fails.
 fileprivate final class HeadChannelHandler: OutboundChannelHandler {
     static let name: String = "pipeline_head_handler"
     
-    func channel(close context: ChannelHandlerContext) throws {
+    func channel(close context: ChannelHandlerContext, promise: EventLoopPromise<Void>) throws {
         try context.channel.socket.close()
+        promise.succeed()
     }
     
-    func channel(connect context: ChannelHandlerContext, to host: String, port: Int) throws {
+    func channel(connect context: ChannelHandlerContext, to host: String, port: Int, promise: EventLoopPromise<Void>) throws {
         try context.channel.socket.connect(to: host, port: port)
+        context.channel.connecting(promise: promise)
     }
     
-    func channel(_ context: ChannelHandlerContext, write data: Any) throws {
-        print("Writing to underlying socket impl!")
-        try context.channel.socket.write(data: data)
+    func channel(_ context: ChannelHandlerContext, write data: ChannelPayload, promise: EventLoopPromise<Void>) throws {
+        guard case .bytes(let buffer) = data else {
+            throw SocketError.notSupportedOutboundDataType
+        }
+        
+        try context.channel.socket.write(data: buffer, promise: promise)
+    }
+    
+    func channel(flush context: ChannelHandlerContext) throws {
+        try context.channel.socket.flush()
     }
 }
 
 fileprivate final class TailChannelHandler: InboundChannelHandler {
     static let name: String = "pipeline_tail_handler"
     
+    // Reads reaching the end are dropped, only errors get here
+    var handledEvents: ChannelEvents {
+        return .error
+    }
+    
     func handler(_ context: ChannelHandlerContext, error: Error) throws {
         print("[ERROR] -- An error event has reached the tail of the pipeline without being handled.")
         print("[ERROR] -- \(String(describing: error))")
     }
-    
-    func handler(_ context: ChannelHandlerContext, read data: Any) throws {
-        // Discard event
-    }
 }
@@ -0,0 +1,276 @@
+#if os(Linux)
+import Foundation
+import CFuse
+
+/// Non-blocking TCP socket on edge triggered epoll. Its event
+/// loop waits for readiness and hands it over on the same thread,
+/// the socket drains reads and writes until the kernel would
+/// block, since the same edge never fires twice.
+internal final class EpollSocket: Socket {
+    private var _descriptor: Int32
+    private var _connected: Bool
+    private let _options: ChannelOptions
+    private var _rcvbuf: UnsafeByteBuffer
+    private var _allocator: RecvBufferAllocator
+    private var _sndbuf: CompositeByteBuffer
+    private let _promises: WritePromiseQueue
+    private var _flushed: Int
+    private var _writable: Bool
+    
+    unowned
+    private let _eventLoop: EventLoop
+    
+    weak
+    private var _delegate: SocketDelegate?
+    
+    internal required init(eventLoop: EventLoop, options: ChannelOptions = ChannelOptions()) {
+        self._eventLoop  = eventLoop
+        self._options    = options
+        self._descriptor = -1
+        self._connected  = false
+        self._allocator  = options.recvAllocator
+        self._flushed    = 0
+        self._writable   = true
+        self._promises   = WritePromiseQueue()
+        self._rcvbuf = UnsafeByteBuffer(
+            capacity: kDefaultRcvBufferCapacity, pool: .default)
+        self._sndbuf = CompositeByteBuffer(
+            capacity: kDefaultSndBufferComponents)
+    }
+}
+
+extension EpollSocket {
+    internal var delegate: SocketDelegate? {
+        get {
+            return self._delegate
+        }
+        set(value) {
+            self._delegate = value
+        }
+    }
+    
+    internal var isWritable: Bool {
+        return self._writable
+    }
+}
+
+extension EpollSocket {
+    internal func close() throws {
+        // Queued bytes are never sent now
+        self._promises.fail(SocketError.closed)
+        
+        guard self._descriptor != -1 else {
+            throw ChannelError.alreadyClosed
+        }
+        
+        self._eventLoop.deregister(self, descriptor: self._descriptor)
+        
+        _ = fs_socket_close(self._descriptor)
+        
+        self._descriptor = -1
+        self._connected  = false
+        
+        self._delegate?.socket(closed: self)
+    }
+    
+    /// Starts connecting, the socket opens once it turns writable.
+    internal func connect(to host: String, port: Int) throws {
+        guard self._descriptor == -1 else {
+            throw self._connected ? ChannelError.alreadyConnected : ChannelError.alreadyConnecting
+        }
+        
+        var options    = self._options.socketOptions
+        var descriptor = Int32(-1)
+        
+        guard fs_socket_connect(host, UInt16(port), &options, &descriptor) == FS_OKAY else {
+            throw SocketError.ioError(EpollSocket.posixError())
+        }
+        
+        self._descriptor = descriptor
+        
+        do {
+            try self._eventLoop.register(self, descriptor: descriptor)
+        } catch let error {
+            _ = fs_socket_close(descriptor)
+            self._descriptor = -1
+            throw error
+        }
+    }
+    
+    private func finishConnect() throws {
+        guard fs_socket_finish_connect(self._descriptor) == FS_OKAY else {
+            throw SocketError.ioError(EpollSocket.posixError())
+        }
+        
+        self._connected = true
+        self._delegate?.socket(opened: self)
+    }
+}
+
+extension EpollSocket {
+    /// Called by the event loop, on its thread.
+    internal func ready(_ events: UInt32) {
+        do {
+            guard self._descriptor != -1 else {
+                return
+            }
+            
+            if  events & UInt32(FS_EVENT_WRITE | FS_EVENT_ERROR) != 0, !self._connected {
+                try self.finishConnect()
+            }
+            
+            if  events & UInt32(FS_EVENT_WRITE) != 0 {
+                try self.write()
+            }
+            
+            // A hung up peer may have left bytes behind,
+            // reading drains them and then finds the end
+            if  events & UInt32(FS_EVENT_READ | FS_EVENT_HANGUP) != 0 {
+                try self.read()
+            }
+        } catch let error {
+            self._promises.fail(error)
+            self._delegate?.socket(self, hasCaughtError: error)
+            
+            if self._descriptor != -1 {
+                try? self.close()
+            }
+        }
+    }
+}
+
+extension EpollSocket {
+    internal func read() throws {
+        guard self._connected else {
+            return
+        }
+        
+        for _ in 0 ..< self._options.maxMessagesPerRead {
+            let capacity = self._allocator.nextCapacity
+            let rcvbuf   = self.prepareRcvBuffer(capacity)
+            
+            var count  = UInt32()
+            let result = fs_socket_read(self._descriptor, &rcvbuf.handle, UInt32(capacity), &count)
+            
+            if  result == FS_ERR_EOF {
+                return try self.close()
+            }
+            
+            guard result == FS_OKAY else {
+                throw SocketError.ioError(EpollSocket.posixError())
+            }
+            
+            // Would block, the next edge brings more
+            guard count > 0 else {
+                return
+            }
+            
+            self._allocator.record(Int(count))
+            self._delegate?.socket(self, hasBytesAvailable: rcvbuf.readSlice(Int(count)))
+            
+            // Closed by a handler while it had the bytes
+            guard self._descriptor != -1 else {
+                return
+            }
+            
+            // Short reads leave the kernel's buffer empty
+            guard Int(count) == capacity else {
+                return
+            }
+        }
+        
+        // Still more to read but no edge will say so, picked
+        // up again after whatever else is queued has run
+        self._eventLoop.execute {
+            self.ready(UInt32(FS_EVENT_READ))
+        }
+    }
+    
+    /// Same reuse as `TCPSocket`, slices still in flight
+    /// keep the storage they see.
+    private func prepareRcvBuffer(_ capacity: Int) -> UnsafeByteBuffer {
+        let rcvbuf = self._rcvbuf
+        
+        if  rcvbuf.referenceCount == 1 {
+            rcvbuf.readerIndex = 0
+            rcvbuf.writerIndex = 0
+        }
+        
+        if  rcvbuf.writableBytes < capacity {
+            self._rcvbuf = UnsafeByteBuffer(capacity: max(capacity, kDefaultRcvBufferCapacity), pool: .default)
+        }
+        
+        return self._rcvbuf
+    }
+}
+
+extension EpollSocket {
+    /// Queues `data` without copying it, so the written
+    /// buffer must not be modified until it's been sent.
+    /// Nothing goes out until the next `flush()`.
+    internal func write(data buffer: ByteBuffer, promise: EventLoopPromise<Void>) throws {
+        self._promises.append(buffer.readableBytes, promise: promise)
+        
+        _ = self._sndbuf.addComponent(buffer)
+        
+        if  self._sndbuf.readableBytes > self._options.writeBufferHighWaterMark {
+            self.setWritable(false)
+        }
+    }
+    
+    internal func flush() throws {
+        self._flushed = self._sndbuf.readableBytes
+        
+        try self.write()
+    }
+    
+    private func write() throws {
+        guard self._connected else {
+            return
+        }
+        
+        var sent = 0
+        
+        while self._flushed > 0 {
+            var written = UInt32()
+            
+            guard fs_socket_writev(self._descriptor, &self._sndbuf.handle, UInt32(self._flushed), &written) == FS_OKAY else {
+                throw SocketError.ioError(EpollSocket.posixError())
+            }
+            
+            // Would block, resumed on the next writable edge
+            guard written > 0 else {
+                break
+            }
+            
+            self._flushed -= Int(written)
+            
+            sent += Int(written)
+        }
+        
+        _ = self._sndbuf.discardReadComponents()
+        
+        if  self._sndbuf.readableBytes < self._options.writeBufferLowWaterMark {
+            self.setWritable(true)
+        }
+        
+        self._promises.sent(sent)
+    }
+    
+    private func setWritable(_ value: Bool) {
+        guard self._writable != value else {
+            return
+        }
+        
+        self._writable = value
+        self._delegate?.socket(writabilityChanged: self)
+    }
+    
+    fileprivate static func posixError() -> Error {
+        return NSError(domain: NSPOSIXErrorDomain, code: Int(errno))
+    }
+}
+
+fileprivate let kDefaultRcvBufferCapacity: Int = 64 * 1024
+fileprivate let kDefaultSndBufferComponents: Int = 16
+#endif
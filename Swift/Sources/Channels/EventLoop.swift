@@ -0,0 +1,351 @@
+import Foundation
+import CFuse
+
+/// One thread running every event of the channels it owns. On
+/// Linux it also waits on epoll for their sockets, so readiness
+/// is handled right where it's found. Channels stay on the loop
+/// they were given for their whole lifetime.
+public final class EventLoop {
+    private let _cpu: Int?
+    private let _lock: NSCondition
+    private var _tasks: [() -> Void]
+    private var _channels: Int
+    private var _thread: Thread!
+    
+    #if os(Linux)
+    private let _selector: UnsafeMutablePointer<fs_event_loop_t>
+    private var _ring: UnsafeMutablePointer<fs_uring_t>?
+    private var _ringProbed: Bool = false
+    #endif
+    
+    internal init(name: String, cpu: Int? = nil) {
+        self._cpu      = cpu
+        self._lock     = NSCondition()
+        self._tasks    = []
+        self._channels = 0
+        
+        #if os(Linux)
+        self._selector = UnsafeMutablePointer<fs_event_loop_t>.allocate(capacity: 1)
+        
+        let result = fs_event_loop_init(self._selector)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while initializing event loop. Reason: \(message)")
+        }
+        #endif
+        
+        // Loops live as long as the process does
+        self._thread = Thread { [unowned self] in
+            self.run()
+        }
+        
+        self._thread.name = name
+        self._thread.start()
+    }
+}
+
+extension EventLoop {
+    public var inEventLoop: Bool {
+        return Thread.current === self._thread
+    }
+    
+    /// Channels created on this loop and still alive.
+    public var channelCount: Int {
+        self._lock.lock()
+        defer { self._lock.unlock() }
+        
+        return self._channels
+    }
+    
+    internal func register(channel: Channel) {
+        self._lock.lock()
+        self._channels += 1
+        self._lock.unlock()
+    }
+    
+    internal func deregister(channel: Channel) {
+        self._lock.lock()
+        self._channels -= 1
+        self._lock.unlock()
+    }
+    
+    /// Where `Stream` callbacks land before hopping onto the loop.
+    internal var streamQueue: DispatchQueue {
+        return kStreamQueue
+    }
+}
+
+extension EventLoop {
+    /// Runs `task` on the loop, after whatever it's running now.
+    public func execute(_ task: @escaping () -> Void) {
+        self._lock.lock()
+        self._tasks.append(task)
+        self._lock.unlock()
+        
+        #if os(Linux)
+        // On the loop the queue is checked before waiting again
+        if !self.inEventLoop {
+            _ = fs_event_loop_wakeup(self._selector)
+        }
+        #else
+        self._lock.signal()
+        #endif
+    }
+    
+    /// Runs `body` on the loop and waits for it, right away
+    /// when called from the loop itself.
+    public func sync<T>(_ body: @escaping () throws -> T) throws -> T {
+        if self.inEventLoop {
+            return try body()
+        }
+        
+        var value: T?
+        var failure: Error?
+        
+        let done = DispatchSemaphore(value: 0)
+        
+        self.execute {
+            do {
+                value = try body()
+            } catch let error {
+                failure = error
+            }
+            
+            done.signal()
+        }
+        
+        done.wait()
+        
+        if let error = failure {
+            throw error
+        }
+        
+        return value!
+    }
+    
+    private func takeTasks() -> [() -> Void] {
+        self._lock.lock()
+        defer { self._lock.unlock() }
+        
+        let tasks = self._tasks
+        self._tasks.removeAll(keepingCapacity: true)
+        
+        return tasks
+    }
+    
+    private var hasTasks: Bool {
+        self._lock.lock()
+        defer { self._lock.unlock() }
+        
+        return !self._tasks.isEmpty
+    }
+}
+
+#if os(Linux)
+extension EventLoop {
+    /// Sockets are retained while registered, so readiness
+    /// found just before they leave still has them around.
+    internal func register(_ socket: EpollSocket, descriptor: Int32) throws {
+        let context = Unmanaged.passRetained(socket)
+        
+        guard fs_event_loop_add(self._selector, descriptor, context.toOpaque()) == FS_OKAY else {
+            context.release()
+            throw SocketError.ioError(NSError(domain: NSPOSIXErrorDomain, code: Int(errno)))
+        }
+    }
+    
+    internal func deregister(_ socket: EpollSocket, descriptor: Int32) {
+        _ = fs_event_loop_remove(self._selector, descriptor)
+        
+        // Released after the batch being handled, if any
+        let context = Unmanaged.passUnretained(socket)
+        
+        self.execute {
+            context.release()
+        }
+    }
+    
+    /// The loop's io_uring, set up the first time it's asked
+    /// for. Nil when the kernel can't, sockets use epoll then.
+    /// Only ever touched on the loop.
+    internal var ring: UnsafeMutablePointer<fs_uring_t>? {
+        guard !self._ringProbed else {
+            return self._ring
+        }
+        
+        self._ringProbed = true
+        
+        let ring = UnsafeMutablePointer<fs_uring_t>.allocate(capacity: 1)
+        ring.initialize(to: fs_uring_t())
+        
+        guard fs_uring_init(ring, UInt32(kRingEntries), ByteBufferPool.default.handle, UInt32(kRingBuffers), UInt32(kRingBufferLength)) == FS_OKAY else {
+            ring.deinitialize(count: 1)
+            ring.deallocate()
+            return nil
+        }
+        
+        // Completions wake the same wait readiness does
+        guard fs_event_loop_add(self._selector, ring.pointee.fd, UnsafeMutableRawPointer(ring)) == FS_OKAY else {
+            _ = fs_uring_free(ring)
+            ring.deinitialize(count: 1)
+            ring.deallocate()
+            return nil
+        }
+        
+        self._ring = ring
+        
+        return ring
+    }
+    
+    /// Whether sockets on this loop can go through io_uring.
+    public var supportsIoUring: Bool {
+        return (try? self.sync { self.ring != nil }) ?? false
+    }
+    
+    private func run() {
+        if let cpu = self._cpu {
+            // Best effort, an unpinned loop works all the same
+            _ = fs_thread_pin(Int32(cpu))
+        }
+        
+        var events = [fs_event_t](repeating: fs_event_t(), count: kEventLoopBatchSize)
+        
+        var completions = [fs_uring_event_t](repeating: fs_uring_event_t(), count: kEventLoopBatchSize)
+        
+        while true {
+            // Requests queued last turn go in with one call
+            if  let ring = self._ring {
+                self.submit(ring)
+                self.reap(ring, &completions)
+            }
+            
+            let busy   = self.hasTasks || (self._ring?.pointee.pending ?? 0) > 0
+            var count  = UInt32()
+            let result = fs_event_loop_wait(self._selector, &events, UInt32(events.count), busy ? 0 : -1, &count)
+            
+            guard result == FS_OKAY else {
+                let message = String(cString: fs_error_to_string(result))
+                fatalError("Fatal error while waiting on event loop. Reason: \(message)")
+            }
+            
+            for event in events[0 ..< Int(count)] {
+                if  let ring = self._ring, event.context == UnsafeMutableRawPointer(ring) {
+                    self.reap(ring, &completions)
+                } else {
+                    Unmanaged<EpollSocket>.fromOpaque(event.context!).takeUnretainedValue().ready(event.events)
+                }
+            }
+            
+            self.takeTasks().forEach { $0() }
+        }
+    }
+    
+    private func submit(_ ring: UnsafeMutablePointer<fs_uring_t>) {
+        let result = fs_uring_submit(ring, 0)
+        
+        guard result == FS_OKAY else {
+            let message = String(cString: fs_error_to_string(result))
+            fatalError("Fatal error while submitting to io_uring. Reason: \(message)")
+        }
+    }
+    
+    /// Hands every completion to its socket, until none is left.
+    private func reap(_ ring: UnsafeMutablePointer<fs_uring_t>, _ completions: inout [fs_uring_event_t]) {
+        var count = UInt32()
+        
+        repeat {
+            _ = fs_uring_reap(ring, &completions, UInt32(completions.count), &count)
+            
+            for completion in completions[0 ..< Int(count)] {
+                // Cancellations come back without a socket
+                guard let context = completion.context else {
+                    continue
+                }
+                
+                Unmanaged<UringSocket>.fromOpaque(context).takeUnretainedValue().complete(completion)
+            }
+        } while count > 0
+    }
+}
+#else
+extension EventLoop {
+    private func run() {
+        if let cpu = self._cpu {
+            // Best effort, an unpinned loop works all the same
+            _ = fs_thread_pin(Int32(cpu))
+        }
+        
+        while true {
+            self._lock.lock()
+            
+            while self._tasks.isEmpty {
+                self._lock.wait()
+            }
+            
+            self._lock.unlock()
+            
+            self.takeTasks().forEach { $0() }
+        }
+    }
+}
+#endif
+
+/// A fixed set of event loops, handing them out to new channels.
+public final class EventLoopGroup {
+    public enum Chooser {
+        case roundRobin
+        case leastLoaded
+    }
+    
+    /// Shared by everything not given a group of its own.
+    public static let `default` = EventLoopGroup()
+    
+    private let _loops: [EventLoop]
+    private let _chooser: Chooser
+    private let _lock: NSLock
+    private var _next: Int
+    
+    /// - parameter loops: defaults to one per core
+    /// - parameter pinned: binds loop `n` to cpu `n % cores`, Linux only
+    public init(loops: Int = Int(fs_thread_cpu_count()), chooser: Chooser = .roundRobin, pinned: Bool = false) {
+        precondition(loops > 0, "an event loop group needs at least one loop")
+        
+        let cores = Int(fs_thread_cpu_count())
+        
+        self._loops = (0 ..< loops).map { index in
+            EventLoop(name: "io.fuse.eventloop.\(index)", cpu: pinned ? index % cores : nil)
+        }
+        
+        self._chooser = chooser
+        self._lock    = NSLock()
+        self._next    = 0
+    }
+}
+
+extension EventLoopGroup {
+    public var loops: [EventLoop] {
+        return self._loops
+    }
+    
+    public func next() -> EventLoop {
+        switch self._chooser {
+        case .roundRobin:
+            self._lock.lock()
+            defer { self._lock.unlock() }
+            
+            let loop = self._loops[self._next]
+            self._next = (self._next + 1) % self._loops.count
+            
+            return loop
+        case .leastLoaded:
+            return self._loops.min { $0.channelCount < $1.channelCount }!
+        }
+    }
+}
+
+fileprivate let kEventLoopBatchSize: Int = 64
+fileprivate let kRingEntries: Int = 1024
+fileprivate let kRingBuffers: Int = 256
+fileprivate let kRingBufferLength: Int = 16 * 1024
+fileprivate let kStreamQueue: DispatchQueue = DispatchQueue(label: "io.fuse.eventloop.streams")
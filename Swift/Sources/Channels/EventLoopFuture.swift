@@ -0,0 +1,222 @@
+import Foundation
+
+/// What a future ends up holding.
+public enum EventLoopFutureValue<T> {
+    case success(T)
+    case failure(Error)
+}
+
+/// The result of work done on an event loop, there or later.
+/// Callbacks always run on the future's loop, right away when
+/// it completes there, so chained futures on the same loop
+/// complete one after the other without queueing a hop.
+public final class EventLoopFuture<T> {
+    private let _eventLoop: EventLoop
+    private var _value: EventLoopFutureValue<T>?
+    private var _callbacks: [(EventLoopFutureValue<T>) -> Void]
+    
+    internal init(eventLoop: EventLoop) {
+        self._eventLoop = eventLoop
+        self._value     = nil
+        self._callbacks = []
+    }
+    
+    /// Already completed, for results known up front.
+    public convenience init(eventLoop: EventLoop, value: EventLoopFutureValue<T>) {
+        self.init(eventLoop: eventLoop)
+        self._value = value
+    }
+}
+
+extension EventLoopFuture {
+    public var eventLoop: EventLoop {
+        return self._eventLoop
+    }
+    
+    /// Only meaningful on the loop, elsewhere it may be stale.
+    public var isFulfilled: Bool {
+        return self._value != nil
+    }
+}
+
+extension EventLoopFuture {
+    /// Runs `callback` with the value once there is one.
+    public func whenComplete(_ callback: @escaping (EventLoopFutureValue<T>) -> Void) {
+        guard self._eventLoop.inEventLoop else {
+            self._eventLoop.execute {
+                self.whenComplete(callback)
+            }
+            return
+        }
+        
+        if  let value = self._value {
+            callback(value)
+        } else {
+            self._callbacks.append(callback)
+        }
+    }
+    
+    public func whenSuccess(_ callback: @escaping (T) -> Void) {
+        self.whenComplete { value in
+            if  case .success(let result) = value {
+                callback(result)
+            }
+        }
+    }
+    
+    public func whenFailure(_ callback: @escaping (Error) -> Void) {
+        self.whenComplete { value in
+            if  case .failure(let error) = value {
+                callback(error)
+            }
+        }
+    }
+    
+    /// A future for what `body` makes of this one's result.
+    /// Failures, this one's or thrown by `body`, go through.
+    public func map<U>(_ body: @escaping (T) throws -> U) -> EventLoopFuture<U> {
+        let next = EventLoopFuture<U>(eventLoop: self._eventLoop)
+        
+        self.whenComplete { value in
+            switch value {
+            case .success(let result):
+                do {
+                    next.complete(.success(try body(result)))
+                } catch let error {
+                    next.complete(.failure(error))
+                }
+            case .failure(let error):
+                next.complete(.failure(error))
+            }
+        }
+        
+        return next
+    }
+    
+    /// Chains work that's asynchronous itself. The returned
+    /// future is on this one's loop whatever loop `body`'s is.
+    public func flatMap<U>(_ body: @escaping (T) throws -> EventLoopFuture<U>) -> EventLoopFuture<U> {
+        let next = EventLoopFuture<U>(eventLoop: self._eventLoop)
+        
+        self.whenComplete { value in
+            switch value {
+            case .success(let result):
+                do {
+                    try body(result).whenComplete { next.complete($0) }
+                } catch let error {
+                    next.complete(.failure(error))
+                }
+            case .failure(let error):
+                next.complete(.failure(error))
+            }
+        }
+        
+        return next
+    }
+    
+    /// Blocks until there's a value. Never on the loop itself,
+    /// the loop would be waiting on its own work.
+    public func wait() throws -> T {
+        precondition(!self._eventLoop.inEventLoop, "waiting on a future from its own event loop would never return")
+        
+        var value: EventLoopFutureValue<T>?
+        
+        let done = DispatchSemaphore(value: 0)
+        
+        self.whenComplete {
+            value = $0
+            done.signal()
+        }
+        
+        done.wait()
+        
+        switch value! {
+        case .success(let result):
+            return result
+        case .failure(let error):
+            throw error
+        }
+    }
+}
+
+extension EventLoopFuture {
+    /// The first value wins, later ones are dropped.
+    internal func complete(_ value: EventLoopFutureValue<T>) {
+        guard self._eventLoop.inEventLoop else {
+            self._eventLoop.execute {
+                self.complete(value)
+            }
+            return
+        }
+        
+        guard self._value == nil else {
+            return
+        }
+        
+        self._value = value
+        
+        let callbacks = self._callbacks
+        self._callbacks.removeAll()
+        
+        callbacks.forEach { $0(value) }
+    }
+}
+
+/// The side of a future that completes it. A value type, it
+/// holds nothing else than the future, and the void promise
+/// not even that: fire and forget operations use it to skip
+/// allocating a future no one would look at.
+public struct EventLoopPromise<T> {
+    private let _future: EventLoopFuture<T>?
+    
+    public init(eventLoop: EventLoop) {
+        self._future = EventLoopFuture(eventLoop: eventLoop)
+    }
+    
+    private init(future: EventLoopFuture<T>?) {
+        self._future = future
+    }
+}
+
+extension EventLoopPromise {
+    /// Traps on the void promise, there's nothing to observe.
+    public var futureResult: EventLoopFuture<T> {
+        guard let future = self._future else {
+            preconditionFailure("the void promise has no future")
+        }
+        
+        return future
+    }
+    
+    public var isVoid: Bool {
+        return self._future == nil
+    }
+    
+    public func succeed(_ value: T) {
+        self._future?.complete(.success(value))
+    }
+    
+    /// On the void promise the error is dropped here, outbound
+    /// failures reach the pipeline's error handlers either way.
+    public func fail(_ error: Error) {
+        self._future?.complete(.failure(error))
+    }
+}
+
+extension EventLoopPromise where T == Void {
+    /// Shared by every fire and forget operation, it allocates
+    /// nothing and completing it does nothing.
+    public static var void: EventLoopPromise<Void> {
+        return EventLoopPromise(future: nil)
+    }
+    
+    public func succeed() {
+        self.succeed(())
+    }
+}
+
+extension EventLoop {
+    public func newPromise<T>(of type: T.Type = T.self) -> EventLoopPromise<T> {
+        return EventLoopPromise(eventLoop: self)
+    }
+}
@@ -0,0 +1,193 @@
+import Foundation
+
+/// Frames of exactly `frameLength` bytes.
+public final class FixedLengthFrameDecoder: ByteToMessageDecoder {
+    private let _frameLength: Int
+    
+    public init(frameLength: Int) {
+        precondition(frameLength > 0, "Frame length must be positive")
+        self._frameLength = frameLength
+    }
+    
+    public func decode(_ buffer: inout ByteBuffer) throws -> ByteBuffer? {
+        guard buffer.readableBytes >= self._frameLength else {
+            return nil
+        }
+        
+        return buffer.readSlice(self._frameLength)
+    }
+}
+
+/// Frames ended by `\n` or `\r\n`.
+public final class LineBasedFrameDecoder: ByteToMessageDecoder {
+    private let _maxLength: Int
+    private let _stripDelimiter: Bool
+    
+    // Readable bytes already searched, so fragmented
+    // lines aren't searched again from their start
+    private var _scanned: Int
+    
+    public init(maxLength: Int, stripDelimiter: Bool = true) {
+        self._maxLength      = maxLength
+        self._stripDelimiter = stripDelimiter
+        self._scanned        = 0
+    }
+    
+    public func decode(_ buffer: inout ByteBuffer) throws -> ByteBuffer? {
+        let end = buffer.readerIndex + buffer.readableBytes
+        
+        guard let eol = buffer.index(of: 0x0A, from: buffer.readerIndex + self._scanned, to: end) else {
+            self._scanned = buffer.readableBytes
+            
+            guard self._scanned <= self._maxLength + 2 else {
+                self._scanned = 0
+                throw DecoderError.frameTooLong(buffer.readableBytes)
+            }
+            
+            return nil
+        }
+        
+        self._scanned = 0
+        
+        var length    = eol - buffer.readerIndex
+        var delimiter = 1
+        
+        if length > 0 && buffer.getInt8(at: eol - 1) == 0x0D {
+            length    -= 1
+            delimiter += 1
+        }
+        
+        guard length <= self._maxLength else {
+            throw DecoderError.frameTooLong(length)
+        }
+        
+        if self._stripDelimiter {
+            let frame = buffer.readSlice(length)
+            buffer.readerIndex += delimiter
+            return frame
+        }
+        
+        return buffer.readSlice(length + delimiter)
+    }
+}
+
+/// Frames ended by any given sequence of bytes.
+public final class DelimiterBasedFrameDecoder: ByteToMessageDecoder {
+    private let _delimiter: [UInt8]
+    private let _maxLength: Int
+    private let _stripDelimiter: Bool
+    
+    // Readable bytes already searched, so fragmented
+    // frames aren't searched again from their start
+    private var _scanned: Int
+    
+    public init(delimiter: [UInt8], maxLength: Int, stripDelimiter: Bool = true) {
+        precondition(!delimiter.isEmpty, "Delimiter must not be empty")
+        self._delimiter      = delimiter
+        self._maxLength      = maxLength
+        self._stripDelimiter = stripDelimiter
+        self._scanned        = 0
+    }
+    
+    public func decode(_ buffer: inout ByteBuffer) throws -> ByteBuffer? {
+        let end = buffer.readerIndex + buffer.readableBytes
+        
+        // A delimiter may have been cut short at the end
+        let from = buffer.readerIndex + max(0, self._scanned - self._delimiter.count + 1)
+        
+        guard let at = buffer.index(of: self._delimiter, from: from, to: end) else {
+            self._scanned = buffer.readableBytes
+            
+            guard self._scanned <= self._maxLength + self._delimiter.count else {
+                self._scanned = 0
+                throw DecoderError.frameTooLong(buffer.readableBytes)
+            }
+            
+            return nil
+        }
+        
+        self._scanned = 0
+        
+        let length = at - buffer.readerIndex
+        
+        guard length <= self._maxLength else {
+            throw DecoderError.frameTooLong(length)
+        }
+        
+        if self._stripDelimiter {
+            let frame = buffer.readSlice(length)
+            buffer.readerIndex += self._delimiter.count
+            return frame
+        }
+        
+        return buffer.readSlice(length + self._delimiter.count)
+    }
+}
+
+/// Frames carrying their own length in a header field.
+///
+/// A frame spans the header up to the end of the length field
+/// plus its value, plus `lengthAdjustment` for fields that count
+/// more, or less, than the bytes following them. The first
+/// `initialBytesToStrip` bytes are left out of the frame fired.
+public final class LengthFieldBasedFrameDecoder: ByteToMessageDecoder {
+    private let _maxFrameLength: Int
+    private let _lengthFieldOffset: Int
+    private let _lengthFieldLength: Int
+    private let _lengthAdjustment: Int
+    private let _initialBytesToStrip: Int
+    private let _endianness: Endianness
+    
+    /// - parameter lengthFieldLength: 1, 2, 4 or 8 bytes
+    public init(maxFrameLength: Int, lengthFieldOffset: Int = 0, lengthFieldLength: Int = 4, lengthAdjustment: Int = 0, initialBytesToStrip: Int = 0, endianness: Endianness = .bigEndian) {
+        precondition([1, 2, 4, 8].contains(lengthFieldLength), "Length field must be 1, 2, 4 or 8 bytes long")
+        self._maxFrameLength      = maxFrameLength
+        self._lengthFieldOffset   = lengthFieldOffset
+        self._lengthFieldLength   = lengthFieldLength
+        self._lengthAdjustment    = lengthAdjustment
+        self._initialBytesToStrip = initialBytesToStrip
+        self._endianness          = endianness
+    }
+    
+    public func decode(_ buffer: inout ByteBuffer) throws -> ByteBuffer? {
+        let headerLength = self._lengthFieldOffset + self._lengthFieldLength
+        
+        guard buffer.readableBytes >= headerLength else {
+            return nil
+        }
+        
+        let at = buffer.readerIndex + self._lengthFieldOffset
+        let length: Int64
+        
+        switch self._lengthFieldLength {
+        case 1:
+            length = Int64(UInt8 (bitPattern: buffer.getInt8 (at: at)))
+        case 2:
+            length = Int64(UInt16(bitPattern: buffer.getInt16(at: at, endianness: self._endianness)))
+        case 4:
+            length = Int64(UInt32(bitPattern: buffer.getInt32(at: at, endianness: self._endianness)))
+        default:
+            length = buffer.getInt64(at: at, endianness: self._endianness)
+        }
+        
+        let (adjusted, overflow) = length.addingReportingOverflow(Int64(self._lengthAdjustment + headerLength))
+        
+        guard !overflow, adjusted >= Int64(max(headerLength, self._initialBytesToStrip)) else {
+            throw DecoderError.invalidLengthField(length)
+        }
+        
+        guard adjusted <= Int64(self._maxFrameLength) else {
+            throw DecoderError.frameTooLong(Int(clamping: adjusted))
+        }
+        
+        let frameLength = Int(adjusted)
+        
+        guard buffer.readableBytes >= frameLength else {
+            return nil
+        }
+        
+        buffer.readerIndex += self._initialBytesToStrip
+        
+        return buffer.readSlice(frameLength - self._initialBytesToStrip)
+    }
+}
@@ -0,0 +1,352 @@
+#if os(Linux)
+import Foundation
+import CFuse
+
+/// Non-blocking TCP socket on its event loop's io_uring. Rather
+/// than waiting for readiness and then reading, one multishot
+/// receive stays armed for the socket's whole life and the kernel
+/// fills buffers the ring provides from the pool, handed over
+/// without copying. Sends are queued as gathering writes and go
+/// in with whatever else the loop submits before its next wait.
+internal final class UringSocket: Socket {
+    private var _descriptor: Int32
+    private var _closing: Int32
+    private var _connected: Bool
+    private let _options: ChannelOptions
+    private var _sndbuf: CompositeByteBuffer
+    private let _promises: WritePromiseQueue
+    private let _send: UnsafeMutablePointer<fs_uring_send_t>
+    private var _flushed: Int
+    private var _sending: Bool
+    private var _receiving: Bool
+    private var _writable: Bool
+    private var _inflight: Int
+    
+    unowned
+    private let _eventLoop: EventLoop
+    
+    weak
+    private var _delegate: SocketDelegate?
+    
+    internal required init(eventLoop: EventLoop, options: ChannelOptions = ChannelOptions()) {
+        self._eventLoop  = eventLoop
+        self._options    = options
+        self._descriptor = -1
+        self._closing    = -1
+        self._connected  = false
+        self._flushed    = 0
+        self._sending    = false
+        self._receiving  = false
+        self._writable   = true
+        self._inflight   = 0
+        self._promises   = WritePromiseQueue()
+        self._send = UnsafeMutablePointer<fs_uring_send_t>.allocate(capacity: 1)
+        self._send.initialize(to: fs_uring_send_t())
+        self._sndbuf = CompositeByteBuffer(
+            capacity: kDefaultSndBufferComponents)
+    }
+    
+    deinit {
+        self._send.deinitialize(count: 1)
+        self._send.deallocate()
+    }
+}
+
+extension UringSocket {
+    internal var delegate: SocketDelegate? {
+        get {
+            return self._delegate
+        }
+        set(value) {
+            self._delegate = value
+        }
+    }
+    
+    internal var isWritable: Bool {
+        return self._writable
+    }
+    
+    /// Only asked for once the loop has been found to have one.
+    private var ring: UnsafeMutablePointer<fs_uring_t> {
+        return self._eventLoop.ring!
+    }
+}
+
+extension UringSocket {
+    internal func close() throws {
+        // Queued bytes are never sent now
+        self._promises.fail(SocketError.closed)
+        
+        guard self._descriptor != -1 else {
+            throw ChannelError.alreadyClosed
+        }
+        
+        // Multishot requests hold the descriptor open, they
+        // must be cancelled before it's closed, not after. The
+        // cancel may only go in with the loop's next submit, so
+        // the descriptor is closed once they've all finished: a
+        // number reused meanwhile would be cancelled otherwise.
+        if  self._inflight > 0 {
+            if  fs_uring_cancel(self.ring, self._descriptor) != FS_OKAY {
+                // No room for it, shutting down ends them too
+                _ = shutdown(self._descriptor, Int32(SHUT_RDWR))
+            }
+            
+            self._closing = self._descriptor
+        } else {
+            _ = fs_socket_close(self._descriptor)
+        }
+        
+        self._descriptor = -1
+        self._connected  = false
+        
+        self._delegate?.socket(closed: self)
+    }
+    
+    /// Starts connecting, the socket opens once it turns writable.
+    internal func connect(to host: String, port: Int) throws {
+        guard self._descriptor == -1 else {
+            throw self._connected ? ChannelError.alreadyConnected : ChannelError.alreadyConnecting
+        }
+        
+        var options    = self._options.socketOptions
+        var descriptor = Int32(-1)
+        
+        guard fs_socket_connect(host, UInt16(port), &options, &descriptor) == FS_OKAY else {
+            throw SocketError.ioError(UringSocket.posixError())
+        }
+        
+        self._descriptor = descriptor
+        
+        guard fs_uring_poll(self.ring, descriptor, UInt32(FS_EVENT_WRITE), self.request()) == FS_OKAY else {
+            let error = UringSocket.posixError()
+            
+            self.finished()
+            
+            _ = fs_socket_close(descriptor)
+            self._descriptor = -1
+            
+            throw SocketError.ioError(error)
+        }
+    }
+    
+    private func finishConnect() throws {
+        guard fs_socket_finish_connect(self._descriptor) == FS_OKAY else {
+            throw SocketError.ioError(UringSocket.posixError())
+        }
+        
+        self._connected = true
+        
+        try self.read()
+        
+        self._delegate?.socket(opened: self)
+        
+        // Written before the connection opened
+        try self.write()
+    }
+}
+
+extension UringSocket {
+    /// Called by the event loop with each of this socket's
+    /// completions, on its thread.
+    internal func complete(_ event: fs_uring_event_t) {
+        defer {
+            if  event.flags & UInt32(FS_URING_MORE) == 0 {
+                self.finished()
+            }
+        }
+        
+        do {
+            // Cancelled requests finishing, buffers they
+            // still filled just go back to the pool
+            guard self._descriptor != -1 else {
+                return try self.drop(event)
+            }
+            
+            switch Int32(event.op) {
+            case FS_URING_OP_POLL:
+                try self.finishConnect()
+            case FS_URING_OP_RECV:
+                try self.received(event)
+            case FS_URING_OP_SEND:
+                try self.sent(event)
+            default:
+                break
+            }
+        } catch let error {
+            self._promises.fail(error)
+            self._delegate?.socket(self, hasCaughtError: error)
+            
+            if self._descriptor != -1 {
+                try? self.close()
+            }
+        }
+    }
+    
+    private func received(_ event: fs_uring_event_t) throws {
+        if  event.flags & UInt32(FS_URING_BUFFER) != 0, event.result > 0 {
+            var handle = fs_byte_buffer_t()
+            
+            guard fs_uring_take_buffer(self.ring, event.buffer, UInt32(event.result), &handle) == FS_OKAY else {
+                throw SocketError.ioError(UringSocket.posixError())
+            }
+            
+            self._delegate?.socket(self, hasBytesAvailable: UnsafeByteBuffer(handle: handle, pool: .default))
+        }
+        
+        if  event.result == 0 {
+            return try self.close()
+        }
+        
+        // Out of provided buffers, or anything else that ends
+        // the request without an error, it's armed again
+        if  event.flags & UInt32(FS_URING_MORE) == 0, self._descriptor != -1 {
+            self._receiving = false
+            
+            guard event.result > 0 || event.result == -ENOBUFS else {
+                throw SocketError.ioError(NSError(domain: NSPOSIXErrorDomain, code: Int(-event.result)))
+            }
+            
+            try self.read()
+        }
+    }
+    
+    private func drop(_ event: fs_uring_event_t) throws {
+        guard event.flags & UInt32(FS_URING_BUFFER) != 0, event.result > 0 else {
+            return
+        }
+        
+        var handle = fs_byte_buffer_t()
+        
+        if  fs_uring_take_buffer(self.ring, event.buffer, UInt32(event.result), &handle) == FS_OKAY {
+            _ = fs_byte_buffer_free(&handle)
+        }
+    }
+}
+
+extension UringSocket {
+    /// Arms the multishot receive, reads then keep coming
+    /// without asking until the socket closes.
+    internal func read() throws {
+        guard self._connected, !self._receiving else {
+            return
+        }
+        
+        guard fs_uring_recv(self.ring, self._descriptor, self.request()) == FS_OKAY else {
+            self.finished()
+            throw SocketError.ioError(UringSocket.posixError())
+        }
+        
+        self._receiving = true
+    }
+}
+
+extension UringSocket {
+    /// Queues `data` without copying it, so the written
+    /// buffer must not be modified until it's been sent.
+    /// Nothing goes out until the next `flush()`.
+    internal func write(data buffer: ByteBuffer, promise: EventLoopPromise<Void>) throws {
+        self._promises.append(buffer.readableBytes, promise: promise)
+        
+        _ = self._sndbuf.addComponent(buffer)
+        
+        if  self._sndbuf.readableBytes > self._options.writeBufferHighWaterMark {
+            self.setWritable(false)
+        }
+    }
+    
+    internal func flush() throws {
+        self._flushed = self._sndbuf.readableBytes
+        
+        try self.write()
+    }
+    
+    /// One send in flight at a time, bytes flushed meanwhile
+    /// go out together once it completes.
+    private func write() throws {
+        guard self._connected, !self._sending, self._flushed > 0 else {
+            return
+        }
+        
+        guard fs_uring_sendmsg(self.ring, self._descriptor, self._send, &self._sndbuf.handle, UInt32(self._flushed), self.request()) == FS_OKAY else {
+            self.finished()
+            throw SocketError.ioError(UringSocket.posixError())
+        }
+        
+        self._sending = true
+    }
+    
+    private func sent(_ event: fs_uring_event_t) throws {
+        self._sending = false
+        
+        guard event.result >= 0 else {
+            throw SocketError.ioError(NSError(domain: NSPOSIXErrorDomain, code: Int(-event.result)))
+        }
+        
+        self._sndbuf.readerIndex += Int(event.result)
+        self._flushed -= Int(event.result)
+        
+        _ = self._sndbuf.discardReadComponents()
+        
+        if  self._sndbuf.readableBytes < self._options.writeBufferLowWaterMark {
+            self.setWritable(true)
+        }
+        
+        self._promises.sent(Int(event.result))
+        
+        try self.write()
+    }
+    
+    private func setWritable(_ value: Bool) {
+        guard self._writable != value else {
+            return
+        }
+        
+        self._writable = value
+        self._delegate?.socket(writabilityChanged: self)
+    }
+}
+
+extension UringSocket {
+    /// The context of a new request. The socket is retained
+    /// while any is in flight, the kernel may still write into
+    /// its send state or complete after it's been closed.
+    private func request() -> UnsafeMutableRawPointer {
+        let context = Unmanaged.passUnretained(self)
+        
+        if  self._inflight == 0 {
+            _ = context.retain()
+        }
+        
+        self._inflight += 1
+        
+        return context.toOpaque()
+    }
+    
+    private func finished() {
+        self._inflight -= 1
+        
+        guard self._inflight == 0 else {
+            return
+        }
+        
+        if  self._closing != -1 {
+            _ = fs_socket_close(self._closing)
+            self._closing = -1
+        }
+        
+        // Released after the batch being handled
+        let context = Unmanaged.passUnretained(self)
+        
+        self._eventLoop.execute {
+            context.release()
+        }
+    }
+    
+    fileprivate static func posixError() -> Error {
+        return NSError(domain: NSPOSIXErrorDomain, code: Int(errno))
+    }
+}
+
+fileprivate let kDefaultSndBufferComponents: Int = 16
+#endif
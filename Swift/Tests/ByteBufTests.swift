@@ -10,5 +10,264 @@ import Fuse
 
 class ByteBufferTests: XCTestCase {
     
+    func testPooledBufferReusesStorage() {
+        let pool = ByteBufferPool()
+        
+        do {
+            let buffer = UnsafeByteBuffer(capacity: 100, pool: pool)
+            XCTAssertEqual(buffer.capacity, 128)
+        }
+        
+        do {
+            let buffer = UnsafeByteBuffer(capacity: 120, pool: pool)
+            _ = buffer.write(int32: 42, endianness: .bigEndian)
+            XCTAssertEqual(buffer.readInt32(endianness: .bigEndian), 42)
+        }
+        
+        XCTAssertEqual(pool.stats.misses, 1)
+        XCTAssertEqual(pool.stats.hits, 1)
+        XCTAssertEqual(pool.stats.bytesRetained, 128)
+    }
     
+    func testPooledBufferCopy() {
+        let buffer = UnsafeByteBuffer(capacity: 64, pool: ByteBufferPool.default)
+        _ = buffer.write(int64: 7, endianness: .littleEndian)
+        
+        let copy = buffer.copy()
+        XCTAssertEqual(copy.readInt64(endianness: .littleEndian), 7)
+        XCTAssertEqual(buffer.readableBytes, 8)
+    }
+    
+    func testSliceSharesStorage() {
+        let buffer = UnsafeByteBuffer(capacity: 64)
+        _ = buffer.write(int32: 1, endianness: .bigEndian)
+        _ = buffer.write(int32: 2, endianness: .bigEndian)
+        
+        let slice = buffer.readSlice(4)
+        XCTAssertEqual(buffer.referenceCount, 2)
+        XCTAssertEqual(buffer.readInt32(endianness: .bigEndian), 2)
+        
+        _ = buffer.set(int32: 3, at: 0, endianness: .bigEndian)
+        XCTAssertEqual(slice.readInt32(endianness: .bigEndian), 3)
+    }
+    
+    func testSliceOutlivesParent() {
+        var slice: ByteBuffer? = nil
+        
+        do {
+            let buffer = UnsafeByteBuffer(capacity: 64)
+            _ = buffer.write(int64: 9, endianness: .littleEndian)
+            slice = buffer.getSlice(at: 0, length: 8)
+        }
+        
+        XCTAssertEqual(slice?.readInt64(endianness: .littleEndian), 9)
+    }
+    
+    func testCompositeReadsAcrossComponents() {
+        let head = UnsafeByteBuffer(capacity: 64)
+        let tail = UnsafeByteBuffer(capacity: 64)
+        _ = head.write(int16: 0x0102, endianness: .bigEndian)
+        _ = tail.write(int16: 0x0304, endianness: .bigEndian)
+        
+        let composite = CompositeByteBuffer()
+            .addComponent(head.readSlice(1))
+            .addComponent(head)
+            .addComponent(tail)
+        
+        XCTAssertEqual(composite.numberOfComponents, 3)
+        XCTAssertEqual(composite.readInt32(endianness: .bigEndian), 0x01020304)
+    }
+    
+    func testWritingABufferCopiesItsReadableBytesOnly() {
+        let bytes: [UInt8] = [1, 2, 3, 4]
+        let source = UnsafeByteBuffer(capacity: 8).write(bytes: bytes)
+        _ = source.readBytes(2)
+        
+        let target = UnsafeByteBuffer(capacity: 8).write(bytes: source)
+        
+        XCTAssertEqual(target.readableBytes, 2)
+        XCTAssertEqual(target.readBytes(2), [3, 4])
+        XCTAssertEqual(source.readerIndex, 2)
+        
+        // Partly read composites too, gathered from their reader index
+        let composite = CompositeByteBuffer()
+            .addComponent(UnsafeByteBuffer(capacity: 4).write(bytes: bytes))
+        _ = composite.readBytes(1)
+        
+        XCTAssertEqual(UnsafeByteBuffer(capacity: 8).write(bytes: composite).readBytes(3), [2, 3, 4])
+    }
+    
+    func testCompositeExportsIovecs() {
+        let composite = CompositeByteBuffer()
+        
+        for value in 0 ..< 3 {
+            let buffer = UnsafeByteBuffer(capacity: 64)
+            _ = buffer.write(int32: Int32(value), endianness: .bigEndian)
+            _ = composite.addComponent(buffer)
+        }
+        
+        _ = composite.readInt32(endianness: .bigEndian)
+        _ = composite.discardReadComponents()
+        
+        composite.withUnsafeReadableIovecs { iovecs in
+            XCTAssertEqual(iovecs.count, 2)
+            XCTAssertEqual(iovecs.reduce(0) { $0 + $1.iov_len }, 8)
+        }
+    }
+    
+    func testBulkIntegersRoundTrip() {
+        let values = (0 ..< 37).map { Int32($0) * 0x01020304 }
+        let buffer = UnsafeByteBuffer(capacity: 256)
+            .write(int8: 0)
+            .write(int32s: values, endianness: .bigEndian)
+        
+        XCTAssertEqual(buffer.getInt32(at: 5, endianness: .bigEndian), values[1])
+        XCTAssertEqual(buffer.readInt8(), 0)
+        XCTAssertEqual(buffer.readInt32s(count: values.count, endianness: .bigEndian), values)
+        XCTAssertEqual(buffer.readableBytes, 0)
+    }
+    
+    func testVarintRoundTrip() {
+        let values: [UInt32] = [0, 1, 127, 128, 300, 16384, UInt32.max] + (0 ..< 32).map { UInt32($0) }
+        let buffer = UnsafeByteBuffer(capacity: 256)
+        
+        for value in values {
+            _ = buffer.write(varint32: value)
+        }
+        
+        _ = buffer.write(zigzag64: -2)
+        
+        XCTAssertEqual(buffer.getInt8(at: 3), Int8(bitPattern: 0x80))
+        XCTAssertEqual(buffer.readVarint32s(count: values.count), values)
+        XCTAssertEqual(buffer.readZigZag64(), -2)
+    }
+    
+    func testMappedFileIsReadable() {
+        let path = NSTemporaryDirectory() + "fuse-mapped-file.bin"
+        FileManager.default.createFile(atPath: path, contents: Data([0, 0, 0, 42]))
+        
+        let buffer = UnsafeByteBuffer(contentsOfFile: path)?.advise(.sequential)
+        XCTAssertEqual(buffer?.readableBytes, 4)
+        XCTAssertEqual(buffer?.readInt32(endianness: .bigEndian), 42)
+        XCTAssertNil(UnsafeByteBuffer(contentsOfFile: path + ".missing"))
+    }
+    
+    func testRingDiscardWrapsAround() {
+        let buffer = UnsafeByteBuffer(ringCapacity: 100)
+        let filler = [UInt8](repeating: 7, count: buffer.capacity - 4)
+        
+        // the second value straddles the end of the ring
+        _ = buffer.write(bytes: filler).readBytes(filler.count)
+        _ = buffer.discardReadBytes().write(int64: 42, endianness: .bigEndian)
+        
+        XCTAssertEqual(buffer.readerIndex, 0)
+        XCTAssertEqual(buffer.readInt64(endianness: .bigEndian), 42)
+    }
+    
+    func testWritesGrowUpToMaxCapacity() {
+        let buffer = UnsafeByteBuffer(capacity: 8)
+        buffer.growthPolicy = ByteBufferGrowthPolicy(step: 16, maxCapacity: 40)
+        
+        _ = buffer.write(int64s: [1, 2, 3, 4], endianness: .bigEndian)
+        
+        XCTAssertEqual(buffer.capacity, 40)
+        XCTAssertEqual(buffer.readInt64s(count: 4, endianness: .bigEndian), [1, 2, 3, 4])
+    }
+    
+    func testFindsDelimitersAcrossComponents() {
+        let head = UnsafeByteBuffer(capacity: 64).write(bytes: Array("GET / HTTP/1.1\r".utf8))
+        let tail = UnsafeByteBuffer(capacity: 64).write(bytes: Array("\nHost: a\r\n".utf8))
+        let composite = CompositeByteBuffer().addComponent(head).addComponent(tail)
+        
+        XCTAssertEqual(head.index(of: UInt8(ascii: " ")), 3)
+        XCTAssertNil(head.index(of: [0x0D, 0x0A]))
+        XCTAssertEqual(composite.index(of: [0x0D, 0x0A]), 14)
+        XCTAssertEqual(composite.index(of: [0x0D, 0x0A], from: 15, to: composite.writerIndex), 23)
+        XCTAssertEqual(composite.forEachByte { $0 != UInt8(ascii: ":") }, 20)
+    }
+    
+    func testLineDecoderResumesFragmentedLines() throws {
+        let decoder = LineBasedFrameDecoder(maxLength: 64)
+        var buffer: ByteBuffer = UnsafeByteBuffer(capacity: 64).write(bytes: Array("PING\r".utf8))
+        
+        XCTAssertNil(try decoder.decode(&buffer))
+        _ = buffer.write(bytes: Array("\nPONG\n".utf8))
+        
+        XCTAssertEqual(try decoder.decode(&buffer)?.readBytes(4), Array("PING".utf8))
+        XCTAssertEqual(try decoder.decode(&buffer)?.readableBytes, 4)
+        XCTAssertEqual(buffer.readableBytes, 0)
+    }
+    
+    func testCRC32CChainsAcrossComponents() {
+        let composite = CompositeByteBuffer()
+            .addComponent(UnsafeByteBuffer(capacity: 64).write(bytes: Array("1234".utf8)))
+            .addComponent(UnsafeByteBuffer(capacity: 64).write(bytes: Array("56789".utf8)))
+        
+        XCTAssertEqual(composite.crc32c(), 0xE3069283)
+        XCTAssertEqual(composite.crc32c(at: 4, length: 5, seed: composite.crc32c(at: 0, length: 4, seed: 0)), 0xE3069283)
+        XCTAssertEqual(composite.xxHash64(), composite.copy().xxHash64())
+    }
+    
+    func testDecompressorInflatesCompressedBlocks() throws {
+        let line   = Array("{\"ts\":1529990000,\"cpu\":0.42}\n".utf8)
+        let source = UnsafeByteBuffer(capacity: 4096)
+        
+        for _ in 0..<64 {
+            _ = source.write(bytes: line)
+        }
+        
+        let length = source.readableBytes
+        let frame  = UnsafeByteBuffer(capacity: 4096).write(int32: 0).write(int32: Int32(length))
+        
+        let compressed = frame.write(compressing: source, length: length)
+        XCTAssertLessThan(compressed, length / 4)
+        
+        let decoder = BlockDecompressor(pool: nil)
+        var buffer: ByteBuffer = frame.set(int32: Int32(compressed), at: 0)
+        
+        let decoded = try decoder.decode(&buffer)
+        XCTAssertEqual(decoded?.readableBytes, length)
+        XCTAssertEqual(decoded?.getBytes(at: length - line.count, length: line.count), line)
+        XCTAssertEqual(buffer.readableBytes, 0)
+    }
+    
+    func testStringsRejectMalformedUTF8() {
+        let buffer = UnsafeByteBuffer(capacity: 64).write(string: "GET ").write(string: "café €")
+        
+        XCTAssertEqual(buffer.readString(length: 4), "GET ")
+        XCTAssertEqual(buffer.getString(at: 4, length: 9), "café €")
+        
+        // Cut in the middle of "é"
+        XCTAssertNil(buffer.readString(length: 4))
+        XCTAssertEqual(buffer.readerIndex, 4)
+        
+        let composite = CompositeByteBuffer()
+            .addComponent(buffer.getSlice(at: 4, length: 4))
+            .addComponent(buffer.getSlice(at: 8, length: 5))
+        
+        XCTAssertEqual(composite.readString(length: 9), "café €")
+    }
+    
+    func testViewsReadStorageInPlace() {
+        let buffer = UnsafeByteBuffer(capacity: 64).write(bytes: Array("HEADbody".utf8))
+        buffer.readerIndex += 4
+        
+        let view = buffer.readableBytesView
+        XCTAssertEqual(view.startIndex, 4)
+        XCTAssertEqual(Array(view), Array("body".utf8))
+        XCTAssertEqual(view.index(of: UInt8(ascii: "d")), 6)
+        
+        buffer.unsafe[5] = UInt8(ascii: "O")
+        XCTAssertEqual(view[5], UInt8(ascii: "O"))
+        
+        XCTAssertEqual(buffer.withUnsafeReadableBytes { $0.count }, 4)
+        
+        let written = buffer.withUnsafeMutableWritableBytes { bytes -> Int in
+            bytes[0] = UInt8(ascii: "!")
+            return 1
+        }
+        
+        buffer.writerIndex += written
+        XCTAssertEqual(buffer.readBytes(5), Array("bOdy!".utf8))
+    }
 }
@@ -15,7 +15,7 @@ class ChannelHandlerTests: XCTestCase {
     
     func testChannelWrite() {
         let channel = Channel(socket: { channel in
-            let socket = TCPSocket(queue: channel.pipeline.executor)
+            let socket = TCPSocket(eventLoop: channel.eventLoop)
                 socket.delegate = channel
             return socket
         })
@@ -26,6 +26,119 @@ class ChannelHandlerTests: XCTestCase {
         
         repeat { Thread.sleep(forTimeInterval: 0.25) } while testRunning
     }
+    
+    /// Per hop cost of reads crossing pipelines 1 to 20 handlers
+    /// deep. Handlers all on the channel's loop are called right
+    /// away, alternating them between two loops queues every hop.
+    func testPipelineHopCost() throws {
+        let group = EventLoopGroup(loops: 2)
+        let data  = ChannelPayload.bytes(UnsafeByteBuffer(capacity: 8))
+        
+        print("[XCTEST] -- handlers  same loop ns/hop  alternating ns/hop")
+        
+        for depth in [1, 2, 5, 10, 20] {
+            let inline = try self.measureHops(depth: depth, group: group, payload: data) { PassthroughChannelHandler() }
+            let queued = try self.measureHops(depth: depth, group: group, alternating: true, payload: data) { PassthroughChannelHandler() }
+            
+            print(String(format: "[XCTEST] -- %8d  %16.1f  %18.1f", depth, inline, queued))
+        }
+    }
+    
+    /// Reads through 10 handlers on one loop, each one unwrapping
+    /// its message and firing it on. Buffers go as `.bytes` through
+    /// typed handlers, against buffers cast out of `.message` the
+    /// way untyped handlers do, and a four word value, too wide for
+    /// `Any`, boxed again on every hop. Next to the time per hop,
+    /// the heap each payload keeps alive shows what's allocated.
+    func testPayloadHopCost() throws {
+        let group  = EventLoopGroup(loops: 1)
+        let buffer = UnsafeByteBuffer(capacity: 8)
+        
+        guard case .bytes = ChannelPayload(buffer) else {
+            return XCTFail("Buffers should be wrapped as bytes")
+        }
+        
+        let cases: [(String, () -> ChannelHandler, () -> ChannelPayload)] = [
+            ("typed bytes",  { BytesForwardingHandler() },              { .bytes(buffer) }),
+            ("cast bytes",   { CastForwardingHandler() },               { .message(buffer) }),
+            ("boxed values", { TypedForwardingHandler<WideMessage>() }, { .message(WideMessage()) })
+        ]
+        
+        var heap: [String: Double] = [:]
+        
+        print("[XCTEST] -- payload       ns/hop  heap bytes/payload")
+        
+        for (name, handler, payload) in cases {
+            let perHop = try self.measureHops(depth: kPayloadHopCostDepth, group: group, payload: payload(), handler: handler)
+            
+            heap[name] = self.heapBytes(retainedBy: payload)
+            
+            print("[XCTEST] -- \(name.padding(toLength: 12, withPad: " ", startingAt: 0))  " + String(format: "%6.1f  %18.1f", perHop, heap[name]!))
+        }
+        
+        // Buffers ride inline either way, wide values get a box each
+        XCTAssertLessThan(heap["typed bytes"]!, 1)
+        XCTAssertLessThan(heap["cast bytes"]!, 1)
+        XCTAssertGreaterThanOrEqual(heap["boxed values"]!, Double(MemoryLayout<WideMessage>.size))
+    }
+    
+    /// Fires `kHopCostReads` reads of `payload` into a pipeline of
+    /// `depth` handlers, the last one counting them, and returns
+    /// the ns each hop took.
+    private func measureHops(depth: Int, group: EventLoopGroup, alternating: Bool = false, payload: ChannelPayload, handler: () -> ChannelHandler) throws -> Double {
+        let loop    = group.loops[0]
+        let counter = CountingChannelHandler(expected: kHopCostReads)
+        let channel = Channel(eventLoop: loop, socket: { channel in
+            return TCPSocket(eventLoop: channel.eventLoop)
+        })
+        
+        // Position 0 is the head, on the channel's loop
+        func executor(_ position: Int) -> EventLoop? {
+            return alternating && position % 2 == 1 ? group.loops[1] : nil
+        }
+        
+        try channel.pipeline.add(handler: counter, named: "counter", first: true, executor: executor(depth))
+        
+        // Each one goes right after the head
+        for position in (1 ..< depth).reversed() {
+            try channel.pipeline.add(handler: handler(), named: "handler_\(position)", executor: executor(position))
+        }
+        
+        let start = DispatchTime.now().uptimeNanoseconds
+        
+        try loop.sync {
+            for _ in 0 ..< kHopCostReads {
+                channel.pipeline.fireChannelRead(payload)
+            }
+        }
+        
+        XCTAssertEqual(counter.done.wait(timeout: .now() + .seconds(30)), .success, "reads went missing")
+        
+        let elapsed = DispatchTime.now().uptimeNanoseconds - start
+        
+        XCTAssertEqual(try loop.sync { counter.count }, kHopCostReads)
+        
+        return Double(elapsed) / Double(kHopCostReads * depth)
+    }
+    
+    /// Heap bytes in use per payload while `kPayloadAllocations`
+    /// of them are alive, the array holding them aside.
+    private func heapBytes(retainedBy payload: () -> ChannelPayload) -> Double {
+        var payloads: [ChannelPayload] = []
+        payloads.reserveCapacity(kPayloadAllocations)
+        
+        let before = heapBytesInUse()
+        
+        for _ in 0 ..< kPayloadAllocations {
+            payloads.append(payload())
+        }
+        
+        let after = heapBytesInUse()
+        
+        withExtendedLifetime(payloads) {}
+        
+        return Double(max(0, after - before)) / Double(kPayloadAllocations)
+    }
 }
 
 extension ChannelHandlerTests: DuplexChannelHandler {
@@ -45,7 +158,7 @@ extension ChannelHandlerTests: DuplexChannelHandler {
         _ = data.write(int32: 5, endianness: .bigEndian)
         _ = data.write(bytes: [0xb1, 0xde, 0xb3, 0xb2, 0xb0])
         
-        context.write(data)
+        context.writeAndFlush(data)
     }
     
     func channel(inactive context: ChannelHandlerContext) throws {
@@ -54,13 +167,88 @@ extension ChannelHandlerTests: DuplexChannelHandler {
         testRunning = false
     }
     
-    func channel(_ context: ChannelHandlerContext, read data: Any) throws {
+    func channel(_ context: ChannelHandlerContext, read data: ChannelPayload) throws {
         print("[XCTEST] -- Channel read! -> \(data)")
         context.fireChannelRead(data)
     }
     
-    func channel(_ context: ChannelHandlerContext, write data: Any) throws {
+    func channel(_ context: ChannelHandlerContext, write data: ChannelPayload, promise: EventLoopPromise<Void>) throws {
         print("[XCTEST] -- Channel write! -> \(data)")
-        context.write(data)
+        context.write(data, promise: promise)
+    }
+}
+
+fileprivate final class PassthroughChannelHandler: InboundChannelHandler {
+}
+
+/// Concrete on buffers, so it gets the payload matched directly.
+fileprivate final class BytesForwardingHandler: TypedInboundChannelHandler {
+    typealias InboundIn = ByteBuffer
+    
+    func channel(_ context: ChannelHandlerContext, read data: ByteBuffer) throws {
+        context.fireChannelRead(self.wrapInboundOut(data))
+    }
+}
+
+fileprivate final class TypedForwardingHandler<Message>: TypedInboundChannelHandler {
+    typealias InboundIn = Message
+    
+    func channel(_ context: ChannelHandlerContext, read data: Message) throws {
+        context.fireChannelRead(self.wrapInboundOut(data))
+    }
+}
+
+/// Untyped handlers, every hop casting its buffer out of `Any`.
+fileprivate final class CastForwardingHandler: InboundChannelHandler {
+    func channel(_ context: ChannelHandlerContext, read data: ChannelPayload) throws {
+        guard case .message(let value) = data, let buffer = value as? ByteBuffer else {
+            throw ChannelPipelineError.unexpectedPayload(expected: ByteBuffer.self)
+        }
+        
+        context.fireChannelRead(.message(buffer))
     }
 }
+
+fileprivate struct WideMessage {
+    var a: Int = 1
+    var b: Int = 2
+    var c: Int = 3
+    var d: Int = 4
+}
+
+fileprivate final class CountingChannelHandler: InboundChannelHandler {
+    let done = DispatchSemaphore(value: 0)
+    
+    private let _expected: Int
+    private var _count: Int = 0
+    
+    init(expected: Int) {
+        self._expected = expected
+    }
+    
+    var count: Int {
+        return self._count
+    }
+    
+    func channel(_ context: ChannelHandlerContext, read data: ChannelPayload) throws {
+        self._count += 1
+        
+        if  self._count == self._expected {
+            self.done.signal()
+        }
+    }
+}
+
+fileprivate func heapBytesInUse() -> Int {
+    #if os(Linux)
+    return Int(mallinfo2().uordblks)
+    #else
+    var stats = malloc_statistics_t()
+    malloc_zone_statistics(nil, &stats)
+    return Int(stats.size_in_use)
+    #endif
+}
+
+fileprivate let kHopCostReads: Int = 20_000
+fileprivate let kPayloadHopCostDepth: Int = 10
+fileprivate let kPayloadAllocations: Int = 10_000
@@ -8,6 +8,9 @@
 
 import XCTest
 @testable import Fuse
+#if os(Linux)
+import CFuse
+#endif
 
 class ChannelTests: XCTestCase {
     
@@ -16,14 +19,22 @@ class ChannelTests: XCTestCase {
             try channel.pipeline.add(handler: TestChannelHandler(), named: "test")
         }
         
-        let channel = try? bootstrap.connect(to: "163.172.34.118", port: 20212)
+        let connected = bootstrap.connect(to: "163.172.34.118", port: 20212)
         
-        XCTAssertTrue(channel != nil, "Channel is nil!")
+        XCTAssertTrue(EventLoopGroup.default.loops.contains { $0 === connected.eventLoop })
+        
+        // Initializers throwing fail the connection up front
+        let failing = Bootstrap { channel in
+            try channel.pipeline.add(handler: TestChannelHandler(), named: "test")
+            try channel.pipeline.add(handler: TestChannelHandler(), named: "test")
+        }
+        
+        XCTAssertThrowsError(try failing.connect(to: "163.172.34.118", port: 20212).wait())
     }
     
     func testChannelPipeline() {
         let channel = Channel(socket: { channel in
-            let socket = TCPSocket(queue: channel.pipeline.executor)
+            let socket = TCPSocket(eventLoop: channel.eventLoop)
                 socket.delegate = channel
             return socket
         })
@@ -37,7 +48,336 @@ class ChannelTests: XCTestCase {
         var i: Int = 0
         repeat { i+=1; Thread.sleep(forTimeInterval: 1) } while i != 10
     }
+    
+    func testAdaptiveAllocatorGrowsFastShrinksSlow() {
+        var allocator = AdaptiveRecvBufferAllocator(minimum: 64, initial: 1024, maximum: 16 * 1024)
+        
+        allocator.record(1024)
+        XCTAssertEqual(allocator.nextCapacity, 16 * 1024)
+        
+        allocator.record(16 * 1024)
+        XCTAssertEqual(allocator.nextCapacity, 16 * 1024)
+        
+        // One short read is forgiven, the second one isn't
+        allocator.record(100)
+        XCTAssertEqual(allocator.nextCapacity, 16 * 1024)
+        allocator.record(100)
+        XCTAssertEqual(allocator.nextCapacity, 8 * 1024)
+    }
+    
+    func testWritesPastHighWaterMarkAreNotWritable() throws {
+        let options = ChannelOptions(writeBufferLowWaterMark: 8, writeBufferHighWaterMark: 16)
+        let socket  = TCPSocket(eventLoop: EventLoopGroup.default.next(), options: options)
+        
+        try socket.write(data: UnsafeByteBuffer(capacity: 16).write(bytes: [UInt8](repeating: 0x2a, count: 12)))
+        XCTAssertTrue(socket.isWritable)
+        
+        // Not connected, flushing leaves them queued
+        try socket.write(data: UnsafeByteBuffer(capacity: 16).write(bytes: [UInt8](repeating: 0x2a, count: 12)))
+        try socket.flush()
+        XCTAssertFalse(socket.isWritable)
+    }
+    
+    func testEventLoopGroupHandsOutLoopsInTurn() throws {
+        let group  = EventLoopGroup(loops: 2)
+        let first  = group.next()
+        let second = group.next()
+        
+        XCTAssertFalse(first === second)
+        XCTAssertTrue(group.next() === first)
+        
+        XCTAssertFalse(first.inEventLoop)
+        XCTAssertTrue(try first.sync { first.inEventLoop })
+        
+        let channel = Channel(eventLoop: second, socket: { channel in
+            return TCPSocket(eventLoop: channel.eventLoop)
+        })
+        
+        XCTAssertTrue(channel.pipeline.executor === second)
+        XCTAssertEqual(second.channelCount, 1)
+    }
+    
+    func testEventsSkipHandlersNotHandlingThem() throws {
+        let loop    = EventLoopGroup.default.next()
+        let reader  = ReadCountingHandler()
+        let channel = Channel(eventLoop: loop, socket: { channel in
+            return TCPSocket(eventLoop: channel.eventLoop)
+        })
+        
+        try channel.pipeline.add(handler: reader, named: "reader", first: true)
+        try channel.pipeline.add(handler: ActiveOnlyHandler(), named: "active_only")
+        
+        try loop.sync {
+            channel.pipeline.fireChannelRead(.message(1))
+        }
+        
+        XCTAssertEqual(reader.reads, 1)
+        
+        // Added in between later on, still reached
+        let forwarder = ReadCountingHandler(forwarding: true)
+        
+        try channel.pipeline.add(handler: forwarder, named: "forwarder", after: "active_only")
+        
+        try loop.sync {
+            channel.pipeline.fireChannelRead(.message(2))
+        }
+        
+        XCTAssertEqual(forwarder.reads, 1)
+        XCTAssertEqual(reader.reads, 2)
+        
+        // Removed, by name or by instance, no longer reached
+        try channel.pipeline.remove(handler: "forwarder")
+        
+        try loop.sync {
+            channel.pipeline.fireChannelRead(.message(3))
+        }
+        
+        XCTAssertEqual(forwarder.reads, 1)
+        XCTAssertEqual(reader.reads, 3)
+        
+        try channel.pipeline.remove(handler: reader)
+        
+        try loop.sync {
+            channel.pipeline.fireChannelRead(.message(4))
+        }
+        
+        XCTAssertEqual(reader.reads, 3)
+        XCTAssertThrowsError(try channel.pipeline.remove(handler: "forwarder"))
+    }
+    
+    func testRemovedDecoderHandsOnWhatItHolds() throws {
+        let loop    = EventLoopGroup.default.next()
+        let reader  = ReadCountingHandler()
+        let channel = Channel(eventLoop: loop, socket: { channel in
+            return TCPSocket(eventLoop: channel.eventLoop)
+        })
+        
+        try channel.pipeline.add(handler: reader, named: "reader", first: true)
+        try channel.pipeline.add(handler: ByteToMessageHandler(decoder: FixedLengthFrameDecoder(frameLength: 4)), named: "decoder")
+        
+        try loop.sync {
+            channel.pipeline.fireChannelRead(.bytes(UnsafeByteBuffer(capacity: 6).write(bytes: [1, 2, 3, 4, 5, 6])))
+        }
+        
+        XCTAssertEqual(reader.reads, 1)
+        XCTAssertEqual(reader.bytes, [1, 2, 3, 4])
+        
+        // Half a frame left, passed on rather than lost
+        try channel.pipeline.remove(handler: "decoder")
+        
+        XCTAssertEqual(reader.reads, 2)
+        XCTAssertEqual(reader.bytes, [1, 2, 3, 4, 5, 6])
+    }
+    
+    func testWritePromisesCompleteOnTheLoop() throws {
+        let loop    = EventLoopGroup.default.next()
+        let channel = Channel(eventLoop: loop, socket: { channel in
+            return TCPSocket(eventLoop: channel.eventLoop)
+        })
+        
+        // Not connected, the bytes wait in the socket's queue
+        let written = channel.write(UnsafeByteBuffer(capacity: 4).write(bytes: Array("PING".utf8)))
+        
+        var onLoop = false
+        
+        written.whenComplete { _ in
+            onLoop = loop.inEventLoop
+        }
+        
+        XCTAssertFalse(try loop.sync { written.isFulfilled })
+        
+        // Only bytes are taken by the socket
+        XCTAssertThrowsError(try channel.write(.message("PING")).wait())
+        
+        // Never sent, closing fails it
+        channel.close()
+        
+        XCTAssertThrowsError(try written.wait())
+        XCTAssertTrue(onLoop)
+        
+        // Nothing to wait on, nothing allocated
+        let promise = EventLoopPromise<Void>.void
+        
+        XCTAssertTrue(promise.isVoid)
+        channel.write(.message("PING"), promise: promise)
+    }
+    
+    #if os(Linux)
+    func testConnectFutureCompletesOnceOpened() throws {
+        var listener = Int32(-1)
+        var port     = UInt16()
+        
+        XCTAssertEqual(fs_socket_listen("127.0.0.1", 0, 1, &listener, &port), FS_OKAY)
+        
+        let bootstrap = Bootstrap { channel in
+            try channel.pipeline.add(handler: TestChannelHandler(), named: "test")
+        }
+        
+        // Accepted by the backlog, no need to accept it here
+        let channel = try bootstrap.connect(to: "127.0.0.1", port: Int(port)).wait()
+        
+        XCTAssertTrue(try channel.eventLoop.sync { channel.isWritable })
+        
+        // Nothing listening any more, the connection is refused
+        _ = fs_socket_close(listener)
+        
+        XCTAssertThrowsError(try bootstrap.connect(to: "127.0.0.1", port: Int(port)).wait())
+    }
+    
+    func testDroppedChannelClosesItsSocket() throws {
+        var options  = ChannelOptions().socketOptions
+        var listener = Int32(-1)
+        var port     = UInt16()
+        
+        XCTAssertEqual(fs_socket_listen("127.0.0.1", 0, 1, &listener, &port), FS_OKAY)
+        defer { _ = fs_socket_close(listener) }
+        
+        var channel: Channel? = try Bootstrap { _ in }.connect(to: "127.0.0.1", port: Int(port)).wait()
+        
+        XCTAssertNotNil(channel)
+        channel = nil
+        
+        var peer = Int32(-1)
+        
+        for _ in 0 ..< 200 {
+            XCTAssertEqual(fs_socket_accept(listener, &options, &peer), FS_OKAY)
+            
+            if peer != -1 {
+                break
+            }
+            
+            usleep(10_000)
+        }
+        
+        defer { _ = fs_socket_close(peer) }
+        
+        // The peer finds the end once the channel's gone
+        var byte   = UInt8()
+        var result = -1
+        
+        for _ in 0 ..< 200 {
+            result = recv(peer, &byte, 1, 0)
+            
+            if result != -1 {
+                break
+            }
+            
+            usleep(10_000)
+        }
+        
+        XCTAssertEqual(result, 0)
+    }
+    
+    func testEpollSocketEchoesOverLoopback() throws {
+        try self.echoOverLoopback(EpollSocket.self, on: EventLoopGroup.default.next())
+    }
+    
+    func testUringSocketEchoesOverLoopback() throws {
+        let loop = EventLoopGroup.default.next()
+        
+        guard loop.supportsIoUring else {
+            print("io_uring unavailable, skipped")
+            return
+        }
+        
+        try self.echoOverLoopback(UringSocket.self, on: loop)
+    }
+    
+    private func echoOverLoopback(_ type: Socket.Type, on loop: EventLoop) throws {
+        var options  = ChannelOptions().socketOptions
+        var listener = Int32(-1)
+        var port     = UInt16()
+        
+        XCTAssertEqual(fs_socket_listen("127.0.0.1", 0, 1, &listener, &port), FS_OKAY)
+        defer { _ = fs_socket_close(listener) }
+        
+        let delegate = LoopbackDelegate(expectation: self.expectation(description: "PONG"))
+        let socket   = type.init(eventLoop: loop, options: ChannelOptions())
+        
+        socket.delegate = delegate
+        
+        let sent = loop.newPromise(of: Void.self)
+        
+        try loop.sync {
+            try socket.connect(to: "127.0.0.1", port: Int(port))
+            try socket.write(data: UnsafeByteBuffer(capacity: 4).write(bytes: Array("PING".utf8)), promise: sent)
+            try socket.flush()
+        }
+        
+        var peer = Int32(-1)
+        
+        for _ in 0 ..< 200 {
+            XCTAssertEqual(fs_socket_accept(listener, &options, &peer), FS_OKAY)
+            
+            if peer != -1 {
+                break
+            }
+            
+            usleep(10_000)
+        }
+        
+        defer { _ = fs_socket_close(peer) }
+        
+        // Queued before the connection opened, sent once it did
+        let buffer = UnsafeByteBuffer(capacity: 4)
+        var count  = UInt32()
+        
+        for _ in 0 ..< 200 {
+            XCTAssertEqual(fs_socket_read(peer, &buffer.handle, 4, &count), FS_OKAY)
+            
+            if count != 0 {
+                break
+            }
+            
+            usleep(10_000)
+        }
+        
+        XCTAssertEqual(buffer.readBytes(4), Array("PING".utf8))
+        XCTAssertNoThrow(try sent.futureResult.wait())
+        XCTAssertEqual(send(peer, "PONG", 4, 0), 4)
+        
+        self.waitForExpectations(timeout: 2)
+        XCTAssertEqual(delegate.received, Array("PONG".utf8))
+        
+        try loop.sync {
+            try socket.close()
+        }
+    }
+    #endif
+}
+
+#if os(Linux)
+private final class LoopbackDelegate: SocketDelegate {
+    private let _expectation: XCTestExpectation
+    
+    var received: [UInt8] = []
+    
+    init(expectation: XCTestExpectation) {
+        self._expectation = expectation
+    }
+    
+    func socket(opened socket: Socket) {
+    }
+    
+    func socket(closed socket: Socket) {
+    }
+    
+    func socket(_ socket: Socket, hasCaughtError error: Error) {
+        XCTFail(String(describing: error))
+    }
+    
+    func socket(_ socket: Socket, hasBytesAvailable bytes: ByteBuffer) {
+        self.received += bytes.readBytes(bytes.readableBytes)
+        
+        if  self.received.count == 4 {
+            self._expectation.fulfill()
+        }
+    }
+    
+    func socket(writabilityChanged socket: Socket) {
+    }
 }
+#endif
 
 private class TestChannelHandler: DuplexChannelHandler {
     func channel(active context: ChannelHandlerContext) throws {
@@ -48,3 +388,36 @@ private class TestChannelHandler: DuplexChannelHandler {
         print("[\(String(describing: Thread.current.name))] -- ChannelInactive")
     }
 }
+
+private final class ActiveOnlyHandler: InboundChannelHandler {
+    var handledEvents: ChannelEvents {
+        return .active
+    }
+    
+    func channel(_ context: ChannelHandlerContext, read data: ChannelPayload) throws {
+        XCTFail("Reads should go past a handler not handling them")
+    }
+}
+
+private final class ReadCountingHandler: InboundChannelHandler {
+    private let _forwarding: Bool
+    
+    var reads: Int = 0
+    var bytes: [UInt8] = []
+    
+    init(forwarding: Bool = false) {
+        self._forwarding = forwarding
+    }
+    
+    func channel(_ context: ChannelHandlerContext, read data: ChannelPayload) throws {
+        self.reads += 1
+        
+        if  let buffer = data.bytes {
+            self.bytes += buffer.getBytes(at: buffer.readerIndex, length: buffer.readableBytes)
+        }
+        
+        if  self._forwarding {
+            context.fireChannelRead(data)
+        }
+    }
+}